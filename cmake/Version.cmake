@@ -11,7 +11,7 @@ set(DATAFED_COMMON_LIB_MINOR 0)
 set(DATAFED_COMMON_LIB_PATCH 2)
 
 set(DATAFED_COMMON_PROTOCOL_API_MAJOR 1)
-set(DATAFED_COMMON_PROTOCOL_API_MINOR 1)
+set(DATAFED_COMMON_PROTOCOL_API_MINOR 2)
 set(DATAFED_COMMON_PROTOCOL_API_PATCH 0)
 
 set(DATAFED_CORE_MAJOR 1)
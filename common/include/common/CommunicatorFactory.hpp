@@ -10,6 +10,7 @@
 
 // Standard includes
 #include <memory>
+#include <vector>
 
 namespace SDMS {
 
@@ -25,6 +26,18 @@ public:
                                         const ICredentials &credentials,
                                         uint32_t timeout_on_receive,
                                         long timeout_on_poll) const;
+
+  /**
+   * Sizes the ZeroMQ context shared by all TCP communicators of the process.
+   * Must be called before the first TCP communicator is created, returns
+   * false if that has already happened and the settings were ignored.
+   *
+   * io_threads - ZeroMQ I/O threads, CURVE encryption of many connections is
+   *              spread across them
+   * cpus       - cores to pin the I/O threads to, empty leaves it to the OS
+   **/
+  static bool configureTcpContext(int io_threads,
+                                  const std::vector<int> &cpus = {});
 };
 
 } // namespace SDMS
@@ -7,69 +7,70 @@
 #include <syslog.h>
 
 // Standard includes
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <sstream>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
-// Have to use macros for the line and func macros to work
+/**
+ * Compile-time log level threshold. Log statements more verbose than this
+ * level (see LogLevel below) are compiled out entirely, so they cost nothing
+ * even when the runtime level would enable them. Set through the
+ * DATAFED_COMPILE_LOG_LEVEL CMake variable, defaults to keeping all levels.
+ **/
+#ifndef DATAFED_COMPILE_LOG_LEVEL
+#define DATAFED_COMPILE_LOG_LEVEL 5
+#endif
+
+// Have to use macros for the line and func macros to work. The message
+// arguments are only evaluated if the level is enabled, so they may be
+// arbitrarily expensive (i.e. DebugString()).
 #define DL_LOG(level, context, message)                                        \
   {                                                                            \
-    std::stringstream temp_buffer;                                             \
-    temp_buffer << message;                                                    \
-    ::SDMS::global_logger.log(level, __FILE__, __func__, __LINE__, context,    \
-                              temp_buffer.str());                              \
+    if (static_cast<unsigned int>(level) <= DATAFED_COMPILE_LOG_LEVEL &&       \
+        ::SDMS::global_logger.isEnabled(level)) {                              \
+      std::stringstream temp_buffer;                                           \
+      temp_buffer << message;                                                  \
+      ::SDMS::global_logger.log(level, __FILE__, __func__, __LINE__, context,  \
+                                temp_buffer.str());                            \
+    }                                                                          \
   }
 
-#define DL_CRITICAL(context, message)                                          \
+#define DL_LOG_AT(level, method, context, message)                             \
   {                                                                            \
-    std::stringstream temp_buffer;                                             \
-    temp_buffer << message;                                                    \
-    ::SDMS::global_logger.critical(__FILE__, __func__, __LINE__, context,      \
-                                   temp_buffer.str());                         \
+    if constexpr (static_cast<unsigned int>(level) <=                          \
+                  DATAFED_COMPILE_LOG_LEVEL) {                                 \
+      if (::SDMS::global_logger.isEnabled(level)) {                            \
+        std::stringstream temp_buffer;                                         \
+        temp_buffer << message;                                                \
+        ::SDMS::global_logger.method(__FILE__, __func__, __LINE__, context,    \
+                                     temp_buffer.str());                       \
+      }                                                                        \
+    }                                                                          \
   }
 
+#define DL_CRITICAL(context, message)                                          \
+  DL_LOG_AT(::SDMS::LogLevel::CRITICAL, critical, context, message)
+
 #define DL_ERROR(context, message)                                             \
-  {                                                                            \
-    std::stringstream temp_buffer;                                             \
-    temp_buffer << message;                                                    \
-    ::SDMS::global_logger.error(__FILE__, __func__, __LINE__, context,         \
-                                temp_buffer.str());                            \
-  }
+  DL_LOG_AT(::SDMS::LogLevel::ERROR, error, context, message)
 
 #define DL_WARNING(context, message)                                           \
-  {                                                                            \
-    std::stringstream temp_buffer;                                             \
-    temp_buffer << message;                                                    \
-    ::SDMS::global_logger.warning(__FILE__, __func__, __LINE__, context,       \
-                                  temp_buffer.str());                          \
-  }
+  DL_LOG_AT(::SDMS::LogLevel::WARNING, warning, context, message)
 
 #define DL_INFO(context, message)                                              \
-  {                                                                            \
-    std::stringstream temp_buffer;                                             \
-    temp_buffer << message;                                                    \
-    ::SDMS::global_logger.info(__FILE__, __func__, __LINE__, context,          \
-                               temp_buffer.str());                             \
-  }
+  DL_LOG_AT(::SDMS::LogLevel::INFO, info, context, message)
 
 #define DL_DEBUG(context, message)                                             \
-  {                                                                            \
-    std::stringstream temp_buffer;                                             \
-    temp_buffer << message;                                                    \
-    ::SDMS::global_logger.debug(__FILE__, __func__, __LINE__, context,         \
-                                temp_buffer.str());                            \
-  }
+  DL_LOG_AT(::SDMS::LogLevel::DEBUG, debug, context, message)
 
 #define DL_TRACE(context, message)                                             \
-  {                                                                            \
-    std::stringstream temp_buffer;                                             \
-    temp_buffer << message;                                                    \
-    ::SDMS::global_logger.trace(__FILE__, __func__, __LINE__, context,         \
-                                temp_buffer.str());                            \
-  }
+  DL_LOG_AT(::SDMS::LogLevel::TRACE, trace, context, message)
 
 namespace SDMS {
 
@@ -115,24 +116,66 @@ public:
 };
 std::ostream &operator<<(std::ostream &out, const LogLine &log_line);
 
+/**
+ * What asynchronous logging does when the queue is full.
+ *
+ * DROP  - Discard the new line and count it, the caller never waits
+ * BLOCK - Wait for the writer thread to free up space
+ **/
+enum class LogOverflow : unsigned int { DROP, BLOCK };
+
 class Logger {
 private:
+  class AsyncWriter;
+
   // Parameters
   std::vector<std::reference_wrapper<std::ostream>> m_streams;
-  LogLevel m_log_level = LogLevel::INFO;
+  std::atomic<LogLevel> m_log_level{LogLevel::INFO};
   bool m_output_to_syslog = false;
   mutable std::vector<std::unique_ptr<std::mutex>> m_mutexes;
+  std::unique_ptr<AsyncWriter> m_async;
 
   // Internal Methods
   void output(const LogLevel, std::string, std::string, int,
               const LogContext &context, const std::string &message);
+  void write(const LogLevel, const boost::posix_time::ptime &,
+             const std::string &, const std::string &, int,
+             const LogContext &context, const std::string &message,
+             bool flush);
+  void flushStreams();
 
 public:
+  Logger();
+  ~Logger();
+
   // Methods
   void setLevel(LogLevel) noexcept;
   void addStream(std::ostream &stream);
+  /// Stop writing to a stream, must not be called while other threads log
+  void removeStream(std::ostream &stream);
   void setSysLog(bool on_or_off) noexcept { m_output_to_syslog = on_or_off; }
 
+  /**
+   * Hand log lines to a background writer thread through a bounded queue of
+   * a_queue_size lines instead of writing them on the calling thread. Lines
+   * are written in batches and streams are only flushed once per batch.
+   * Should be called at startup, after the streams have been added and
+   * before other threads start logging.
+   **/
+  void setAsync(size_t a_queue_size,
+                LogOverflow a_overflow = LogOverflow::DROP);
+  /// Wait until all queued log lines have been written
+  void flush();
+  /// Number of log lines discarded because the async queue was full
+  uint64_t droppedCount() const noexcept;
+
+  /// True if messages of the given level are written at the current level
+  bool isEnabled(const LogLevel level) const noexcept {
+    return static_cast<unsigned int>(level) <=
+           static_cast<unsigned int>(
+               m_log_level.load(std::memory_order_relaxed));
+  }
+
   void log(const LogLevel, std::string file_name, std::string func_name, int,
            const LogContext &context, const std::string &message);
   void critical(std::string file_name, std::string func_name, int,
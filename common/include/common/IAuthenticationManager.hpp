@@ -4,6 +4,7 @@
 #pragma once
 
 // Standard imports
+#include <cstdint>
 #include <string>
 
 namespace SDMS {
@@ -51,6 +52,43 @@ public:
    **/
   virtual std::string getUID(const std::string &pub_key) const = 0;
 
+  /**
+   * Looks up the key, counts the access and sets uid. Returns false if the
+   *key is not known. Implementations should override this to answer with a
+   *single lookup instead of three.
+   **/
+  virtual bool authenticate(const std::string &pub_key, std::string &uid) {
+    if (!hasKey(pub_key)) {
+      return false;
+    }
+    incrementKeyAccessCounter(pub_key);
+    uid = getUID(pub_key);
+    return true;
+  }
+
+  /**
+   * Will return true if hasKey and getUID can answer for the key without
+   *blocking. Otherwise the key is looked up in the background, this returns
+   *false and the caller should ask again later.
+   **/
+  virtual bool resolveKeyAsync(const std::string &pub_key) {
+    (void)pub_key;
+    return true;
+  }
+
+  /**
+   * Will return false if the user may not send another request of the given
+   *message type right now, retry_after_ms is then set to the time until a
+   *retry may succeed. Requests are not limited by default.
+   **/
+  virtual bool admit(const std::string &uid, uint16_t msg_type,
+                     uint32_t &retry_after_ms) {
+    (void)uid;
+    (void)msg_type;
+    (void)retry_after_ms;
+    return true;
+  }
+
   /**
    * Purge keys if needed
    **/
@@ -35,6 +35,13 @@ public:
    **/
   virtual Response poll(const MessageType) = 0;
 
+  /**
+   * Same as poll but only the routes and header parts are decoded, the body
+   * is kept as an opaque IRawPayload so it can be forwarded by send without
+   * being parsed and serialized again.
+   **/
+  virtual Response pollPassThrough(const MessageType) = 0;
+
   /**
    * This is technical debt in the future get rid of MsgBuf and replace with
    * IMessage
@@ -48,6 +55,12 @@ public:
   virtual const std::string id() const noexcept = 0;
   virtual const std::string address() const noexcept = 0;
 
+  /**
+   * The underlying transport socket, i.e. the zmq socket, so a server can
+   * wait on several communicators with a single poll call.
+   **/
+  virtual void *nativeHandle() const noexcept = 0;
+
   virtual ~ICommunicator(){};
 };
 
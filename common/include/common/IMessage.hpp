@@ -3,6 +3,7 @@
 #pragma once
 
 // Standard includes
+#include <chrono>
 #include <list>
 #include <memory>
 #include <string>
@@ -50,6 +51,20 @@ const std::string CONTEXT = "context";
 } // namespace message
 } // namespace constants
 
+/**
+ * An already serialized message body owned by the transport layer.
+ *
+ * Used when forwarding a message without decoding it, i.e. by a proxy, so
+ * the body received from one socket can be handed to another without being
+ * parsed into a protobuf message and serialized again.
+ **/
+class IRawPayload {
+public:
+  virtual ~IRawPayload(){};
+  virtual const void *data() const = 0;
+  virtual size_t size() const = 0;
+};
+
 class IMessage {
 public:
 
@@ -68,6 +83,12 @@ public:
   virtual void
       setPayload(std::variant<std::unique_ptr<::google::protobuf::Message>,
                               std::string>) = 0;
+  /**
+   * Store an opaque serialized body in place of a decoded payload, the frame
+   * attributes must already describe it. Setting either kind of payload
+   * clears the other one.
+   **/
+  virtual void setRawPayload(std::unique_ptr<IRawPayload>) = 0;
   virtual void addRoute(const std::string &route) = 0;
 
   virtual void setRoutes(const std::list<std::string> &routes) = 0;
@@ -77,6 +98,14 @@ public:
 
   virtual void set(std::string attribute_name,
                    std::variant<uint8_t, uint16_t, uint32_t>) = 0;
+
+  /**
+   * Point after which the sender of a request no longer waits for the reply,
+   * time_point::max() if there is none. It travels as the time left so the
+   * clocks of sender and receiver need not agree, and is never copied into a
+   * response.
+   **/
+  virtual void setDeadline(std::chrono::steady_clock::time_point) = 0;
   /**
    * Getters
    **/
@@ -92,11 +121,15 @@ public:
   virtual MessageType type() const noexcept = 0;
   virtual std::variant<uint8_t, uint16_t, uint32_t>
   get(const std::string &attribute_name) const = 0;
+  virtual std::chrono::steady_clock::time_point getDeadline() const = 0;
 
   /// Note not returning a unique_ptr but a raw pointer because the message
   // should stil have ownership of the object.
   virtual std::variant<google::protobuf::Message *, std::string>
   getPayload() = 0;
+
+  /// Returns nullptr unless the body was received without being decoded
+  virtual IRawPayload *getRawPayload() = 0;
 };
 
 } // namespace SDMS
@@ -5,6 +5,9 @@
 // Local includes
 #include "OperatorTypes.hpp"
 
+// Standard includes
+#include <memory>
+
 namespace SDMS {
 
 class IMessage;
@@ -15,6 +18,26 @@ public:
   virtual ~IOperator() {};
   virtual OperatorType type() const noexcept = 0;
   virtual void execute(IMessage &message) = 0;
+
+  /**
+   * Returns false if execute can not yet run on the message without
+   * blocking, i.e. it is waiting on a background lookup. The caller should
+   * hold on to the message and ask again later.
+   **/
+  virtual bool ready(IMessage &message) {
+    (void)message;
+    return true;
+  }
+
+  /**
+   * Asked after execute. Returns a reply to send straight back to the sender
+   * instead of passing the message on, i.e. to refuse it, or null to pass it
+   * on.
+   **/
+  virtual std::unique_ptr<IMessage> reply(IMessage &message) {
+    (void)message;
+    return nullptr;
+  }
 };
 
 } // namespace SDMS
@@ -12,6 +12,7 @@
 // Standard includes
 #include <map>
 #include <unordered_map>
+#include <vector>
 #include <cstdint>
 
 namespace SDMS {
@@ -20,28 +21,53 @@ class ProtoBufMap : public IMessageMapper {
 public:
   typedef std::map<uint8_t, const ::google::protobuf::FileDescriptor *>
       FileDescriptorMap;
-  typedef std::map<uint16_t, const ::google::protobuf::Descriptor *>
-      DescriptorMap;
-  typedef std::map<const ::google::protobuf::Descriptor *, uint16_t> MsgTypeMap;
+  typedef std::unordered_map<const ::google::protobuf::Descriptor *, uint16_t>
+      MsgTypeMap;
 
 private:
   FileDescriptorMap m_file_descriptor_map;
-  DescriptorMap m_descriptor_map;
   MsgTypeMap m_msg_type_map;
   std::unordered_map<MessageProtocol, uint16_t> m_protocol_ids;
+  /// Flat tables indexed by message type, entries are null for gaps between
+  /// protocols
+  std::vector<const ::google::protobuf::Descriptor *> m_descriptors;
+  std::vector<const ::google::protobuf::Message *> m_prototypes;
+
+  void registerProtocol(const ::google::protobuf::EnumDescriptor *a_enum_desc,
+                        MessageProtocol a_protocol);
 
 public:
   ProtoBufMap();
 
+  /**
+   * Process-wide registry, the map never changes once built so it can be
+   * shared by all threads instead of being built for each use.
+   **/
+  static const ProtoBufMap &getInstance() {
+    static const ProtoBufMap inst;
+    return inst;
+  }
+
   const ::google::protobuf::Descriptor *
   getDescriptorType(uint16_t message_type) const;
-  bool exists(uint16_t message_type) const {
-    return m_descriptor_map.count(message_type) > 0;
+  bool exists(uint16_t message_type) const noexcept {
+    return message_type < m_descriptors.size() &&
+           m_descriptors[message_type] != nullptr;
+  }
+  /**
+   * Default instance of the message type, new messages are created from it
+   * with New() without having to go through the protobuf message factory.
+   **/
+  const ::google::protobuf::Message *getPrototype(uint16_t message_type) const;
+  /// Highest registered message type, tables indexed by message type need
+  /// maxMessageType() + 1 entries
+  uint16_t maxMessageType() const noexcept {
+    return static_cast<uint16_t>(m_descriptors.size() - 1);
   }
-  uint16_t getMessageType(::google::protobuf::Message &);
+  uint16_t getMessageType(::google::protobuf::Message &) const;
   std::string toString(uint16_t MessageType) const;
   virtual uint16_t getMessageType(uint8_t a_proto_id,
-                                  const std::string &a_message_name) final;
+                                  const std::string &a_message_name) const final;
   virtual uint8_t getProtocolID(MessageProtocol) const final;
 };
 } // namespace SDMS
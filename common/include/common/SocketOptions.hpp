@@ -32,6 +32,21 @@ enum class SocketDirectionalityType { UNIDIRECTIONAL, BIDIRECTIONAL };
 
 enum class SocketConnectionSecurity { SECURE, INSECURE };
 
+/**
+ * LEGACY  - message metadata is sent as one frame per field, understood by
+ *           every DataFed client
+ * COMPACT - message metadata is packed into a single header frame, only for
+ *           DEALER/ROUTER links where both ends run this library
+ **/
+enum class WireFormat { LEGACY, COMPACT };
+
+/// Default ceiling on the size of a message body
+const uint32_t DEFAULT_MAX_MESSAGE_SIZE = 256 * 1024 * 1024;
+
+/// Default ceiling on the size of a request from a peer that has not yet
+/// been authenticated
+const uint32_t DEFAULT_MAX_REQUEST_SIZE = 1024 * 1024;
+
 /**
  * Will deconstruct a string address into scheme, host and port
  *
@@ -75,6 +90,26 @@ struct SocketOptions {
   std::string host = "";
   std::optional<uint16_t> port;
   std::optional<std::string> local_id;
+  /**
+   * Message bodies larger than chunk_size are sent as a sequence of frames of
+   * at most chunk_size bytes. 0 sends every body as a single frame, peers
+   * that do not understand chunked bodies require this.
+   **/
+  uint32_t chunk_size = 0;
+  /// Largest message body that will be sent or accepted, protobuf can not
+  /// handle messages above 2 GiB
+  uint32_t max_message_size = DEFAULT_MAX_MESSAGE_SIZE;
+  /**
+   * Largest message body that will be accepted, defaults to max_message_size.
+   * ZeroMQ drops the connection of a peer that sends a larger frame before it
+   * is buffered, so sockets facing untrusted peers should keep this small.
+   **/
+  std::optional<uint32_t> max_receive_size;
+  /**
+   * Format used for requests sent from this socket. Responses always use the
+   * format the request arrived in, so a socket can serve both kinds of peer.
+   **/
+  WireFormat wire_format = WireFormat::LEGACY;
 };
 
 } // namespace SDMS
@@ -3,6 +3,7 @@
 #include "communicators/ZeroMQCommunicator.hpp"
 #include "communicators/ZeroMQCommunicatorSecure.hpp"
 #include "sockets/ZeroMQSocket.hpp"
+#include "support/zeromq/Context.hpp"
 
 // Local public includes
 #include "common/CommunicatorFactory.hpp"
@@ -31,4 +32,9 @@ std::unique_ptr<ICommunicator> CommunicatorFactory::create(
   return std::unique_ptr<ICommunicator>();
 }
 
+bool CommunicatorFactory::configureTcpContext(int io_threads,
+                                              const std::vector<int> &cpus) {
+  return TcpContext::configure(io_threads, cpus);
+}
+
 } // namespace SDMS
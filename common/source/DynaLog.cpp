@@ -3,13 +3,253 @@
 #include "common/DynaLog.hpp"
 
 // Standard includes
+#include <chrono>
+#include <condition_variable>
 #include <optional>
 #include <string>
+#include <thread>
 
 namespace SDMS {
 
 Logger global_logger;
 
+// Max number of lines written between stream flushes
+#define LOG_ASYNC_BATCH_MAX 512
+// Idle writer thread wakes up at least this often
+#define LOG_ASYNC_IDLE_WAIT_MS 10
+
+/**
+ * Background writer for asynchronous logging.
+ *
+ * Log lines are handed over through a bounded multi-producer/single-consumer
+ * ring buffer. Producers claim a slot with a single compare-and-swap and never
+ * take a lock, unless the writer thread is idle and needs to be woken up. The
+ * writer thread formats the lines, writes them in batches and flushes the
+ * streams once per batch.
+ */
+class Logger::AsyncWriter {
+public:
+  AsyncWriter(Logger &a_logger, size_t a_queue_size, LogOverflow a_overflow);
+  ~AsyncWriter();
+
+  void push(const LogLevel a_level, std::string &&a_file, std::string &&a_func,
+            int a_line_num, const LogContext &a_context,
+            const std::string &a_message);
+  void flush();
+  uint64_t dropped() const noexcept { return m_dropped.load(); }
+
+private:
+  struct Record {
+    LogLevel level = LogLevel::INFO;
+    boost::posix_time::ptime time;
+    std::string file;
+    std::string func;
+    int line_num = 0;
+    LogContext context;
+    std::string message;
+  };
+
+  struct Cell {
+    std::atomic<size_t> seq;
+    Record record;
+  };
+
+  bool tryPush(Record &a_record);
+  bool pop(Record &a_record);
+  bool empty() const;
+  void wakeWriter();
+  void writerThread();
+
+  Logger &m_logger;
+  LogOverflow m_overflow;
+  std::unique_ptr<Cell[]> m_cells;
+  size_t m_mask;
+  std::atomic<size_t> m_enqueue_pos;
+  size_t m_dequeue_pos; ///< Only used by the writer thread
+  std::atomic<uint64_t> m_dropped;
+  std::atomic<uint64_t> m_pushed;
+  std::atomic<bool> m_sleeping;
+  std::mutex m_mutex;
+  std::condition_variable m_cvar;
+  std::condition_variable m_flush_cvar;
+  bool m_run;         ///< Guarded by m_mutex
+  uint64_t m_written; ///< Guarded by m_mutex
+  std::thread m_thread;
+};
+
+Logger::AsyncWriter::AsyncWriter(Logger &a_logger, size_t a_queue_size,
+                                 LogOverflow a_overflow)
+    : m_logger(a_logger), m_overflow(a_overflow), m_enqueue_pos(0),
+      m_dequeue_pos(0), m_dropped(0), m_pushed(0), m_sleeping(false),
+      m_run(true), m_written(0) {
+  // Slot lookup uses a mask, so round capacity up to a power of 2
+  size_t capacity = 2;
+  while (capacity < a_queue_size)
+    capacity <<= 1;
+
+  m_cells.reset(new Cell[capacity]);
+  m_mask = capacity - 1;
+
+  for (size_t i = 0; i < capacity; i++)
+    m_cells[i].seq.store(i, std::memory_order_relaxed);
+
+  m_thread = std::thread(&Logger::AsyncWriter::writerThread, this);
+}
+
+Logger::AsyncWriter::~AsyncWriter() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_run = false;
+  }
+
+  m_cvar.notify_one();
+  m_thread.join();
+}
+
+void Logger::AsyncWriter::push(const LogLevel a_level, std::string &&a_file,
+                               std::string &&a_func, int a_line_num,
+                               const LogContext &a_context,
+                               const std::string &a_message) {
+  Record record;
+  record.level = a_level;
+  record.time = boost::posix_time::microsec_clock::universal_time();
+  record.file = std::move(a_file);
+  record.func = std::move(a_func);
+  record.line_num = a_line_num;
+  record.context = a_context;
+  record.message = a_message;
+
+  while (!tryPush(record)) {
+    if (m_overflow == LogOverflow::DROP) {
+      m_dropped++;
+      return;
+    }
+
+    wakeWriter();
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+
+  m_pushed++;
+
+  if (m_sleeping.load())
+    wakeWriter();
+}
+
+void Logger::AsyncWriter::flush() {
+  uint64_t target = m_pushed.load();
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  m_cvar.notify_one();
+  m_flush_cvar.wait(lock, [this, target] { return m_written >= target; });
+}
+
+bool Logger::AsyncWriter::tryPush(Record &a_record) {
+  Cell *cell;
+  size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+
+  while (true) {
+    cell = &m_cells[pos & m_mask];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+    if (diff == 0) {
+      if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      // Queue is full
+      return false;
+    } else {
+      pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->record = std::move(a_record);
+  cell->seq.store(pos + 1, std::memory_order_release);
+
+  return true;
+}
+
+bool Logger::AsyncWriter::pop(Record &a_record) {
+  Cell *cell = &m_cells[m_dequeue_pos & m_mask];
+
+  if (cell->seq.load(std::memory_order_acquire) != m_dequeue_pos + 1)
+    return false;
+
+  a_record = std::move(cell->record);
+  cell->seq.store(m_dequeue_pos + m_mask + 1, std::memory_order_release);
+  m_dequeue_pos++;
+
+  return true;
+}
+
+bool Logger::AsyncWriter::empty() const {
+  return m_cells[m_dequeue_pos & m_mask].seq.load(
+             std::memory_order_acquire) != m_dequeue_pos + 1;
+}
+
+void Logger::AsyncWriter::wakeWriter() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_cvar.notify_one();
+}
+
+void Logger::AsyncWriter::writerThread() {
+  Record record;
+  uint64_t reported_dropped = 0;
+  uint64_t dropped;
+  size_t count;
+  LogContext log_context;
+
+  log_context.thread_name = "logWriter";
+
+  while (true) {
+    count = 0;
+
+    while (count < LOG_ASYNC_BATCH_MAX && pop(record)) {
+      m_logger.write(record.level, record.time, record.file, record.func,
+                     record.line_num, record.context, record.message, false);
+      count++;
+    }
+
+    dropped = m_dropped.load();
+    if (dropped != reported_dropped) {
+      m_logger.write(LogLevel::WARNING,
+                     boost::posix_time::microsec_clock::universal_time(),
+                     __FILE__, __func__, __LINE__, log_context,
+                     "Log queue full, dropped " +
+                         std::to_string(dropped - reported_dropped) +
+                         " lines",
+                     false);
+      reported_dropped = dropped;
+      count++;
+    }
+
+    if (count) {
+      m_logger.flushStreams();
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_written += count;
+      m_flush_cvar.notify_all();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // Only exit once the queue has been drained
+    if (!m_run)
+      break;
+
+    m_sleeping.store(true);
+    if (empty())
+      m_cvar.wait_for(lock, std::chrono::milliseconds(LOG_ASYNC_IDLE_WAIT_MS));
+    m_sleeping.store(false);
+  }
+}
+
+Logger::Logger() {}
+
+Logger::~Logger() { m_async.reset(); }
+
 std::string toString(const LogLevel level) {
   if (level == LogLevel::TRACE) {
     return "TRACE";
@@ -78,20 +318,33 @@ std::ostream &operator<<(std::ostream &out, const LogLine &log_line) {
 void Logger::output(const LogLevel level, std::string file, std::string func,
                     int line_num, const LogContext &context,
                     const std::string &message) {
+  if (m_async) {
+    m_async->push(level, std::move(file), std::move(func), line_num, context,
+                  message);
+    return;
+  }
 
+  write(level, boost::posix_time::microsec_clock::universal_time(), file, func,
+        line_num, context, message, true);
+}
+
+void Logger::write(const LogLevel level, const boost::posix_time::ptime &time,
+                   const std::string &file, const std::string &func,
+                   int line_num, const LogContext &context,
+                   const std::string &message, bool flush) {
   size_t index = 0;
   for (auto &output_stream : m_streams) {
     std::lock_guard<std::mutex> lock(*m_mutexes.at(index));
     index++;
-    boost::posix_time::ptime time =
-        boost::posix_time::microsec_clock::universal_time();
     output_stream.get() << boost::posix_time::to_iso_extended_string(time)
                         << "Z ";
     output_stream.get() << toString(level) << " ";
     output_stream.get() << file << ":" << func << ":" << line_num << " ";
     LogLine log_line(context, message);
     output_stream.get() << log_line;
-    output_stream.get() << std::endl;
+    output_stream.get() << '\n';
+    if (flush)
+      output_stream.get().flush();
   }
 
   if (m_output_to_syslog) {
@@ -105,52 +358,85 @@ void Logger::output(const LogLevel level, std::string file, std::string func,
   }
 }
 
+void Logger::flushStreams() {
+  size_t index = 0;
+  for (auto &output_stream : m_streams) {
+    std::lock_guard<std::mutex> lock(*m_mutexes.at(index));
+    index++;
+    output_stream.get().flush();
+  }
+}
+
 void Logger::setLevel(LogLevel level) noexcept { m_log_level = level; }
 
+void Logger::setAsync(size_t a_queue_size, LogOverflow a_overflow) {
+  // Drains and stops any previous writer first
+  m_async.reset();
+
+  if (a_queue_size)
+    m_async = std::make_unique<AsyncWriter>(*this, a_queue_size, a_overflow);
+}
+
+void Logger::flush() {
+  if (m_async)
+    m_async->flush();
+}
+
+uint64_t Logger::droppedCount() const noexcept {
+  return m_async ? m_async->dropped() : 0;
+}
+
 void Logger::addStream(std::ostream &stream) {
   m_streams.push_back(std::ref(stream));
   m_mutexes.emplace_back(std::make_unique<std::mutex>());
 }
 
+void Logger::removeStream(std::ostream &stream) {
+  // Lines still queued for the stream are written first
+  flush();
+
+  for (size_t index = 0; index < m_streams.size(); ++index) {
+    if (&m_streams[index].get() == &stream) {
+      m_streams.erase(m_streams.begin() + index);
+      m_mutexes.erase(m_mutexes.begin() + index);
+      return;
+    }
+  }
+}
+
 void Logger::trace(std::string file, std::string func, int line_num,
                    const LogContext &context, const std::string &message) {
-  if (static_cast<unsigned int>(m_log_level) >=
-      static_cast<unsigned int>(LogLevel::TRACE)) {
+  if (isEnabled(LogLevel::TRACE)) {
     output(LogLevel::TRACE, file, func, line_num, context, message);
   }
 }
 void Logger::debug(std::string file, std::string func, int line_num,
                    const LogContext &context, const std::string &message) {
-  if (static_cast<unsigned int>(m_log_level) >=
-      static_cast<unsigned int>(LogLevel::DEBUG)) {
+  if (isEnabled(LogLevel::DEBUG)) {
     output(LogLevel::DEBUG, file, func, line_num, context, message);
   }
 }
 void Logger::info(std::string file, std::string func, int line_num,
                   const LogContext &context, const std::string &message) {
-  if (static_cast<unsigned int>(m_log_level) >=
-      static_cast<unsigned int>(LogLevel::INFO)) {
+  if (isEnabled(LogLevel::INFO)) {
     output(LogLevel::INFO, file, func, line_num, context, message);
   }
 }
 void Logger::warning(std::string file, std::string func, int line_num,
                      const LogContext &context, const std::string &message) {
-  if (static_cast<unsigned int>(m_log_level) >=
-      static_cast<unsigned int>(LogLevel::WARNING)) {
+  if (isEnabled(LogLevel::WARNING)) {
     output(LogLevel::WARNING, file, func, line_num, context, message);
   }
 }
 void Logger::error(std::string file, std::string func, int line_num,
                    const LogContext &context, const std::string &message) {
-  if (static_cast<unsigned int>(m_log_level) >=
-      static_cast<unsigned int>(LogLevel::ERROR)) {
+  if (isEnabled(LogLevel::ERROR)) {
     output(LogLevel::ERROR, file, func, line_num, context, message);
   }
 }
 void Logger::critical(std::string file, std::string func, int line_num,
                       const LogContext &context, const std::string &message) {
-  if (static_cast<unsigned int>(m_log_level) >=
-      static_cast<unsigned int>(LogLevel::CRITICAL)) {
+  if (isEnabled(LogLevel::CRITICAL)) {
     output(LogLevel::CRITICAL, file, func, line_num, context, message);
   }
 }
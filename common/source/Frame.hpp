@@ -53,7 +53,8 @@ public:
 
 class FrameFactory {
 public:
-  Frame create(::google::protobuf::Message &a_msg, ProtoBufMap &proto_map);
+  Frame create(::google::protobuf::Message &a_msg,
+               const ProtoBufMap &proto_map);
   Frame create(const IMessage &msg);
   Frame create(zmq_msg_t &zmq_msg);
 };
@@ -19,9 +19,10 @@ ProtoBufFactory::ProtoBufFactory() {
 
 std::unique_ptr<::google::protobuf::Message>
 ProtoBufFactory::create(uint16_t desc_type) {
-  const ::google::protobuf::Descriptor *msg_descriptor =
-      m_proto_map.getDescriptorType(desc_type);
-  return create(msg_descriptor);
+  // The registry caches the prototype of every message type, so no descriptor
+  // or factory lookup is needed on the receive path
+  return std::unique_ptr<::google::protobuf::Message>(
+      m_proto_map.getPrototype(desc_type)->New());
 }
 
 // https://stackoverflow.com/questions/29960871/protobuf-message-object-creation-by-name
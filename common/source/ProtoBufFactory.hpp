@@ -16,7 +16,7 @@
 namespace SDMS {
 
 class ProtoBufFactory {
-  ProtoBufMap m_proto_map;
+  const ProtoBufMap &m_proto_map = ProtoBufMap::getInstance();
   ::google::protobuf::MessageFactory *m_factory;
 
 public:
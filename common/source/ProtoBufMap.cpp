@@ -14,73 +14,58 @@ namespace proto = ::google::protobuf;
 namespace SDMS {
 
 ProtoBufMap::ProtoBufMap() {
-  // These two code blocks should be templatized to make them DRY
-
-  {
-    auto a_enum_desc = Anon::Protocol_descriptor();
-    if (a_enum_desc->name() != "Protocol")
-      EXCEPT(EC_PROTO_INIT, "Must register with Protocol EnumDescriptor.");
-
-    const proto::FileDescriptor *file = a_enum_desc->file();
-    if (!file)
-      EXCEPT(EC_PROTO_INIT,
-             "Failed to acquire protocol buffer file descriptor.");
-
-    const proto::EnumValueDescriptor *val_desc =
-        a_enum_desc->FindValueByName("ID");
-    if (!val_desc)
-      EXCEPT(EC_PROTO_INIT, "Protocol enum missing required ID field.");
-
-    uint16_t id = val_desc->number();
-    // std::cout << __FILE__ << ":" << __LINE__ << " PROTOCOL id is " << id <<
-    // std::endl;
-    m_file_descriptor_map[id] = file;
-
-    int count = file->message_type_count();
-    uint16_t msg_type = id << 8;
-
-    for (int i = 0; i < count; i++, msg_type++) {
-      const proto::Descriptor *desc = file->message_type(i);
-      m_descriptor_map[msg_type] = desc;
-      // Register Message types from  Anon
-      m_msg_type_map[desc] = msg_type;
-    }
-    m_protocol_ids[MessageProtocol::GOOGLE_ANONONYMOUS] = id;
+  registerProtocol(Anon::Protocol_descriptor(),
+                   MessageProtocol::GOOGLE_ANONONYMOUS);
+  registerProtocol(Auth::Protocol_descriptor(),
+                   MessageProtocol::GOOGLE_AUTHORIZED);
+}
+
+/**
+ * Message types are the protocol ID in the upper byte and the index of the
+ * message in its proto file in the lower byte.
+ **/
+void ProtoBufMap::registerProtocol(const proto::EnumDescriptor *a_enum_desc,
+                                   MessageProtocol a_protocol) {
+  if (a_enum_desc->name() != "Protocol")
+    EXCEPT(EC_PROTO_INIT, "Must register with Protocol EnumDescriptor.");
+
+  const proto::FileDescriptor *file = a_enum_desc->file();
+  if (!file)
+    EXCEPT(EC_PROTO_INIT, "Failed to acquire protocol buffer file descriptor.");
+
+  const proto::EnumValueDescriptor *val_desc =
+      a_enum_desc->FindValueByName("ID");
+  if (!val_desc)
+    EXCEPT(EC_PROTO_INIT, "Protocol enum missing required ID field.");
+
+  uint16_t id = val_desc->number();
+  m_file_descriptor_map[id] = file;
+
+  int count = file->message_type_count();
+  uint16_t msg_type = id << 8;
+
+  if (m_descriptors.size() < static_cast<size_t>(msg_type + count)) {
+    m_descriptors.resize(msg_type + count, nullptr);
+    m_prototypes.resize(msg_type + count, nullptr);
   }
-  {
-    auto a_enum_desc = Auth::Protocol_descriptor();
-    if (a_enum_desc->name() != "Protocol")
-      EXCEPT(EC_PROTO_INIT, "Must register with Protocol EnumDescriptor.");
-
-    const proto::FileDescriptor *file = a_enum_desc->file();
-    if (!file)
-      EXCEPT(EC_PROTO_INIT,
-             "Failed to acquire protocol buffer file descriptor.");
-
-    const proto::EnumValueDescriptor *val_desc =
-        a_enum_desc->FindValueByName("ID");
-    if (!val_desc)
-      EXCEPT(EC_PROTO_INIT, "Protocol enum missing required ID field.");
-
-    uint16_t id = val_desc->number();
-    // std::cout << "PROTOCOL id is " << id << std::endl;
-    // std::cout << __FILE__ << ":" << __LINE__ << " PROTOCOL id is " << id <<
-    // std::endl;
-    m_file_descriptor_map[id] = file;
-
-    int count = file->message_type_count();
-    uint16_t msg_type = id << 8;
-
-    for (int i = 0; i < count; i++, msg_type++) {
-      const proto::Descriptor *desc = file->message_type(i);
-      m_descriptor_map[msg_type] = desc;
-      m_msg_type_map[desc] = msg_type;
-    }
-    m_protocol_ids[MessageProtocol::GOOGLE_AUTHORIZED] = id;
+
+  proto::MessageFactory *factory =
+      proto::MessageFactory::generated_factory();
+  for (int i = 0; i < count; i++, msg_type++) {
+    const proto::Descriptor *desc = file->message_type(i);
+    const proto::Message *prototype = factory->GetPrototype(desc);
+    if (prototype == nullptr)
+      EXCEPT_PARAM(EC_PROTO_INIT,
+                   "Cannot create prototype message for " << desc->name());
+
+    m_descriptors[msg_type] = desc;
+    m_prototypes[msg_type] = prototype;
+    m_msg_type_map[desc] = msg_type;
   }
+  m_protocol_ids[a_protocol] = id;
 }
 
-uint16_t ProtoBufMap::getMessageType(proto::Message &a_msg) {
+uint16_t ProtoBufMap::getMessageType(proto::Message &a_msg) const {
   const proto::Descriptor *desc = a_msg.GetDescriptor();
   if (m_msg_type_map.count(desc) == 0) {
     EXCEPT_PARAM(EC_INVALID_PARAM,
@@ -90,14 +75,14 @@ uint16_t ProtoBufMap::getMessageType(proto::Message &a_msg) {
 }
 
 std::string ProtoBufMap::toString(uint16_t msg_type) const {
-  if (m_descriptor_map.count(msg_type)) {
-    return m_descriptor_map.at(msg_type)->name();
+  if (exists(msg_type)) {
+    return m_descriptors[msg_type]->name();
   }
   EXCEPT_PARAM(1, "Provided message type is unknown cannot retrieve name.");
 }
 
 uint16_t ProtoBufMap::getMessageType(uint8_t a_proto_id,
-                                     const std::string &a_message_name) {
+                                     const std::string &a_message_name) const {
 
   // std::cout << "PROTOCOL id is " << a_proto_id << std::endl;
   // std::cout << __FILE__ << ":" << __LINE__ << " PROTOCOL id is " <<
@@ -126,8 +111,8 @@ uint16_t ProtoBufMap::getMessageType(uint8_t a_proto_id,
 
 const proto::Descriptor *
 ProtoBufMap::getDescriptorType(uint16_t message_type) const {
-  if (m_descriptor_map.count(message_type)) {
-    return m_descriptor_map.at(message_type);
+  if (exists(message_type)) {
+    return m_descriptors[message_type];
   } else {
     EXCEPT_PARAM(EC_PROTO_INIT,
                  "Descriptor type mapping failed, unregistered message type "
@@ -135,6 +120,16 @@ ProtoBufMap::getDescriptorType(uint16_t message_type) const {
   }
 }
 
+const proto::Message *ProtoBufMap::getPrototype(uint16_t message_type) const {
+  if (exists(message_type)) {
+    return m_prototypes[message_type];
+  } else {
+    EXCEPT_PARAM(EC_PROTO_INIT,
+                 "Prototype lookup failed, unregistered message type "
+                     << message_type);
+  }
+}
+
 uint8_t ProtoBufMap::getProtocolID(MessageProtocol msg_protocol) const {
   if (m_protocol_ids.count(msg_protocol)) {
     return static_cast<uint8_t>(m_protocol_ids.at(msg_protocol));
@@ -2,7 +2,9 @@
 #include "ZeroMQCommunicator.hpp"
 #include "../Frame.hpp"
 #include "../ProtoBufFactory.hpp"
+#include "../support/zeromq/CompactHeader.hpp"
 #include "../support/zeromq/Context.hpp"
+#include "../support/zeromq/DeadlinePart.hpp"
 #include "../support/zeromq/SocketTranslator.hpp"
 
 // Local public includes
@@ -15,10 +17,14 @@
 
 // Third party includes
 #include <boost/range/adaptor/reversed.hpp>
+#include <google/protobuf/io/zero_copy_stream.h>
 #include <zmq.hpp>
 
 // Standard includes
+#include <algorithm>
 #include <arpa/inet.h>
+#include <cstring>
+#include <list>
 #include <string>
 #include <unordered_map>
 
@@ -106,7 +112,15 @@ void sendFinalDelimiter(void *outgoing_zmq_socket) {
 // 0 - number of routes
 // null
 // Frame - function will not read
-void receiveRoute(IMessage &msg, void *incoming_zmq_socket,
+//
+// Or, when the sender used the compact header
+//
+// Route 1
+// Compact header - routes, correlation id, key, id and frame
+//
+// Returns true if the message uses the compact header, the correlation id,
+// key, id and frame have then been read as well.
+bool receiveRoute(IMessage &msg, void *incoming_zmq_socket,
                   LogContext log_context) {
   // If the first frame is not empty assume it is a route that was provided by
   // the internals of zmq
@@ -123,6 +137,17 @@ void receiveRoute(IMessage &msg, void *incoming_zmq_socket,
     }
     size_t len = zmq_msg_size(&zmq_msg);
     if (len) {
+      if (CompactHeader::matches(zmq_msg)) {
+        try {
+          CompactHeader header;
+          header.decode(zmq_msg, msg, previous_route);
+        } catch (...) {
+          zmq_msg_close(&zmq_msg);
+          throw;
+        }
+        zmq_msg_close(&zmq_msg);
+        return true;
+      }
       if (len > 255) {
         zmq_msg_close(&zmq_msg);
         EXCEPT(1, "Message route segment exceeds max allowed length.");
@@ -216,10 +241,16 @@ void receiveRoute(IMessage &msg, void *incoming_zmq_socket,
     }
     zmq_msg_close(&zmq_msg);
   }
+  return false;
 }
 
+/**
+ * When compact is true the routes that are not identity routes, the
+ * correlation id, key, id and frame are all sent in a single compact header
+ * part instead.
+ **/
 void sendRoute(IMessage &msg, void *outgoing_zmq_socket,
-               const int zmq_socket_type) {
+               const int zmq_socket_type, const bool compact) {
 
   // If this is a response then we need to attach the identity of the server
   // that the response needs to be sent to
@@ -248,6 +279,19 @@ void sendRoute(IMessage &msg, void *outgoing_zmq_socket,
     }
   }
 
+  if (compact) {
+    zmq_msg_t zmq_msg;
+    CompactHeader header;
+    header.encode(msg, routes, zmq_msg);
+    int number_of_bytes =
+             zmq_msg_send(&zmq_msg, outgoing_zmq_socket, ZMQ_SNDMORE);
+    zmq_msg_close(&zmq_msg);
+    if ( number_of_bytes < 0 ) {
+      EXCEPT(1, "sendRoute zmq_msg_send (compact header) failed.");
+    }
+    return;
+  }
+
   sendDelimiter(outgoing_zmq_socket);
   { // Send header
     zmq_msg_t zmq_msg;
@@ -300,7 +344,8 @@ void sendRoute(IMessage &msg, void *outgoing_zmq_socket,
 }
 
 /**
- * Will load the frame of the message.
+ * Will load the frame of the message, and the deadline if it is sent ahead of
+ * the frame.
  **/
 void receiveFrame(IMessage &msg, void *incoming_zmq_socket,
                   LogContext log_context) {
@@ -313,6 +358,13 @@ void receiveFrame(IMessage &msg, void *incoming_zmq_socket,
       zmq_msg_close(&zmq_msg);
       EXCEPT_PARAM(
           1, "RCV zmq_msg_recv (frame) failed: " << zmq_strerror(zmq_errno()));
+    } else if (DeadlinePart::matches(zmq_msg) && zmq_msg_more(&zmq_msg)) {
+      DeadlinePart part;
+      part.decode(zmq_msg, msg);
+      zmq_msg_close(&zmq_msg);
+      DL_TRACE(log_context, "Received deadline.");
+      // The frame follows
+      number_of_bytes = 0;
     } else if (number_of_bytes == 8) {
       FrameFactory frame_factory;
       Frame frame = frame_factory.create(zmq_msg); // THIS IS THE ERROR
@@ -333,6 +385,27 @@ void receiveFrame(IMessage &msg, void *incoming_zmq_socket,
   }
 }
 
+/**
+ * Requests with a deadline are sent with it ahead of the frame, responses
+ * never carry one.
+ **/
+void sendDeadline(IMessage &msg, void *outgoing_zmq_socket) {
+  if (std::get<MessageState>(msg.get(MessageAttribute::STATE)) !=
+          MessageState::REQUEST or
+      msg.getDeadline() == std::chrono::steady_clock::time_point::max()) {
+    return;
+  }
+  zmq_msg_t zmq_msg;
+  DeadlinePart part;
+  part.encode(msg, zmq_msg);
+  int number_of_bytes =
+           zmq_msg_send(&zmq_msg, outgoing_zmq_socket, ZMQ_SNDMORE);
+  zmq_msg_close(&zmq_msg);
+  if ( number_of_bytes < 0 ) {
+    EXCEPT(1, "zmq_msg_send (deadline) failed.");
+  }
+}
+
 void sendFrame(IMessage &msg, void *outgoing_zmq_socket) {
   zmq_msg_t zmq_msg;
   zmq_msg_init_size(&zmq_msg, 8);
@@ -353,15 +426,360 @@ void sendFrame(IMessage &msg, void *outgoing_zmq_socket) {
   }
 }
 
+/**
+ * Discard the remaining parts of a multipart message so the next receive
+ * starts at the beginning of a message.
+ **/
+void drainMessage(void *incoming_zmq_socket) {
+  int more = 0;
+  size_t more_size = sizeof(more);
+  zmq_getsockopt(incoming_zmq_socket, ZMQ_RCVMORE, &more, &more_size);
+  while (more) {
+    zmq_msg_t zmq_msg;
+    zmq_msg_init(&zmq_msg);
+    if (zmq_msg_recv(&zmq_msg, incoming_zmq_socket, ZMQ_DONTWAIT) < 0) {
+      zmq_msg_close(&zmq_msg);
+      return;
+    }
+    more = zmq_msg_more(&zmq_msg);
+    zmq_msg_close(&zmq_msg);
+  }
+}
+
+void freeChunk(void *data, void *) { delete[] static_cast<char *>(data); }
+
+/**
+ * Protobuf input stream over a body that was sent as several zmq parts. The
+ * parts are received one at a time while the message is parsed, so only one
+ * part is held at a time and the body is never reassembled.
+ *
+ * Any parts that were not consumed are discarded when the stream is
+ * destroyed.
+ **/
+class ZeroMQChunkInputStream : public proto::io::ZeroCopyInputStream {
+public:
+  ZeroMQChunkInputStream(void *incoming_zmq_socket, zmq_msg_t &first_chunk,
+                         size_t expected_size)
+      : m_socket(incoming_zmq_socket), m_expected_size(expected_size) {
+    zmq_msg_init(&m_chunk);
+    zmq_msg_move(&m_chunk, &first_chunk);
+  }
+  ZeroMQChunkInputStream(const ZeroMQChunkInputStream &) = delete;
+  ZeroMQChunkInputStream &operator=(const ZeroMQChunkInputStream &) = delete;
+
+  virtual ~ZeroMQChunkInputStream() {
+    bool more = zmq_msg_more(&m_chunk);
+    zmq_msg_close(&m_chunk);
+    if (more) {
+      drainMessage(m_socket);
+    }
+  }
+
+  virtual bool Next(const void **data, int *size) final {
+    if (m_backup > 0) {
+      *data = static_cast<const char *>(zmq_msg_data(&m_chunk)) +
+              zmq_msg_size(&m_chunk) - m_backup;
+      *size = m_backup;
+      m_byte_count += m_backup;
+      m_backup = 0;
+      return true;
+    }
+
+    while (true) {
+      if (m_started) {
+        if (!zmq_msg_more(&m_chunk)) {
+          return false;
+        }
+        zmq_msg_close(&m_chunk);
+        zmq_msg_init(&m_chunk);
+        if (zmq_msg_recv(&m_chunk, m_socket, ZMQ_DONTWAIT) < 0) {
+          m_error = true;
+          return false;
+        }
+      }
+      m_started = true;
+
+      size_t chunk_size = zmq_msg_size(&m_chunk);
+      if (m_received + chunk_size > m_expected_size) {
+        m_error = true;
+        return false;
+      }
+      m_received += chunk_size;
+      if (chunk_size > 0) {
+        *data = zmq_msg_data(&m_chunk);
+        *size = static_cast<int>(chunk_size);
+        m_byte_count += chunk_size;
+        return true;
+      }
+    }
+  }
+
+  virtual void BackUp(int count) final {
+    m_backup = count;
+    m_byte_count -= count;
+  }
+
+  virtual bool Skip(int count) final {
+    const void *data;
+    int size;
+    while (count > 0) {
+      if (!Next(&data, &size)) {
+        return false;
+      }
+      if (size > count) {
+        BackUp(size - count);
+        return true;
+      }
+      count -= size;
+    }
+    return true;
+  }
+
+  virtual int64_t ByteCount() const final { return m_byte_count; }
+
+  /// True if exactly the announced number of bytes was received
+  bool complete() const {
+    return !m_error && m_received == m_expected_size &&
+           !zmq_msg_more(const_cast<zmq_msg_t *>(&m_chunk));
+  }
+
+private:
+  void *m_socket;
+  zmq_msg_t m_chunk;
+  size_t m_expected_size;
+  size_t m_received = 0;
+  int64_t m_byte_count = 0;
+  int m_backup = 0;
+  bool m_started = false;
+  bool m_error = false;
+};
+
+/**
+ * Protobuf output stream that serializes a body straight into zmq parts of at
+ * most chunk_size bytes. Each part is handed to zmq, which takes ownership of
+ * the memory, as soon as the next one is requested.
+ **/
+class ZeroMQChunkOutputStream : public proto::io::ZeroCopyOutputStream {
+public:
+  ZeroMQChunkOutputStream(void *outgoing_zmq_socket, size_t chunk_size,
+                          size_t total_size)
+      : m_socket(outgoing_zmq_socket), m_chunk_size(chunk_size),
+        m_total_size(total_size) {}
+  ZeroMQChunkOutputStream(const ZeroMQChunkOutputStream &) = delete;
+  ZeroMQChunkOutputStream &operator=(const ZeroMQChunkOutputStream &) = delete;
+
+  virtual ~ZeroMQChunkOutputStream() { delete[] m_chunk; }
+
+  virtual bool Next(void **data, int *size) final {
+    if (m_chunk && !sendChunk(ZMQ_SNDMORE)) {
+      return false;
+    }
+    // Chunks are sized so the last one ends exactly at the end of the body
+    size_t chunk_size =
+        std::min(m_chunk_size, m_total_size - static_cast<size_t>(m_byte_count));
+    if (chunk_size == 0) {
+      return false;
+    }
+    m_chunk = new char[chunk_size];
+    m_used = chunk_size;
+    m_byte_count += chunk_size;
+    *data = m_chunk;
+    *size = static_cast<int>(chunk_size);
+    return true;
+  }
+
+  virtual void BackUp(int count) final {
+    m_used -= count;
+    m_byte_count -= count;
+  }
+
+  virtual int64_t ByteCount() const final { return m_byte_count; }
+
+  /// Send the last part, must be called once serialization is done
+  bool finish() {
+    if (m_chunk == nullptr) {
+      m_chunk = new char[1];
+      m_used = 0;
+    }
+    return sendChunk(0);
+  }
+
+private:
+  bool sendChunk(int flags) {
+    zmq_msg_t zmq_msg;
+    zmq_msg_init_data(&zmq_msg, m_chunk, m_used, freeChunk, nullptr);
+    m_chunk = nullptr;
+    if (zmq_msg_send(&zmq_msg, m_socket, flags) < 0) {
+      zmq_msg_close(&zmq_msg);
+      return false;
+    }
+    return true;
+  }
+
+  void *m_socket;
+  size_t m_chunk_size;
+  size_t m_total_size;
+  char *m_chunk = nullptr;
+  size_t m_used = 0;
+  int64_t m_byte_count = 0;
+};
+
+/**
+ * Keeps the received zmq body parts alive so they can be forwarded as is. A
+ * body that was sent in chunks is forwarded in the same chunks.
+ **/
+class ZeroMQRawPayload : public IRawPayload {
+public:
+  ZeroMQRawPayload() = default;
+  ZeroMQRawPayload(const ZeroMQRawPayload &) = delete;
+  ZeroMQRawPayload &operator=(const ZeroMQRawPayload &) = delete;
+
+  virtual ~ZeroMQRawPayload() {
+    for (zmq_msg_t &chunk : m_chunks) {
+      zmq_msg_close(&chunk);
+    }
+  }
+
+  /// Takes over the content of zmq_msg
+  void addChunk(zmq_msg_t &zmq_msg) {
+    m_chunks.emplace_back();
+    zmq_msg_init(&m_chunks.back());
+    zmq_msg_move(&m_chunks.back(), &zmq_msg);
+    m_size += zmq_msg_size(&m_chunks.back());
+  }
+
+  /// A chunked body is joined into a contiguous copy the first time this is
+  /// called
+  virtual const void *data() const final {
+    if (m_chunks.size() == 1) {
+      return zmq_msg_data(const_cast<zmq_msg_t *>(&m_chunks.front()));
+    }
+    if (m_joined.size() != m_size) {
+      m_joined.reserve(m_size);
+      for (const zmq_msg_t &chunk : m_chunks) {
+        zmq_msg_t *part = const_cast<zmq_msg_t *>(&chunk);
+        m_joined.append(static_cast<const char *>(zmq_msg_data(part)),
+                        zmq_msg_size(part));
+      }
+    }
+    return m_joined.data();
+  }
+  virtual size_t size() const final { return m_size; }
+
+  /**
+   * Sends the parts, zmq reference counts the data so nothing is copied and
+   * the payload can still be sent again.
+   **/
+  int sendTo(void *outgoing_zmq_socket) {
+    size_t remaining = m_chunks.size();
+    for (zmq_msg_t &chunk : m_chunks) {
+      zmq_msg_t zmq_msg;
+      zmq_msg_init(&zmq_msg);
+      zmq_msg_copy(&zmq_msg, &chunk);
+      if (zmq_msg_send(&zmq_msg, outgoing_zmq_socket,
+                       --remaining ? ZMQ_SNDMORE : 0) < 0) {
+        zmq_msg_close(&zmq_msg);
+        return -1;
+      }
+    }
+    return 0;
+  }
+
+private:
+  /// List so the zmq_msg_t never move once initialized
+  std::list<zmq_msg_t> m_chunks;
+  size_t m_size = 0;
+  mutable std::string m_joined;
+};
+
+/**
+ * Same as receiveBody but the body is not decoded, it is attached to the
+ * message as a ZeroMQRawPayload.
+ **/
+void receiveRawBody(IMessage &msg, void *incoming_zmq_socket,
+                    uint32_t max_message_size, LogContext log_context) {
+
+  if (msg.exists(FRAME_SIZE)) {
+    uint32_t frame_size = std::get<uint32_t>(msg.get(FRAME_SIZE));
+    if (frame_size > max_message_size) {
+      drainMessage(incoming_zmq_socket);
+      EXCEPT_PARAM(1, "RCV Message body of " << frame_size
+                                             << " bytes exceeds the limit of "
+                                             << max_message_size);
+    }
+
+    zmq_msg_t zmq_msg;
+    zmq_msg_init(&zmq_msg);
+
+    int number_of_bytes = 0;
+    if ((number_of_bytes =
+             zmq_msg_recv(&zmq_msg, incoming_zmq_socket, ZMQ_DONTWAIT)) < 0) {
+      zmq_msg_close(&zmq_msg);
+      EXCEPT_PARAM(1, "RCV zmq_msg_recv (body) failed. Frame size: "
+                          << frame_size << " received " << number_of_bytes);
+    }
+
+    // A zero size frame is a legitimate message, i.e. a NACK, the frame
+    // carries everything needed to forward it.
+    if (frame_size == 0) {
+      bool more = zmq_msg_more(&zmq_msg);
+      zmq_msg_close(&zmq_msg);
+      if (more) {
+        drainMessage(incoming_zmq_socket);
+        EXCEPT(1, "There should not be additional messages after the body "
+                  "has been sent but there are...!");
+      }
+      return;
+    }
+
+    auto payload = std::make_unique<ZeroMQRawPayload>();
+    bool more = zmq_msg_more(&zmq_msg);
+    payload->addChunk(zmq_msg);
+    zmq_msg_close(&zmq_msg);
+    while (more && payload->size() <= frame_size) {
+      zmq_msg_init(&zmq_msg);
+      if (zmq_msg_recv(&zmq_msg, incoming_zmq_socket, ZMQ_DONTWAIT) < 0) {
+        zmq_msg_close(&zmq_msg);
+        EXCEPT(1, "RCV zmq_msg_recv (body chunk) failed.");
+      }
+      more = zmq_msg_more(&zmq_msg);
+      payload->addChunk(zmq_msg);
+      zmq_msg_close(&zmq_msg);
+    }
+
+    if (more || payload->size() != frame_size) {
+      if (more) {
+        drainMessage(incoming_zmq_socket);
+      }
+      EXCEPT_PARAM(1, "RCV Invalid message body received. Expected: "
+                          << frame_size << ", got: " << payload->size());
+    }
+    DL_TRACE(log_context, "Received opaque message body of size: "
+                              << frame_size);
+    msg.setRawPayload(std::move(payload));
+  }
+}
+
 /**
  * Will load the body of the message if there is one. Or else it will do
  * nothing.
+ *
+ * The payload is parsed straight from the zmq message data, there is no
+ * intermediate copy. A body that was sent in chunks is parsed while the
+ * chunks are received.
  **/
-void receiveBody(IMessage &msg, Buffer &buffer, ProtoBufFactory &factory,
-                 void *incoming_zmq_socket, LogContext log_context) {
+void receiveBody(IMessage &msg, ProtoBufFactory &factory,
+                 void *incoming_zmq_socket, uint32_t max_message_size,
+                 LogContext log_context) {
 
   if (msg.exists(FRAME_SIZE)) {
     uint32_t frame_size = std::get<uint32_t>(msg.get(FRAME_SIZE));
+    if (frame_size > max_message_size) {
+      drainMessage(incoming_zmq_socket);
+      EXCEPT_PARAM(1, "RCV Message body of " << frame_size
+                                             << " bytes exceeds the limit of "
+                                             << max_message_size);
+    }
 
     zmq_msg_t zmq_msg;
     zmq_msg_init(&zmq_msg);
@@ -377,6 +795,33 @@ void receiveBody(IMessage &msg, Buffer &buffer, ProtoBufFactory &factory,
     // Only set payload if there is a payload
     if (frame_size > 0) {
 
+      uint16_t desc_type = std::get<uint16_t>(msg.get(MSG_TYPE));
+      std::unique_ptr<proto::Message> payload = factory.create(desc_type);
+      if (payload == nullptr) {
+        zmq_msg_close(&zmq_msg);
+        drainMessage(incoming_zmq_socket);
+        EXCEPT(1, "No payload was assigned something is wrong");
+      }
+
+      if (zmq_msg_more(&zmq_msg)) {
+        ZeroMQChunkInputStream stream(incoming_zmq_socket, zmq_msg, frame_size);
+        zmq_msg_close(&zmq_msg);
+        bool parsed = payload->ParseFromZeroCopyStream(&stream);
+        if (!stream.complete()) {
+          EXCEPT_PARAM(1, "RCV Invalid chunked message body received. "
+                          "Expected: "
+                              << frame_size
+                              << ", got: " << stream.ByteCount());
+        }
+        if (!parsed) {
+          EXCEPT_PARAM(1, "RCV Unable to parse message body of type: "
+                              << ProtoBufMap::getInstance().toString(
+                                     desc_type));
+        }
+        msg.setPayload(std::move(payload));
+        return;
+      }
+
       if (zmq_msg_size(&zmq_msg) != frame_size) {
         zmq_msg_close(&zmq_msg);
         EXCEPT_PARAM(1, "RCV Invalid message body received. Expected: "
@@ -384,14 +829,11 @@ void receiveBody(IMessage &msg, Buffer &buffer, ProtoBufFactory &factory,
                             << ", got: " << zmq_msg_size(&zmq_msg));
       }
 
-      copyToBuffer(buffer, zmq_msg_data(&zmq_msg), frame_size);
-      uint16_t desc_type = std::get<uint16_t>(msg.get(MSG_TYPE));
-      std::unique_ptr<proto::Message> payload = factory.create(desc_type);
-      if (payload == nullptr) {
+      if (!payload->ParseFromArray(zmq_msg_data(&zmq_msg), frame_size)) {
         zmq_msg_close(&zmq_msg);
-        EXCEPT(1, "No payload was assigned something is wrong");
+        EXCEPT_PARAM(1, "RCV Unable to parse message body of type: "
+                            << ProtoBufMap::getInstance().toString(desc_type));
       }
-      copyFromBuffer(payload.get(), buffer);
       msg.setPayload(std::move(payload));
     } else {
 
@@ -400,7 +842,7 @@ void receiveBody(IMessage &msg, Buffer &buffer, ProtoBufFactory &factory,
       // as a NACK
       uint16_t msg_type = std::get<uint16_t>(msg.get(MSG_TYPE));
 
-      ProtoBufMap proto_map;
+      const ProtoBufMap &proto_map = ProtoBufMap::getInstance();
       DL_TRACE(log_context, "Receiving message body of type: " +
                                 proto_map.toString(msg_type));
       if (proto_map.exists(msg_type)) {
@@ -408,6 +850,7 @@ void receiveBody(IMessage &msg, Buffer &buffer, ProtoBufFactory &factory,
         msg.setPayload(std::move(payload));
       } else {
         zmq_msg_close(&zmq_msg);
+        drainMessage(incoming_zmq_socket);
         EXCEPT(1, "Unrecognized message type specified unable to identify "
                   "message body/payload");
       }
@@ -415,6 +858,7 @@ void receiveBody(IMessage &msg, Buffer &buffer, ProtoBufFactory &factory,
 
     if (zmq_msg_more(&zmq_msg)) {
       zmq_msg_close(&zmq_msg);
+      drainMessage(incoming_zmq_socket);
       EXCEPT(1, "There should not be additional messages after the body has "
                 "been sent but there are...!");
     }
@@ -422,16 +866,40 @@ void receiveBody(IMessage &msg, Buffer &buffer, ProtoBufFactory &factory,
   }
 }
 
-void sendBody(IMessage &msg, Buffer &buffer, void *outgoing_zmq_socket) {
+/**
+ * Protobuf payloads are serialized directly into the zmq message, there is no
+ * intermediate copy. Bodies larger than chunk_size are split into several
+ * parts, 0 always sends a single part.
+ **/
+void sendBody(IMessage &msg, void *outgoing_zmq_socket, uint32_t chunk_size) {
 
   if (msg.exists(FRAME_SIZE)) {
 
     uint32_t frame_size = std::get<uint32_t>(msg.get(FRAME_SIZE));
-    if (frame_size > 0) {
-      zmq_msg_t zmq_msg;
-
-      zmq_msg_init_size(&zmq_msg, frame_size);
+    if (frame_size > 0 && msg.getRawPayload()) {
+      // Forwarding a body that was never decoded
+      IRawPayload *raw_payload = msg.getRawPayload();
+      if (raw_payload->size() != frame_size) {
+        EXCEPT_PARAM(1, "Frame and message sizes differ message size: "
+                            << raw_payload->size()
+                            << " frame size: " << frame_size);
+      }
 
+      auto zmq_payload = dynamic_cast<ZeroMQRawPayload *>(raw_payload);
+      if (zmq_payload) {
+        if (zmq_payload->sendTo(outgoing_zmq_socket) < 0) {
+          EXCEPT(1, "zmq_msg_send (body) failed.");
+        }
+      } else {
+        zmq_msg_t zmq_msg;
+        zmq_msg_init_size(&zmq_msg, frame_size);
+        memcpy(zmq_msg_data(&zmq_msg), raw_payload->data(), frame_size);
+        if (zmq_msg_send(&zmq_msg, outgoing_zmq_socket, 0) < 0) {
+          zmq_msg_close(&zmq_msg);
+          EXCEPT(1, "zmq_msg_send (body) failed.");
+        }
+      }
+    } else if (frame_size > 0) {
       proto::Message *payload;
       try {
         payload = std::get<proto::Message *>(msg.getPayload());
@@ -439,28 +907,39 @@ void sendBody(IMessage &msg, Buffer &buffer, void *outgoing_zmq_socket) {
         EXCEPT(1, ex.what());
       }
 
-      if (payload) {
-        auto size = payload->ByteSizeLong();
-        if (size != frame_size) {
+      if (payload == nullptr) {
+        EXCEPT(1, "Payload not defined... something went wrong");
+      }
+
+      auto size = payload->ByteSizeLong();
+      if (size != frame_size) {
+        EXCEPT_PARAM(1, "Frame and message sizes differ message size: "
+                            << size << " frame size: " << frame_size);
+      }
+      if (!payload->IsInitialized()) {
+        EXCEPT(1, "Cannot send message it is missing required fields");
+      }
+
+      if (chunk_size > 0 && frame_size > chunk_size) {
+        ZeroMQChunkOutputStream stream(outgoing_zmq_socket, chunk_size,
+                                       frame_size);
+        if (!payload->SerializeToZeroCopyStream(&stream) ||
+            static_cast<uint32_t>(stream.ByteCount()) != frame_size ||
+            !stream.finish()) {
+          EXCEPT(1, "zmq_msg_send (body chunk) failed.");
+        }
+      } else {
+        zmq_msg_t zmq_msg;
+        zmq_msg_init_size(&zmq_msg, frame_size);
+        if (!payload->SerializeToArray(zmq_msg_data(&zmq_msg), size)) {
           zmq_msg_close(&zmq_msg);
-          EXCEPT_PARAM(1, "Frame and message sizes differ message size: "
-                              << size << " frame size: " << frame_size);
+          EXCEPT(1, "SerializeToArray for message failed.");
         }
-
-        copyToBuffer<proto::Message *>(buffer, payload, size);
-        copyFromBuffer<void *>(zmq_msg_data(&zmq_msg), buffer);
-        int number_of_bytes = 0;
-        if ((number_of_bytes = zmq_msg_send(&zmq_msg, outgoing_zmq_socket, 0)) <
-            0) {
+        if (zmq_msg_send(&zmq_msg, outgoing_zmq_socket, 0) < 0) {
           zmq_msg_close(&zmq_msg);
           EXCEPT(1, "zmq_msg_send (body) failed.");
         }
-      } else {
-        zmq_msg_close(&zmq_msg);
-        EXCEPT(1, "Payload not defined... something went wrong");
       }
-
-      zmq_msg_close(&zmq_msg);
     } else {
 
       sendFinalDelimiter(outgoing_zmq_socket);
@@ -655,6 +1134,105 @@ ZeroMQCommunicator::m_poll(uint32_t timeout_milliseconds) {
   return response;
 }
 
+ICommunicator::Response
+ZeroMQCommunicator::m_receive(const MessageType message_type,
+                              uint32_t timeout_milliseconds,
+                              bool decode_body) {
+
+  Response response = m_poll(timeout_milliseconds);
+  LogContext log_context = m_log_context;
+  if (response.error == false and response.time_out == false) {
+    response.message = m_msg_factory.create(message_type);
+    bool compact = receiveRoute(*response.message, m_zmq_socket, log_context);
+    if (compact == false) {
+      receiveCorrelationID(*response.message, m_zmq_socket, log_context);
+      receiveKey(*response.message, m_zmq_socket, log_context);
+      receiveID(*response.message, m_zmq_socket, log_context);
+      receiveFrame(*response.message, m_zmq_socket, log_context);
+    }
+    rememberWireFormat(*response.message, compact);
+    if (decode_body) {
+      receiveBody(*response.message, m_protocol_factory, m_zmq_socket,
+                  m_max_receive_size, log_context);
+    } else {
+      receiveRawBody(*response.message, m_zmq_socket, m_max_receive_size,
+                     log_context);
+    }
+
+    log_context.correlation_id = std::get<std::string>(
+        response.message->get(MessageAttribute::CORRELATION_ID));
+    uint16_t msg_type = std::get<uint16_t>(
+        response.message->get(constants::message::google::MSG_TYPE));
+    DL_DEBUG(log_context, "Received message on communicator id: "
+                              << id() << ", msg type: "
+                              << ProtoBufMap::getInstance().toString(msg_type)
+                              << ", receiving from address: " << address());
+  } else {
+    if (response.error) {
+      std::string err_message =
+          "Error encountered for communicator id: " + id();
+      err_message += ", error is: " + response.error_msg;
+      err_message += ", receiving from address: " + address();
+      DL_ERROR(log_context, err_message);
+    } else if (response.time_out) {
+      DL_TRACE(log_context, "Timeout encountered for communicator id: "
+                                << id() << ", timeout occurred after: "
+                                << timeout_milliseconds
+                                << ", receiving from address: " << address());
+    }
+  }
+  return response;
+}
+
+void ZeroMQCommunicator::rememberWireFormat(IMessage &msg, bool compact) {
+  const auto &routes = msg.getRoutes();
+  if (routes.size() == 0) {
+    return;
+  }
+  if (compact) {
+    // Identities of peers that have gone away are never removed, start over
+    // rather than let the set grow without bound
+    if (m_compact_peers.size() >= MAX_COMPACT_PEERS) {
+      m_compact_peers.clear();
+    }
+    m_compact_peers.insert(routes.front());
+  } else if (m_compact_peers.size()) {
+    m_compact_peers.erase(routes.front());
+  }
+}
+
+bool ZeroMQCommunicator::useCompactHeader(IMessage &msg) const {
+  // REQ and REP sockets depend on the null delimiter of the legacy format
+  if (m_zmq_socket_type != ZMQ_DEALER and m_zmq_socket_type != ZMQ_ROUTER) {
+    return false;
+  }
+  if (std::get<MessageState>(msg.get(MessageAttribute::STATE)) ==
+      MessageState::RESPONSE) {
+    const auto &routes = msg.getRoutes();
+    return routes.size() and m_compact_peers.count(routes.front());
+  }
+  return m_wire_format == WireFormat::COMPACT;
+}
+
+/**
+ * Sets the receive ceiling and has ZeroMQ enforce it, a frame above the limit
+ * closes the peer's connection before the frame is buffered. The size check
+ * on FRAME_SIZE alone runs only after the whole message is in memory. The
+ * allowance covers the route and header frames.
+ **/
+void ZeroMQCommunicator::limitReceiveSize(const SocketOptions &socket_options) {
+  m_max_receive_size =
+      socket_options.max_receive_size.value_or(socket_options.max_message_size);
+
+  const int64_t max_frame_size =
+      static_cast<int64_t>(m_max_receive_size) + MAX_HEADER_FRAME_SIZE;
+  if (zmq_setsockopt(m_zmq_socket, ZMQ_MAXMSGSIZE, &max_frame_size,
+                     sizeof(max_frame_size)) == -1) {
+    EXCEPT_PARAM(1, "Set ZMQ_MAXMSGSIZE failed. ZMQ msg: "
+                        << zmq_strerror(zmq_errno()));
+  }
+}
+
 /******************************************************************************
  * Public Class Methods
  ******************************************************************************/
@@ -664,19 +1242,22 @@ ZeroMQCommunicator::ZeroMQCommunicator(const SocketOptions &socket_options,
                                        long timeout_on_poll_milliseconds,
                                        const LogContext &log_context)
     : m_timeout_on_receive_milliseconds(timeout_on_receive_milliseconds),
-      m_timeout_on_poll_milliseconds(timeout_on_poll_milliseconds) {
+      m_timeout_on_poll_milliseconds(timeout_on_poll_milliseconds),
+      m_chunk_size(socket_options.chunk_size),
+      m_max_message_size(socket_options.max_message_size),
+      m_wire_format(socket_options.wire_format) {
 
   m_log_context = log_context;
   auto socket_factory = SocketFactory();
   m_socket = socket_factory.create(socket_options, credentials);
 
-  // If running INPROC, each ZeroMQ socket should use the same context, other
-  // wise they should use a different context.
+  // INPROC sockets can only reach each other through the same context, TCP
+  // sockets share one so its I/O threads are not duplicated per socket.
   if ( socket_options.scheme == URIScheme::INPROC ) {
     m_zmq_ctx = InprocContext::getContext();
     InprocContext::increment();
   } else {
-    m_zmq_ctx = zmq_ctx_new();
+    m_zmq_ctx = TcpContext::getContext();
   }
   m_zmq_socket_type = translateToZMQSocket(m_socket.get());
   m_zmq_socket = zmq_socket(m_zmq_ctx, m_zmq_socket_type);
@@ -692,6 +1273,7 @@ ZeroMQCommunicator::ZeroMQCommunicator(const SocketOptions &socket_options,
   const int reconnect_ivl_max = 4000;
   const int linger_milliseconds = 100;
 
+  limitReceiveSize(socket_options);
   zmq_setsockopt(m_zmq_socket, ZMQ_TCP_KEEPALIVE, &keep_alive,
                  sizeof(const int));
   zmq_setsockopt(m_zmq_socket, ZMQ_TCP_KEEPALIVE_CNT, &keep_alive_cnt,
@@ -766,14 +1348,14 @@ ZeroMQCommunicator::~ZeroMQCommunicator() {
   }
 
   rc = 0;
+  // The shared TCP context outlives the communicator, only the INPROC one is
+  // terminated once its last socket is gone
   if ( m_socket->getSocketScheme() == URIScheme::INPROC ) {
     InprocContext::decrement();
     // Only call terminate if counter is at 0;
     if( InprocContext::get() == 0 ) {
       rc = InprocContext::resetContext();
     }
-  } else {
-    rc = zmq_ctx_term(m_zmq_ctx);
   }
   if (rc) {
     std::string err_message =
@@ -786,110 +1368,50 @@ ZeroMQCommunicator::~ZeroMQCommunicator() {
 
 ICommunicator::Response
 ZeroMQCommunicator::poll(const MessageType message_type) {
-  Response response = m_poll(m_timeout_on_poll_milliseconds);
-  LogContext log_context = m_log_context;
-  if (response.error == false and response.time_out == false) {
-    response.message = m_msg_factory.create(message_type);
-    receiveRoute(*response.message, m_zmq_socket, log_context);
-    receiveCorrelationID(*response.message, m_zmq_socket, log_context);
-    receiveKey(*response.message, m_zmq_socket, log_context);
-    receiveID(*response.message, m_zmq_socket, log_context);
-    receiveFrame(*response.message, m_zmq_socket, log_context);
-
-    receiveBody(*response.message, m_buffer, m_protocol_factory, m_zmq_socket,
-                log_context);
-
-    uint16_t msg_type = std::get<uint16_t>(
-        response.message->get(constants::message::google::MSG_TYPE));
-    ProtoBufMap proto_map;
-
-    log_context.correlation_id = std::get<std::string>(
-        response.message->get(MessageAttribute::CORRELATION_ID));
-    std::string err_message = "Received message on communicator id: " + id();
-    err_message += ", msg type: " + proto_map.toString(msg_type);
-    err_message += ", receiving from address: " + address();
-    DL_DEBUG(log_context, err_message);
-  } else {
-    if (response.error) {
-      std::string err_message =
-          "Error encountered for communicator id: " + id();
-      err_message += ", error is: " + response.error_msg;
-      err_message += ", receiving from address: " + address();
-      DL_ERROR(log_context, err_message);
-    } else if (response.time_out) {
-      std::string err_message =
-          "Timeout encountered for communicator id: " + id();
-      err_message +=
-          ", timeout occurred after: " + m_timeout_on_poll_milliseconds;
-      err_message += ", receiving from address: " + address();
-      DL_TRACE(log_context, err_message);
-    }
-  }
+  return m_receive(message_type, m_timeout_on_poll_milliseconds, true);
+}
 
-  return response;
+ICommunicator::Response
+ZeroMQCommunicator::pollPassThrough(const MessageType message_type) {
+  return m_receive(message_type, m_timeout_on_poll_milliseconds, false);
 }
 
 void ZeroMQCommunicator::send(IMessage &message) {
 
   uint16_t msg_type =
       std::get<uint16_t>(message.get(constants::message::google::MSG_TYPE));
-  ProtoBufMap proto_map;
   LogContext log_context = m_log_context;
   log_context.correlation_id =
       std::get<std::string>(message.get(MessageAttribute::CORRELATION_ID));
-  std::string err_message = "Sending message on communicator id: " + id();
-  err_message += ", to address: " + address() +
-                 ", msg type: " + proto_map.toString(msg_type);
-  DL_DEBUG(log_context, err_message);
-  sendRoute(message, m_zmq_socket, m_zmq_socket_type);
-  sendCorrelationID(message, m_zmq_socket);
-  sendKey(message, m_zmq_socket);
-  sendID(message, m_zmq_socket);
-  sendFrame(message, m_zmq_socket);
-  sendBody(message, m_buffer, m_zmq_socket);
+  DL_DEBUG(log_context, "Sending message on communicator id: "
+                            << id() << ", to address: " << address()
+                            << ", msg type: "
+                            << ProtoBufMap::getInstance().toString(msg_type));
+  // Checked before anything is sent so that no partial message goes out
+  if (message.exists(constants::message::google::FRAME_SIZE)) {
+    uint32_t frame_size = std::get<uint32_t>(
+        message.get(constants::message::google::FRAME_SIZE));
+    if (frame_size > m_max_message_size) {
+      EXCEPT_PARAM(1, "Message body of " << frame_size
+                                         << " bytes exceeds the limit of "
+                                         << m_max_message_size);
+    }
+  }
+  bool compact = useCompactHeader(message);
+  sendRoute(message, m_zmq_socket, m_zmq_socket_type, compact);
+  if (compact == false) {
+    sendCorrelationID(message, m_zmq_socket);
+    sendKey(message, m_zmq_socket);
+    sendID(message, m_zmq_socket);
+    sendDeadline(message, m_zmq_socket);
+    sendFrame(message, m_zmq_socket);
+  }
+  sendBody(message, m_zmq_socket, m_chunk_size);
 }
 
 ICommunicator::Response
 ZeroMQCommunicator::receive(const MessageType message_type) {
-
-  Response response = m_poll(m_timeout_on_receive_milliseconds);
-  LogContext log_context = m_log_context;
-  if (response.error == false and response.time_out == false) {
-    response.message = m_msg_factory.create(message_type);
-    receiveRoute(*response.message, m_zmq_socket, log_context);
-    receiveCorrelationID(*response.message, m_zmq_socket, log_context);
-    receiveKey(*response.message, m_zmq_socket, log_context);
-    receiveID(*response.message, m_zmq_socket, log_context);
-    receiveFrame(*response.message, m_zmq_socket, log_context);
-    receiveBody(*response.message, m_buffer, m_protocol_factory, m_zmq_socket,
-                log_context);
-
-    uint16_t msg_type = std::get<uint16_t>(
-        response.message->get(constants::message::google::MSG_TYPE));
-    ProtoBufMap proto_map;
-    log_context.correlation_id = std::get<std::string>(
-        response.message->get(MessageAttribute::CORRELATION_ID));
-    std::string log_message = "Received message on communicator id: " + id();
-    log_message += ", msg type: " + proto_map.toString(msg_type);
-    log_message += ", receiving from address: " + address();
-    DL_DEBUG(log_context, log_message);
-  } else {
-    if (response.error) {
-      std::string err_message =
-          "Error encountered for communicator id: " + id();
-      err_message += ", error is: " + response.error_msg;
-      err_message += ", receiving from address: " + address();
-      DL_ERROR(log_context, err_message);
-    } else if (response.time_out) {
-      std::string err_message =
-          "Timeout encountered for communicator id: " + id();
-      err_message +=
-          ", timeout occurred after: " + m_timeout_on_poll_milliseconds;
-      err_message += ", receiving from address: " + address();
-      DL_TRACE(log_context, err_message);
-    }
-  }
-  return response;
+  return m_receive(message_type, m_timeout_on_receive_milliseconds, true);
 }
 
 const std::string ZeroMQCommunicator::id() const noexcept {
@@ -3,15 +3,15 @@
 #pragma once
 
 // Local private includes
-#include "../Buffer.hpp"
+#include "../ProtoBufFactory.hpp"
 
 // Local public includes
-#include "../ProtoBufFactory.hpp"
 #include "common/DynaLog.hpp"
 #include "common/ICommunicator.hpp"
 #include "common/IMessage.hpp"
 #include "common/ISocket.hpp"
 #include "common/MessageFactory.hpp"
+#include "common/SocketOptions.hpp"
 
 // Third party includes
 #include <zmq.hpp>
@@ -19,6 +19,7 @@
 // Standard includes
 #include <memory>
 #include <string>
+#include <unordered_set>
 
 namespace SDMS {
 
@@ -31,10 +32,27 @@ protected:
   /// Optional timeout in milliseconds (0 = wait forever)
   uint32_t m_timeout_on_receive_milliseconds = 0;
   long m_timeout_on_poll_milliseconds = 10;
+  /// Bodies above this size are sent in chunks, 0 disables chunking
+  uint32_t m_chunk_size = 0;
+  uint32_t m_max_message_size = DEFAULT_MAX_MESSAGE_SIZE;
+  /// Largest body accepted, also enforced by ZeroMQ for every frame
+  uint32_t m_max_receive_size = DEFAULT_MAX_MESSAGE_SIZE;
+  WireFormat m_wire_format = WireFormat::LEGACY;
+  /// Peers whose last message used the compact header, replies to them use it
+  /// as well
+  std::unordered_set<std::string> m_compact_peers;
+  static const size_t MAX_COMPACT_PEERS = 4096;
+  /// Allowed on top of the receive ceiling for route and header frames
+  static const int64_t MAX_HEADER_FRAME_SIZE = 4096;
   MessageFactory m_msg_factory;
-  Buffer m_buffer;
   ProtoBufFactory m_protocol_factory;
   ICommunicator::Response m_poll(uint32_t timeout_milliseconds);
+  ICommunicator::Response m_receive(const MessageType,
+                                    uint32_t timeout_milliseconds,
+                                    bool decode_body);
+  void rememberWireFormat(IMessage &msg, bool compact);
+  bool useCompactHeader(IMessage &msg) const;
+  void limitReceiveSize(const SocketOptions &socket_options);
 
   void zmqCurveSetup(const ICredentials &credentials);
 
@@ -59,12 +77,14 @@ public:
    * Return false if timeout and or no message
    **/
   virtual ICommunicator::Response poll(const MessageType) final;
+  virtual ICommunicator::Response pollPassThrough(const MessageType) final;
 
   virtual void send(IMessage &message) final;
   virtual ICommunicator::Response receive(const MessageType) final;
 
   virtual const std::string id() const noexcept final;
   virtual const std::string address() const noexcept final;
+  virtual void *nativeHandle() const noexcept final { return m_zmq_socket; }
 };
 
 } // namespace SDMS
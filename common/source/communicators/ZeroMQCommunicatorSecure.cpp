@@ -146,17 +146,20 @@ ZeroMQCommunicatorSecure::ZeroMQCommunicatorSecure(
   }
   m_timeout_on_receive_milliseconds = timeout_on_receive_milliseconds;
   m_timeout_on_poll_milliseconds = timeout_on_poll_milliseconds;
+  m_chunk_size = socket_options.chunk_size;
+  m_max_message_size = socket_options.max_message_size;
+  m_wire_format = socket_options.wire_format;
 
   auto socket_factory = SocketFactory();
   m_socket = socket_factory.create(socket_options, credentials);
 
-  // If running INPROC, each ZeroMQ socket should use the same context, other
-  // wise they should a different context.
+  // INPROC sockets can only reach each other through the same context, TCP
+  // sockets share one so its I/O threads are not duplicated per socket.
   if ( socket_options.scheme == URIScheme::INPROC ) {
     m_zmq_ctx = InprocContext::getContext();
     InprocContext::increment();
   } else {
-    m_zmq_ctx = zmq_ctx_new();
+    m_zmq_ctx = TcpContext::getContext();
   }
 
   m_zmq_socket_type = translateToZMQSocket(m_socket.get());
@@ -183,6 +186,7 @@ ZeroMQCommunicatorSecure::ZeroMQCommunicatorSecure(
   const int reconnect_ivl_max = 4000;
   const int linger_milliseconds = 100;
 
+  limitReceiveSize(socket_options);
   zmq_setsockopt(m_zmq_socket, ZMQ_TCP_KEEPALIVE, &keep_alive,
                  sizeof(const int));
   zmq_setsockopt(m_zmq_socket, ZMQ_TCP_KEEPALIVE_CNT, &keep_alive_cnt,
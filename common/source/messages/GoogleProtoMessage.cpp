@@ -10,33 +10,58 @@
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
+#include <boost/random/mersenne_twister.hpp>
 
 // Standard includes
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <variant>
 
 namespace SDMS {
 
-GoogleProtoMessage::GoogleProtoMessage() {
-  m_dyn_attributes[constants::message::google::FRAME_SIZE] = (uint32_t)0;
-  m_dyn_attributes[constants::message::google::PROTO_ID] = (uint8_t)0;
-  m_dyn_attributes[constants::message::google::MSG_ID] = (uint8_t)0;
-  m_dyn_attributes[constants::message::google::MSG_TYPE] = (uint16_t)0;
-  m_dyn_attributes[constants::message::google::CONTEXT] = (uint16_t)0;
-
-  boost::uuids::random_generator generator;
-  boost::uuids::uuid uuid = generator();
-  m_attributes[MessageAttribute::CORRELATION_ID] =
-      boost::uuids::to_string(uuid);
+namespace {
+/**
+ * boost::uuids::random_generator seeds itself from the system entropy source
+ * every time one is constructed, which is far more expensive than generating
+ * the id. Each thread seeds a single generator the first time it creates a
+ * message and reuses it after that.
+ **/
+std::string newCorrelationID() {
+  thread_local boost::uuids::basic_random_generator<boost::random::mt19937>
+      generator;
+  return boost::uuids::to_string(generator());
+}
+} // namespace
+
+GoogleProtoMessage::GoogleProtoMessage()
+    : m_correlation_id(newCorrelationID()) {}
+
+GoogleProtoMessage::Field
+GoogleProtoMessage::toField(const std::string &attribute_name) noexcept {
+  if (attribute_name == constants::message::google::MSG_TYPE) {
+    return Field::MSG_TYPE;
+  } else if (attribute_name == constants::message::google::CONTEXT) {
+    return Field::CONTEXT;
+  } else if (attribute_name == constants::message::google::FRAME_SIZE) {
+    return Field::FRAME_SIZE;
+  } else if (attribute_name == constants::message::google::PROTO_ID) {
+    return Field::PROTO_ID;
+  } else if (attribute_name == constants::message::google::MSG_ID) {
+    return Field::MSG_ID;
+  }
+  return Field::NONE;
 }
 
 bool GoogleProtoMessage::exists(MessageAttribute attribute_type) const {
-  return m_attributes.count(attribute_type) != 0;
+  if (attribute_type == MessageAttribute::ID) {
+    return m_has_id;
+  } else if (attribute_type == MessageAttribute::KEY) {
+    return m_has_key;
+  }
+  return attribute_type == MessageAttribute::CORRELATION_ID;
 }
 bool GoogleProtoMessage::exists(const std::string &attribute_type) const {
-  return m_dyn_attributes.count(attribute_type) != 0;
+  return toField(attribute_type) != Field::NONE;
 }
 
 /**
@@ -52,28 +77,38 @@ void GoogleProtoMessage::setPayload(
     FrameFactory frame_factory;
     Frame frame = frame_factory.create(
         *std::get<std::unique_ptr<::google::protobuf::Message>>(payload),
-        m_proto_map);
-    m_dyn_attributes[constants::message::google::FRAME_SIZE] = frame.size;
-    m_dyn_attributes[constants::message::google::PROTO_ID] = frame.proto_id;
-    m_dyn_attributes[constants::message::google::MSG_ID] = frame.msg_id;
-    m_dyn_attributes[constants::message::google::MSG_TYPE] = frame.getMsgType();
+        ProtoBufMap::getInstance());
+    m_frame_size = frame.size;
+    m_proto_id = frame.proto_id;
+    m_msg_id = frame.msg_id;
+    m_msg_type = frame.getMsgType();
     // Do not overload the context because this is not associated with the
     // message payload but with the response
     m_payload = std::move(
         std::get<std::unique_ptr<::google::protobuf::Message>>(payload));
+    m_raw_payload.reset();
   } else {
     EXCEPT(1, "Attempt to add unsupported payload to GoogleProtoMessage.");
   }
 }
 
+void GoogleProtoMessage::setRawPayload(
+    std::unique_ptr<IRawPayload> raw_payload) {
+  // The frame was received along with the body so it is already correct
+  m_raw_payload = std::move(raw_payload);
+  m_payload.reset();
+}
+
 void GoogleProtoMessage::set(MessageAttribute attribute_type,
                              const std::string &attribute) {
   if (attribute_type == MessageAttribute::ID) {
-    m_attributes[MessageAttribute::ID] = attribute;
+    m_id = attribute;
+    m_has_id = true;
   } else if (attribute_type == MessageAttribute::KEY) {
-    m_attributes[MessageAttribute::KEY] = attribute;
+    m_key = attribute;
+    m_has_key = true;
   } else if (attribute_type == MessageAttribute::CORRELATION_ID) {
-    m_attributes[MessageAttribute::CORRELATION_ID] = attribute;
+    m_correlation_id = attribute;
   } else {
     EXCEPT(1, "Attempt to add unsupported attribute to GoogleProtoMessage.");
   }
@@ -90,9 +125,26 @@ void GoogleProtoMessage::set(MessageAttribute attribute_type,
 
 void GoogleProtoMessage::set(std::string attribute_name,
                              std::variant<uint8_t, uint16_t, uint32_t> value) {
-  if (m_dyn_attributes.count(attribute_name)) {
-    m_dyn_attributes[attribute_name] = value;
-  } else {
+  // Each field keeps its own width regardless of how the value was passed in
+  const uint32_t number =
+      std::visit([](auto v) { return static_cast<uint32_t>(v); }, value);
+  switch (toField(attribute_name)) {
+  case Field::FRAME_SIZE:
+    m_frame_size = number;
+    break;
+  case Field::PROTO_ID:
+    m_proto_id = static_cast<uint8_t>(number);
+    break;
+  case Field::MSG_ID:
+    m_msg_id = static_cast<uint8_t>(number);
+    break;
+  case Field::MSG_TYPE:
+    m_msg_type = static_cast<uint16_t>(number);
+    break;
+  case Field::CONTEXT:
+    m_context = static_cast<uint16_t>(number);
+    break;
+  case Field::NONE:
     EXCEPT_PARAM(
         1, "Unable to set GoogleProtoMessage with attribute it is unsuppored: "
                << attribute_name);
@@ -106,8 +158,12 @@ std::variant<std::string, MessageState>
 GoogleProtoMessage::get(MessageAttribute attribute_type) const {
   if (attribute_type == MessageAttribute::STATE) {
     return m_state;
-  } else if (exists(attribute_type)) {
-    return m_attributes.at(attribute_type);
+  } else if (attribute_type == MessageAttribute::CORRELATION_ID) {
+    return m_correlation_id;
+  } else if (attribute_type == MessageAttribute::ID && m_has_id) {
+    return m_id;
+  } else if (attribute_type == MessageAttribute::KEY && m_has_key) {
+    return m_key;
   } else {
     EXCEPT_PARAM(
         1, "Attempt to get unsupported attribute type from GoogleProtoMessage."
@@ -117,13 +173,23 @@ GoogleProtoMessage::get(MessageAttribute attribute_type) const {
 
 std::variant<uint8_t, uint16_t, uint32_t>
 GoogleProtoMessage::get(const std::string &attribute_name) const {
-  if (exists(attribute_name)) {
-    return m_dyn_attributes.at(attribute_name);
-  } else {
-    EXCEPT_PARAM(
-        1, "Attempt to get unsupported attribute type from GoogleProtoMessage."
-               << attribute_name);
+  switch (toField(attribute_name)) {
+  case Field::FRAME_SIZE:
+    return m_frame_size;
+  case Field::PROTO_ID:
+    return m_proto_id;
+  case Field::MSG_ID:
+    return m_msg_id;
+  case Field::MSG_TYPE:
+    return m_msg_type;
+  case Field::CONTEXT:
+    return m_context;
+  case Field::NONE:
+    break;
   }
+  EXCEPT_PARAM(
+      1, "Attempt to get unsupported attribute type from GoogleProtoMessage."
+             << attribute_name);
 }
 
 std::variant<::google::protobuf::Message *, std::string>
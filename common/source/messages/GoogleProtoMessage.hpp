@@ -11,10 +11,10 @@
 #include <google/protobuf/message.h>
 
 // Standard includes
+#include <chrono>
 #include <list>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <variant>
 
 namespace SDMS {
@@ -42,19 +42,39 @@ public:
 
   virtual ~GoogleProtoMessage() {};
 private:
+  /// Header fields that can be addressed by name, see the
+  /// constants::message::google names
+  enum class Field { FRAME_SIZE, PROTO_ID, MSG_ID, MSG_TYPE, CONTEXT, NONE };
+
+  static Field toField(const std::string &attribute_name) noexcept;
+
   MessageState m_state = MessageState::REQUEST;
 
   /// List instead of vector because need to add to front, routes are small
   /// so vector cache optimization really wouldn't really make a difference
   std::list<std::string> m_routes;
-  std::unordered_map<MessageAttribute, std::string> m_attributes;
 
-  std::unordered_map<std::string, std::variant<uint8_t, uint16_t, uint32_t>>
-      m_dyn_attributes;
+  /**
+   * The attributes are a fixed set, they are kept in plain members rather
+   * than in maps so that creating a message does not allocate a node per
+   * attribute.
+   **/
+  std::string m_id;
+  std::string m_key;
+  std::string m_correlation_id;
+  bool m_has_id = false;
+  bool m_has_key = false;
+
+  uint32_t m_frame_size = 0;
+  uint8_t m_proto_id = 0;
+  uint8_t m_msg_id = 0;
+  uint16_t m_msg_type = 0;
+  uint16_t m_context = 0;
+  std::chrono::steady_clock::time_point m_deadline =
+      std::chrono::steady_clock::time_point::max();
 
   std::unique_ptr<::google::protobuf::Message> m_payload;
-
-  ProtoBufMap m_proto_map;
+  std::unique_ptr<IRawPayload> m_raw_payload;
   /**
    * State checkers
    **/
@@ -75,10 +95,15 @@ private:
   virtual void setPayload(
       std::variant<std::unique_ptr<::google::protobuf::Message>, std::string>)
       final;
+  virtual void setRawPayload(std::unique_ptr<IRawPayload>) final;
   virtual void set(MessageAttribute, const std::string &) final;
   virtual void set(MessageAttribute, MessageState) final;
   virtual void set(std::string attribute_name,
                    std::variant<uint8_t, uint16_t, uint32_t>) final;
+  virtual void
+  setDeadline(std::chrono::steady_clock::time_point deadline) final {
+    m_deadline = deadline;
+  }
   /**
    * Getters
    **/
@@ -86,6 +111,9 @@ private:
       get(MessageAttribute) const final;
   virtual std::variant<uint8_t, uint16_t, uint32_t>
   get(const std::string &attribute_name) const final;
+  virtual std::chrono::steady_clock::time_point getDeadline() const final {
+    return m_deadline;
+  }
   virtual const std::list<std::string> &getRoutes() const final {
     return m_routes;
   }
@@ -95,6 +123,7 @@ private:
   }
   virtual std::variant<::google::protobuf::Message *, std::string>
   getPayload() final;
+  virtual IRawPayload *getRawPayload() final { return m_raw_payload.get(); }
 };
 
 } // namespace SDMS
@@ -3,8 +3,12 @@
 #include "AuthenticationOperator.hpp"
 
 // Local public includes
+#include "common/MessageFactory.hpp"
 #include "common/TraceException.hpp"
 
+// Proto file includes
+#include "common/SDMS_Anon.pb.h"
+
 // Standard includes
 #include <any>
 #include <iostream>
@@ -31,20 +35,53 @@ void AuthenticationOperator::execute(IMessage &message) {
   std::string key = std::get<std::string>(message.get(MessageAttribute::KEY));
 
   std::string uid = "anon";
-  if (m_authentication_manager->hasKey(key)) {
-    m_authentication_manager->incrementKeyAccessCounter(key);
-    
-    try {
-      uid = m_authentication_manager->getUID(key);
-    } catch (const std::exception& e) {
-      // Log the exception to help diagnose authentication issues
-      std::cerr << "[AuthenticationOperator] Failed to get UID for key: " 
-                << key.substr(0, 8) << "... Exception: " << e.what() << std::endl;
-      // Keep uid as "anon" if we fail to get the actual UID
+  try {
+    std::string key_uid;
+    if (m_authentication_manager->authenticate(key, key_uid)) {
+      uid = key_uid;
     }
+  } catch (const std::exception& e) {
+    // Log the exception to help diagnose authentication issues
+    std::cerr << "[AuthenticationOperator] Failed to get UID for key: " 
+              << key.substr(0, 8) << "... Exception: " << e.what() << std::endl;
+    // Keep uid as "anon" if we fail to get the actual UID
   }
 
   message.set(MessageAttribute::ID, uid);
 }
 
+std::unique_ptr<IMessage> AuthenticationOperator::reply(IMessage &message) {
+  if (message.exists(MessageAttribute::ID) == 0) {
+    return nullptr;
+  }
+
+  const std::string uid =
+      std::get<std::string>(message.get(MessageAttribute::ID));
+  const uint16_t msg_type =
+      std::get<uint16_t>(message.get(constants::message::google::MSG_TYPE));
+  uint32_t retry_after_ms = 0;
+  if (m_authentication_manager->admit(uid, msg_type, retry_after_ms)) {
+    return nullptr;
+  }
+
+  MessageFactory msg_factory;
+  auto reply_msg = msg_factory.createResponseEnvelope(message);
+  auto nack = std::make_unique<Anon::NackReply>();
+  nack->set_err_code(ID_SERVICE_ERROR);
+  nack->set_err_msg("Too many requests, retry after " +
+                    std::to_string(retry_after_ms) + " ms");
+  nack->set_retry_after_ms(retry_after_ms);
+  reply_msg->setPayload(std::move(nack));
+  return reply_msg;
+}
+
+bool AuthenticationOperator::ready(IMessage &message) {
+  if (message.exists(MessageAttribute::KEY) == 0) {
+    // execute will reject it without a lookup
+    return true;
+  }
+  return m_authentication_manager->resolveKeyAsync(
+      std::get<std::string>(message.get(MessageAttribute::KEY)));
+}
+
 } // namespace SDMS
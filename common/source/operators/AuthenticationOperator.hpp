@@ -49,6 +49,11 @@ private:
   }
 
   virtual void execute(IMessage &message) final;
+
+  virtual bool ready(IMessage &message) final;
+
+  /// Refuses the request if its user is over the rate limit
+  virtual std::unique_ptr<IMessage> reply(IMessage &message) final;
 };
 
 inline std::unique_ptr<IOperator>
@@ -5,21 +5,38 @@
 // Local public includes
 #include "common/CommunicatorFactory.hpp"
 #include "common/ICommunicator.hpp"
+#include "common/MessageFactory.hpp"
 #include "common/TraceException.hpp"
 
 // Proto file includes
 #include "common/SDMS_Anon.pb.h"
 #include "common/SDMS_Auth.pb.h"
 
+// Third party includes
+#include <zmq.hpp>
+
 // Standard includes
 #include <exception>
 #include <iostream>
+#include <set>
 #include <unordered_map>
 
 using namespace std;
 
 namespace SDMS {
 
+namespace {
+/// True if a message can be read from the zmq socket without waiting
+bool hasIncoming(void *zmq_socket) {
+  int events = 0;
+  size_t events_size = sizeof(events);
+  if (zmq_getsockopt(zmq_socket, ZMQ_EVENTS, &events, &events_size) != 0) {
+    return false;
+  }
+  return events & ZMQ_POLLIN;
+}
+} // namespace
+
 Proxy::Proxy(
     const std::unordered_map<SocketRole, SocketOptions> &socket_options,
     const std::unordered_map<SocketRole, ICredentials *> &socket_credentials,
@@ -92,83 +109,210 @@ void Proxy::setRunDuration(std::chrono::duration<double> duration) {
   m_run_duration = duration;
 }
 
+/**
+ * Forward the messages that are ready on the "from" socket to the "to"
+ * socket, at most m_max_burst_size of them so the other direction is not
+ * starved.
+ **/
+void Proxy::forwardBurst(const SocketRole from, const SocketRole to,
+                         bool apply_operators) {
+  void *from_socket = m_communicators[from]->nativeHandle();
+  for (size_t count = 0; count < m_max_burst_size; ++count) {
+    if (count > 0 and not hasIncoming(from_socket)) {
+      break;
+    }
+
+    auto response = m_communicators[from]->pollPassThrough(
+        MessageType::GOOGLE_PROTOCOL_BUFFER);
+
+    if (response.error) {
+      DL_ERROR(m_log_context, m_communicators[from]->id()
+                                  << " error detected: "
+                                  << response.error_msg);
+      break;
+    } else if (response.time_out) {
+      break;
+    } else if (not response.message) {
+      DL_ERROR(m_log_context,
+               "Proxy::run - Something is wrong, message "
+                   << "response is not defined but no timeouts or errors were "
+                   << "triggered, unable to send message.");
+      break;
+    }
+
+    if (apply_operators) {
+      // Hold the message back instead of waiting on the operators, later
+      // messages with the same key are held back too so they stay in order
+      if (isDeferred(*response.message) or
+          not operatorsReady(*response.message)) {
+        if (m_deferred.size() < m_max_deferred) {
+          defer(std::move(response.message));
+        } else {
+          refuse(*response.message, "Server busy, retry later");
+        }
+        continue;
+      }
+      operateAndSend(*response.message);
+    } else {
+      m_communicators[to]->send(*response.message);
+    }
+  }
+}
+
+bool Proxy::operatorsReady(IMessage &message) {
+  for (auto &in_operator : m_incoming_operators) {
+    if (not in_operator->ready(message)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+namespace {
+std::string keyOf(IMessage &message) {
+  if (not message.exists(MessageAttribute::KEY)) {
+    return std::string();
+  }
+  return std::get<std::string>(message.get(MessageAttribute::KEY));
+}
+} // namespace
+
+bool Proxy::isDeferred(IMessage &message) const {
+  return not m_deferred_keys.empty() and
+         m_deferred_keys.count(keyOf(message));
+}
+
+void Proxy::defer(std::unique_ptr<IMessage> message) {
+  m_deferred_keys[keyOf(*message)]++;
+  m_deferred.push_back({std::chrono::steady_clock::now() + m_max_defer_time,
+                        std::move(message)});
+}
+
+void Proxy::operateAndSend(IMessage &message) {
+  for (auto &in_operator : m_incoming_operators) {
+    in_operator->execute(message);
+  }
+  for (auto &in_operator : m_incoming_operators) {
+    auto reply = in_operator->reply(message);
+    if (reply) {
+      m_communicators[SocketRole::SERVER]->send(*reply);
+      return;
+    }
+  }
+  m_communicators[SocketRole::CLIENT]->send(message);
+}
+
+/**
+ * Answer the sender with a NackReply instead of passing the message on.
+ **/
+void Proxy::refuse(IMessage &message, const std::string &reason) {
+  MessageFactory msg_factory;
+  auto reply_msg = msg_factory.createResponseEnvelope(message);
+  auto nack = std::make_unique<Anon::NackReply>();
+  nack->set_err_code(ID_SERVICE_ERROR);
+  nack->set_err_msg(reason);
+  reply_msg->setPayload(std::move(nack));
+  m_communicators[SocketRole::SERVER]->send(*reply_msg);
+}
+
+/**
+ * Send the held back messages whose operators are now ready, and refuse the
+ * ones that have waited too long rather than running the operators on them,
+ * which would block on the lookups they are waiting for. Messages are sent in
+ * the order they arrived for any given key.
+ **/
+void Proxy::sendDeferred() {
+  const auto now = std::chrono::steady_clock::now();
+  std::set<std::string> blocked_keys;
+
+  for (auto deferred = m_deferred.begin(); deferred != m_deferred.end();) {
+    IMessage &message = *deferred->message;
+    const std::string key = keyOf(message);
+    const bool expired = deferred->deadline <= now;
+
+    if (blocked_keys.count(key) or
+        (not expired and not operatorsReady(message))) {
+      blocked_keys.insert(key);
+      ++deferred;
+      continue;
+    }
+
+    try {
+      if (expired and not operatorsReady(message)) {
+        refuse(message, "Authentication timed out, retry later");
+      } else {
+        operateAndSend(message);
+      }
+    } catch (TraceException &e) {
+      DL_ERROR(m_log_context, "Proxy::sendDeferred - " << e.toString());
+    } catch (exception &e) {
+      DL_ERROR(m_log_context, "Proxy::sendDeferred - " << e.what());
+    }
+
+    auto count = m_deferred_keys.find(key);
+    if (--count->second == 0) {
+      m_deferred_keys.erase(count);
+    }
+    deferred = m_deferred.erase(deferred);
+  }
+}
+
 void Proxy::run() {
 
   auto end_time = std::chrono::steady_clock::now() + m_run_duration;
 
-  int count = 0;
+  // Message bodies are forwarded as received, the operators only need the
+  // header parts so the protobuf payload is never decoded or re-encoded here.
+  //
+  // Both sockets are waited on with a single poll so a message arriving on
+  // either side is handled as soon as it arrives.
+  zmq_pollitem_t items[] = {
+      {m_communicators[SocketRole::CLIENT]->nativeHandle(), 0, ZMQ_POLLIN, 0},
+      {m_communicators[SocketRole::SERVER]->nativeHandle(), 0, ZMQ_POLLIN,
+       0}};
+  const int num_items_in_array = 2;
 
   while (m_run_infinite_loop or (end_time > std::chrono::steady_clock::now())) {
     try {
-      count++;
-      // Coming from the client socket that is local so communication flow is
-      // going from an internal thread/process
-      //
-      //                                              <- POLL_IN
-      // Pub Client - Client Sock - Serv Sock - Proxy - Client Sock - Serv Sock
-      // - Inter App
-      auto resp_from_client_socket = m_communicators[SocketRole::CLIENT]->poll(
-          MessageType::GOOGLE_PROTOCOL_BUFFER);
+      // Check back often on messages waiting for the operators
+      const long timeout = m_deferred.empty() ? m_timeout_on_poll_milliseconds
+                                              : m_deferred_poll_milliseconds;
+      int events_detected = zmq_poll(items, num_items_in_array, timeout);
 
-      if (resp_from_client_socket.error) {
-        DL_ERROR(m_log_context, m_communicators[SocketRole::CLIENT]->id()
-                                    << " error detected: "
-                                    << resp_from_client_socket.error_msg);
+      if (not m_deferred.empty()) {
+        sendDeferred();
       }
 
-      // Coming from the server socket that is local so communication flow is
-      // coming from a public client thread/process
+      if (events_detected < 0) {
+        DL_ERROR(m_log_context, "Proxy::run - zmq_poll failed: "
+                                    << zmq_strerror(zmq_errno()));
+        continue;
+      } else if (events_detected == 0) {
+        continue;
+      }
+
+      // Coming from the client socket that is local so communication flow is
+      // going from an internal thread/process, essentially just route with
+      // out doing anything if flow is towards the public
       //
-      //                              POLL_IN  ->
+      //                                              <- POLL_IN
       // Pub Client - Client Sock - Serv Sock - Proxy - Client Sock - Serv Sock
       // - Inter App
-      auto resp_from_server_socket = m_communicators[SocketRole::SERVER]->poll(
-          MessageType::GOOGLE_PROTOCOL_BUFFER);
-      if (resp_from_server_socket.error) {
-        DL_ERROR(m_log_context, m_communicators[SocketRole::SERVER]->id()
-                                    << " error detected: "
-                                    << resp_from_server_socket.error_msg);
-      }
-
-      // Essentially just route with out doing anything if flow is towards the
-      // public
-      if (resp_from_client_socket.error == false and
-          resp_from_client_socket.time_out == false) {
-        if (not resp_from_client_socket.message) {
-          DL_ERROR(
-              m_log_context,
-              "Proxy::run - Something is wrong, message "
-                  << "response is not defined but no timeouts or errors were "
-                  << "triggered, unable to send to server.");
-        } else {
-          m_communicators[SocketRole::SERVER]->send(
-              *resp_from_client_socket.message);
-        }
+      if (items[0].revents & ZMQ_POLLIN) {
+        forwardBurst(SocketRole::CLIENT, SocketRole::SERVER, false);
       }
 
-      // If there are operations that need to happen on incoming messages,
-      // messages headed to the internal server of which we are a client,
-      // they will now be executed.
+      // Coming from the server socket that is local so communication flow is
+      // coming from a public client thread/process. If there are operations
+      // that need to happen on incoming messages, messages headed to the
+      // internal server of which we are a client, they will now be executed.
       //                 |            |
       //         POLL_IN ->           |
       //                 | Operate on -> Pass to internal Server
       //                 |            |
       // ... - Serv Sock - Proxy ------ Client Sock - Serv Sock - Inter App
-      if (resp_from_server_socket.error == false and
-          resp_from_server_socket.time_out == false) {
-        if (not resp_from_server_socket.message) {
-          DL_ERROR(
-              m_log_context,
-              "Proxy::run - Something is wrong, message "
-                  << "response is not defined but no timeouts or errors were "
-                  << "triggered, unable to operate and send to client.");
-        } else {
-          for (auto &in_operator : m_incoming_operators) {
-            in_operator->execute(*resp_from_server_socket.message);
-          }
-          m_communicators[SocketRole::CLIENT]->send(
-              *resp_from_server_socket.message);
-        }
+      if (items[1].revents & ZMQ_POLLIN) {
+        forwardBurst(SocketRole::SERVER, SocketRole::CLIENT, true);
       }
 
     } catch (TraceException &e) {
@@ -11,6 +11,7 @@
 
 // Standard includes
 #include <chrono>
+#include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -22,6 +23,14 @@ class Proxy : public IServer {
 private:
   uint32_t m_timeout_on_receive_milliseconds = 50;
   long m_timeout_on_poll_milliseconds = 50;
+  /// Most messages forwarded in one direction before polling again
+  size_t m_max_burst_size = 128;
+  /// Poll timeout used while messages are waiting on the operators
+  long m_deferred_poll_milliseconds = 2;
+  /// Most messages held back waiting on the operators, later ones are refused
+  size_t m_max_deferred = 1024;
+  /// Longest a message is held back before it is refused
+  std::chrono::milliseconds m_max_defer_time = std::chrono::seconds(5);
   std::vector<std::unique_ptr<IOperator>> m_incoming_operators;
   std::unordered_map<SocketRole, std::unique_ptr<ICommunicator>>
       m_communicators;
@@ -31,6 +40,24 @@ private:
   LogContext m_log_context;
   std::unordered_map<SocketRole, std::string> m_addresses;
 
+  struct DeferredMessage {
+    std::chrono::steady_clock::time_point deadline;
+    std::unique_ptr<IMessage> message;
+  };
+  /// Incoming messages waiting for the operators to be ready, in order
+  std::deque<DeferredMessage> m_deferred;
+  /// Number of messages in m_deferred by key
+  std::unordered_map<std::string, size_t> m_deferred_keys;
+
+  void forwardBurst(const SocketRole from, const SocketRole to,
+                    bool apply_operators);
+  bool operatorsReady(IMessage &message);
+  bool isDeferred(IMessage &message) const;
+  void defer(std::unique_ptr<IMessage> message);
+  void operateAndSend(IMessage &message);
+  void refuse(IMessage &message, const std::string &reason);
+  void sendDeferred();
+
 public:
   /// Convenience constructor
   Proxy(
@@ -0,0 +1,226 @@
+// Local private includes
+#include "CompactHeader.hpp"
+#include "DeadlinePart.hpp"
+#include "../../Frame.hpp"
+
+// Local public includes
+#include "common/TraceException.hpp"
+
+// Standard includes
+#include <arpa/inet.h>
+#include <cstring>
+
+namespace SDMS {
+
+namespace {
+
+const char MAGIC[4] = {'D', 'F', 'M', 'H'};
+const size_t FIXED_SIZE = 16;
+
+/// Legacy format sends these when the attribute is not set
+const std::string NO_KEY = "no key";
+const std::string NO_ID = "no id";
+
+unsigned char *writeString(unsigned char *out, const std::string &value) {
+  uint16_t length = htons(static_cast<uint16_t>(value.size()));
+  memcpy(out, &length, sizeof(length));
+  memcpy(out + sizeof(length), value.data(), value.size());
+  return out + sizeof(length) + value.size();
+}
+
+class Reader {
+public:
+  Reader(const unsigned char *data, size_t size)
+      : m_data(data), m_remaining(size) {}
+
+  std::string readString() {
+    uint16_t length = 0;
+    if (m_remaining < sizeof(length)) {
+      EXCEPT(1, "Compact message header is truncated.");
+    }
+    memcpy(&length, m_data, sizeof(length));
+    length = ntohs(length);
+    m_data += sizeof(length);
+    m_remaining -= sizeof(length);
+    if (m_remaining < length) {
+      EXCEPT(1, "Compact message header is truncated.");
+    }
+    std::string value(reinterpret_cast<const char *>(m_data), length);
+    m_data += length;
+    m_remaining -= length;
+    return value;
+  }
+
+  uint64_t readUint64() {
+    if (m_remaining < sizeof(uint64_t)) {
+      EXCEPT(1, "Compact message header is truncated.");
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+      value = (value << 8) | m_data[i];
+    }
+    m_data += sizeof(uint64_t);
+    m_remaining -= sizeof(uint64_t);
+    return value;
+  }
+
+  size_t remaining() const noexcept { return m_remaining; }
+
+private:
+  const unsigned char *m_data;
+  size_t m_remaining;
+};
+
+} // namespace
+
+bool CompactHeader::matches(zmq_msg_t &zmq_msg) {
+  if (zmq_msg_size(&zmq_msg) < FIXED_SIZE) {
+    return false;
+  }
+  const unsigned char *data =
+      static_cast<const unsigned char *>(zmq_msg_data(&zmq_msg));
+  return memcmp(data, MAGIC, sizeof(MAGIC)) == 0 && data[4] == VERSION;
+}
+
+void CompactHeader::encode(IMessage &msg, const std::list<std::string> &routes,
+                           zmq_msg_t &zmq_msg) {
+  FrameFactory frame_factory;
+  Frame frame = frame_factory.create(msg);
+
+  if (routes.size() > UINT16_MAX) {
+    EXCEPT(1, "Too many routes to fit in a compact message header.");
+  }
+
+  if (!msg.exists(MessageAttribute::CORRELATION_ID)) {
+    EXCEPT(1, "Message missing correlation id, something is really wrong.");
+  }
+  const std::string correlation_id =
+      std::get<std::string>(msg.get(MessageAttribute::CORRELATION_ID));
+  const std::string key =
+      msg.exists(MessageAttribute::KEY)
+          ? std::get<std::string>(msg.get(MessageAttribute::KEY))
+          : NO_KEY;
+  const std::string id =
+      msg.exists(MessageAttribute::ID)
+          ? std::get<std::string>(msg.get(MessageAttribute::ID))
+          : NO_ID;
+
+  size_t size = FIXED_SIZE;
+  for (const std::string &route : routes) {
+    if (route.size() == 0) {
+      EXCEPT(1, "Cannot send a route of size 0");
+    }
+    if (route.size() > 255) {
+      EXCEPT(1, "Message route segment exceeds max allowed length.");
+    }
+    size += sizeof(uint16_t) + route.size();
+  }
+  for (const std::string *value : {&correlation_id, &key, &id}) {
+    if (value->size() > UINT16_MAX) {
+      EXCEPT(1, "Message attribute too large for a compact message header.");
+    }
+    size += sizeof(uint16_t) + value->size();
+  }
+  // Responses never carry the deadline of their request
+  const bool has_deadline =
+      std::get<MessageState>(msg.get(MessageAttribute::STATE)) ==
+          MessageState::REQUEST &&
+      msg.getDeadline() != std::chrono::steady_clock::time_point::max();
+  if (has_deadline) {
+    size += sizeof(uint64_t);
+  }
+
+  zmq_msg_init_size(&zmq_msg, size);
+  unsigned char *out = static_cast<unsigned char *>(zmq_msg_data(&zmq_msg));
+
+  memcpy(out, MAGIC, sizeof(MAGIC));
+  out[4] = VERSION;
+  out[5] = has_deadline ? FLAG_DEADLINE : 0;
+  uint16_t number_of_routes = htons(static_cast<uint16_t>(routes.size()));
+  memcpy(out + 6, &number_of_routes, sizeof(number_of_routes));
+  uint32_t frame_size = htonl(frame.size);
+  memcpy(out + 8, &frame_size, sizeof(frame_size));
+  out[12] = frame.proto_id;
+  out[13] = frame.msg_id;
+  uint16_t context = htons(frame.context);
+  memcpy(out + 14, &context, sizeof(context));
+
+  out += FIXED_SIZE;
+  for (const std::string &route : routes) {
+    out = writeString(out, route);
+  }
+  out = writeString(out, correlation_id);
+  out = writeString(out, key);
+  out = writeString(out, id);
+  if (has_deadline) {
+    uint64_t left = DeadlinePart::timeLeft(msg);
+    for (size_t i = sizeof(uint64_t); i > 0; --i) {
+      out[i - 1] = static_cast<unsigned char>(left & 0xFF);
+      left >>= 8;
+    }
+  }
+}
+
+void CompactHeader::decode(zmq_msg_t &zmq_msg, IMessage &msg,
+                           std::string previous_route) {
+  if (!matches(zmq_msg)) {
+    EXCEPT(1, "Not a compact message header.");
+  }
+  const unsigned char *data =
+      static_cast<const unsigned char *>(zmq_msg_data(&zmq_msg));
+
+  uint16_t number_of_routes = 0;
+  memcpy(&number_of_routes, data + 6, sizeof(number_of_routes));
+  number_of_routes = ntohs(number_of_routes);
+
+  Frame frame;
+  uint32_t frame_size = 0;
+  memcpy(&frame_size, data + 8, sizeof(frame_size));
+  frame.size = ntohl(frame_size);
+  frame.proto_id = data[12];
+  frame.msg_id = data[13];
+  uint16_t context = 0;
+  memcpy(&context, data + 14, sizeof(context));
+  frame.context = ntohs(context);
+
+  Reader reader(data + FIXED_SIZE, zmq_msg_size(&zmq_msg) - FIXED_SIZE);
+  for (uint16_t route_i = 0; route_i < number_of_routes; ++route_i) {
+    std::string route = reader.readString();
+    if (route.size() == 0) {
+      EXCEPT(1, "Message route should not be an empty message.");
+    }
+    if (route.size() > 255) {
+      EXCEPT(1, "Message route segment exceeds max allowed length.");
+    }
+    // Only add the next route if it has a different name
+    if (previous_route.compare(route) != 0) {
+      msg.addRoute(route);
+      previous_route = route;
+    }
+  }
+
+  std::string correlation_id = reader.readString();
+  std::string key = reader.readString();
+  std::string id = reader.readString();
+  if (data[5] & FLAG_DEADLINE) {
+    DeadlinePart::setTimeLeft(msg, reader.readUint64());
+  }
+  if (reader.remaining() != 0) {
+    EXCEPT(1, "Compact message header has trailing bytes.");
+  }
+
+  if (correlation_id.size()) {
+    msg.set(MessageAttribute::CORRELATION_ID, correlation_id);
+  }
+  if (key.size()) {
+    msg.set(MessageAttribute::KEY, key);
+  }
+  if (id.size()) {
+    msg.set(MessageAttribute::ID, id);
+  }
+
+  FrameConverter converter;
+  converter.copy(FrameConverter::CopyDirection::FROM_FRAME, msg, frame);
+}
+
+} // namespace SDMS
@@ -0,0 +1,70 @@
+#ifndef COMPACTHEADER_HPP
+#define COMPACTHEADER_HPP
+#pragma once
+
+// Local public includes
+#include "common/IMessage.hpp"
+
+// Third party includes
+#include <zmq.hpp>
+
+// Standard includes
+#include <cstdint>
+#include <list>
+#include <string>
+
+namespace SDMS {
+
+/**
+ * Packs everything the legacy wire format spreads over separate parts (the
+ * "BEGIN_DATAFED" marker, route count, routes, delimiters, frame, correlation
+ * id, key and id) into a single binary part. A message is then sent as
+ *
+ * [identity routes needed by a ROUTER socket]
+ * compact header
+ * body
+ *
+ * Layout, all integers in network byte order
+ *
+ * 0  - 3  magic "DFMH"
+ * 4       version
+ * 5       flags, FLAG_DEADLINE
+ * 6  - 7  number of routes
+ * 8  - 11 body size
+ * 12      protocol id
+ * 13      message id
+ * 14 - 15 context
+ * 16 -    routes, correlation id, key and id, each as a 16 bit length
+ *         followed by the bytes
+ *         with FLAG_DEADLINE, 64 bit milliseconds left until the deadline
+ *
+ * Receivers recognize the header by its magic so both formats can arrive on
+ * the same socket.
+ **/
+class CompactHeader {
+public:
+  static const uint8_t VERSION = 1;
+  static const uint8_t FLAG_DEADLINE = 0x01;
+
+  /// True if the part is a compact header of a version that can be read
+  static bool matches(zmq_msg_t &zmq_msg);
+
+  /**
+   * routes are the routes left after the identity routes a ROUTER socket
+   * needs have been sent as their own parts. zmq_msg must not be initialized,
+   * it is sized to fit the header.
+   **/
+  void encode(IMessage &msg, const std::list<std::string> &routes,
+              zmq_msg_t &zmq_msg);
+
+  /**
+   * previous_route is the last identity route already added to msg,
+   * consecutive duplicate routes are dropped the same way the legacy format
+   * does.
+   **/
+  void decode(zmq_msg_t &zmq_msg, IMessage &msg, std::string previous_route);
+};
+
+} // namespace SDMS
+
+#endif // COMPACTHEADER_HPP
@@ -8,6 +8,8 @@
 // Standard library includes
 #include <atomic>
 #include <iostream>
+#include <mutex>
+#include <vector>
 
 namespace SDMS {
 
@@ -51,6 +53,53 @@ private:
     inline static void *context = nullptr;
 };
 
+/**
+ * Context shared by every TCP communicator of the process. Each context owns
+ * its own I/O threads, so a context per communicator costs a thread for every
+ * connection to a repo server. The shared context is created on first use and
+ * lives until the process exits, sockets close with a short linger so nothing
+ * is left waiting on it.
+ *
+ * configure must be called before the first TCP communicator is created, once
+ * the context exists the settings no longer apply.
+ **/
+class TcpContext {
+public:
+    /// See CommunicatorFactory::configureTcpContext
+    static bool configure(int io_threads, const std::vector<int> &cpus = {}) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (context != nullptr) {
+        return false;
+      }
+      io_thread_count = io_threads > 0 ? io_threads : 1;
+      io_thread_cpus = cpus;
+      return true;
+    }
+
+    static void *getContext() {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (context == nullptr) {
+        context = zmq_ctx_new();
+        zmq_ctx_set(context, ZMQ_IO_THREADS, io_thread_count);
+        for (int cpu : io_thread_cpus) {
+          zmq_ctx_set(context, ZMQ_THREAD_AFFINITY_CPU_ADD, cpu);
+        }
+      }
+      return context;
+    }
+
+    static int ioThreads() {
+      std::lock_guard<std::mutex> lock(mutex);
+      return io_thread_count;
+    }
+
+private:
+    inline static std::mutex mutex;
+    inline static void *context = nullptr;
+    inline static int io_thread_count = 1;
+    inline static std::vector<int> io_thread_cpus;
+};
+
 } // namespace SDMS
 
 #endif // ZMQCONTEXT_HPP
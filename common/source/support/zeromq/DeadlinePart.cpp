@@ -0,0 +1,65 @@
+// Local private includes
+#include "DeadlinePart.hpp"
+
+// Local public includes
+#include "common/TraceException.hpp"
+
+// Standard includes
+#include <algorithm>
+#include <cstring>
+
+namespace SDMS {
+
+namespace {
+
+const char MAGIC[4] = {'D', 'F', 'D', 'L'};
+
+/// Far enough out to mean no hurry, close enough to not overflow the clock
+const uint64_t MAX_TIME_LEFT = UINT32_MAX;
+
+} // namespace
+
+uint64_t DeadlinePart::timeLeft(const IMessage &msg) {
+  const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        msg.getDeadline() - std::chrono::steady_clock::now())
+                        .count();
+  return left > 0 ? std::min(static_cast<uint64_t>(left), MAX_TIME_LEFT) : 0;
+}
+
+void DeadlinePart::setTimeLeft(IMessage &msg, uint64_t milliseconds) {
+  msg.setDeadline(
+      std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(std::min(milliseconds, MAX_TIME_LEFT)));
+}
+
+bool DeadlinePart::matches(zmq_msg_t &zmq_msg) {
+  return zmq_msg_size(&zmq_msg) == SIZE &&
+         memcmp(zmq_msg_data(&zmq_msg), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+void DeadlinePart::encode(const IMessage &msg, zmq_msg_t &zmq_msg) {
+  uint64_t left = timeLeft(msg);
+
+  zmq_msg_init_size(&zmq_msg, SIZE);
+  unsigned char *out = static_cast<unsigned char *>(zmq_msg_data(&zmq_msg));
+  memcpy(out, MAGIC, sizeof(MAGIC));
+  for (size_t i = SIZE; i > sizeof(MAGIC); --i) {
+    out[i - 1] = static_cast<unsigned char>(left & 0xFF);
+    left >>= 8;
+  }
+}
+
+void DeadlinePart::decode(zmq_msg_t &zmq_msg, IMessage &msg) {
+  if (!matches(zmq_msg)) {
+    EXCEPT(1, "Not a message deadline part.");
+  }
+  const unsigned char *data =
+      static_cast<const unsigned char *>(zmq_msg_data(&zmq_msg));
+  uint64_t left = 0;
+  for (size_t i = sizeof(MAGIC); i < SIZE; ++i) {
+    left = (left << 8) | data[i];
+  }
+  setTimeLeft(msg, left);
+}
+
+} // namespace SDMS
@@ -0,0 +1,45 @@
+#ifndef DEADLINEPART_HPP
+#define DEADLINEPART_HPP
+#pragma once
+
+// Local public includes
+#include "common/IMessage.hpp"
+
+// Third party includes
+#include <zmq.hpp>
+
+// Standard includes
+#include <cstdint>
+
+namespace SDMS {
+
+/**
+ * Carries the deadline of a request in the legacy wire format, as an optional
+ * part between the id and the frame
+ *
+ * 0 - 3  magic "DFDL"
+ * 4 - 11 milliseconds left until the deadline, network byte order
+ *
+ * The time left rather than the deadline itself is sent, the receiver turns
+ * it back into a point on its own clock. Receivers older than this part do
+ * not skip it, so it is only sent to peers known to understand it.
+ **/
+class DeadlinePart {
+public:
+  static const size_t SIZE = 12;
+
+  /// Time left until the deadline of msg in ms, 0 once it has passed
+  static uint64_t timeLeft(const IMessage &msg);
+  static void setTimeLeft(IMessage &msg, uint64_t milliseconds);
+
+  /// True if the part is a deadline part
+  static bool matches(zmq_msg_t &zmq_msg);
+
+  /// zmq_msg must not be initialized, it is sized to fit the part
+  void encode(const IMessage &msg, zmq_msg_t &zmq_msg);
+  void decode(zmq_msg_t &zmq_msg, IMessage &msg);
+};
+
+} // namespace SDMS
+
+#endif // DEADLINEPART_HPP
@@ -0,0 +1,154 @@
+// Local private includes
+#include "Frame.hpp"
+
+// Local public includes
+#include "common/IMessage.hpp"
+#include "common/MessageFactory.hpp"
+#include "common/ProtoBufMap.hpp"
+
+// Proto file includes
+#include "common/SDMS_Anon.pb.h"
+
+// Third party includes
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+// Standard includes
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <variant>
+
+using namespace SDMS;
+
+namespace {
+
+/**
+ * Reproduces what creating and filling in a GoogleProtoMessage used to cost:
+ * a type map built per message, string keyed attribute maps and a freshly
+ * seeded uuid generator. Kept here so the current envelope can be compared
+ * against it.
+ **/
+class LegacyEnvelope {
+public:
+  LegacyEnvelope() {
+    m_dyn_attributes[constants::message::google::FRAME_SIZE] = (uint32_t)0;
+    m_dyn_attributes[constants::message::google::PROTO_ID] = (uint8_t)0;
+    m_dyn_attributes[constants::message::google::MSG_ID] = (uint8_t)0;
+    m_dyn_attributes[constants::message::google::MSG_TYPE] = (uint16_t)0;
+    m_dyn_attributes[constants::message::google::CONTEXT] = (uint16_t)0;
+
+    boost::uuids::random_generator generator;
+    m_attributes[MessageAttribute::CORRELATION_ID] =
+        boost::uuids::to_string(generator());
+  }
+
+  void set(MessageAttribute attribute_type, const std::string &attribute) {
+    m_attributes[attribute_type] = attribute;
+  }
+
+  void set(const std::string &attribute_name,
+           std::variant<uint8_t, uint16_t, uint32_t> value) {
+    m_dyn_attributes.at(attribute_name) = value;
+  }
+
+  std::variant<uint8_t, uint16_t, uint32_t>
+  get(const std::string &attribute_name) const {
+    return m_dyn_attributes.at(attribute_name);
+  }
+
+  void setPayload(std::unique_ptr<::google::protobuf::Message> payload) {
+    FrameFactory frame_factory;
+    Frame frame = frame_factory.create(*payload, m_proto_map);
+    m_dyn_attributes[constants::message::google::FRAME_SIZE] = frame.size;
+    m_dyn_attributes[constants::message::google::PROTO_ID] = frame.proto_id;
+    m_dyn_attributes[constants::message::google::MSG_ID] = frame.msg_id;
+    m_dyn_attributes[constants::message::google::MSG_TYPE] = frame.getMsgType();
+    m_payload = std::move(payload);
+  }
+
+  std::list<std::string> &getRoutes() { return m_routes; }
+
+private:
+  std::list<std::string> m_routes;
+  std::unordered_map<MessageAttribute, std::string> m_attributes;
+  std::unordered_map<std::string, std::variant<uint8_t, uint16_t, uint32_t>>
+      m_dyn_attributes;
+  std::unique_ptr<::google::protobuf::Message> m_payload;
+  ProtoBufMap m_proto_map;
+};
+
+/// The work done on a typical request envelope between the socket and a
+/// worker
+template <class Envelope> uint64_t fill(Envelope &msg) {
+  msg.set(MessageAttribute::ID, "u/benchmark");
+  msg.set(MessageAttribute::KEY, "benchmark-public-key");
+  msg.getRoutes().push_back("route_to_client");
+  msg.setPayload(std::make_unique<Anon::VersionRequest>());
+  msg.set(constants::message::google::CONTEXT, (uint16_t)1);
+  return std::get<uint16_t>(msg.get(constants::message::google::MSG_TYPE));
+}
+
+template <class Create> double run(size_t iterations, Create create) {
+  uint64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    checksum += create();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  // Keeps the loop from being optimized away
+  if (checksum == 0) {
+    std::cerr << "Unexpected checksum" << std::endl;
+  }
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         iterations;
+}
+
+} // namespace
+
+/**
+ * Usage: benchmark_GoogleProtoMessage [iterations]
+ **/
+int main(int argc, char **argv) {
+  size_t iterations = 100000;
+  if (argc > 1) {
+    iterations = std::strtoul(argv[1], nullptr, 10);
+  }
+  if (iterations == 0) {
+    std::cerr << "Iterations must be greater than 0" << std::endl;
+    return 1;
+  }
+
+  MessageFactory msg_factory;
+
+  // Warm up, the first message of a thread seeds its generator and the first
+  // use of the registry builds it
+  fill(*msg_factory.create(MessageType::GOOGLE_PROTOCOL_BUFFER));
+
+  double legacy_ns = run(iterations, []() {
+    LegacyEnvelope msg;
+    return fill(msg);
+  });
+
+  double current_ns = run(iterations, [&msg_factory]() {
+    auto msg = msg_factory.create(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    return fill(*msg);
+  });
+
+  std::cout << "Iterations:             " << iterations << std::endl;
+  std::cout << "Legacy envelope:        " << legacy_ns << " ns/message"
+            << std::endl;
+  std::cout << "GoogleProtoMessage:     " << current_ns << " ns/message"
+            << std::endl;
+  std::cout << "Speedup:                " << legacy_ns / current_ns << "x"
+            << std::endl;
+
+  google::protobuf::ShutdownProtobufLibrary();
+  return 0;
+}
@@ -0,0 +1,135 @@
+// Local public includes
+#include "common/CommunicatorFactory.hpp"
+#include "common/CredentialFactory.hpp"
+#include "common/DynaLog.hpp"
+#include "common/ICommunicator.hpp"
+#include "common/IMessage.hpp"
+#include "common/MessageFactory.hpp"
+#include "common/SocketOptions.hpp"
+
+// Proto file includes
+#include "common/SDMS_Anon.pb.h"
+
+// Standard includes
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+using namespace SDMS;
+
+namespace {
+
+SocketOptions generateOptions(const std::string &channel,
+                              const std::string &local_id,
+                              SocketClassType class_type,
+                              WireFormat wire_format) {
+  SocketOptions socket_options;
+  socket_options.scheme = URIScheme::INPROC;
+  socket_options.class_type = class_type;
+  socket_options.direction_type = SocketDirectionalityType::BIDIRECTIONAL;
+  socket_options.communication_type = SocketCommunicationType::ASYNCHRONOUS;
+  socket_options.connection_life = class_type == SocketClassType::SERVER
+                                       ? SocketConnectionLife::PERSISTENT
+                                       : SocketConnectionLife::INTERMITTENT;
+  socket_options.protocol_type = ProtocolType::ZQTP;
+  socket_options.host = channel;
+  socket_options.local_id = local_id;
+  socket_options.wire_format = wire_format;
+  return socket_options;
+}
+
+/**
+ * Sends a small request from a DEALER to a ROUTER and the reply back, the
+ * shape of the traffic between the proxies and the client workers, and
+ * returns the time per round trip.
+ **/
+double run(size_t iterations, WireFormat wire_format,
+           const std::string &channel) {
+  LogContext log_context;
+  CommunicatorFactory factory(log_context);
+  CredentialFactory cred_factory;
+  std::unordered_map<CredentialType, std::string> cred_options;
+  auto credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
+
+  auto server = factory.create(
+      generateOptions(channel, "benchmark_server", SocketClassType::SERVER,
+                      WireFormat::LEGACY),
+      *credentials, 1000, 1000);
+  auto client = factory.create(
+      generateOptions(channel, "benchmark_client", SocketClassType::CLIENT,
+                      wire_format),
+      *credentials, 1000, 1000);
+
+  MessageFactory msg_factory;
+  auto roundTrip = [&]() {
+    auto request = msg_factory.create(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    request->set(MessageAttribute::ID, "u/benchmark");
+    request->set(MessageAttribute::KEY, "benchmark-public-key");
+    request->addRoute("external_client");
+    request->setPayload(std::make_unique<Anon::VersionRequest>());
+    client->send(*request);
+
+    ICommunicator::Response response =
+        server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    if (response.time_out or response.error) {
+      std::cerr << "Request was not received" << std::endl;
+      std::exit(1);
+    }
+
+    auto reply = msg_factory.createResponseEnvelope(*response.message);
+    reply->setPayload(std::make_unique<Anon::VersionReply>());
+    server->send(*reply);
+
+    response = client->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    if (response.time_out or response.error) {
+      std::cerr << "Reply was not received" << std::endl;
+      std::exit(1);
+    }
+  };
+
+  // Warm up, includes the connect of the client
+  for (size_t i = 0; i < 100; ++i) {
+    roundTrip();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    roundTrip();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         iterations;
+}
+
+} // namespace
+
+/**
+ * Usage: benchmark_ZeroMQCommunicator [iterations]
+ **/
+int main(int argc, char **argv) {
+  size_t iterations = 20000;
+  if (argc > 1) {
+    iterations = std::strtoul(argv[1], nullptr, 10);
+  }
+  if (iterations == 0) {
+    std::cerr << "Iterations must be greater than 0" << std::endl;
+    return 1;
+  }
+
+  double legacy_ns = run(iterations, WireFormat::LEGACY, "benchmark_legacy");
+  double compact_ns = run(iterations, WireFormat::COMPACT, "benchmark_compact");
+
+  std::cout << "Iterations:             " << iterations << std::endl;
+  std::cout << "Legacy wire format:     " << legacy_ns << " ns/round trip"
+            << std::endl;
+  std::cout << "Compact wire format:    " << compact_ns << " ns/round trip"
+            << std::endl;
+  std::cout << "Speedup:                " << legacy_ns / compact_ns << "x"
+            << std::endl;
+
+  google::protobuf::ShutdownProtobufLibrary();
+  return 0;
+}
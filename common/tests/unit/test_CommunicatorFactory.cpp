@@ -10,12 +10,20 @@
 #include "common/ICredentials.hpp"
 #include "common/MessageFactory.hpp"
 #include "common/ProtocolTypes.hpp"
+#include "common/TraceException.hpp"
 
 // Proto file includes
 #include "common/SDMS.pb.h"
 #include "common/SDMS_Anon.pb.h"
 
+// Local private includes
+#include "support/zeromq/Context.hpp"
+
+// Third party includes
+#include <zmq.h>
+
 // Standard includes
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <unordered_map>
@@ -185,6 +193,452 @@ BOOST_AUTO_TEST_CASE(testing_CommunicatorFactory) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(testing_CommunicatorFactoryChunked) {
+
+  LogContext log_context;
+  log_context.thread_name = "test_communicator_factory_chunked";
+  CommunicatorFactory factory(log_context);
+
+  CredentialFactory cred_factory;
+  std::unordered_map<CredentialType, std::string> cred_options;
+  cred_options[CredentialType::PUBLIC_KEY] = public_key;
+  cred_options[CredentialType::PRIVATE_KEY] = secret_key;
+  cred_options[CredentialType::SERVER_KEY] = server_key;
+  auto credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
+
+  const uint32_t max_message_size = 4 * 1024 * 1024;
+  auto server = [&]() {
+    SocketOptions socket_options = generateCommonOptions("test_chunked");
+    socket_options.port = 1343;
+    socket_options.local_id = "overlord";
+    socket_options.max_message_size = max_message_size;
+    return factory.create(socket_options, *credentials, 40, 10);
+  }();
+
+  auto client = [&]() {
+    SocketOptions socket_options = generateCommonOptions("test_chunked");
+    socket_options.class_type = SocketClassType::CLIENT;
+    socket_options.connection_life = SocketConnectionLife::INTERMITTENT;
+    socket_options.port = 1343;
+    socket_options.local_id = "minion";
+    socket_options.chunk_size = 64 * 1024;
+    return factory.create(socket_options, *credentials, 10, 10);
+  }();
+
+  MessageFactory msg_factory;
+  auto sendToken = [&](const std::string &token) {
+    auto msg_from_client =
+        msg_factory.create(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    msg_from_client->set(MessageAttribute::ID, "Bob");
+    msg_from_client->set(MessageAttribute::KEY, "skeleton");
+    auto auth_by_token_req =
+        std::make_unique<Anon::AuthenticateByTokenRequest>();
+    auth_by_token_req->set_token(token);
+    msg_from_client->setPayload(std::move(auth_by_token_req));
+    client->send(*msg_from_client);
+  };
+
+  // Larger than the old 1 MiB limit, goes out as 64 KiB chunks
+  const std::string large_token(3 * 1024 * 1024 + 17, 'x');
+
+  { // Decoded while the chunks are received
+    sendToken(large_token);
+    ICommunicator::Response response =
+        server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    BOOST_REQUIRE(response.time_out == false);
+    BOOST_REQUIRE(response.error == false);
+
+    auto payload = dynamic_cast<Anon::AuthenticateByTokenRequest *>(
+        std::get<::google::protobuf::Message *>(
+            response.message->getPayload()));
+    BOOST_REQUIRE(payload != nullptr);
+    BOOST_CHECK(payload->token() == large_token);
+  }
+
+  { // Kept as raw chunks for forwarding
+    sendToken(large_token);
+    ICommunicator::Response response = server->pollPassThrough(
+        MessageType::GOOGLE_PROTOCOL_BUFFER);
+    for (int i = 0; i < 100 && response.time_out; ++i) {
+      response = server->pollPassThrough(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    }
+    BOOST_REQUIRE(response.time_out == false);
+    BOOST_REQUIRE(response.error == false);
+
+    IRawPayload *raw_payload = response.message->getRawPayload();
+    BOOST_REQUIRE(raw_payload != nullptr);
+    uint32_t frame_size = std::get<uint32_t>(
+        response.message->get(constants::message::google::FRAME_SIZE));
+    BOOST_CHECK(raw_payload->size() == frame_size);
+
+    Anon::AuthenticateByTokenRequest request;
+    BOOST_CHECK(request.ParseFromArray(raw_payload->data(),
+                                       raw_payload->size()));
+    BOOST_CHECK(request.token() == large_token);
+  }
+
+  { // Bodies above the ceiling are rejected without leaving parts behind
+    sendToken(std::string(max_message_size + 1, 'y'));
+    BOOST_CHECK_THROW(server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER),
+                      TraceException);
+
+    sendToken("small_token");
+    ICommunicator::Response response =
+        server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    BOOST_REQUIRE(response.time_out == false);
+    auto payload = dynamic_cast<Anon::AuthenticateByTokenRequest *>(
+        std::get<::google::protobuf::Message *>(
+            response.message->getPayload()));
+    BOOST_REQUIRE(payload != nullptr);
+    BOOST_CHECK(payload->token() == "small_token");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testing_CommunicatorFactoryCompact) {
+
+  LogContext log_context;
+  log_context.thread_name = "test_communicator_factory_compact";
+  CommunicatorFactory factory(log_context);
+
+  CredentialFactory cred_factory;
+  std::unordered_map<CredentialType, std::string> cred_options;
+  cred_options[CredentialType::PUBLIC_KEY] = public_key;
+  cred_options[CredentialType::PRIVATE_KEY] = secret_key;
+  cred_options[CredentialType::SERVER_KEY] = server_key;
+  auto credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
+
+  // The server keeps the default format and has to answer both clients
+  auto server = [&]() {
+    SocketOptions socket_options = generateCommonOptions("test_compact");
+    socket_options.port = 1344;
+    socket_options.local_id = "overlord";
+    return factory.create(socket_options, *credentials, 40, 10);
+  }();
+
+  auto createClient = [&](const std::string &client_id,
+                          WireFormat wire_format) {
+    SocketOptions socket_options = generateCommonOptions("test_compact");
+    socket_options.class_type = SocketClassType::CLIENT;
+    socket_options.connection_life = SocketConnectionLife::INTERMITTENT;
+    socket_options.port = 1344;
+    socket_options.local_id = client_id;
+    socket_options.wire_format = wire_format;
+    return factory.create(socket_options, *credentials, 40, 10);
+  };
+  auto compact_client = createClient("compact_minion", WireFormat::COMPACT);
+  auto legacy_client = createClient("legacy_minion", WireFormat::LEGACY);
+
+  MessageFactory msg_factory;
+  auto roundTrip = [&](ICommunicator &client, const std::string &client_id) {
+    const std::string token = "token_from_" + client_id;
+    auto msg_from_client =
+        msg_factory.create(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    msg_from_client->set(MessageAttribute::ID, "Bob");
+    msg_from_client->addRoute("relay");
+    auto auth_by_token_req =
+        std::make_unique<Anon::AuthenticateByTokenRequest>();
+    auth_by_token_req->set_token(token);
+    msg_from_client->setPayload(std::move(auth_by_token_req));
+    const std::string correlation_id = std::get<std::string>(
+        msg_from_client->get(MessageAttribute::CORRELATION_ID));
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    msg_from_client->setDeadline(deadline);
+    client.send(*msg_from_client);
+
+    ICommunicator::Response response =
+        server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    BOOST_REQUIRE(response.time_out == false);
+    BOOST_REQUIRE(response.error == false);
+
+    BOOST_CHECK(std::get<std::string>(response.message->get(
+                    MessageAttribute::CORRELATION_ID)) == correlation_id);
+    BOOST_CHECK(std::get<std::string>(
+                    response.message->get(MessageAttribute::ID)) == "Bob");
+    // Key was not set, both formats carry the same placeholder
+    BOOST_CHECK(std::get<std::string>(
+                    response.message->get(MessageAttribute::KEY)) == "no key");
+    const auto &routes = response.message->getRoutes();
+    BOOST_REQUIRE(routes.size() == 2);
+    BOOST_CHECK(routes.front() == client_id);
+    BOOST_CHECK(routes.back() == "relay");
+    // Sent as the time left, so it only comes back to the millisecond
+    BOOST_CHECK(response.message->getDeadline() <= deadline);
+    BOOST_CHECK(response.message->getDeadline() >
+                deadline - std::chrono::seconds(1));
+
+    auto payload = dynamic_cast<Anon::AuthenticateByTokenRequest *>(
+        std::get<::google::protobuf::Message *>(
+            response.message->getPayload()));
+    BOOST_REQUIRE(payload != nullptr);
+    BOOST_CHECK(payload->token() == token);
+
+    auto nack_msg = msg_factory.createResponseEnvelope(*response.message);
+    auto nack_reply = std::make_unique<Anon::NackReply>();
+    nack_reply->set_err_code(ErrorCode::ID_SERVICE_ERROR);
+    nack_reply->set_err_msg("reply_to_" + client_id);
+    nack_msg->setPayload(std::move(nack_reply));
+    server->send(*nack_msg);
+
+    ICommunicator::Response client_response =
+        client.receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    BOOST_REQUIRE(client_response.time_out == false);
+    BOOST_REQUIRE(client_response.error == false);
+    BOOST_CHECK(std::get<std::string>(client_response.message->get(
+                    MessageAttribute::CORRELATION_ID)) == correlation_id);
+    BOOST_CHECK(client_response.message->getRoutes().size() == 1);
+    BOOST_CHECK(client_response.message->getRoutes().front() == "relay");
+    BOOST_CHECK(client_response.message->getDeadline() ==
+                std::chrono::steady_clock::time_point::max());
+
+    auto reply = dynamic_cast<Anon::NackReply *>(
+        std::get<::google::protobuf::Message *>(
+            client_response.message->getPayload()));
+    BOOST_REQUIRE(reply != nullptr);
+    BOOST_CHECK(reply->err_msg() == "reply_to_" + client_id);
+  };
+
+  // Interleaved so the server has to track the format of each peer
+  roundTrip(*compact_client, "compact_minion");
+  roundTrip(*legacy_client, "legacy_minion");
+  roundTrip(*compact_client, "compact_minion");
+}
+
+BOOST_AUTO_TEST_CASE(testing_CommunicatorFactoryLegacyDeadline) {
+
+  LogContext log_context;
+  log_context.thread_name = "test_communicator_factory_legacy_deadline";
+  CommunicatorFactory factory(log_context);
+
+  CredentialFactory cred_factory;
+  std::unordered_map<CredentialType, std::string> cred_options;
+  auto credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
+
+  auto server = [&]() {
+    SocketOptions socket_options = generateCommonOptions("test_deadline");
+    socket_options.local_id = "overlord";
+    return factory.create(socket_options, *credentials, 40, 10);
+  }();
+
+  auto client = [&]() {
+    SocketOptions socket_options = generateCommonOptions("test_deadline");
+    socket_options.class_type = SocketClassType::CLIENT;
+    socket_options.connection_life = SocketConnectionLife::INTERMITTENT;
+    socket_options.local_id = "minion";
+    socket_options.wire_format = WireFormat::LEGACY;
+    return factory.create(socket_options, *credentials, 40, 10);
+  }();
+
+  MessageFactory msg_factory;
+  auto sendToken = [&](const std::string &token,
+                       std::chrono::steady_clock::time_point deadline) {
+    auto msg_from_client =
+        msg_factory.create(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    msg_from_client->set(MessageAttribute::ID, "Bob");
+    auto auth_by_token_req =
+        std::make_unique<Anon::AuthenticateByTokenRequest>();
+    auth_by_token_req->set_token(token);
+    msg_from_client->setPayload(std::move(auth_by_token_req));
+    msg_from_client->setDeadline(deadline);
+    client->send(*msg_from_client);
+  };
+
+  auto checkToken = [](IMessage &message, const std::string &token) {
+    auto payload = dynamic_cast<Anon::AuthenticateByTokenRequest *>(
+        std::get<::google::protobuf::Message *>(message.getPayload()));
+    BOOST_REQUIRE(payload != nullptr);
+    BOOST_CHECK(payload->token() == token);
+  };
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(30);
+
+  { // The deadline part is read ahead of the frame
+    sendToken("with_deadline", deadline);
+    ICommunicator::Response response =
+        server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    BOOST_REQUIRE(response.time_out == false);
+    BOOST_REQUIRE(response.error == false);
+    BOOST_CHECK(response.message->getDeadline() <= deadline);
+    BOOST_CHECK(response.message->getDeadline() >
+                deadline - std::chrono::seconds(1));
+    BOOST_CHECK(std::get<std::string>(
+                    response.message->get(MessageAttribute::ID)) == "Bob");
+    checkToken(*response.message, "with_deadline");
+
+    // Replies never carry the deadline back
+    auto nack_msg = msg_factory.createResponseEnvelope(*response.message);
+    auto nack_reply = std::make_unique<Anon::NackReply>();
+    nack_reply->set_err_code(ErrorCode::ID_SERVICE_ERROR);
+    nack_msg->setPayload(std::move(nack_reply));
+    server->send(*nack_msg);
+
+    ICommunicator::Response client_response =
+        client->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    BOOST_REQUIRE(client_response.time_out == false);
+    BOOST_REQUIRE(client_response.error == false);
+    BOOST_CHECK(client_response.message->getDeadline() ==
+                std::chrono::steady_clock::time_point::max());
+  }
+
+  { // Requests without one are sent without the part
+    sendToken("without_deadline",
+              std::chrono::steady_clock::time_point::max());
+    ICommunicator::Response response =
+        server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    BOOST_REQUIRE(response.time_out == false);
+    BOOST_REQUIRE(response.error == false);
+    BOOST_CHECK(response.message->getDeadline() ==
+                std::chrono::steady_clock::time_point::max());
+    checkToken(*response.message, "without_deadline");
+  }
+
+  { // Kept when the body is passed through undecoded
+    sendToken("pass_through", deadline);
+    ICommunicator::Response response =
+        server->pollPassThrough(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    for (int i = 0; i < 100 && response.time_out; ++i) {
+      response = server->pollPassThrough(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    }
+    BOOST_REQUIRE(response.time_out == false);
+    BOOST_REQUIRE(response.error == false);
+    BOOST_CHECK(response.message->getDeadline() <= deadline);
+    BOOST_CHECK(response.message->getDeadline() >
+                deadline - std::chrono::seconds(1));
+    BOOST_CHECK(response.message->getRawPayload() != nullptr);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testing_CommunicatorFactoryTcpContext) {
+
+  LogContext log_context;
+  log_context.thread_name = "test_communicator_factory_tcp_context";
+  CommunicatorFactory factory(log_context);
+
+  // Only takes effect before the first TCP communicator exists, which other
+  // test cases may already have created
+  const bool configured = CommunicatorFactory::configureTcpContext(2);
+
+  CredentialFactory cred_factory;
+  std::unordered_map<CredentialType, std::string> cred_options;
+  auto credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
+
+  auto server = [&]() {
+    SocketOptions socket_options = generateCommonOptions("127.0.0.1");
+    socket_options.scheme = URIScheme::TCP;
+    socket_options.port = 17345;
+    socket_options.local_id = "overlord";
+    return factory.create(socket_options, *credentials, 1000, 10);
+  }();
+
+  BOOST_CHECK(CommunicatorFactory::configureTcpContext(4) == false);
+
+  // The context runs the number of I/O threads it was configured with
+  const int io_threads =
+      zmq_ctx_get(TcpContext::getContext(), ZMQ_IO_THREADS);
+  BOOST_CHECK(io_threads == TcpContext::ioThreads());
+  if (configured) {
+    BOOST_CHECK(io_threads == 2);
+  }
+
+  // Several clients share the context, each one used to start its own
+  for (int client_i = 0; client_i < 3; ++client_i) {
+    SocketOptions socket_options = generateCommonOptions("127.0.0.1");
+    socket_options.scheme = URIScheme::TCP;
+    socket_options.class_type = SocketClassType::CLIENT;
+    socket_options.connection_life = SocketConnectionLife::INTERMITTENT;
+    socket_options.port = 17345;
+    socket_options.local_id = "minion_" + std::to_string(client_i);
+    auto client = factory.create(socket_options, *credentials, 1000, 10);
+
+    MessageFactory msg_factory;
+    auto msg_from_client =
+        msg_factory.create(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    auto auth_by_token_req =
+        std::make_unique<Anon::AuthenticateByTokenRequest>();
+    auth_by_token_req->set_token("token");
+    msg_from_client->setPayload(std::move(auth_by_token_req));
+    client->send(*msg_from_client);
+
+    ICommunicator::Response response =
+        server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    BOOST_REQUIRE(response.time_out == false);
+    BOOST_REQUIRE(response.error == false);
+    BOOST_CHECK(response.message->getRoutes().front() ==
+                "minion_" + std::to_string(client_i));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testing_CommunicatorFactoryReceiveLimit) {
+
+  LogContext log_context;
+  log_context.thread_name = "test_communicator_factory_receive_limit";
+  CommunicatorFactory factory(log_context);
+
+  CredentialFactory cred_factory;
+  std::unordered_map<CredentialType, std::string> cred_options;
+  auto credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
+
+  const uint32_t max_receive_size = 64 * 1024;
+  auto server = [&]() {
+    SocketOptions socket_options = generateCommonOptions("127.0.0.1");
+    socket_options.scheme = URIScheme::TCP;
+    socket_options.port = 17346;
+    socket_options.local_id = "overlord";
+    socket_options.max_receive_size = max_receive_size;
+    return factory.create(socket_options, *credentials, 1000, 10);
+  }();
+
+  auto createClient = [&](const std::string &local_id, uint32_t chunk_size) {
+    SocketOptions socket_options = generateCommonOptions("127.0.0.1");
+    socket_options.scheme = URIScheme::TCP;
+    socket_options.class_type = SocketClassType::CLIENT;
+    socket_options.connection_life = SocketConnectionLife::INTERMITTENT;
+    socket_options.port = 17346;
+    socket_options.local_id = local_id;
+    socket_options.chunk_size = chunk_size;
+    return factory.create(socket_options, *credentials, 1000, 10);
+  };
+
+  MessageFactory msg_factory;
+  auto sendToken = [&](ICommunicator &client, const std::string &token) {
+    auto msg_from_client =
+        msg_factory.create(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    auto auth_by_token_req =
+        std::make_unique<Anon::AuthenticateByTokenRequest>();
+    auth_by_token_req->set_token(token);
+    msg_from_client->setPayload(std::move(auth_by_token_req));
+    client.send(*msg_from_client);
+  };
+
+  const std::string large_token(2 * max_receive_size, 'x');
+
+  { // ZeroMQ drops the peer before the body is buffered, nothing arrives
+    auto client = createClient("greedy_minion", 0);
+    sendToken(*client, large_token);
+    ICommunicator::Response response =
+        server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    BOOST_CHECK(response.time_out == true);
+  }
+
+  { // Every chunk fits, the total is still checked
+    auto client = createClient("chunked_minion", 16 * 1024);
+    sendToken(*client, large_token);
+    BOOST_CHECK_THROW(server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER),
+                      TraceException);
+  }
+
+  { // The limit only applies to what is received
+    auto client = createClient("minion", 0);
+    sendToken(*client, "small_token");
+    ICommunicator::Response response =
+        server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+    BOOST_REQUIRE(response.time_out == false);
+    BOOST_REQUIRE(response.error == false);
+    BOOST_CHECK(response.message->getRoutes().front() == "minion");
+  }
+}
+
 BOOST_AUTO_TEST_CASE(testing_CommunicatorFactorySecure) {
 
   std::cout << "\n*****************************" << std::endl;
@@ -7,10 +7,15 @@
 #include "common/DynaLog.hpp"
 
 // Standard includes
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <regex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace SDMS;
 
@@ -25,6 +30,151 @@ BOOST_AUTO_TEST_CASE(testing_Enum) {
   BOOST_CHECK(static_cast<unsigned int>(SDMS::LogLevel::CRITICAL) == 0);
 }
 
+BOOST_AUTO_TEST_CASE(testing_LazyEvaluation) {
+  LogContext log_context;
+  int evaluated = 0;
+  auto expensive = [&evaluated]() {
+    evaluated++;
+    return std::string("expensive");
+  };
+
+  global_logger.setLevel(SDMS::LogLevel::INFO);
+
+  BOOST_CHECK(global_logger.isEnabled(SDMS::LogLevel::INFO));
+  BOOST_CHECK(!global_logger.isEnabled(SDMS::LogLevel::DEBUG));
+
+  // Message arguments of disabled levels must not be evaluated
+  DL_DEBUG(log_context, expensive());
+  DL_TRACE(log_context, expensive());
+  DL_LOG(SDMS::LogLevel::TRACE, log_context, expensive());
+  BOOST_CHECK(evaluated == 0);
+
+  DL_INFO(log_context, expensive());
+  DL_LOG(SDMS::LogLevel::ERROR, log_context, expensive());
+  BOOST_CHECK(evaluated == 2);
+
+  global_logger.setLevel(SDMS::LogLevel::TRACE);
+  DL_TRACE(log_context, expensive());
+  if (DATAFED_COMPILE_LOG_LEVEL >=
+      static_cast<unsigned int>(SDMS::LogLevel::TRACE)) {
+    BOOST_CHECK(evaluated == 3);
+  } else {
+    BOOST_CHECK(evaluated == 2);
+  }
+}
+
+/// Stream buffer that holds up writers while it is closed
+class GateBuffer : public std::streambuf {
+public:
+  void close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_open = false;
+  }
+
+  void open() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_open = true;
+    }
+    m_cvar.notify_all();
+  }
+
+protected:
+  int overflow(int c) override {
+    wait();
+    return c == EOF ? 0 : c;
+  }
+
+  std::streamsize xsputn(const char *, std::streamsize n) override {
+    wait();
+    return n;
+  }
+
+private:
+  void wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cvar.wait(lock, [this] { return m_open; });
+  }
+
+  std::mutex m_mutex;
+  std::condition_variable m_cvar;
+  bool m_open = true;
+};
+
+BOOST_AUTO_TEST_CASE(testing_AsyncOutput) {
+  std::stringstream stream;
+  LogContext log_context;
+  log_context.thread_name = "async_thread";
+
+  global_logger.setLevel(SDMS::LogLevel::INFO);
+  global_logger.addStream(stream);
+  global_logger.setAsync(64, LogOverflow::BLOCK);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&log_context, t]() {
+      for (int i = 0; i < 250; i++) {
+        DL_INFO(log_context, "async " << t << " " << i);
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+
+  global_logger.flush();
+
+  // Blocking mode never drops, and each thread's lines stay in order
+  BOOST_CHECK(global_logger.droppedCount() == 0);
+
+  std::vector<int> next(4, 0);
+  std::string line;
+  int count = 0;
+  std::regex pattern("async ([0-9]) ([0-9]+)");
+  std::smatch match;
+  while (std::getline(stream, line)) {
+    if (std::regex_search(line, match, pattern)) {
+      int t = std::stoi(match[1]);
+      BOOST_CHECK(std::stoi(match[2]) == next[t]);
+      next[t]++;
+      count++;
+    }
+  }
+  BOOST_CHECK(count == 1000);
+
+  // Drop mode never blocks the caller, overflow is counted. The writer is
+  // held up by the gate so the queue is bound to overflow.
+  GateBuffer gate_buffer;
+  std::ostream gate(&gate_buffer);
+  global_logger.addStream(gate);
+  stream.clear();
+  global_logger.setAsync(2, LogOverflow::DROP);
+
+  gate_buffer.close();
+  for (int i = 0; i < 1000; i++) {
+    DL_INFO(log_context, "drop " << i);
+  }
+  gate_buffer.open();
+  global_logger.flush();
+
+  uint64_t dropped = global_logger.droppedCount();
+  BOOST_CHECK(dropped > 0);
+
+  int written = 0;
+  std::regex drop_pattern("drop [0-9]+");
+  while (std::getline(stream, line)) {
+    if (std::regex_search(line, drop_pattern))
+      written++;
+  }
+  BOOST_CHECK(written + dropped == 1000);
+
+  global_logger.setAsync(0);
+  BOOST_CHECK(global_logger.droppedCount() == 0);
+
+  // Later test cases must not write to the streams of this one
+  global_logger.removeStream(gate);
+  global_logger.removeStream(stream);
+}
+
 BOOST_AUTO_TEST_CASE(testing_LogOutput) {
 
   std::string file_name = "./log_output_test1.txt";
@@ -60,6 +210,7 @@ BOOST_AUTO_TEST_CASE(testing_LogOutput) {
   DL_DEBUG(log_context, message);
   DL_TRACE(log_context, message);
 
+  global_logger.removeStream(file);
   file.close();
 
   std::ifstream file2(file_name);
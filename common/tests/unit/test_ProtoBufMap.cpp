@@ -56,4 +56,23 @@ BOOST_AUTO_TEST_CASE(testing_ProtoBufMap_toString) {
   BOOST_CHECK(name.compare("VersionRequest") == 0);
 }
 
+BOOST_AUTO_TEST_CASE(testing_ProtoBufMap_prototype) {
+  const ProtoBufMap &proto_map = ProtoBufMap::getInstance();
+  SDMS::Auth::RepoDataDeleteRequest delete_request;
+  uint16_t msg_type = proto_map.getMessageType(delete_request);
+
+  BOOST_CHECK(proto_map.exists(msg_type));
+  BOOST_CHECK(msg_type <= proto_map.maxMessageType());
+  BOOST_CHECK(proto_map.getPrototype(msg_type)->GetDescriptor() ==
+              delete_request.GetDescriptor());
+  BOOST_CHECK(proto_map.getDescriptorType(msg_type) ==
+              delete_request.GetDescriptor());
+
+  // Gap between the anonymous and authorized protocol types
+  uint16_t unused_type = (1 << 8) + 255;
+  BOOST_CHECK(proto_map.exists(unused_type) == false);
+  BOOST_CHECK_THROW(proto_map.getPrototype(unused_type), TraceException);
+  BOOST_CHECK(proto_map.exists(proto_map.maxMessageType() + 1) == false);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
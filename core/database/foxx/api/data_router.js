@@ -1006,6 +1006,66 @@ router
     .summary("Update data record schema validation error message")
     .description("Update data record schema validation error message");
 
+router
+    .post("/update/md_err_msg/batch", function (req, res) {
+        try {
+            g_db._executeTransaction({
+                collections: {
+                    write: ["d"],
+                },
+                action: function () {
+                    const client = g_lib.getUserFromClientID(req.queryParams.client);
+                    var i, data_id;
+
+                    // Records that no longer exist are skipped, the batch they
+                    // came from has already been written
+                    for (i in req.body.records) {
+                        data_id = g_lib.resolveDataID(req.body.records[i].id, client);
+
+                        if (
+                            !g_db.d.exists({
+                                _id: data_id,
+                            })
+                        )
+                            continue;
+
+                        g_db._update(
+                            data_id,
+                            {
+                                md_err_msg: req.body.records[i].msg,
+                                md_err: true,
+                            },
+                            {
+                                keepNull: false,
+                            },
+                        );
+                    }
+                },
+            });
+        } catch (e) {
+            g_lib.handleException(e, res);
+        }
+    })
+    .queryParam("client", joi.string().optional(), "Client ID")
+    .body(
+        joi
+            .object({
+                records: joi
+                    .array()
+                    .items(
+                        joi.object({
+                            id: joi.string().required(),
+                            msg: joi.string().required(),
+                        }),
+                    )
+                    .required(),
+            })
+            .required(),
+        "Records and their error messages",
+    )
+    .summary("Update schema validation error messages of data records")
+    .description("Update schema validation error messages of a batch of data records");
+
 // Only called after upload of raw data for managed records
 router
     .post("/update/size", function (req, res) {
@@ -1169,6 +1229,84 @@ router
     .summary("Get data by ID or alias")
     .description("Get data by ID or alias");
 
+router
+    .post("/view/metadata/batch", function (req, res) {
+        try {
+            const client = g_lib.getUserFromClientID(req.queryParams.client);
+            var i,
+                data_id,
+                data,
+                sch,
+                results = [];
+
+            // Each record succeeds or fails on its own, a missing or
+            // forbidden record must not fail the others
+            for (i in req.body.ids) {
+                try {
+                    data_id = g_lib.resolveDataID(req.body.ids[i], client);
+                    data = g_db.d.document(data_id);
+
+                    // Same access rules as /view
+                    var rem_md = false;
+                    if (!g_lib.hasAdminPermObject(client, data_id)) {
+                        var perms = g_lib.getPermissions(
+                            client,
+                            data,
+                            g_lib.PERM_RD_REC | g_lib.PERM_RD_META,
+                        );
+                        if (data.locked || (perms & (g_lib.PERM_RD_REC | g_lib.PERM_RD_META)) == 0)
+                            throw g_lib.ERR_PERM_DENIED;
+                        if ((perms & g_lib.PERM_RD_META) == 0) rem_md = true;
+                    }
+
+                    var result = {
+                        id: req.body.ids[i],
+                    };
+
+                    if (data.md && !rem_md) result.md = JSON.stringify(data.md);
+
+                    if (data.sch_id) {
+                        sch = g_db.sch.document(data.sch_id);
+                        result.sch_id = sch.id + ":" + sch.ver;
+                    }
+
+                    results.push(result);
+                } catch (e) {
+                    var msg;
+                    if (g_lib.isInteger(e) && e >= 0 && e < g_lib.ERR_COUNT)
+                        msg = g_lib.ERR_INFO[e][1];
+                    else if (Array.isArray(e)) msg = e[1];
+                    else if (e.errorNum == 1202) msg = "Record does not exist";
+                    else msg = "Unexpected exception: " + e;
+
+                    results.push({
+                        id: req.body.ids[i],
+                        error: msg,
+                    });
+                }
+            }
+
+            res.send({
+                results: results,
+            });
+        } catch (e) {
+            g_lib.handleException(e, res);
+        }
+    })
+    .queryParam("client", joi.string().required(), "Client ID")
+    .body(
+        joi
+            .object({
+                ids: joi.array().items(joi.string()).required(),
+            })
+            .required(),
+        "Data IDs or aliases",
+    )
+    .summary("Get metadata and schema of data records")
+    .description(
+        "Get metadata and schema ID of a batch of data records by ID or alias, in request order",
+    );
+
 router
     .post("/export", function (req, res) {
         try {
@@ -345,9 +345,10 @@ router
                 action: function () {
                     result = g_db
                         ._query(
-                            "for i in task filter i.status > 0 and i.status < 3 sort i.status desc return i._id",
+                            "for i in task filter i.status > 0 and i.status < 3 sort i.status desc return i",
                         )
-                        .toArray();
+                        .toArray()
+                        .map(g_tasks.taskSchedInfo);
                 },
             });
 
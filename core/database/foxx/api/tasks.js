@@ -1767,19 +1767,22 @@ var tasks_func = (function () {
                 .toArray();
             // If blocked task has only one block, then it's this task being finalized and will be able to run now
             if (dep_blocks.length === 1) {
-                ready_tasks.push(dep);
                 //console.log("taskComplete - task", dep, "ready");
-                g_db.task.update(
-                    dep,
-                    {
-                        status: g_lib.TS_READY,
-                        msg: "Pending",
-                        ut: time,
-                    },
-                    {
-                        returnNew: true,
-                        waitForSync: true,
-                    },
+                ready_tasks.push(
+                    obj.taskSchedInfo(
+                        g_db.task.update(
+                            dep,
+                            {
+                                status: g_lib.TS_READY,
+                                msg: "Pending",
+                                ut: time,
+                            },
+                            {
+                                returnNew: true,
+                                waitForSync: true,
+                            },
+                        ).new,
+                    ),
                 );
             }
         }
@@ -1841,6 +1844,18 @@ var tasks_func = (function () {
         });
     };
 
+    /**
+     * Returns what the core task scheduler needs to know about a ready task.
+     * Tasks created before the owner field existed are charged to the client.
+     */
+    obj.taskSchedInfo = function (a_task) {
+        return {
+            _id: a_task._id,
+            type: a_task.type,
+            owner: a_task.owner ? a_task.owner : a_task.client,
+        };
+    };
+
     obj._createTask = function (a_client_id, a_type, a_steps, a_state) {
         var time = Math.floor(Date.now() / 1000);
         var obj = {
@@ -1850,6 +1865,10 @@ var tasks_func = (function () {
             ct: time,
             ut: time,
             client: a_client_id,
+            // Fair-share scheduling key. Owner and allocation changes are
+            // charged to the destination owner or allocation subject, every
+            // other task (data get/put, deletes) to the requesting client
+            owner: a_state.owner_id || a_state.subject || a_client_id,
             step: 0,
             steps: a_steps,
             state: a_state,
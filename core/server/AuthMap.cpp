@@ -1,8 +1,10 @@
-
 // Local private includes
 #include "AuthMap.hpp"
 #include "DatabaseAPI.hpp"
 
+// Standard includes
+#include <unordered_set>
+
 using namespace std;
 
 namespace SDMS {
@@ -12,17 +14,9 @@ AuthMap::AuthMap(const AuthMap &auth_map) {
   m_trans_active_increment = auth_map.m_trans_active_increment;
   m_session_active_increment = auth_map.m_session_active_increment;
 
-  auth_map.m_trans_clients_mtx.lock();
-  m_trans_auth_clients = auth_map.m_trans_auth_clients;
-  auth_map.m_trans_clients_mtx.unlock();
-
-  auth_map.m_session_clients_mtx.lock();
-  m_session_auth_clients = auth_map.m_session_auth_clients;
-  auth_map.m_session_clients_mtx.unlock();
+  copyKeys(auth_map);
 
-  auth_map.m_persistent_clients_mtx.lock();
-  m_persistent_auth_clients = auth_map.m_persistent_auth_clients;
-  auth_map.m_persistent_clients_mtx.unlock();
+  m_persistent_key_cache = auth_map.m_persistent_key_cache;
 
   m_db_url = auth_map.m_db_url;
   m_db_user = auth_map.m_db_user;
@@ -33,29 +27,14 @@ AuthMap &AuthMap::operator=(const AuthMap &&auth_map) {
   m_trans_active_increment = auth_map.m_trans_active_increment;
   m_session_active_increment = auth_map.m_session_active_increment;
 
-  auth_map.m_trans_clients_mtx.lock();
-  const auto trans = auth_map.m_trans_auth_clients;
-  auth_map.m_trans_clients_mtx.unlock();
-
-  m_trans_clients_mtx.lock();
-  m_trans_auth_clients = trans;
-  m_trans_clients_mtx.unlock();
-
-  auth_map.m_session_clients_mtx.lock();
-  const auto session = auth_map.m_session_auth_clients;
-  auth_map.m_session_clients_mtx.unlock();
-
-  m_session_clients_mtx.lock();
-  m_session_auth_clients = session;
-  m_session_clients_mtx.unlock();
-
-  auth_map.m_persistent_clients_mtx.lock();
-  const auto persistent = auth_map.m_persistent_auth_clients;
-  auth_map.m_persistent_clients_mtx.unlock();
+  clearAllNonPersistentKeys();
+  for (Shard &shard : m_shards) {
+    lock_guard<mutex> lock(shard.mutex);
+    shard.keys.clear();
+  }
+  copyKeys(auth_map);
 
-  m_persistent_clients_mtx.lock();
-  m_persistent_auth_clients = persistent;
-  m_persistent_clients_mtx.unlock();
+  m_persistent_key_cache = auth_map.m_persistent_key_cache;
 
   m_db_url = auth_map.m_db_url;
   m_db_user = auth_map.m_db_user;
@@ -63,104 +42,206 @@ AuthMap &AuthMap::operator=(const AuthMap &&auth_map) {
   return *this;
 }
 
-std::vector<std::string>
-AuthMap::getExpiredKeys(const PublicKeyType pub_key_type,
-                        const time_t threshold) const noexcept {
-
-  auto expiredKeys = [=](const AuthMap::client_map_t &client_map,
-                         const time_t expire_time) -> std::vector<std::string> {
-    std::vector<std::string> expired_keys;
-    for (const auto &element : client_map) {
-      if (element.second.expiration_time >= expire_time) {
-        expired_keys.push_back(element.first);
+/**
+ * Copies the keys of auth_map into the (empty) shards of this map and
+ * schedules their expiry.
+ */
+void AuthMap::copyKeys(const AuthMap &auth_map) {
+  for (size_t i = 0; i < SHARD_COUNT; i++) {
+    unordered_map<string, KeyEntry> keys;
+    {
+      lock_guard<mutex> lock(auth_map.m_shards[i].mutex);
+      keys = auth_map.m_shards[i].keys;
+    }
+
+    for (auto &key : keys) {
+      if (key.second.has_transient) {
+        m_trans_count++;
+        scheduleExpiry(PublicKeyType::TRANSIENT, key.first,
+                       key.second.transient.expiration_time);
+      }
+      if (key.second.has_session) {
+        m_session_count++;
+        scheduleExpiry(PublicKeyType::SESSION, key.first,
+                       key.second.session.expiration_time);
       }
     }
-    return expired_keys;
-  };
+
+    lock_guard<mutex> lock(m_shards[i].mutex);
+    m_shards[i].keys = std::move(keys);
+  }
+}
+
+AuthMap::Shard &AuthMap::shard(const std::string &public_key) {
+  return m_shards[hash<string>()(public_key) % SHARD_COUNT];
+}
+
+const AuthMap::Shard &AuthMap::shard(const std::string &public_key) const {
+  return m_shards[hash<string>()(public_key) % SHARD_COUNT];
+}
+
+AuthMap::AuthElement *AuthMap::element(KeyEntry &entry,
+                                       const PublicKeyType type) {
+  if (type == PublicKeyType::TRANSIENT) {
+    return entry.has_transient ? &entry.transient : nullptr;
+  } else if (type == PublicKeyType::SESSION) {
+    return entry.has_session ? &entry.session : nullptr;
+  }
+  return nullptr;
+}
+
+void AuthMap::scheduleExpiry(const PublicKeyType pub_key_type,
+                             const std::string &public_key,
+                             time_t expiration_time) {
+  if (pub_key_type == PublicKeyType::TRANSIENT) {
+    lock_guard<mutex> lock(m_trans_expiry_mtx);
+    m_trans_expiry.schedule(public_key, expiration_time);
+  } else if (pub_key_type == PublicKeyType::SESSION) {
+    lock_guard<mutex> lock(m_session_expiry_mtx);
+    m_session_expiry.schedule(public_key, expiration_time);
+  }
+}
+
+std::vector<std::string>
+AuthMap::getExpiredKeys(const PublicKeyType pub_key_type,
+                        const time_t threshold) noexcept {
+  std::vector<std::string> expired_keys;
+  std::vector<std::string> due;
 
   if (PublicKeyType::TRANSIENT == pub_key_type) {
-    lock_guard<mutex> lock(m_trans_clients_mtx);
-    return expiredKeys(m_trans_auth_clients, threshold);
+    lock_guard<mutex> lock(m_trans_expiry_mtx);
+    m_trans_expiry.advance(threshold, due);
   } else if (PublicKeyType::SESSION == pub_key_type) {
-    lock_guard<mutex> lock(m_session_clients_mtx);
-    return expiredKeys(m_session_auth_clients, threshold);
+    lock_guard<mutex> lock(m_session_expiry_mtx);
+    m_session_expiry.advance(threshold, due);
+  } else {
+    return expired_keys;
+  }
+
+  // Timers of removed or reset keys are skipped, a key reset twice in the
+  // same second has two timers
+  unordered_set<string> seen;
+  for (string &public_key : due) {
+    Shard &s = shard(public_key);
+    lock_guard<mutex> lock(s.mutex);
+    auto entry = s.keys.find(public_key);
+    if (entry == s.keys.end())
+      continue;
+    AuthElement *elem = element(entry->second, pub_key_type);
+    if (elem && elem->expiration_time <= threshold &&
+        seen.insert(public_key).second) {
+      expired_keys.push_back(std::move(public_key));
+    }
   }
-  return std::vector<std::string>();
+  return expired_keys;
 }
 
 void AuthMap::removeKey(const PublicKeyType pub_key_type,
                         const std::string &pub_key) {
+  if (pub_key_type != PublicKeyType::TRANSIENT &&
+      pub_key_type != PublicKeyType::SESSION &&
+      pub_key_type != PublicKeyType::PERSISTENT) {
+    EXCEPT(1, "Unsupported PublicKey Type during execution of removeKey.");
+  }
 
-  if (PublicKeyType::TRANSIENT == pub_key_type) {
-    lock_guard<mutex> lock(m_trans_clients_mtx);
-    if (m_trans_auth_clients.count(pub_key)) {
-      m_trans_auth_clients.erase(pub_key);
-    }
-  } else if (PublicKeyType::SESSION == pub_key_type) {
-    lock_guard<mutex> lock(m_session_clients_mtx);
-    if (m_session_auth_clients.count(pub_key)) {
-      m_session_auth_clients.erase(pub_key);
-    }
-  } else if (PublicKeyType::PERSISTENT == pub_key_type) {
-    lock_guard<mutex> lock(m_persistent_clients_mtx);
-    if (m_persistent_auth_clients.count(pub_key)) {
-      m_persistent_auth_clients.erase(pub_key);
+  {
+    Shard &s = shard(pub_key);
+    lock_guard<mutex> lock(s.mutex);
+    auto entry = s.keys.find(pub_key);
+    if (entry != s.keys.end()) {
+      KeyEntry &key = entry->second;
+      if (PublicKeyType::TRANSIENT == pub_key_type && key.has_transient) {
+        key.has_transient = false;
+        key.transient = AuthElement();
+        m_trans_count--;
+      } else if (PublicKeyType::SESSION == pub_key_type && key.has_session) {
+        key.has_session = false;
+        key.session = AuthElement();
+        m_session_count--;
+      } else if (PublicKeyType::PERSISTENT == pub_key_type) {
+        key.has_repo = false;
+        key.repo_uid.clear();
+      }
+      if (key.empty()) {
+        s.keys.erase(entry);
+      }
     }
-  } else {
-    EXCEPT(1, "Unsupported PublicKey Type during execution of removeKey.");
+  }
+
+  if (PublicKeyType::PERSISTENT == pub_key_type) {
+    m_persistent_key_cache->invalidate(pub_key);
   }
 }
 
 void AuthMap::resetKey(const PublicKeyType pub_key_type,
                        const std::string &public_key) {
-  if (pub_key_type == PublicKeyType::TRANSIENT) {
-    lock_guard<mutex> lock(m_trans_clients_mtx);
-    if (m_trans_auth_clients.count(public_key)) {
-      m_trans_auth_clients[public_key].expiration_time =
-          time(0) + m_trans_active_increment;
-      m_trans_auth_clients[public_key].access_count = 0;
-    } else {
-      EXCEPT(1, "Missing public key cannot reset transient expiration.");
-    }
-  } else if (pub_key_type == PublicKeyType::SESSION) {
-    lock_guard<mutex> lock(m_session_clients_mtx);
-    if (m_session_auth_clients.count(public_key)) {
-      m_session_auth_clients[public_key].expiration_time =
-          time(0) + m_session_active_increment;
-      m_session_auth_clients[public_key].access_count = 0;
-    } else {
-      EXCEPT(1, "Missing public key cannot reset session expiration.");
-    }
-  } else {
+  if (pub_key_type != PublicKeyType::TRANSIENT &&
+      pub_key_type != PublicKeyType::SESSION) {
     EXCEPT(1, "Unsupported PublicKey Type during execution of resetKey.");
   }
+
+  time_t expiration_time = time(0) + (pub_key_type == PublicKeyType::TRANSIENT
+                                          ? m_trans_active_increment
+                                          : m_session_active_increment);
+  {
+    Shard &s = shard(public_key);
+    lock_guard<mutex> lock(s.mutex);
+    auto entry = s.keys.find(public_key);
+    AuthElement *elem =
+        entry == s.keys.end() ? nullptr : element(entry->second, pub_key_type);
+    if (!elem) {
+      if (pub_key_type == PublicKeyType::TRANSIENT) {
+        EXCEPT(1, "Missing public key cannot reset transient expiration.");
+      } else {
+        EXCEPT(1, "Missing public key cannot reset session expiration.");
+      }
+    }
+    elem->expiration_time = expiration_time;
+    elem->access_count = 0;
+  }
+
+  scheduleExpiry(pub_key_type, public_key, expiration_time);
 }
 
 void AuthMap::addKey(const PublicKeyType pub_key_type,
                      const std::string &public_key, const std::string &id) {
-  if (pub_key_type == PublicKeyType::TRANSIENT) {
-    lock_guard<mutex> lock(m_trans_clients_mtx);
-    AuthElement element = {id, time(0) + m_trans_active_increment, 0};
-    m_trans_auth_clients[public_key] = element;
-  } else if (pub_key_type == PublicKeyType::SESSION) {
-    lock_guard<mutex> lock(m_session_clients_mtx);
-    AuthElement element = {id, time(0) + m_session_active_increment, 0};
-    m_session_auth_clients[public_key] = element;
-  } else if (pub_key_type == PublicKeyType::PERSISTENT) {
-    lock_guard<mutex> lock(m_persistent_clients_mtx);
-    m_persistent_auth_clients[public_key] = id;
-  } else {
-    EXCEPT(1, "Unsupported PublicKey Type during execution of addKey.");
+  time_t expiration_time = 0;
+  {
+    Shard &s = shard(public_key);
+    lock_guard<mutex> lock(s.mutex);
+    if (pub_key_type == PublicKeyType::TRANSIENT) {
+      KeyEntry &key = s.keys[public_key];
+      expiration_time = time(0) + m_trans_active_increment;
+      if (!key.has_transient) {
+        key.has_transient = true;
+        m_trans_count++;
+      }
+      key.transient = {id, expiration_time, 0};
+    } else if (pub_key_type == PublicKeyType::SESSION) {
+      KeyEntry &key = s.keys[public_key];
+      expiration_time = time(0) + m_session_active_increment;
+      if (!key.has_session) {
+        key.has_session = true;
+        m_session_count++;
+      }
+      key.session = {id, expiration_time, 0};
+    } else if (pub_key_type == PublicKeyType::PERSISTENT) {
+      KeyEntry &key = s.keys[public_key];
+      key.has_repo = true;
+      key.repo_uid = id;
+    } else {
+      EXCEPT(1, "Unsupported PublicKey Type during execution of addKey.");
+    }
   }
+
+  scheduleExpiry(pub_key_type, public_key, expiration_time);
 }
 
 size_t AuthMap::size(const PublicKeyType pub_key_type) const {
   if (pub_key_type == PublicKeyType::TRANSIENT) {
-    lock_guard<mutex> lock(m_trans_clients_mtx);
-    return m_trans_auth_clients.size();
+    return m_trans_count;
   } else if (pub_key_type == PublicKeyType::SESSION) {
-    lock_guard<mutex> lock(m_session_clients_mtx);
-    return m_session_auth_clients.size();
+    return m_session_count;
   } else {
     // Don't support size of persistent keys
     EXCEPT(1, "Unsupported PublicKey Type during execution of size.");
@@ -169,49 +250,95 @@ size_t AuthMap::size(const PublicKeyType pub_key_type) const {
 
 void AuthMap::incrementKeyAccessCounter(const PublicKeyType pub_key_type,
                                         const std::string &public_key) {
-  if (pub_key_type == PublicKeyType::TRANSIENT) {
-    lock_guard<mutex> lock(m_trans_clients_mtx);
-    if (m_trans_auth_clients.count(public_key)) {
-      m_trans_auth_clients.at(public_key).access_count++;
-    }
-  } else if (pub_key_type == PublicKeyType::SESSION) {
-    lock_guard<mutex> lock(m_session_clients_mtx);
-    if (m_session_auth_clients.count(public_key)) {
-      m_session_auth_clients.at(public_key).access_count++;
+  Shard &s = shard(public_key);
+  lock_guard<mutex> lock(s.mutex);
+  auto entry = s.keys.find(public_key);
+  if (entry != s.keys.end()) {
+    AuthElement *elem = element(entry->second, pub_key_type);
+    if (elem) {
+      elem->access_count++;
     }
   }
 }
 
 bool AuthMap::hasKey(const PublicKeyType pub_key_type,
                      const std::string &public_key) const {
-  if (pub_key_type == PublicKeyType::TRANSIENT) {
-    lock_guard<mutex> lock(m_trans_clients_mtx);
-    return m_trans_auth_clients.count(public_key) > 0;
-  } else if (pub_key_type == PublicKeyType::SESSION) {
-    lock_guard<mutex> lock(m_session_clients_mtx);
-    return m_session_auth_clients.count(public_key) > 0;
+  if (pub_key_type == PublicKeyType::TRANSIENT ||
+      pub_key_type == PublicKeyType::SESSION) {
+    return hasKeyType(pub_key_type, public_key);
   } else if (pub_key_type == PublicKeyType::PERSISTENT) {
-    // Check to see if it is a repository key FIRST
-    {
-      lock_guard<mutex> lock(m_persistent_clients_mtx);
-      if (m_persistent_auth_clients.count(public_key) > 0) {
+    std::string uid;
+    return lookupPersistentKey(public_key, uid) ==
+           PersistentKeyCache::Lookup::FOUND;
+  } else {
+    EXCEPT(1, "Unrecognized PublicKey Type during execution of hasKey.");
+  }
+  return false;
+}
+
+bool AuthMap::lookup(const std::string &public_key, std::string &uid,
+                     PublicKeyType &type) const {
+  {
+    const Shard &s = shard(public_key);
+    lock_guard<mutex> lock(s.mutex);
+    auto entry = s.keys.find(public_key);
+    if (entry != s.keys.end()) {
+      const KeyEntry &key = entry->second;
+      if (key.has_transient) {
+        uid = key.transient.uid;
+        type = PublicKeyType::TRANSIENT;
+        return true;
+      } else if (key.has_session) {
+        uid = key.session.uid;
+        type = PublicKeyType::SESSION;
+        return true;
+      } else if (key.has_repo) {
+        uid = key.repo_uid;
+        type = PublicKeyType::PERSISTENT;
         return true;
       }
     }
-    
-    // Only check database for user keys if not found in memory
-    try {
-      DatabaseAPI db(m_db_url, m_db_user, m_db_pass);
-      std::string uid;
-      if (db.uidByPubKey(public_key, uid)) {
+  }
+
+  if (lookupPersistentKey(public_key, uid) ==
+      PersistentKeyCache::Lookup::FOUND) {
+    type = PublicKeyType::PERSISTENT;
+    return true;
+  }
+  return false;
+}
+
+bool AuthMap::lookupAndCount(const std::string &public_key, std::string &uid,
+                             PublicKeyType &type) {
+  {
+    Shard &s = shard(public_key);
+    lock_guard<mutex> lock(s.mutex);
+    auto entry = s.keys.find(public_key);
+    if (entry != s.keys.end()) {
+      KeyEntry &key = entry->second;
+      if (key.has_transient) {
+        key.transient.access_count++;
+        uid = key.transient.uid;
+        type = PublicKeyType::TRANSIENT;
+        return true;
+      } else if (key.has_session) {
+        key.session.access_count++;
+        uid = key.session.uid;
+        type = PublicKeyType::SESSION;
+        return true;
+      } else if (key.has_repo) {
+        uid = key.repo_uid;
+        type = PublicKeyType::PERSISTENT;
         return true;
       }
-    } catch (const std::exception& e) {
-      // Database is down, but we already checked memory map
-      // TODO: Caller should log this failure for monitoring/alerting
     }
-  } else {
-    EXCEPT(1, "Unrecognized PublicKey Type during execution of hasKey.");
+  }
+
+  // Access counts are not kept for persistent keys
+  if (lookupPersistentKey(public_key, uid) ==
+      PersistentKeyCache::Lookup::FOUND) {
+    type = PublicKeyType::PERSISTENT;
+    return true;
   }
   return false;
 }
@@ -220,7 +347,7 @@ std::string AuthMap::getUID(const PublicKeyType pub_key_type,
                             const std::string &public_key) const {
 
   std::string uid = getUIDSafe(pub_key_type, public_key);
-  
+
   if (uid.empty()) {
     if (pub_key_type == PublicKeyType::TRANSIENT) {
       EXCEPT(1, "Missing transient public key unable to map to uid.");
@@ -233,88 +360,181 @@ std::string AuthMap::getUID(const PublicKeyType pub_key_type,
       EXCEPT(1, "Unrecognized PublicKey Type during execution of getId.");
     }
   }
-  
+
   return uid;
 }
 
 std::string AuthMap::getUIDSafe(const PublicKeyType pub_key_type,
                                 const std::string &public_key) const {
-  if (pub_key_type == PublicKeyType::TRANSIENT) {
-    lock_guard<mutex> lock(m_trans_clients_mtx);
-    if (m_trans_auth_clients.count(public_key)) {
-      return m_trans_auth_clients.at(public_key).uid;
-    }
-  } else if (pub_key_type == PublicKeyType::SESSION) {
-    lock_guard<mutex> lock(m_session_clients_mtx);
-    if (m_session_auth_clients.count(public_key)) {
-      return m_session_auth_clients.at(public_key).uid;
-    }
-  } else if (pub_key_type == PublicKeyType::PERSISTENT) {
-    // Check repository keys first (with proper locking)
-    {
-      lock_guard<mutex> lock(m_persistent_clients_mtx);
-      if (m_persistent_auth_clients.count(public_key)) {
-        return m_persistent_auth_clients.at(public_key);
+  if (pub_key_type == PublicKeyType::TRANSIENT ||
+      pub_key_type == PublicKeyType::SESSION) {
+    const Shard &s = shard(public_key);
+    lock_guard<mutex> lock(s.mutex);
+    auto entry = s.keys.find(public_key);
+    if (entry != s.keys.end()) {
+      const KeyEntry &key = entry->second;
+      if (pub_key_type == PublicKeyType::TRANSIENT && key.has_transient) {
+        return key.transient.uid;
+      } else if (pub_key_type == PublicKeyType::SESSION && key.has_session) {
+        return key.session.uid;
       }
     }
-    
-    // Check database for user keys
-    DatabaseAPI db(m_db_url, m_db_user, m_db_pass);
+  } else if (pub_key_type == PublicKeyType::PERSISTENT) {
     std::string uid;
-    if (db.uidByPubKey(public_key, uid)) {
+    if (lookupPersistentKey(public_key, uid) ==
+        PersistentKeyCache::Lookup::FOUND) {
       return uid;
     }
   }
-  
-  return "";  // Return empty string instead of throwing
+
+  return ""; // Return empty string instead of throwing
+}
+
+PersistentKeyCache::Lookup
+AuthMap::lookupPersistentKey(const std::string &public_key,
+                             std::string &uid) const {
+  // Check to see if it is a repository key FIRST
+  {
+    const Shard &s = shard(public_key);
+    lock_guard<mutex> lock(s.mutex);
+    auto entry = s.keys.find(public_key);
+    if (entry != s.keys.end() && entry->second.has_repo) {
+      uid = entry->second.repo_uid;
+      return PersistentKeyCache::Lookup::FOUND;
+    }
+  }
+
+  PersistentKeyCache::Lookup result =
+      m_persistent_key_cache->get(public_key, uid);
+  if (result == PersistentKeyCache::Lookup::FOUND ||
+      result == PersistentKeyCache::Lookup::NOT_FOUND) {
+    return result;
+  }
+
+  // Only check database for user keys if not found in memory
+  const uint64_t generation = m_persistent_key_cache->generation();
+  try {
+    DatabaseAPI db(m_db_url, m_db_user, m_db_pass);
+    long http_code = 0;
+    if (db.uidByPubKey(public_key, uid, http_code)) {
+      m_persistent_key_cache->store(public_key, generation, true, uid);
+      return PersistentKeyCache::Lookup::FOUND;
+    } else if (http_code >= 400 && http_code < 500) {
+      m_persistent_key_cache->store(public_key, generation, false, "");
+      return PersistentKeyCache::Lookup::NOT_FOUND;
+    }
+  } catch (const std::exception &e) {
+    // Database is down, but we already checked memory map
+  }
+  m_persistent_key_cache->storeFailure(public_key, generation);
+  return PersistentKeyCache::Lookup::NOT_FOUND;
+}
+
+bool AuthMap::resolvePersistentKeyAsync(const std::string &public_key) const {
+  std::string uid;
+  {
+    const Shard &s = shard(public_key);
+    lock_guard<mutex> lock(s.mutex);
+    auto entry = s.keys.find(public_key);
+    if (entry != s.keys.end() && entry->second.has_repo) {
+      return true;
+    }
+  }
+
+  PersistentKeyCache::Lookup result =
+      m_persistent_key_cache->get(public_key, uid);
+  if (result == PersistentKeyCache::Lookup::FOUND ||
+      result == PersistentKeyCache::Lookup::NOT_FOUND) {
+    return true;
+  }
+
+  uint64_t generation = 0;
+  if (!m_persistent_key_cache->beginLookup(public_key, generation)) {
+    // Already being looked up
+    return false;
+  }
+
+  // The callback holds on to the cache so it stays valid even if this
+  // AuthMap is replaced while the lookup is running
+  std::shared_ptr<PersistentKeyCache> cache = m_persistent_key_cache;
+  try {
+    DatabaseAPI db(m_db_url, m_db_user, m_db_pass);
+    db.uidByPubKeyAsync(
+        public_key, [cache, public_key, generation](long a_http_code,
+                                                    const std::string &a_uid) {
+          if (a_http_code >= 200 && a_http_code < 300) {
+            cache->store(public_key, generation, true, a_uid);
+          } else if (a_http_code >= 400 && a_http_code < 500) {
+            cache->store(public_key, generation, false, "");
+          } else {
+            cache->storeFailure(public_key, generation);
+          }
+        });
+  } catch (const std::exception &e) {
+    cache->storeFailure(public_key, generation);
+    return true;
+  }
+  return false;
+}
+
+void AuthMap::invalidatePersistentKeys(const std::string &uid) {
+  m_persistent_key_cache->invalidateUID(uid);
 }
 
 bool AuthMap::hasKeyType(const PublicKeyType pub_key_type,
                          const std::string &public_key) const {
-  if (pub_key_type == PublicKeyType::TRANSIENT) {
-    lock_guard<mutex> lock(m_trans_clients_mtx);
-    return m_trans_auth_clients.count(public_key);
-  } else if (pub_key_type == PublicKeyType::SESSION) {
-    lock_guard<mutex> lock(m_session_clients_mtx);
-    return m_session_auth_clients.count(public_key);
-  } else {
+  if (pub_key_type != PublicKeyType::TRANSIENT &&
+      pub_key_type != PublicKeyType::SESSION) {
     EXCEPT(1, "Unsupported PublicKey Type during execution of hasKeyType.");
   }
+
+  const Shard &s = shard(public_key);
+  lock_guard<mutex> lock(s.mutex);
+  auto entry = s.keys.find(public_key);
+  if (entry == s.keys.end()) {
+    return false;
+  }
+  return pub_key_type == PublicKeyType::TRANSIENT ? entry->second.has_transient
+                                                  : entry->second.has_session;
 }
 
 void AuthMap::setAccessCount(const PublicKeyType pub_key_type,
                              const std::string &public_key,
                              const size_t count) {
-  if (pub_key_type == PublicKeyType::TRANSIENT) {
-    std::lock_guard<std::mutex> lock(m_trans_clients_mtx);
-    if (m_trans_auth_clients.count(public_key)) {
-      m_trans_auth_clients.at(public_key).access_count = count;
-    }
-  } else if (pub_key_type == PublicKeyType::SESSION) {
-    std::lock_guard<std::mutex> lock(m_session_clients_mtx);
-    if (m_session_auth_clients.count(public_key)) {
-      m_session_auth_clients.at(public_key).access_count = count;
-    }
-  } else {
+  if (pub_key_type != PublicKeyType::TRANSIENT &&
+      pub_key_type != PublicKeyType::SESSION) {
     EXCEPT(1, "Unsupported PublicKey Type during execution of setAccessCount.");
   }
+
+  Shard &s = shard(public_key);
+  lock_guard<mutex> lock(s.mutex);
+  auto entry = s.keys.find(public_key);
+  if (entry != s.keys.end()) {
+    AuthElement *elem = element(entry->second, pub_key_type);
+    if (elem) {
+      elem->access_count = count;
+    }
+  }
 }
 
 size_t AuthMap::getAccessCount(const PublicKeyType pub_key_type,
                                const std::string &public_key) const {
-  if (pub_key_type == PublicKeyType::TRANSIENT) {
-    lock_guard<mutex> lock(m_trans_clients_mtx);
-    if (m_trans_auth_clients.count(public_key)) {
-      return m_trans_auth_clients.at(public_key).access_count;
-    }
-  } else if (pub_key_type == PublicKeyType::SESSION) {
-    lock_guard<mutex> lock(m_session_clients_mtx);
-    if (m_session_auth_clients.count(public_key)) {
-      return m_session_auth_clients.at(public_key).access_count;
-    }
-  } else {
+  if (pub_key_type != PublicKeyType::TRANSIENT &&
+      pub_key_type != PublicKeyType::SESSION) {
     EXCEPT(1, "Unsupported PublicKey Type during execution of getAccessCount.");
   }
+
+  const Shard &s = shard(public_key);
+  lock_guard<mutex> lock(s.mutex);
+  auto entry = s.keys.find(public_key);
+  if (entry != s.keys.end()) {
+    const KeyEntry &key = entry->second;
+    if (pub_key_type == PublicKeyType::TRANSIENT && key.has_transient) {
+      return key.transient.access_count;
+    } else if (pub_key_type == PublicKeyType::SESSION && key.has_session) {
+      return key.session.access_count;
+    }
+  }
   return 0;
 }
 
@@ -342,45 +562,94 @@ void AuthMap::migrateKey(const PublicKeyType from_type,
     EXCEPT(1, "Unsupported key migration attempted, only allowed to migrate to TRANSIENT -> SESSION or SESSION -> PERSISTENT");
   }
 
-  if (from_type == PublicKeyType::TRANSIENT) {
-    // TRANSIENT -> SESSION
-    std::lock_guard<std::mutex> lock_trans(m_trans_clients_mtx);
-    // Make sure TRANSIENT key exists before trying to remove it.
-    if (! m_trans_auth_clients.count(public_key)) {
-      EXCEPT(1, "Missing TRANSIENT key, unable to migrate key (TRANSIENT->SESSION)!");
-    }
-    std::lock_guard<std::mutex> lock_sess(m_session_clients_mtx);
-    m_trans_auth_clients.erase(public_key);
-    // Make sure SESSION key does not exist before trying to add it.
-    if ( m_session_auth_clients.count(public_key) == 0 ) {
-      AuthElement element = {id, time(0) + m_trans_active_increment, 0};
-      m_session_auth_clients[public_key] = element;
-    }
+  // Both types of a key are in the same entry, one lock covers the move
+  time_t expiration_time = 0;
+  {
+    Shard &s = shard(public_key);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto entry = s.keys.find(public_key);
+
+    if (from_type == PublicKeyType::TRANSIENT) {
+      // TRANSIENT -> SESSION
+      // Make sure TRANSIENT key exists before trying to remove it.
+      if (entry == s.keys.end() || !entry->second.has_transient) {
+        EXCEPT(1, "Missing TRANSIENT key, unable to migrate key (TRANSIENT->SESSION)!");
+      }
+      KeyEntry &key = entry->second;
+      key.has_transient = false;
+      key.transient = AuthElement();
+      m_trans_count--;
+      // Make sure SESSION key does not exist before trying to add it.
+      if (!key.has_session) {
+        expiration_time = time(0) + m_trans_active_increment;
+        key.has_session = true;
+        key.session = {id, expiration_time, 0};
+        m_session_count++;
+      }
 
-  } else if (from_type == PublicKeyType::SESSION) {
-    // SESSION -> PERSISTENT
-    std::lock_guard<std::mutex> lock_sess(m_session_clients_mtx);
-    // Make sure SESSION key exists before trying to remove it.
-    if (! m_session_auth_clients.count(public_key)) {
-      EXCEPT(1, "Missing SESSION key, unable to migrate key (SESSION->PERSISTENT)!");
-    }
-    std::lock_guard<std::mutex> lock_pers(m_persistent_clients_mtx);
-    m_session_auth_clients.erase(public_key);
-    // Make sure PERSISTENT key does not exist before trying to add it.
-    if ( m_persistent_auth_clients.count(public_key) == 0 ) {
-      m_persistent_auth_clients[public_key] = id;
+    } else if (from_type == PublicKeyType::SESSION) {
+      // SESSION -> PERSISTENT
+      // Make sure SESSION key exists before trying to remove it.
+      if (entry == s.keys.end() || !entry->second.has_session) {
+        EXCEPT(1, "Missing SESSION key, unable to migrate key (SESSION->PERSISTENT)!");
+      }
+      KeyEntry &key = entry->second;
+      key.has_session = false;
+      key.session = AuthElement();
+      m_session_count--;
+      // Make sure PERSISTENT key does not exist before trying to add it.
+      if (!key.has_repo) {
+        key.has_repo = true;
+        key.repo_uid = id;
+      }
     }
   }
+
+  if (expiration_time) {
+    scheduleExpiry(PublicKeyType::SESSION, public_key, expiration_time);
+  }
 }
 
 void AuthMap::clearTransientKeys() {
-  std::lock_guard<std::mutex> lock(m_trans_clients_mtx);
-  m_trans_auth_clients.clear();
+  std::lock_guard<std::mutex> expiry_lock(m_trans_expiry_mtx);
+  m_trans_expiry.clear();
+
+  for (Shard &s : m_shards) {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (auto entry = s.keys.begin(); entry != s.keys.end();) {
+      if (entry->second.has_transient) {
+        entry->second.has_transient = false;
+        entry->second.transient = AuthElement();
+        m_trans_count--;
+      }
+      if (entry->second.empty()) {
+        entry = s.keys.erase(entry);
+      } else {
+        ++entry;
+      }
+    }
+  }
 }
 
 void AuthMap::clearSessionKeys() {
-  std::lock_guard<std::mutex> lock(m_session_clients_mtx);
-  m_session_auth_clients.clear();
+  std::lock_guard<std::mutex> expiry_lock(m_session_expiry_mtx);
+  m_session_expiry.clear();
+
+  for (Shard &s : m_shards) {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (auto entry = s.keys.begin(); entry != s.keys.end();) {
+      if (entry->second.has_session) {
+        entry->second.has_session = false;
+        entry->second.session = AuthElement();
+        m_session_count--;
+      }
+      if (entry->second.empty()) {
+        entry = s.keys.erase(entry);
+      } else {
+        ++entry;
+      }
+    }
+  }
 }
 
 void AuthMap::clearAllNonPersistentKeys() {
@@ -4,20 +4,36 @@
 
 // Local includes
 #include "AuthMap.hpp"
+#include "PersistentKeyCache.hpp"
 #include "PublicKeyTypes.hpp"
+#include "TimerWheel.hpp"
 
 // Local common includes
 #include "common/IAuthenticationManager.hpp"
 
 // Standard includes
+#include <array>
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace SDMS {
 namespace Core {
 
+/**
+ * Keys of authenticated clients and the users they map to.
+ *
+ * Transient, session and repo (persistent) keys live in one hash map split
+ * into shards with their own mutex, so concurrent lookups of different keys
+ * rarely contend. All types of a key are stored together, lookup() answers
+ * with one probe. Transient and session keys expire through a timer wheel per
+ * type, purging touches only the keys that expired. Persistent user keys are
+ * looked up in the database and kept in the PersistentKeyCache.
+ **/
 class AuthMap {
 public:
   struct AuthElement {
@@ -26,35 +42,65 @@ public:
     size_t access_count = 0;
   };
 
-  typedef std::map<std::string, AuthElement> client_map_t;
-  typedef std::map<std::string, std::string> persistent_client_map_t;
-
 private:
+  static const size_t SHARD_COUNT = 64;
+
+  /// Everything known about one key, a key may have several types at once
+  struct KeyEntry {
+    AuthElement transient;
+    AuthElement session;
+    std::string repo_uid;
+    bool has_transient = false;
+    bool has_session = false;
+    bool has_repo = false;
+
+    bool empty() const { return !has_transient && !has_session && !has_repo; }
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, KeyEntry> keys;
+  };
+
   time_t m_trans_active_increment = 0;
   time_t m_session_active_increment = 0;
 
+  std::array<Shard, SHARD_COUNT> m_shards;
+  std::atomic<size_t> m_trans_count{0};
+  std::atomic<size_t> m_session_count{0};
+
   /**
-   * WARNING if more than one lock guard need to be applied in a given
-   * method they must be locked in a consistent order to avoid deadlock
-   * TRANSIENT -> SESSION -> PERSISTENT
+   * Expiry of transient and session keys. Lock order is expiry mutex then
+   * shard mutex, a shard mutex is never held while taking an expiry mutex.
    **/
-  mutable std::mutex
-      m_trans_clients_mtx; ///< Mutex for transient client data access
-  mutable std::mutex
-      m_session_clients_mtx; ///< Mutex for session client data access
-  mutable std::mutex
-      m_persistent_clients_mtx; ///< Mutex for persistent client data access
+  mutable std::mutex m_trans_expiry_mtx;
+  mutable std::mutex m_session_expiry_mtx;
+  TimerWheel m_trans_expiry;
+  TimerWheel m_session_expiry;
 
-  client_map_t m_trans_auth_clients; ///< Map of transient authenticated clients
-  client_map_t m_session_auth_clients; ///< Map of session authenticated clients
-  persistent_client_map_t
-      m_persistent_auth_clients; ///< Map of known persistent authenticated
-                                 ///< clients
+  /// Persistent user keys looked up in the DB, shared with async lookups
+  std::shared_ptr<PersistentKeyCache> m_persistent_key_cache =
+      std::make_shared<PersistentKeyCache>();
 
   std::string m_db_url;
   std::string m_db_user;
   std::string m_db_pass;
 
+  /**
+   * Resolve a persistent key, first against the in memory (repository) keys,
+   * then the cache and finally the database. The DB lookup blocks.
+   **/
+  PersistentKeyCache::Lookup lookupPersistentKey(const std::string &public_key,
+                                                 std::string &uid) const;
+
+  Shard &shard(const std::string &public_key);
+  const Shard &shard(const std::string &public_key) const;
+  /// Entry of the given expiring type, null if missing
+  static AuthElement *element(KeyEntry &entry, const PublicKeyType type);
+  void scheduleExpiry(const PublicKeyType pub_key_type,
+                      const std::string &public_key, time_t expiration_time);
+  void copyKeys(const AuthMap &auth_map);
+
 public:
   AuthMap(){};
 
@@ -88,11 +134,13 @@ public:
                   const std::string &public_key) const;
 
   /**
-   * Will grab all the public keys that have expired.
+   * Will grab all the public keys that expired at or before threshold.
+   *
+   * Each expired key is reported once, the caller must remove the key or
+   *reset it, which schedules a new expiry.
    **/
-  std::vector<std::string>
-  getExpiredKeys(const PublicKeyType pub_key_type,
-                 const time_t threshold) const noexcept;
+  std::vector<std::string> getExpiredKeys(const PublicKeyType pub_key_type,
+                                          const time_t threshold) noexcept;
 
   /**
    * Return how many times the key has been accessed since the count was last
@@ -130,6 +178,30 @@ public:
   bool hasKey(const PublicKeyType pub_key_type,
               const std::string &public_key) const;
 
+  /**
+   * Finds the key among transient, session and persistent keys, in that
+   *order, and returns its uid and type. The in memory keys are checked with
+   *a single probe before persistent user keys are looked up, which may block
+   *on the database. Returns false if the key is not known.
+   **/
+  bool lookup(const std::string &public_key, std::string &uid,
+              PublicKeyType &type) const;
+
+  /**
+   * Same as lookup, also counts an access of transient and session keys in
+   *the same probe.
+   **/
+  bool lookupAndCount(const std::string &public_key, std::string &uid,
+                      PublicKeyType &type);
+
+  /**
+   * Non-blocking check used on the message ingress path. Returns true if
+   * hasKey/getUID can answer for a persistent key without going to the
+   *database. Otherwise an asynchronous DB lookup is started, if one is not
+   *already running, and false is returned.
+   **/
+  bool resolvePersistentKeyAsync(const std::string &public_key) const;
+
   /***********************************************************************************
    * Manipulators
    ***********************************************************************************/
@@ -213,6 +285,12 @@ public:
    * Persistent keys are preserved as they represent service accounts.
    **/
   void clearAllNonPersistentKeys();
+
+  /**
+   * Drop the cached persistent keys of a user, must be called when the
+   *user's keys are revoked.
+   **/
+  void invalidatePersistentKeys(const std::string &uid);
 };
 
 } // namespace Core
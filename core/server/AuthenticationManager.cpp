@@ -21,96 +21,122 @@ AuthenticationManager::AuthenticationManager(
       m_purge_conditions(std::move(purge_conditions)),
       m_auth_mapper(m_purge_interval[PublicKeyType::TRANSIENT],
                     m_purge_interval[PublicKeyType::SESSION],
-                    db_url, db_user, db_pass) {
-  for (const auto &purge_int : m_purge_interval) {
-    m_next_purge[purge_int.first] = time(0) + purge_int.second;
-  }
-}
+                    db_url, db_user, db_pass) {}
 
 AuthenticationManager &
 AuthenticationManager::operator=(AuthenticationManager &&other) {
   // Only need to lock the mutex moving from
   if (this != &other) {
     std::lock_guard<std::mutex> lock(other.m_lock);
-    m_next_purge = other.m_next_purge;
+    m_last_purge = other.m_last_purge.load();
     m_purge_interval = other.m_purge_interval;
     m_purge_conditions = std::move(other.m_purge_conditions);
     m_auth_mapper = std::move(other.m_auth_mapper);
+    m_rate_limiter = other.m_rate_limiter;
   }
   return *this;
 }
 
 void AuthenticationManager::purge() {
-  purge(PublicKeyType::TRANSIENT);
-  purge(PublicKeyType::SESSION);
+  // Keys expire with a resolution of one second, there is nothing new to
+  // purge within the same second
+  const time_t now = time(0);
+  time_t last = m_last_purge.load();
+  if (now <= last || !m_last_purge.compare_exchange_strong(last, now)) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(m_lock, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  purgeExpired(PublicKeyType::TRANSIENT, now);
+  purgeExpired(PublicKeyType::SESSION, now);
 }
 
 void AuthenticationManager::purge(const PublicKeyType pub_key_type) {
-
   std::lock_guard<std::mutex> lock(m_lock);
-  if (m_auth_mapper.size(pub_key_type)) {
-    const time_t now = time(0);
-    if (now >= m_next_purge[pub_key_type]) {
-      const std::vector<std::string> expired_keys =
-          m_auth_mapper.getExpiredKeys(pub_key_type, now);
-      for (const auto &pub_key : expired_keys) {
-        if (m_purge_conditions[pub_key_type].size()) {
-          for (std::unique_ptr<Condition> &condition :
-               m_purge_conditions[pub_key_type]) {
-            condition->enforce(m_auth_mapper, pub_key);
-          }
-        } else {
-          m_auth_mapper.removeKey(pub_key_type, pub_key);
-        }
+  purgeExpired(pub_key_type, time(0));
+}
+
+void AuthenticationManager::purgeExpired(const PublicKeyType pub_key_type,
+                                         const time_t now) {
+  // Only the keys whose expiry came up are returned, not the whole map
+  const std::vector<std::string> expired_keys =
+      m_auth_mapper.getExpiredKeys(pub_key_type, now);
+  for (const auto &pub_key : expired_keys) {
+    if (m_purge_conditions[pub_key_type].size()) {
+      for (std::unique_ptr<Condition> &condition :
+           m_purge_conditions[pub_key_type]) {
+        condition->enforce(m_auth_mapper, pub_key);
       }
-      m_next_purge[pub_key_type] = now + m_purge_interval[pub_key_type];
+    } else {
+      m_auth_mapper.removeKey(pub_key_type, pub_key);
     }
   }
 }
 
+bool AuthenticationManager::lookupKey(const std::string &public_key,
+                                      std::string &uid, PublicKeyType &type,
+                                      bool count_access) {
+  if (count_access) {
+    return m_auth_mapper.lookupAndCount(public_key, uid, type);
+  }
+  return m_auth_mapper.lookup(public_key, uid, type);
+}
+
+bool AuthenticationManager::authenticate(const std::string &public_key,
+                                         std::string &uid) {
+  PublicKeyType type;
+  return lookupKey(public_key, uid, type, true);
+}
+
 void AuthenticationManager::incrementKeyAccessCounter(
     const std::string &public_key) {
-  std::lock_guard<std::mutex> lock(m_lock);
-  if (m_auth_mapper.hasKey(PublicKeyType::TRANSIENT, public_key)) {
+  if (m_auth_mapper.hasKeyType(PublicKeyType::TRANSIENT, public_key)) {
     m_auth_mapper.incrementKeyAccessCounter(PublicKeyType::TRANSIENT,
                                             public_key);
-  } else if (m_auth_mapper.hasKey(PublicKeyType::SESSION, public_key)) {
+  } else if (m_auth_mapper.hasKeyType(PublicKeyType::SESSION, public_key)) {
     m_auth_mapper.incrementKeyAccessCounter(PublicKeyType::SESSION, public_key);
   }
   // Ignore persistent cases because counter does nothing for them
 }
 
 bool AuthenticationManager::hasKey(const std::string &public_key) const {
-  std::lock_guard<std::mutex> lock(m_lock);
-  
-  if (m_auth_mapper.hasKey(PublicKeyType::TRANSIENT, public_key)) {
-    return true;
-  }
-  
-  if (m_auth_mapper.hasKey(PublicKeyType::SESSION, public_key)) {
+  std::string uid;
+  PublicKeyType type;
+  return m_auth_mapper.lookup(public_key, uid, type);
+}
+
+bool AuthenticationManager::admit(const std::string &uid, uint16_t msg_type,
+                                  uint32_t &retry_after_ms) {
+  if (!m_rate_limiter) {
     return true;
   }
-  
-  if (m_auth_mapper.hasKey(PublicKeyType::PERSISTENT, public_key)) {
+  return m_rate_limiter->admit(uid, msg_type, retry_after_ms);
+}
+
+void AuthenticationManager::setRateLimiter(
+    std::shared_ptr<RateLimiter> rate_limiter) {
+  m_rate_limiter = rate_limiter;
+}
+
+bool AuthenticationManager::resolveKeyAsync(const std::string &public_key) {
+  if (m_auth_mapper.hasKeyType(PublicKeyType::TRANSIENT, public_key) ||
+      m_auth_mapper.hasKeyType(PublicKeyType::SESSION, public_key)) {
     return true;
   }
-  
-  return false;
+
+  return m_auth_mapper.resolvePersistentKeyAsync(public_key);
 }
 
 std::string AuthenticationManager::getUID(const std::string &public_key) const {
-  std::lock_guard<std::mutex> lock(m_lock);
-
-  if (m_auth_mapper.hasKey(PublicKeyType::TRANSIENT, public_key)) {
-    return m_auth_mapper.getUID(PublicKeyType::TRANSIENT, public_key);
-  }
-  if (m_auth_mapper.hasKey(PublicKeyType::SESSION, public_key)) {
-    return m_auth_mapper.getUID(PublicKeyType::SESSION, public_key);
-  }
-  if (m_auth_mapper.hasKey(PublicKeyType::PERSISTENT, public_key)) {
-    return m_auth_mapper.getUID(PublicKeyType::PERSISTENT, public_key);
+  std::string uid;
+  PublicKeyType type;
+  if (m_auth_mapper.lookup(public_key, uid, type)) {
+    return uid;
   }
-  
+
   EXCEPT(1, "Unrecognized public_key during execution of getUID.");
 }
 
@@ -123,7 +149,6 @@ void AuthenticationManager::addKey(const PublicKeyType &pub_key_type,
 
 bool AuthenticationManager::hasKey(const PublicKeyType &pub_key_type,
                                    const std::string &public_key) const {
-  std::lock_guard<std::mutex> lock(m_lock);
   return m_auth_mapper.hasKey(pub_key_type, public_key);
 }
 
@@ -150,25 +175,17 @@ void AuthenticationManager::clearAllNonPersistentKeys() {
   m_auth_mapper.clearAllNonPersistentKeys();
 }
 
+void AuthenticationManager::invalidateUserKeys(const std::string &uid) {
+  m_auth_mapper.invalidatePersistentKeys(uid);
+}
+
 std::string AuthenticationManager::getUIDSafe(const std::string &public_key) const {
-  std::lock_guard<std::mutex> lock(m_lock);
-  
-  // Try each key type in order
-  std::string uid = m_auth_mapper.getUIDSafe(PublicKeyType::TRANSIENT, public_key);
-  if (!uid.empty()) {
+  std::string uid;
+  PublicKeyType type;
+  if (m_auth_mapper.lookup(public_key, uid, type)) {
     return uid;
   }
-  
-  uid = m_auth_mapper.getUIDSafe(PublicKeyType::SESSION, public_key);
-  if (!uid.empty()) {
-    return uid;
-  }
-  
-  uid = m_auth_mapper.getUIDSafe(PublicKeyType::PERSISTENT, public_key);
-  if (!uid.empty()) {
-    return uid;
-  }
-  
+
   return "";  // Return empty string if not found anywhere
 }
 
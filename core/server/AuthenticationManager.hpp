@@ -6,11 +6,13 @@
 // Local includes
 #include "Condition.hpp"
 #include "PublicKeyTypes.hpp"
+#include "RateLimiter.hpp"
 
 // Common includes
 #include "common/IAuthenticationManager.hpp"
 
 // Standard includes
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -21,8 +23,8 @@ namespace Core {
 
 class AuthenticationManager : public IAuthenticationManager {
 private:
-  // The next purge time for each type of public key
-  std::map<PublicKeyType, time_t> m_next_purge;
+  // Second of the last purge, purge() does nothing more than once a second
+  std::atomic<time_t> m_last_purge{0};
   // The purge interval for each type of public key
   std::map<PublicKeyType, time_t> m_purge_interval;
   // The purge conditions for each type of public key
@@ -30,7 +32,13 @@ private:
       m_purge_conditions;
 
   AuthMap m_auth_mapper;
+  /// Request rate limits of users, none if not set
+  std::shared_ptr<RateLimiter> m_rate_limiter;
 
+  /// Applies the purge conditions to keys that expired at or before now
+  void purgeExpired(const PublicKeyType pub_key_type, const time_t now);
+
+  // Serializes purges and key changes, lookups go straight to the AuthMap
   mutable std::mutex m_lock;
 
 public:
@@ -67,6 +75,9 @@ public:
   /**
    * Calls purge for both TRANSIENT and SESSION keys. If they need to be
    * purged they are.
+   *
+   * Called for every message, so it returns right away if keys were already
+   * purged this second or another thread is purging.
    */
   virtual void purge() final;
 
@@ -81,6 +92,36 @@ public:
    **/
   virtual bool hasKey(const std::string &pub_key) const final;
 
+  /**
+   * Finds the uid of a key of any type with a single lookup and counts the
+   *access. Returns false if the key is not known.
+   **/
+  virtual bool authenticate(const std::string &pub_key,
+                            std::string &uid) final;
+
+  /**
+   * Finds the uid and type of a key of any type, optionally counting the
+   *access of a transient or session key.
+   **/
+  bool lookupKey(const std::string &public_key, std::string &uid,
+                 PublicKeyType &type, bool count_access);
+
+  /**
+   * Checks the request against the user's rate limit, if one is set.
+   **/
+  virtual bool admit(const std::string &uid, uint16_t msg_type,
+                     uint32_t &retry_after_ms) final;
+
+  /// Must be set before messages are received, it is read without locking
+  void setRateLimiter(std::shared_ptr<RateLimiter> rate_limiter);
+
+  /**
+   * Will return true if the key is a known transient or session key, or if
+   *the persistent key lookup is cached. Otherwise starts an asynchronous DB
+   *lookup and returns false.
+   **/
+  virtual bool resolveKeyAsync(const std::string &pub_key) final;
+
   void addKey(const PublicKeyType &pub_key_type, const std::string &public_key,
               const std::string &uid);
 
@@ -113,6 +154,12 @@ public:
    **/
   void clearAllNonPersistentKeys();
 
+  /**
+   * Forget the cached persistent keys of a user, called when the user's
+   *keys are revoked.
+   **/
+  void invalidateUserKeys(const std::string &uid);
+
   /**
    * Will the id or throw an error
    *
@@ -1,6 +1,7 @@
 
 // Local DataFed includes
 #include "ClientWorker.hpp"
+#include "RequestAdmission.hpp"
 #include "TaskMgr.hpp"
 #include "Version.hpp"
 
@@ -24,6 +25,7 @@
 
 // Standard includes
 #include <atomic>
+#include <chrono>
 #include <iostream>
 
 using namespace std;
@@ -35,19 +37,44 @@ using namespace SDMS::Auth;
 
 namespace Core {
 
-map<uint16_t, ClientWorker::msg_fun_t> ClientWorker::m_msg_handlers;
+vector<ClientWorker::msg_fun_t> ClientWorker::m_msg_handlers;
 
 // TODO - This should be defined in proto files
 #define NOTE_MASK_MD_ERR 0x2000
 
+/**
+ * Collects the schema validation errors of a single record, used when
+ * validating batch records concurrently (ClientWorker::error is not
+ * thread-safe).
+ */
+class RecordErrorHandler : public nlohmann::json_schema::basic_error_handler {
+public:
+  void error(const nlohmann::json::json_pointer &a_ptr,
+             const nlohmann::json &a_inst,
+             const std::string &a_err_msg) override {
+    (void)a_inst;
+    const std::string &path = a_ptr.to_string();
+
+    if (m_err.size() == 0)
+      m_err = "Schema Validation Error(s):\n";
+
+    m_err +=
+        "At " + (path.size() ? path : "top-level") + ": " + a_err_msg + "\n";
+  }
+
+  std::string m_err;
+};
+
 ClientWorker::ClientWorker(ICoreServer &a_core, size_t a_tid,
+                           const std::string &a_host,
                            LogContext log_context_in)
     : m_config(Config::getInstance()), m_core(a_core), m_tid(a_tid),
-      m_run(true),
+      m_host(a_host), m_run(true),
       m_db_client(m_config.db_url, m_config.db_user, m_config.db_pass),
-      m_log_context(log_context_in) {
-  // This should be hidden behind a factory or some other builder
-  m_msg_mapper = std::unique_ptr<IMessageMapper>(new ProtoBufMap);
+      m_log_context(log_context_in),
+      m_schema_cache(SchemaValidatorCache::getInstance()),
+      m_response_cache(ResponseCache::getInstance()),
+      m_validation_pool(ValidationPool::getInstance()) {
   setupMsgHandlers();
   LogContext log_context = m_log_context;
   log_context.thread_name +=
@@ -82,9 +109,9 @@ void ClientWorker::wait() {
 }
 
 #define SET_MSG_HANDLER(proto_id, msg, func)                                   \
-  m_msg_handlers[m_msg_mapper->getMessageType(proto_id, #msg)] = func
+  m_msg_handlers[msg_mapper.getMessageType(proto_id, #msg)] = func
 #define SET_MSG_HANDLER_DB(proto_id, rq, rp, func)                             \
-  m_msg_handlers[m_msg_mapper->getMessageType(proto_id, #rq)] =                \
+  m_msg_handlers[msg_mapper.getMessageType(proto_id, #rq)] =                   \
       &ClientWorker::dbPassThrough<rq, rp, &DatabaseAPI::func>
 
 /**
@@ -105,9 +132,13 @@ void ClientWorker::setupMsgHandlers() {
     return;
 
   try {
+    // Handlers are indexed directly by message type, unhandled types are null
+    const ProtoBufMap &msg_mapper = ProtoBufMap::getInstance();
+    m_msg_handlers.assign(msg_mapper.maxMessageType() + 1, nullptr);
+
     // Register and setup handlers for the Anonymous interface
 
-    uint8_t proto_id = m_msg_mapper->getProtocolID(
+    uint8_t proto_id = msg_mapper.getProtocolID(
         MessageProtocol::GOOGLE_ANONONYMOUS); // REG_PROTO( SDMS::Anon );
     // Requests that require the server to take action
     SET_MSG_HANDLER(proto_id, VersionRequest,
@@ -124,7 +155,7 @@ void ClientWorker::setupMsgHandlers() {
                        dailyMessage);
 
     // Register and setup handlers for the Authenticated interface
-    proto_id = m_msg_mapper->getProtocolID(MessageProtocol::GOOGLE_AUTHORIZED);
+    proto_id = msg_mapper.getProtocolID(MessageProtocol::GOOGLE_AUTHORIZED);
 
     // Requests that require the server to take action
     SET_MSG_HANDLER(proto_id, GenerateCredentialsRequest,
@@ -137,6 +168,8 @@ void ClientWorker::setupMsgHandlers() {
                     &ClientWorker::procDataPutRequest);
     SET_MSG_HANDLER(proto_id, RecordCreateRequest,
                     &ClientWorker::procRecordCreateRequest);
+    SET_MSG_HANDLER(proto_id, RecordCreateBatchRequest,
+                    &ClientWorker::procRecordCreateBatchRequest);
     SET_MSG_HANDLER(proto_id, RecordUpdateRequest,
                     &ClientWorker::procRecordUpdateRequest);
     SET_MSG_HANDLER(proto_id, RecordUpdateBatchRequest,
@@ -167,6 +200,8 @@ void ClientWorker::setupMsgHandlers() {
                     &ClientWorker::procSchemaReviseRequest);
     SET_MSG_HANDLER(proto_id, SchemaUpdateRequest,
                     &ClientWorker::procSchemaUpdateRequest);
+    SET_MSG_HANDLER(proto_id, SchemaDeleteRequest,
+                    &ClientWorker::procSchemaDeleteRequest);
     SET_MSG_HANDLER(proto_id, MetadataValidateRequest,
                     &ClientWorker::procMetadataValidateRequest);
 
@@ -207,8 +242,6 @@ void ClientWorker::setupMsgHandlers() {
                        projGetRole);
     SET_MSG_HANDLER_DB(proto_id, RecordViewRequest, RecordDataReply,
                        recordView);
-    SET_MSG_HANDLER_DB(proto_id, RecordCreateBatchRequest, RecordDataReply,
-                       recordCreateBatch);
     SET_MSG_HANDLER_DB(proto_id, RecordExportRequest, RecordExportReply,
                        recordExport);
     SET_MSG_HANDLER_DB(proto_id, RecordLockRequest, ListingReply, recordLock);
@@ -282,7 +315,6 @@ void ClientWorker::setupMsgHandlers() {
                        schemaSearch);
     SET_MSG_HANDLER_DB(proto_id, SchemaViewRequest, SchemaDataReply,
                        schemaView);
-    SET_MSG_HANDLER_DB(proto_id, SchemaDeleteRequest, AckReply, schemaDelete);
     SET_MSG_HANDLER_DB(proto_id, TagSearchRequest, TagDataReply, tagSearch);
     SET_MSG_HANDLER_DB(proto_id, TagListByCountRequest, TagDataReply,
                        tagListByCount);
@@ -316,8 +348,10 @@ void ClientWorker::workerThread(LogContext log_context) {
     socket_options.connection_life = SocketConnectionLife::INTERMITTENT;
     socket_options.connection_security = SocketConnectionSecurity::INSECURE;
     socket_options.protocol_type = ProtocolType::ZQTP;
-    socket_options.host = "workers";
+    socket_options.host = m_host;
     socket_options.local_id = client_id;
+    socket_options.max_message_size = m_config.max_msg_size;
+    socket_options.chunk_size = m_config.msg_chunk_size;
 
     std::unordered_map<CredentialType, std::string> cred_options;
 
@@ -334,7 +368,7 @@ void ClientWorker::workerThread(LogContext log_context) {
                           timeout_on_poll);
   }();
 
-  ProtoBufMap proto_map;
+  const ProtoBufMap &proto_map = ProtoBufMap::getInstance();
   uint16_t task_list_msg_type = proto_map.getMessageType(2, "TaskListRequest");
 
   DL_DEBUG(log_context, "W" << m_tid << " m_run " << m_run);
@@ -368,26 +402,29 @@ void ClientWorker::workerThread(LogContext log_context) {
                                             << " [" << uid << "]");
         }
 
-        if (uid.compare("anon") == 0 && msg_type > 0x1FF) {
-          DL_WARNING(message_log_context,
-                     "W" << m_tid
-                         << " unauthorized access attempt from anon user");
-          auto response_msg = m_msg_factory.createResponseEnvelope(message);
-
-          // I know this is not great... allocating memory here slow
-          // This will need to be fixed
-          auto nack = std::make_unique<Anon::NackReply>();
-          nack->set_err_code(ID_AUTHN_REQUIRED);
-          nack->set_err_msg("Authentication required");
-          response_msg->setPayload(std::move(nack));
-          client->send(*response_msg);
+        Admission admission =
+            admitRequest(message, msg_type, uid, chrono::steady_clock::now());
+        if (admission != Admission::ACCEPT) {
+          if (admission == Admission::AUTHN_REQUIRED) {
+            DL_WARNING(message_log_context,
+                       "W" << m_tid
+                           << " unauthorized access attempt from anon user");
+          } else {
+            // The client has stopped waiting, skip the work
+            DL_DEBUG(message_log_context,
+                     "W" << m_tid << " dropping expired request "
+                         << proto_map.toString(msg_type));
+            m_core.metricsRequestExpired(msg_type);
+          }
+          client->send(*refuseRequest(m_msg_factory, message, admission));
         } else {
           DL_DEBUG(message_log_context,
                    "W" << m_tid << " getting handler from map: msg_type = "
                        << proto_map.toString(msg_type));
-          if (m_msg_handlers.count(msg_type)) {
-
-            auto handler = m_msg_handlers.find(msg_type);
+          msg_fun_t handler = msg_type < m_msg_handlers.size()
+                                  ? m_msg_handlers[msg_type]
+                                  : nullptr;
+          if (handler) {
 
             DL_TRACE(message_log_context,
                      "W" << m_tid
@@ -396,8 +433,11 @@ void ClientWorker::workerThread(LogContext log_context) {
 
             // Have to move the actual unique_ptr, change ownership not simply
             // passing a reference
-            auto response_msg = (this->*handler->second)(
+            auto response_msg = (this->*handler)(
                 uid, std::move(response.message), message_log_context);
+            // Drop cached replies a write may have changed. Writes run as
+            // tasks are not linked, see ResponseCache::defaultPolicies
+            m_response_cache.invalidate(msg_type);
             if (response_msg) {
               // Gather msg metrics except on task lists (web clients poll)
               if (msg_type != task_list_msg_type)
@@ -521,10 +561,29 @@ ClientWorker::dbPassThrough(const std::string &a_uid,
       std::get<std::string>(msg_request->get(MessageAttribute::CORRELATION_ID));
   PROC_MSG_BEGIN(RQ, RP, log_context)
 
-  m_db_client.setClient(a_uid);
+  const uint16_t msg_type = std::get<uint16_t>(
+      msg_request->get(constants::message::google::MSG_TYPE));
+  const bool cacheable = m_response_cache.enabled(msg_type);
+  ResponseCache::Ticket ticket;
+  std::string cached_reply;
+  bool cached = false;
+  if (cacheable && m_response_cache.get(msg_type, a_uid,
+                                        request->SerializeAsString(),
+                                        cached_reply, ticket)) {
+    cached = reply.ParseFromString(cached_reply);
+    if (!cached)
+      reply.Clear();
+  }
 
-  // Both request and reply here need to be Goolge protocol buffer classes
-  (m_db_client.*func)(*request, reply, log_context);
+  if (!cached) {
+    m_db_client.setClient(a_uid);
+
+    // Both request and reply here need to be Goolge protocol buffer classes
+    (m_db_client.*func)(*request, reply, log_context);
+
+    if (cacheable)
+      m_response_cache.put(ticket, reply.SerializeAsString());
+  }
 
   PROC_MSG_END(log_context);
 }
@@ -724,6 +783,7 @@ std::unique_ptr<IMessage> ClientWorker::procRevokeCredentialsRequest(
 
   m_db_client.setClient(a_uid);
   m_db_client.userClearKeys(log_context);
+  m_core.revokeClientKeys(a_uid);
 
   PROC_MSG_END(log_context);
 }
@@ -808,7 +868,7 @@ ClientWorker::procSchemaCreateRequest(const std::string &a_uid,
     schemaEnforceRequiredProperties(schema);
 
     nlohmann::json_schema::json_validator validator(
-        bind(&ClientWorker::schemaLoader, this, placeholders::_1,
+        bind(&ClientWorker::schemaLoader, this, a_uid, placeholders::_1,
              placeholders::_2, log_context));
 
     validator.set_root_schema(schema);
@@ -819,6 +879,9 @@ ClientWorker::procSchemaCreateRequest(const std::string &a_uid,
     EXCEPT_PARAM(1, "Invalid metadata schema: " << e.what());
   }
 
+  // A schema with this ID may have been deleted and cached before
+  m_schema_cache.invalidate(request->id());
+
   PROC_MSG_END(log_context);
 }
 
@@ -841,7 +904,7 @@ ClientWorker::procSchemaReviseRequest(const std::string &a_uid,
       schemaEnforceRequiredProperties(schema);
 
       nlohmann::json_schema::json_validator validator(
-          bind(&ClientWorker::schemaLoader, this, placeholders::_1,
+          bind(&ClientWorker::schemaLoader, this, a_uid, placeholders::_1,
                placeholders::_2, log_context));
 
       validator.set_root_schema(schema);
@@ -852,6 +915,7 @@ ClientWorker::procSchemaReviseRequest(const std::string &a_uid,
   }
 
   m_db_client.schemaRevise(*request, log_context);
+  m_schema_cache.invalidate(request->id());
 
   PROC_MSG_END(log_context);
 }
@@ -875,7 +939,7 @@ ClientWorker::procSchemaUpdateRequest(const std::string &a_uid,
       schemaEnforceRequiredProperties(schema);
 
       nlohmann::json_schema::json_validator validator(
-          bind(&ClientWorker::schemaLoader, this, placeholders::_1,
+          bind(&ClientWorker::schemaLoader, this, a_uid, placeholders::_1,
                placeholders::_2, log_context));
 
       validator.set_root_schema(schema);
@@ -886,6 +950,27 @@ ClientWorker::procSchemaUpdateRequest(const std::string &a_uid,
   }
 
   m_db_client.schemaUpdate(*request, log_context);
+  m_schema_cache.invalidate(request->id());
+  if (request->has_id_new())
+    m_schema_cache.invalidate(request->id_new());
+
+  PROC_MSG_END(log_context);
+}
+
+std::unique_ptr<IMessage>
+ClientWorker::procSchemaDeleteRequest(const std::string &a_uid,
+                                      std::unique_ptr<IMessage> &&msg_request,
+                                      LogContext log_context) {
+  log_context.correlation_id =
+      std::get<std::string>(msg_request->get(MessageAttribute::CORRELATION_ID));
+  PROC_MSG_BEGIN(SchemaDeleteRequest, AckReply, log_context)
+
+  m_db_client.setClient(a_uid);
+
+  DL_DEBUG(log_context, "Schema delete");
+
+  m_db_client.schemaDelete(*request, reply, log_context);
+  m_schema_cache.invalidate(request->id());
 
   PROC_MSG_END(log_context);
 }
@@ -902,21 +987,16 @@ std::unique_ptr<IMessage> ClientWorker::procMetadataValidateRequest(
 
   m_db_client.setClient(a_uid);
 
-  nlohmann::json schema;
+  SchemaValidatorCache::fetch_t fetch =
+      bind(&ClientWorker::schemaFetch, this, placeholders::_1, log_context);
 
   try {
-    libjson::Value sch;
     DL_TRACE(log_context, "Schema " << request->sch_id());
 
-    m_db_client.schemaView(request->sch_id(), sch, log_context);
-
-    DL_TRACE(
-        log_context,
-        "Schema: "
-            << sch.asArray().begin()->asObject().getValue("def").toString());
+    SchemaValidatorCache::definition_ptr_t schema =
+        m_schema_cache.getDefinition(a_uid, request->sch_id(), fetch);
 
-    schema = nlohmann::json::parse(
-        sch.asArray().begin()->asObject().getValue("def").toString());
+    DL_TRACE(log_context, "Schema: " << *schema);
   } catch (TraceException &e) {
     DL_ERROR(log_context, "Schema validate failure: " << e.what());
     throw;
@@ -924,16 +1004,14 @@ std::unique_ptr<IMessage> ClientWorker::procMetadataValidateRequest(
     EXCEPT_PARAM(1, "Schema parse error: " << e.what());
   }
 
-  nlohmann::json_schema::json_validator validator(
-      bind(&ClientWorker::schemaLoader, this, placeholders::_1,
-           placeholders::_2, log_context));
   try {
-    validator.set_root_schema(schema);
+    SchemaValidatorCache::validator_ptr_t validator =
+        m_schema_cache.getValidator(a_uid, request->sch_id(), fetch);
 
     nlohmann::json md = nlohmann::json::parse(request->metadata());
 
     m_validator_err.clear();
-    validator.validate(md, *this);
+    validator->validate(md, *this);
   } catch (exception &e) {
     m_validator_err = string("Invalid metadata schema: ") + e.what() + "\n";
     DL_ERROR(log_context, "Invalid metadata schema: " << e.what());
@@ -970,25 +1048,21 @@ ClientWorker::procRecordCreateRequest(const std::string &a_uid,
 
   if (request->has_metadata() && request->has_sch_id()) {
 
-    nlohmann::json schema;
+    SchemaValidatorCache::fetch_t fetch =
+        bind(&ClientWorker::schemaFetch, this, placeholders::_1, log_context);
 
     try {
-      libjson::Value sch;
-      m_db_client.schemaView(request->sch_id(), sch, log_context);
-      schema = nlohmann::json::parse(
-          sch.asArray().begin()->asObject().getValue("def").toString());
-
-      nlohmann::json_schema::json_validator validator(
-          bind(&ClientWorker::schemaLoader, this, placeholders::_1,
-               placeholders::_2, log_context));
+      // Load (or parse) failures are reported separately from compile errors
+      m_schema_cache.getDefinition(a_uid, request->sch_id(), fetch);
 
       try {
-        validator.set_root_schema(schema);
+        SchemaValidatorCache::validator_ptr_t validator =
+            m_schema_cache.getValidator(a_uid, request->sch_id(), fetch);
 
         nlohmann::json md = nlohmann::json::parse(request->metadata());
 
         m_validator_err.clear();
-        validator.validate(md, *this);
+        validator->validate(md, *this);
       } catch (exception &e) {
         m_validator_err = string("Invalid metadata schema: ") + e.what() + "\n";
         DL_ERROR(log_context, "Invalid metadata schema: " << e.what());
@@ -1020,6 +1094,33 @@ ClientWorker::procRecordCreateRequest(const std::string &a_uid,
   PROC_MSG_END(log_context);
 }
 
+std::unique_ptr<IMessage> ClientWorker::procRecordCreateBatchRequest(
+    const std::string &a_uid, std::unique_ptr<IMessage> &&msg_request,
+    LogContext log_context) {
+  log_context.correlation_id =
+      std::get<std::string>(msg_request->get(MessageAttribute::CORRELATION_ID));
+  PROC_MSG_BEGIN(RecordCreateBatchRequest, RecordDataReply, log_context)
+
+  m_db_client.setClient(a_uid);
+
+  DL_DEBUG(log_context, "Creating record batch");
+
+  nlohmann::json records;
+  try {
+    records = nlohmann::json::parse(request->records());
+  } catch (exception &e) {
+    EXCEPT_PARAM(ID_BAD_REQUEST, "Invalid batch records: " << e.what());
+  }
+
+  vector<string> errors = batchValidate(a_uid, records, false, log_context);
+
+  m_db_client.recordCreateBatch(*request, reply, log_context);
+
+  batchSetSchemaErrors(records, errors, reply, log_context);
+
+  PROC_MSG_END(log_context);
+}
+
 std::unique_ptr<IMessage>
 ClientWorker::procRecordUpdateRequest(const std::string &a_uid,
                                       std::unique_ptr<IMessage> &&msg_request,
@@ -1081,22 +1182,17 @@ ClientWorker::procRecordUpdateRequest(const std::string &a_uid,
     if (metadata.size() && sch_id.size()) {
       DL_TRACE(log_context, "Must validate JSON, schema " << sch_id);
 
-      libjson::Value sch;
-      m_db_client.schemaView(sch_id, sch, log_context);
+      SchemaValidatorCache::fetch_t fetch = bind(
+          &ClientWorker::schemaFetch, this, placeholders::_1, log_context);
 
-      DL_TRACE(log_context, "Schema record JSON:" << sch.toString());
+      SchemaValidatorCache::definition_ptr_t schema =
+          m_schema_cache.getDefinition(a_uid, sch_id, fetch);
 
-      nlohmann::json schema = nlohmann::json::parse(
-          sch.asArray().begin()->asObject().getValue("def").toString());
-
-      DL_TRACE(log_context, "Schema nlohmann: " << schema);
-
-      nlohmann::json_schema::json_validator validator(
-          bind(&ClientWorker::schemaLoader, this, placeholders::_1,
-               placeholders::_2, log_context));
+      DL_TRACE(log_context, "Schema nlohmann: " << *schema);
 
       try {
-        validator.set_root_schema(schema);
+        SchemaValidatorCache::validator_ptr_t validator =
+            m_schema_cache.getValidator(a_uid, sch_id, fetch);
 
         // TODO This is a hacky way to convert between JSON implementations...
 
@@ -1109,7 +1205,7 @@ ClientWorker::procRecordUpdateRequest(const std::string &a_uid,
           md = cur_md;
         }
 
-        validator.validate(md, *this);
+        validator->validate(md, *this);
       } catch (exception &e) {
         m_validator_err = string("Invalid metadata schema: ") + e.what() + "\n";
         DL_WARNING(log_context, "Invalid metadata schema: " << e.what());
@@ -1161,8 +1257,19 @@ std::unique_ptr<IMessage> ClientWorker::procRecordUpdateBatchRequest(
 
   libjson::Value result;
 
+  nlohmann::json records;
+  try {
+    records = nlohmann::json::parse(request->records());
+  } catch (exception &e) {
+    EXCEPT_PARAM(ID_BAD_REQUEST, "Invalid batch records: " << e.what());
+  }
+
+  vector<string> errors = batchValidate(a_uid, records, true, log_context);
+
   m_db_client.recordUpdateBatch(*request, reply, result, log_context);
 
+  batchSetSchemaErrors(records, errors, reply, log_context);
+
   DL_DEBUG(log_context, "procRecordUpdateBatchRequest, uid: " << a_uid);
   handleTaskResponse(result, log_context);
 
@@ -1420,12 +1527,13 @@ void ClientWorker::handleTaskResponse(libjson::Value &a_result,
     if (task_obj.getNumber("status") != TS_BLOCKED) {
       DL_DEBUG(log_context, "handleTaskResponse status is: "
                                 << task_obj.getNumber("status"));
-      TaskMgr::getInstance().newTask(task_obj.getString("_id"), log_context);
+      TaskMgr::getInstance().newTask(obj.value(), log_context);
     }
   }
 }
 
-void ClientWorker::schemaLoader(const nlohmann::json_uri &a_uri,
+void ClientWorker::schemaLoader(const std::string &a_uid,
+                                const nlohmann::json_uri &a_uri,
                                 nlohmann::json &a_value,
                                 LogContext log_context) {
   DL_DEBUG(log_context, "Load schema, scheme: "
@@ -1433,15 +1541,244 @@ void ClientWorker::schemaLoader(const nlohmann::json_uri &a_uri,
                             << ", auth: " << a_uri.authority()
                             << ", id: " << a_uri.identifier());
 
+  m_schema_cache.loadReference(
+      a_uid, a_uri, a_value,
+      bind(&ClientWorker::schemaFetch, this, placeholders::_1, log_context));
+  DL_TRACE(log_context, "Loaded schema: " << a_value);
+}
+
+/**
+ * Loads the JSON definition of a schema from the DB, used to fill the shared
+ * SchemaValidatorCache.
+ */
+SchemaValidatorCache::Source
+ClientWorker::schemaFetch(const std::string &a_id, LogContext log_context) {
   libjson::Value sch;
-  std::string id = a_uri.path();
 
-  id = id.substr(1); // Skip leading "/"
-  m_db_client.schemaView(id, sch, log_context);
+  m_db_client.schemaView(a_id, sch, log_context);
 
-  a_value = nlohmann::json::parse(
-      sch.asArray().begin()->asObject().getValue("def").toString());
-  DL_TRACE(log_context, "Loaded schema: " << a_value);
+  const libjson::Value::Object &obj = sch.asArray().begin()->asObject();
+  SchemaValidatorCache::Source source;
+  source.definition = obj.getValue("def").toString();
+  source.pub = obj.has("pub") && obj.getBool("pub");
+  return source;
+}
+
+/**
+ * Validates the metadata of batch create/update records against their
+ * schemas. Returns one error message per record (empty if valid or not
+ * validated), a record that can not be checked does not fail the batch.
+ *
+ * Anything that needs the DB (current record state for updates, schema
+ * loading) is done up front on the worker thread, as m_db_client is not
+ * thread-safe; the current state of all updated records is read with a
+ * single DB call. Parsing and validation of the metadata documents, which
+ * dominates for large batches, is then spread across the validation pool.
+ */
+std::vector<std::string>
+ClientWorker::batchValidate(const std::string &a_uid,
+                            nlohmann::json &a_records, bool a_update,
+                            LogContext log_context) {
+  if (!a_records.is_array())
+    EXCEPT(ID_BAD_REQUEST, "Invalid batch records: must be a JSON array");
+
+  struct Job {
+    size_t index;
+    string metadata;
+    string cur_metadata;
+    string sch_id;
+    SchemaValidatorCache::validator_ptr_t validator;
+  };
+
+  /// An updated record whose current state is needed
+  struct View {
+    size_t job;
+    bool merge;  ///< Merge the metadata into the current metadata
+    bool sch_id; ///< Use the current schema
+  };
+
+  vector<string> errors(a_records.size());
+  vector<Job> jobs;
+  vector<string> view_ids;
+  vector<View> views;
+
+  for (size_t i = 0; i < a_records.size(); i++) {
+    const nlohmann::json &rec = a_records[i];
+
+    if (!rec.is_object())
+      continue;
+
+    bool has_md = rec.contains("md") && rec["md"].is_string();
+    bool has_sch_id = rec.contains("sch_id") && rec["sch_id"].is_string();
+    Job job{i, string(), string(), string(), nullptr};
+
+    if (has_md)
+      job.metadata = rec["md"].get<string>();
+    if (has_sch_id)
+      job.sch_id = rec["sch_id"].get<string>();
+
+    if (a_update && (has_md || job.sch_id.size())) {
+      // Same rules as procRecordUpdateRequest: merges, and updates that only
+      // change metadata or schema, must be checked against the current record
+      bool merge = !(rec.contains("mdset") && rec["mdset"].is_boolean() &&
+                     rec["mdset"].get<bool>());
+
+      if (rec.contains("id") && rec["id"].is_string() &&
+          (!has_md || merge || !has_sch_id)) {
+        view_ids.push_back(rec["id"].get<string>());
+        views.push_back(View{jobs.size(), has_md && merge, !has_sch_id});
+        jobs.push_back(std::move(job));
+        continue;
+      }
+    }
+
+    if (job.metadata.empty() || job.sch_id.empty())
+      continue;
+
+    jobs.push_back(std::move(job));
+  }
+
+  if (view_ids.size()) {
+    vector<DatabaseAPI::RecordMetadata> current =
+        m_db_client.recordViewMetadataBatch(view_ids, log_context);
+
+    for (size_t v = 0; v < current.size(); v++) {
+      Job &job = jobs[views[v].job];
+
+      if (current[v].error.size()) {
+        errors[job.index] = "Metadata schema error: could not read record " +
+                            view_ids[v] + ": " + current[v].error + "\n";
+        job.sch_id.clear();
+        continue;
+      }
+
+      if (views[v].merge)
+        job.cur_metadata = current[v].metadata;
+      else if (job.metadata.empty())
+        job.metadata = current[v].metadata;
+
+      if (views[v].sch_id)
+        job.sch_id = current[v].sch_id;
+    }
+  }
+
+  // Drop what turned out to have nothing to validate, and load the schemas
+  map<string, SchemaValidatorCache::validator_ptr_t> validators;
+  SchemaValidatorCache::fetch_t fetch =
+      bind(&ClientWorker::schemaFetch, this, placeholders::_1, log_context);
+  size_t num_jobs = 0;
+
+  for (size_t j = 0; j < jobs.size(); j++) {
+    Job &job = jobs[j];
+    if (job.metadata.empty() || job.sch_id.empty())
+      continue;
+
+    auto v = validators.find(job.sch_id);
+    if (v == validators.end()) {
+      SchemaValidatorCache::validator_ptr_t validator;
+
+      try {
+        validator = m_schema_cache.getValidator(a_uid, job.sch_id, fetch);
+      } catch (exception &e) {
+        DL_ERROR(log_context, "Could not load metadata schema "
+                                  << job.sch_id << ": " << e.what());
+      }
+
+      v = validators.emplace(job.sch_id, validator).first;
+    }
+
+    if (!v->second) {
+      errors[job.index] =
+          "Metadata schema error: could not load schema " + job.sch_id + "\n";
+      continue;
+    }
+
+    job.validator = v->second;
+    if (num_jobs != j)
+      jobs[num_jobs] = std::move(job);
+    num_jobs++;
+  }
+  jobs.resize(num_jobs);
+
+  if (jobs.empty())
+    return errors;
+
+  DL_DEBUG(log_context, "Validating metadata of " << jobs.size()
+                                                  << " batch records");
+
+  // Each job writes only to its own slot in errors
+  m_validation_pool.parallelFor(jobs.size(), [&jobs, &errors](size_t a_job) {
+    Job &job = jobs[a_job];
+    RecordErrorHandler handler;
+
+    try {
+      nlohmann::json md = nlohmann::json::parse(job.metadata);
+
+      if (job.cur_metadata.size()) {
+        nlohmann::json cur_md = nlohmann::json::parse(job.cur_metadata);
+        cur_md.merge_patch(md);
+        md = std::move(cur_md);
+      }
+
+      job.validator->validate(md, handler);
+      errors[job.index] = std::move(handler.m_err);
+    } catch (exception &e) {
+      errors[job.index] =
+          string("Invalid metadata schema: ") + e.what() + "\n";
+    }
+  });
+
+  return errors;
+}
+
+/**
+ * Stores the validation errors of batch records in the DB and flags the
+ * matching records in the reply. Reply data entries are in the same order as
+ * the request records.
+ */
+void ClientWorker::batchSetSchemaErrors(const nlohmann::json &a_records,
+                                        const std::vector<std::string> &a_errors,
+                                        Auth::RecordDataReply &a_reply,
+                                        LogContext log_context) {
+  vector<pair<string, string>> db_errors;
+
+  for (size_t i = 0; i < a_errors.size(); i++) {
+    if (a_errors[i].empty())
+      continue;
+
+    RecordData *data = nullptr;
+    string id;
+
+    if (i < (size_t)a_reply.data_size()) {
+      data = a_reply.mutable_data(i);
+      id = data->id();
+    } else if (a_records[i].contains("id") && a_records[i]["id"].is_string()) {
+      id = a_records[i]["id"].get<string>();
+    } else {
+      continue;
+    }
+
+    DL_WARNING(log_context, "Validation error - batch record " << id);
+
+    db_errors.emplace_back(id, a_errors[i]);
+
+    if (data) {
+      // TODO need a def for md_err mask
+      data->set_notes(data->notes() | NOTE_MASK_MD_ERR);
+      data->set_md_err_msg(a_errors[i]);
+    }
+
+    for (int j = 0; j < a_reply.update_size(); j++) {
+      ListingData *update = a_reply.mutable_update(j);
+      if (update->id() == id) {
+        update->set_notes(update->notes() | NOTE_MASK_MD_ERR);
+        break;
+      }
+    }
+  }
+
+  if (db_errors.size())
+    m_db_client.recordUpdateSchemaErrorBatch(db_errors, log_context);
 }
 
 } // namespace Core
@@ -6,11 +6,13 @@
 #include "DatabaseAPI.hpp"
 #include "GlobusAPI.hpp"
 #include "ICoreServer.hpp"
+#include "ResponseCache.hpp"
+#include "SchemaValidatorCache.hpp"
+#include "ValidationPool.hpp"
 
 // DataFed Common public includes
 #include "common/DynaLog.hpp"
 #include "common/IMessage.hpp"
-#include "common/IMessageMapper.hpp"
 #include "common/MessageFactory.hpp"
 #include "common/Util.hpp"
 
@@ -41,8 +43,10 @@ namespace Core {
  */
 class ClientWorker : public nlohmann::json_schema::basic_error_handler {
 public:
-  /// ClientWorker constructor
-  ClientWorker(ICoreServer &a_core, size_t a_tid, LogContext log_context);
+  /// ClientWorker constructor, a_host is the inproc address of the lane the
+  /// worker takes requests from
+  ClientWorker(ICoreServer &a_core, size_t a_tid, const std::string &a_host,
+               LogContext log_context);
 
   /// ClientWorker destructor
   ~ClientWorker();
@@ -116,6 +120,10 @@ private:
                           std::unique_ptr<IMessage> &&msg_request,
                           LogContext log_context);
   std::unique_ptr<IMessage>
+  procRecordCreateBatchRequest(const std::string &a_uid,
+                               std::unique_ptr<IMessage> &&msg_request,
+                               LogContext log_context);
+  std::unique_ptr<IMessage>
   procRecordUpdateRequest(const std::string &a_uid,
                           std::unique_ptr<IMessage> &&msg_request,
                           LogContext log_context);
@@ -179,6 +187,10 @@ private:
   procSchemaUpdateRequest(const std::string &a_uid,
                           std::unique_ptr<IMessage> &&msg_request,
                           LogContext log_context);
+  std::unique_ptr<IMessage>
+  procSchemaDeleteRequest(const std::string &a_uid,
+                          std::unique_ptr<IMessage> &&msg_request,
+                          LogContext log_context);
 
   void schemaEnforceRequiredProperties(const nlohmann::json &a_schema);
   void recordCollectionDelete(const std::vector<std::string> &a_ids,
@@ -195,8 +207,17 @@ private:
       const std::string &a_uid, std::unique_ptr<IMessage> &&request,
       LogContext log_context);
 
-  void schemaLoader(const nlohmann::json_uri &a_uri, nlohmann::json &a_value,
-                    LogContext log_context);
+  void schemaLoader(const std::string &a_uid, const nlohmann::json_uri &a_uri,
+                    nlohmann::json &a_value, LogContext log_context);
+  SchemaValidatorCache::Source schemaFetch(const std::string &a_id,
+                                           LogContext log_context);
+  std::vector<std::string> batchValidate(const std::string &a_uid,
+                                         nlohmann::json &a_records,
+                                         bool a_update, LogContext log_context);
+  void batchSetSchemaErrors(const nlohmann::json &a_records,
+                            const std::vector<std::string> &a_errors,
+                            Auth::RecordDataReply &a_reply,
+                            LogContext log_context);
 
   void error(const nlohmann::json::json_pointer &a_ptr,
              const nlohmann::json &a_inst,
@@ -217,6 +238,7 @@ private:
   Config &m_config;    ///< Ref to configuration singleton
   ICoreServer &m_core; ///< Ref to parent CoreServer interface
   size_t m_tid;        ///< Thread ID
+  std::string m_host;  ///< Inproc address of the message lane
   std::unique_ptr<std::thread> m_worker_thread; ///< Local thread handle
   mutable std::mutex m_run_mutex;
   bool m_run;                  ///< Thread run flag
@@ -225,9 +247,14 @@ private:
   std::string m_validator_err; ///< String buffer for metadata validation errors
   LogContext m_log_context;
   MessageFactory m_msg_factory;
-  std::unique_ptr<IMessageMapper> m_msg_mapper;
-  /// Map of message type to message handler functions
-  static std::map<uint16_t, msg_fun_t> m_msg_handlers;
+  /// Compiled metadata schemas shared by all workers
+  SchemaValidatorCache &m_schema_cache;
+  /// Replies to cached DB pass-through requests shared by all workers
+  ResponseCache &m_response_cache;
+  /// Fans out batch metadata validation, shared by all workers
+  ValidationPool &m_validation_pool;
+  /// Message handler functions indexed by message type
+  static std::vector<msg_fun_t> m_msg_handlers;
 };
 
 } // namespace Core
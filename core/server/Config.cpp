@@ -140,5 +140,14 @@ std::map<std::string, RepoData> Config::getRepos() const {
   return repos;
 }
 
+bool Config::getRepo(const std::string &a_repo_id, RepoData &a_repo) const {
+  std::lock_guard<std::mutex> lock(m_repos_mtx);
+  auto repo = m_repos.find(a_repo_id);
+  if (repo == m_repos.end())
+    return false;
+  a_repo = repo->second;
+  return true;
+}
+
 } // namespace Core
 } // namespace SDMS
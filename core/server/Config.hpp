@@ -9,6 +9,7 @@
 #include "common/DynaLog.hpp"
 #include "common/ICredentials.hpp"
 #include "common/SDMS.pb.h"
+#include "common/SocketOptions.hpp"
 
 // Standard includes
 #include <map>
@@ -16,6 +17,7 @@
 #include <mutex>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace SDMS {
 namespace Core {
@@ -34,13 +36,22 @@ private:
       : glob_oauth_url("https://auth.globus.org/v2/oauth2/"),
         glob_xfr_url("https://transfer.api.globus.org/v0.10/"), port(7512),
         timeout(5), num_client_worker_threads(4), num_task_worker_threads(10),
+        num_db_connections(32), num_validation_threads(0),
         task_purge_age(14 * 24 * 3600), task_purge_period(6 * 3600),
         task_retry_time_fail(3600),
         task_retry_time_init(30), // Double every retry until max backoff
         task_retry_backoff_max(4), repo_chunk_size(100), repo_timeout(60000),
         note_purge_age(7 * 24 * 3600), note_purge_period(6 * 3600),
         metrics_period(300), metrics_purge_period(3600),
-        metrics_purge_age(24 * 3600) {}
+        metrics_purge_age(24 * 3600),
+        max_msg_size(DEFAULT_MAX_MESSAGE_SIZE),
+        max_req_size(DEFAULT_MAX_REQUEST_SIZE), msg_chunk_size(0),
+        num_zmq_io_threads(1), task_repo_limit(0), task_endpoint_limit(0),
+        num_query_worker_threads(2), num_bulk_worker_threads(2),
+        interactive_queue_limit(0), query_queue_limit(32),
+        bulk_queue_limit(32), interactive_rate_limit(50),
+        query_rate_limit(5), bulk_rate_limit(5), rate_limit_burst(4),
+        response_cache_mb(64) {}
 
   std::map<std::string, RepoData> m_repos;
   bool m_trigger_repo_refresh = true; // Default on startup
@@ -53,6 +64,8 @@ public:
   bool repoCacheInvalid();
 
   std::map<std::string, RepoData> getRepos() const;
+  /// Copies a single repo, returns false if it is not registered
+  bool getRepo(const std::string &a_repo_id, RepoData &a_repo) const;
 
   std::string cred_dir;
   std::string db_url;
@@ -66,6 +79,8 @@ public:
   uint32_t timeout;
   uint32_t num_client_worker_threads;
   uint32_t num_task_worker_threads;
+  uint32_t num_db_connections;
+  uint32_t num_validation_threads;
   uint32_t task_purge_age;
   uint32_t task_purge_period;
   uint32_t task_retry_time_fail;
@@ -78,6 +93,46 @@ public:
   uint32_t metrics_period;
   uint32_t metrics_purge_period;
   uint32_t metrics_purge_age;
+  /// Largest message body accepted from or sent to clients
+  uint32_t max_msg_size;
+  /// Largest request accepted on the external interfaces, before the sender
+  /// has been authenticated
+  uint32_t max_req_size;
+  /// Replies above this size are sent in chunks, 0 disables chunking
+  uint32_t msg_chunk_size;
+  /// ZeroMQ I/O threads shared by all TCP sockets, these do the CURVE work
+  uint32_t num_zmq_io_threads;
+  /// Cores the ZeroMQ I/O threads are pinned to, empty leaves it to the OS
+  std::vector<int> zmq_io_cpus;
+  /// Fair-share weight of task owners (user or project IDs), default 1
+  std::map<std::string, double> task_share_weights;
+  /// Task steps running against one repo server at a time, 0 = unlimited
+  uint32_t task_repo_limit;
+  /// Task steps, i.e. Globus transfers, using one endpoint at a time
+  uint32_t task_endpoint_limit;
+  /// Limits of single repos or endpoints overriding the two above
+  std::map<std::string, uint32_t> task_target_limits;
+  /// Client workers serving searches and exports (the query lane) and batch
+  /// writes (the bulk lane), 0 leaves them to the interactive workers
+  uint32_t num_query_worker_threads;
+  uint32_t num_bulk_worker_threads;
+  /// Requests a lane queues beyond its busy workers before refusing new
+  /// ones, 0 = unbounded
+  uint32_t interactive_queue_limit;
+  uint32_t query_queue_limit;
+  uint32_t bulk_queue_limit;
+  /// Request names moved to another lane, name -> interactive, query or bulk
+  std::map<std::string, std::string> msg_lanes;
+  /// Requests per second one user may send to each lane, 0 = unlimited
+  double interactive_rate_limit;
+  double query_rate_limit;
+  double bulk_rate_limit;
+  /// Seconds worth of requests a user may send at once
+  double rate_limit_burst;
+  /// Memory for cached replies to read requests, 0 disables the cache
+  uint32_t response_cache_mb;
+  /// Seconds replies to a cached request are kept, 0 = not cached
+  std::map<std::string, uint32_t> response_cache_ttls;
 
   // MsgComm::SecurityContext            sec_ctx;
   std::unique_ptr<ICredentials> sec_ctx;
@@ -3,24 +3,36 @@
 #include "ClientWorker.hpp"
 #include "Condition.hpp"
 #include "DatabaseAPI.hpp"
+#include "DatabaseConnectionPool.hpp"
 #include "PublicKeyTypes.hpp"
+#include "RepoConnectionPool.hpp"
+#include "ResponseCache.hpp"
 #include "TaskMgr.hpp"
+#include "ValidationPool.hpp"
 
 // DataFed Common includes
+#include "common/CommunicatorFactory.hpp"
 #include "common/CredentialFactory.hpp"
 #include "common/DynaLog.hpp"
 #include "common/IServer.hpp"
+#include "common/MessageFactory.hpp"
 #include "common/OperatorFactory.hpp"
+#include "common/ProtoBufMap.hpp"
 #include "common/ServerFactory.hpp"
 #include "common/SocketOptions.hpp"
 #include "common/Util.hpp"
 
+// Proto file includes
+#include "common/SDMS_Anon.pb.h"
+
 // Third party includes
 #include <curl/curl.h>
+#include <zmq.h>
 
 // Standard includes
 #include <chrono>
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <time.h>
 #include <vector>
@@ -33,6 +45,8 @@
 
 #define MAINT_POLL_INTERVAL 5
 #define CLIENT_IDLE_TIMEOUT 3600
+// Longest a lane counts a request that got no reply
+#define LANE_REQUEST_TIMEOUT chrono::minutes(10)
 
 using namespace std;
 
@@ -45,6 +59,27 @@ Server::Server(LogContext log_context)
   // One-time global libcurl init
   curl_global_init(CURL_GLOBAL_DEFAULT);
 
+  // Bound the number of keep-alive DB connections shared by all DatabaseAPI
+  // instances
+  DatabaseConnectionPool::getInstance().setCapacity(
+      m_config.num_db_connections);
+
+  // One validation pool for all client workers, so batch validation does not
+  // oversubscribe the host as workers are added
+  ValidationPool::getInstance().setNumThreads(m_config.num_validation_threads);
+
+  // Enough idle repo connections for every task worker to have one
+  RepoConnectionPool::getInstance().setMaxIdlePerRepo(
+      m_config.num_task_worker_threads);
+
+  // Every TCP socket of the process, including the per request repo
+  // connections, shares these I/O threads
+  if (!CommunicatorFactory::configureTcpContext(m_config.num_zmq_io_threads,
+                                                m_config.zmq_io_cpus)) {
+    DL_WARNING(m_log_context, "ZeroMQ TCP context already in use, I/O thread "
+                              "settings ignored");
+  }
+
   // Load ZMQ keys
   loadKeys(m_config.cred_dir);
 
@@ -89,6 +124,9 @@ Server::Server(LogContext log_context)
   // Now load repository config from DB into the initialized AuthenticationManager
   m_config.loadRepositoryConfig(m_auth_manager, log_context);
 
+  setupMsgLanes();
+  setupResponseCache();
+
   // Start ZAP handler must be started before any other socket binds are called
   // m_zap_thread = thread( &Server::zapHandler, this );
 
@@ -100,12 +138,13 @@ Server::Server(LogContext log_context)
   m_repo_cache_thread =
       thread(&Server::repoCacheThread, this, m_log_context, getNewThreadId());
 
+  // Create task mgr (starts it's own threads), before the metrics thread
+  // reports its queues
+  TaskMgr::getInstance(m_log_context, getNewThreadId());
+
   // Start DB maintenance thread
   m_metrics_thread =
       thread(&Server::metricsThread, this, m_log_context, getNewThreadId());
-
-  // Create task mgr (starts it's own threads)
-  TaskMgr::getInstance(m_log_context, getNewThreadId());
 }
 
 Server::~Server() {
@@ -175,89 +214,273 @@ void Server::run() {
   m_msg_router_thread.join();
 }
 
+namespace {
+/// True if a message can be read from the zmq socket without waiting
+bool hasIncoming(void *zmq_socket) {
+  int events = 0;
+  size_t events_size = sizeof(events);
+  if (zmq_getsockopt(zmq_socket, ZMQ_EVENTS, &events, &events_size) != 0) {
+    return false;
+  }
+  return events & ZMQ_POLLIN;
+}
+} // namespace
+
+/**
+ * Sorts message types into lanes and sets the lanes' capacity and the rate
+ * limits of users, which are per lane as well. Must run before any message
+ * is received.
+ */
+void Server::setupMsgLanes() {
+  const uint32_t lane_workers[MessageLanes::LANE_COUNT] = {
+      m_config.num_client_worker_threads, m_config.num_query_worker_threads,
+      m_config.num_bulk_worker_threads};
+  const uint32_t lane_queues[MessageLanes::LANE_COUNT] = {
+      m_config.interactive_queue_limit, m_config.query_queue_limit,
+      m_config.bulk_queue_limit};
+  const double lane_rates[MessageLanes::LANE_COUNT] = {
+      m_config.interactive_rate_limit, m_config.query_rate_limit,
+      m_config.bulk_rate_limit};
+
+  // Requests of lanes without workers stay interactive
+  const ProtoBufMap &proto_map = ProtoBufMap::getInstance();
+  auto assignLane = [&](const string &a_msg_name, MessageLanes::Lane a_lane) {
+    if (lane_workers[a_lane] == 0)
+      a_lane = MessageLanes::INTERACTIVE;
+    m_msg_lanes.setLane(proto_map.getMessageType(2, a_msg_name), a_lane);
+  };
+  for (auto &msg_lane : MessageLanes::defaultLanes())
+    assignLane(msg_lane.first, msg_lane.second);
+  for (auto &msg_lane : m_config.msg_lanes) {
+    MessageLanes::Lane lane;
+    if (MessageLanes::fromName(msg_lane.second, lane))
+      assignLane(msg_lane.first, lane);
+  }
+
+  m_rate_limiter = std::make_shared<RateLimiter>(m_msg_lanes);
+  for (uint8_t l = 0; l < MessageLanes::LANE_COUNT; ++l) {
+    m_msg_lanes.setCapacity((MessageLanes::Lane)l,
+                            lane_queues[l] ? lane_workers[l] + lane_queues[l]
+                                           : 0);
+    m_rate_limiter->setLimit((MessageLanes::Lane)l, lane_rates[l],
+                             lane_rates[l] * m_config.rate_limit_burst);
+  }
+  m_auth_manager.setRateLimiter(m_rate_limiter);
+}
+
+void Server::setupResponseCache() {
+  ResponseCache &cache = ResponseCache::getInstance();
+  cache.setCapacity((size_t)m_config.response_cache_mb << 20);
+
+  const ProtoBufMap &proto_map = ProtoBufMap::getInstance();
+  for (auto &policy : ResponseCache::defaultPolicies()) {
+    auto ttl = m_config.response_cache_ttls.find(policy.name);
+    uint32_t seconds =
+        ttl != m_config.response_cache_ttls.end() ? ttl->second : policy.ttl;
+    if (seconds == 0)
+      continue;
+
+    uint16_t msg_type = proto_map.getMessageType(2, policy.name);
+    cache.enable(msg_type, chrono::seconds(seconds), policy.shared);
+    for (const char *write : policy.invalidated_by)
+      cache.invalidateOn(proto_map.getMessageType(2, write), msg_type);
+  }
+}
+
+/**
+ * Routes client requests to the worker lane of their message type and the
+ * replies back.
+ *
+ * Each lane has its own inproc DEALER and group of ClientWorkers. A request
+ * for a lane that already holds as many requests as it may is answered
+ * right away with a NackReply instead of being queued.
+ */
 void Server::msgRouter(LogContext log_context, int thread_count) {
   log_context.thread_name += "-msgRouter";
   log_context.thread_id = thread_count;
-  std::unordered_map<SocketRole, SocketOptions> socket_options;
-  std::unordered_map<SocketRole, ICredentials *> socket_credentials;
-
-  // Credentials are allocated on the heap, to ensure they last until the end of
-  // the test they must be defined outside of the scope block below
-  std::unique_ptr<ICredentials> client_credentials;
-
-  { // Proxy Client Credentials and Socket Options - these options are used
-    // to define the client socket that the proxy will use to communicate with
-    // the backend. The proxy acts like a client to the backend
-    SocketOptions client_socket_options;
-    client_socket_options.scheme = URIScheme::INPROC;
-    client_socket_options.class_type = SocketClassType::CLIENT;
-    client_socket_options.direction_type =
-        SocketDirectionalityType::BIDIRECTIONAL;
-    client_socket_options.communication_type =
-        SocketCommunicationType::ASYNCHRONOUS;
-    client_socket_options.connection_life = SocketConnectionLife::PERSISTENT;
-    client_socket_options.connection_security =
-        SocketConnectionSecurity::INSECURE;
-    client_socket_options.protocol_type = ProtocolType::ZQTP;
-    client_socket_options.host = "workers";
-    client_socket_options.local_id = "core_message_routing_client";
-    socket_options[SocketRole::CLIENT] = client_socket_options;
-
-    CredentialFactory cred_factory;
-    std::unordered_map<CredentialType, std::string> cred_options;
-
-    client_credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
-    socket_credentials[SocketRole::CLIENT] = client_credentials.get();
-  }
 
-  // Credentials are allocated on the heap, to ensure they last until the end of
-  // the test they must be defined outside of the scope block below
-  std::unique_ptr<ICredentials> server_credentials;
-
-  { // Proxy Server Credentials and Socket Options - these options are used
-    // to define the server socket that the proxy will use to communicate with
-    // the frontend. The proxy acts like a server to the frontend
-    SocketOptions server_socket_options;
-    server_socket_options.scheme = URIScheme::INPROC;
-    server_socket_options.class_type = SocketClassType::SERVER;
-    server_socket_options.direction_type =
-        SocketDirectionalityType::BIDIRECTIONAL;
-    server_socket_options.communication_type =
-        SocketCommunicationType::ASYNCHRONOUS;
-    server_socket_options.connection_life = SocketConnectionLife::PERSISTENT;
-    server_socket_options.connection_security =
-        SocketConnectionSecurity::INSECURE;
-    server_socket_options.protocol_type = ProtocolType::ZQTP;
-    server_socket_options.host = "msg_proc";
-    server_socket_options.local_id = "core_message_routing_server";
-    socket_options[SocketRole::SERVER] = server_socket_options;
-
-    CredentialFactory cred_factory;
-
-    std::unordered_map<CredentialType, std::string> cred_options;
-
-    server_credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
-    socket_credentials[SocketRole::SERVER] = server_credentials.get();
-  }
+  const uint32_t lane_workers[MessageLanes::LANE_COUNT] = {
+      m_config.num_client_worker_threads, m_config.num_query_worker_threads,
+      m_config.num_bulk_worker_threads};
+  const ProtoBufMap &proto_map = ProtoBufMap::getInstance();
 
-  ServerFactory server_factory(log_context);
-  auto proxy = server_factory.create(ServerType::PROXY_BASIC_ZMQ,
-                                     socket_options, socket_credentials);
+  CommunicatorFactory factory(log_context);
+  CredentialFactory cred_factory;
+  std::unordered_map<CredentialType, std::string> cred_options;
+  auto credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
+  const uint32_t timeout_on_receive = 50;
+  const long timeout_on_poll = 50;
+
+  // The server socket faces the secure and insecure interfaces
+  SocketOptions server_socket_options;
+  server_socket_options.scheme = URIScheme::INPROC;
+  server_socket_options.class_type = SocketClassType::SERVER;
+  server_socket_options.direction_type =
+      SocketDirectionalityType::BIDIRECTIONAL;
+  server_socket_options.communication_type =
+      SocketCommunicationType::ASYNCHRONOUS;
+  server_socket_options.connection_life = SocketConnectionLife::PERSISTENT;
+  server_socket_options.connection_security =
+      SocketConnectionSecurity::INSECURE;
+  server_socket_options.protocol_type = ProtocolType::ZQTP;
+  server_socket_options.host = "msg_proc";
+  server_socket_options.local_id = "core_message_routing_server";
+  server_socket_options.max_message_size = m_config.max_msg_size;
+  auto server = factory.create(server_socket_options, *credentials,
+                               timeout_on_receive, timeout_on_poll);
+
+  // One bound DEALER per lane, the lane's workers connect to it
+  std::unique_ptr<ICommunicator> lanes[MessageLanes::LANE_COUNT];
+  for (uint8_t l = 0; l < MessageLanes::LANE_COUNT; ++l) {
+    if (lane_workers[l] == 0)
+      continue;
+    SocketOptions lane_socket_options = server_socket_options;
+    lane_socket_options.class_type = SocketClassType::CLIENT;
+    lane_socket_options.host = MessageLanes::host((MessageLanes::Lane)l);
+    lane_socket_options.local_id = string("core_message_routing_") +
+                                   MessageLanes::name((MessageLanes::Lane)l);
+    // Both ends of this link are in process
+    lane_socket_options.wire_format = WireFormat::COMPACT;
+    lanes[l] = factory.create(lane_socket_options, *credentials,
+                              timeout_on_receive, timeout_on_poll);
+  }
 
   // Ceate worker threads
-  for (uint16_t t = 0; t < m_config.num_client_worker_threads; ++t) {
-    LogContext log_context_client = log_context;
-    log_context_client.thread_id = getNewThreadId();
-    m_workers.emplace_back(new ClientWorker(*this, t + 1, log_context_client));
+  size_t worker_id = 0;
+  for (uint8_t l = 0; l < MessageLanes::LANE_COUNT; ++l) {
+    const MessageLanes::Lane lane = (MessageLanes::Lane)l;
+    for (uint32_t t = 0; t < lane_workers[l]; ++t) {
+      LogContext log_context_client = log_context;
+      log_context_client.thread_id = getNewThreadId();
+      m_workers.emplace_back(new ClientWorker(
+          *this, ++worker_id, MessageLanes::host(lane), log_context_client));
+    }
+    DL_INFO(log_context, "Message lane " << MessageLanes::name(lane) << ": "
+                                         << lane_workers[l]
+                                         << " workers, capacity "
+                                         << m_msg_lanes.capacity(lane));
   }
 
-  proxy->run();
+  zmq_pollitem_t items[1 + MessageLanes::LANE_COUNT];
+  MessageLanes::Lane item_lanes[1 + MessageLanes::LANE_COUNT];
+  int num_items = 0;
+  items[num_items++] = {server->nativeHandle(), 0, ZMQ_POLLIN, 0};
+  for (uint8_t l = 0; l < MessageLanes::LANE_COUNT; ++l) {
+    if (lanes[l]) {
+      item_lanes[num_items] = (MessageLanes::Lane)l;
+      items[num_items++] = {lanes[l]->nativeHandle(), 0, ZMQ_POLLIN, 0};
+    }
+  }
+
+  const size_t max_burst_size = 128;
+  MessageFactory msg_factory;
+  auto next_expire = chrono::steady_clock::now() + chrono::minutes(1);
+
+  // Forwards up to max_burst_size messages, returns them one at a time
+  auto forwardBurst = [&](ICommunicator &a_from,
+                          const std::function<void(IMessage &)> &a_route) {
+    for (size_t count = 0; count < max_burst_size; ++count) {
+      if (count > 0 && !hasIncoming(a_from.nativeHandle()))
+        break;
+
+      auto response =
+          a_from.pollPassThrough(MessageType::GOOGLE_PROTOCOL_BUFFER);
+      if (response.error) {
+        DL_ERROR(log_context, a_from.id() << " error detected: "
+                                          << response.error_msg);
+        break;
+      } else if (response.time_out || !response.message) {
+        break;
+      }
+      a_route(*response.message);
+    }
+  };
+
+  auto routeRequest = [&](IMessage &a_msg) {
+    uint16_t msg_type =
+        std::get<uint16_t>(a_msg.get(constants::message::google::MSG_TYPE));
+    const std::string correlation_id =
+        std::get<std::string>(a_msg.get(MessageAttribute::CORRELATION_ID));
+    MessageLanes::Lane lane = m_msg_lanes.lane(msg_type);
+
+    if (m_msg_lanes.admit(lane, correlation_id)) {
+      lanes[lane]->send(a_msg);
+      return;
+    }
+
+    LogContext message_log_context = log_context;
+    message_log_context.correlation_id = correlation_id;
+    DL_WARNING(message_log_context,
+               "Message lane " << MessageLanes::name(lane) << " is full, "
+                               << proto_map.toString(msg_type) << " refused");
+    auto reply = msg_factory.createResponseEnvelope(a_msg);
+    auto nack = std::make_unique<Anon::NackReply>();
+    nack->set_err_code(ID_SERVICE_ERROR);
+    nack->set_err_msg("Server busy, try again later");
+    reply->setPayload(std::move(nack));
+    server->send(*reply);
+  };
+
+  auto routeReply = [&](IMessage &a_msg) {
+    m_msg_lanes.complete(
+        std::get<std::string>(a_msg.get(MessageAttribute::CORRELATION_ID)));
+    server->send(a_msg);
+  };
+
+  bool running = true;
+  while (running) {
+    try {
+      int events_detected = zmq_poll(items, num_items, 1000);
+
+      const auto now = chrono::steady_clock::now();
+      if (now >= next_expire) {
+        // Requests without a reply, e.g. of unknown types, must not hold on
+        // to their lane
+        size_t expired = m_msg_lanes.expire(now - LANE_REQUEST_TIMEOUT);
+        if (expired)
+          DL_WARNING(log_context, "No reply to " << expired
+                                                 << " requests in message lanes");
+        next_expire = now + chrono::minutes(1);
+      }
+
+      if (events_detected < 0) {
+        if (zmq_errno() == ETERM) {
+          // The context is shutting down, the sockets can no longer be used
+          DL_INFO(log_context, "msgRouter - context terminated, exiting");
+          running = false;
+        } else {
+          DL_ERROR(log_context, "msgRouter - zmq_poll failed: "
+                                    << zmq_strerror(zmq_errno()));
+        }
+        continue;
+      } else if (events_detected == 0) {
+        continue;
+      }
+
+      // Replies first, they free room in the lanes
+      for (int i = 1; i < num_items; ++i) {
+        if (items[i].revents & ZMQ_POLLIN)
+          forwardBurst(*lanes[item_lanes[i]], routeReply);
+      }
+
+      if (items[0].revents & ZMQ_POLLIN)
+        forwardBurst(*server, routeRequest);
+
+    } catch (TraceException &e) {
+      DL_ERROR(log_context, "msgRouter - " << e.toString());
+    } catch (exception &e) {
+      DL_ERROR(log_context, "msgRouter - " << e.what());
+    } catch (...) {
+      DL_ERROR(log_context, "msgRouter - unknown exception");
+    }
+  }
 
   // Clean-up workers
-  vector<std::shared_ptr<ClientWorker>>::iterator iwrk;
+  for (auto &worker : m_workers)
+    worker->stop();
 
-  for (iwrk = m_workers.begin(); iwrk != m_workers.end(); ++iwrk)
-    (*iwrk)->stop();
+  for (auto &worker : m_workers)
+    worker->wait();
 }
 
 int Server::getNewThreadId() {
@@ -299,6 +522,10 @@ void Server::ioSecure(LogContext log_context, int thread_count) {
       client_socket_options.host = "msg_proc";
       // client_socket_options.port = 1341;
       client_socket_options.local_id = "internal_facing_secure_proxy_client";
+      client_socket_options.max_message_size = m_config.max_msg_size;
+      // Both ends of this link are in process, the client workers answer in
+      // the same format
+      client_socket_options.wire_format = WireFormat::COMPACT;
       socket_options[SocketRole::CLIENT] = client_socket_options;
 
       CredentialFactory cred_factory;
@@ -331,6 +558,10 @@ void Server::ioSecure(LogContext log_context, int thread_count) {
       server_socket_options.host = "*";
       server_socket_options.port = m_config.port;
       server_socket_options.local_id = "external_facing_secure_proxy_server";
+      server_socket_options.max_message_size = m_config.max_msg_size;
+      // Requests are accepted from anyone, keep what they can make us buffer
+      // small. Replies may still be up to max_msg_size.
+      server_socket_options.max_receive_size = m_config.max_req_size;
       socket_options[SocketRole::SERVER] = server_socket_options;
 
       CredentialFactory cred_factory;
@@ -427,6 +658,7 @@ void Server::ioInsecure(LogContext log_context, int thread_count) {
       server_socket_options.host = "*";
       server_socket_options.port = m_config.port + 1;
       server_socket_options.local_id = "external_facing_secure_proxy_server";
+      server_socket_options.max_receive_size = m_config.max_req_size;
       socket_options[SocketRole::SERVER] = server_socket_options;
 
       CredentialFactory cred_factory;
@@ -508,6 +740,8 @@ void Server::metricsThread(LogContext log_context, int thread_count) {
   uint32_t total, subtot;
   uint32_t timestamp;
   map<string, MsgMetrics_t> metrics;
+  MsgMetrics_t expired;
+  const ProtoBufMap &proto_map = ProtoBufMap::getInstance();
 
   pc = purge_count;
 
@@ -522,6 +756,7 @@ void Server::metricsThread(LogContext log_context, int thread_count) {
         lock_guard<mutex> lock(m_msg_metrics_mutex);
 
         m_msg_metrics.swap(metrics);
+        m_expired_metrics.swap(expired);
       }
 
       timestamp = std::chrono::duration_cast<std::chrono::seconds>(
@@ -542,6 +777,71 @@ void Server::metricsThread(LogContext log_context, int thread_count) {
       db.metricsUpdateMsgCounts(timestamp, total, metrics, log_context);
       metrics.clear();
 
+      DatabaseConnectionPool::Stats pool_stats =
+          DatabaseConnectionPool::getInstance().getStats();
+      DL_DEBUG(log_context, "metrics: DB pool capacity "
+                                << pool_stats.capacity << ", created "
+                                << pool_stats.created << ", in use "
+                                << pool_stats.in_use << ", idle "
+                                << pool_stats.idle << ", acquired "
+                                << pool_stats.acquired << ", waited "
+                                << pool_stats.waited);
+      RepoConnectionPool::Stats repo_pool_stats =
+          RepoConnectionPool::getInstance().getStats();
+      DL_DEBUG(log_context, "metrics: repo pool created "
+                                << repo_pool_stats.created << ", in use "
+                                << repo_pool_stats.in_use << ", idle "
+                                << repo_pool_stats.idle << ", acquired "
+                                << repo_pool_stats.acquired << ", reused "
+                                << repo_pool_stats.reused << ", discarded "
+                                << repo_pool_stats.discarded);
+      DL_DEBUG(log_context,
+               "metrics: log lines dropped " << global_logger.droppedCount());
+      for (auto &drops : m_rate_limiter->takeDrops()) {
+        DL_INFO(log_context, "metrics: requests of " << drops.first
+                                                     << " over rate limit: "
+                                                     << drops.second);
+      }
+      m_rate_limiter->purge();
+      for (auto &exp : expired) {
+        DL_INFO(log_context, "metrics: requests of "
+                                 << proto_map.toString(exp.first)
+                                 << " dropped past their deadline: "
+                                 << exp.second);
+      }
+      expired.clear();
+      for (uint8_t l = 0; l < MessageLanes::LANE_COUNT; ++l) {
+        MessageLanes::LaneStats lane_stats =
+            m_msg_lanes.stats((MessageLanes::Lane)l);
+        DL_DEBUG(log_context, "metrics: message lane "
+                                  << MessageLanes::name((MessageLanes::Lane)l)
+                                  << " " << lane_stats.in_flight
+                                  << " in flight, routed "
+                                  << lane_stats.routed << ", refused "
+                                  << lane_stats.refused);
+      }
+      ResponseCache::Stats cache_stats =
+          ResponseCache::getInstance().getStats();
+      DL_DEBUG(log_context, "metrics: response cache hits "
+                                << cache_stats.hits << ", misses "
+                                << cache_stats.misses << ", stored "
+                                << cache_stats.stored << ", expired "
+                                << cache_stats.expired << ", evicted "
+                                << cache_stats.evicted << ", invalidations "
+                                << cache_stats.invalidations << ", entries "
+                                << cache_stats.entries << ", bytes "
+                                << cache_stats.bytes);
+      for (auto &depth : TaskMgr::getInstance().getQueueDepths()) {
+        DL_DEBUG(log_context, "metrics: ready tasks of "
+                                  << depth.first << ": " << depth.second);
+      }
+      for (auto &target : TaskMgr::getInstance().getTargetStats()) {
+        DL_DEBUG(log_context, "metrics: task steps on "
+                                  << target.first << ": "
+                                  << target.second.in_flight << " running, "
+                                  << target.second.waiting << " waiting");
+      }
+
       if (--pc == 0) {
         DL_DEBUG(log_context, "metrics: purging");
         db.metricsPurge(timestamp - m_config.metrics_purge_age, log_context);
@@ -573,6 +873,11 @@ void Server::authenticateClient(const std::string &a_cert_uid,
   }
 }
 
+// Triggered by client worker
+void Server::revokeClientKeys(const std::string &a_uid) {
+  m_auth_manager.invalidateUserKeys(a_uid);
+}
+
 void Server::metricsUpdateMsgCount(const std::string &a_uid,
                                    uint16_t a_msg_type) {
   lock_guard<mutex> lock(m_msg_metrics_mutex);
@@ -589,5 +894,10 @@ void Server::metricsUpdateMsgCount(const std::string &a_uid,
   }
 }
 
+void Server::metricsRequestExpired(uint16_t a_msg_type) {
+  lock_guard<mutex> lock(m_msg_metrics_mutex);
+  m_expired_metrics[a_msg_type]++;
+}
+
 } // namespace Core
 } // namespace SDMS
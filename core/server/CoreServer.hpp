@@ -6,6 +6,8 @@
 #include "AuthenticationManager.hpp"
 #include "Config.hpp"
 #include "ICoreServer.hpp"
+#include "MessageLanes.hpp"
+#include "RateLimiter.hpp"
 
 // Public common includes
 #include "common/DynaLog.hpp"
@@ -82,10 +84,14 @@ private:
                           const std::string &a_key, const std::string &a_uid,
                           LogContext log_context);
   void metricsUpdateMsgCount(const std::string &a_uid, uint16_t a_msg_type);
+  void metricsRequestExpired(uint16_t a_msg_type);
+  void revokeClientKeys(const std::string &a_uid);
   // bool isClientAuthenticated( const std::string & a_client_key, std::string &
   // a_uid );
   void loadKeys(const std::string &a_cred_dir);
   void loadRepositoryConfig();
+  void setupMsgLanes();
+  void setupResponseCache();
   void msgRouter(LogContext log_context, int thread_count);
   void ioSecure(LogContext log_context, int thread_count);
   void ioInsecure(LogContext log_context, int thread_count);
@@ -102,11 +108,14 @@ private:
   std::thread m_msg_router_thread;  ///< Main message router thread handle
   std::vector<std::shared_ptr<ClientWorker>>
       m_workers;                   ///< List of ClientWorker instances
+  MessageLanes m_msg_lanes;        ///< Lanes of the message router
+  std::shared_ptr<RateLimiter> m_rate_limiter; ///< Request limits of users
   std::thread m_db_maint_thread;   ///< DB maintenance thread handle
   std::thread m_metrics_thread;    ///< Metrics gathering thread handle
   std::thread m_repo_cache_thread; ///< Thread for updating the repo cache
   std::map<std::string, MsgMetrics_t>
       m_msg_metrics;              ///< Map of UID to message request metrics
+  MsgMetrics_t m_expired_metrics; ///< Expired requests per message type
   std::mutex m_msg_metrics_mutex; ///< Mutex for metrics updates
   LogContext m_log_context;
   std::mutex m_thread_count_mutex; ///< Mutex for metrics updates
@@ -1,6 +1,8 @@
 
 // Local private includes
 #include "DatabaseAPI.hpp"
+#include "DatabaseEventLoop.hpp"
+#include "DatabaseReplyStream.hpp"
 
 // Local public includes
 #include "common/DynaLog.hpp"
@@ -41,26 +43,38 @@ using namespace libjson;
 DatabaseAPI::DatabaseAPI(const std::string &a_db_url,
                          const std::string &a_db_user,
                          const std::string &a_db_pass)
-    : m_client(0), m_db_url(a_db_url) {
-  m_curl = curl_easy_init();
-  if (!m_curl)
-    EXCEPT(ID_INTERNAL_ERROR, "libcurl init failed");
-
+    : m_client(0), m_db_url(a_db_url), m_db_user(a_db_user),
+      m_db_pass(a_db_pass) {
   setClient("");
-
-  curl_easy_setopt(m_curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
-  curl_easy_setopt(m_curl, CURLOPT_USERNAME, a_db_user.c_str());
-  curl_easy_setopt(m_curl, CURLOPT_PASSWORD, a_db_pass.c_str());
-  curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, curlResponseWriteCB);
-  curl_easy_setopt(m_curl, CURLOPT_SSL_VERIFYPEER, 0);
-  curl_easy_setopt(m_curl, CURLOPT_TCP_NODELAY, 1);
 }
 
 DatabaseAPI::~DatabaseAPI() {
   if (m_client)
     curl_free(m_client);
+}
 
-  curl_easy_cleanup(m_curl);
+/**
+ * Borrows a keep-alive handle from the shared pool and applies the options
+ * owned by this instance. Handles may have been used by another DatabaseAPI
+ * instance, so everything that is not common to all DB requests must be set
+ * here or by the caller.
+ */
+DatabaseConnectionPool::Handle DatabaseAPI::acquireHandle() {
+  DatabaseConnectionPool::Handle handle =
+      DatabaseConnectionPool::getInstance().acquire();
+  setHandleOptions(handle.get(), m_db_user, m_db_pass);
+
+  return handle;
+}
+
+void DatabaseAPI::setHandleOptions(CURL *a_curl, const std::string &a_db_user,
+                                   const std::string &a_db_pass) {
+  curl_easy_setopt(a_curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+  curl_easy_setopt(a_curl, CURLOPT_USERNAME, a_db_user.c_str());
+  curl_easy_setopt(a_curl, CURLOPT_PASSWORD, a_db_pass.c_str());
+  curl_easy_setopt(a_curl, CURLOPT_WRITEFUNCTION, curlResponseWriteCB);
+  curl_easy_setopt(a_curl, CURLOPT_SSL_VERIFYPEER, 0);
+  curl_easy_setopt(a_curl, CURLOPT_TCP_NODELAY, 1);
 }
 
 void DatabaseAPI::setClient(const std::string &a_client) {
@@ -74,7 +88,7 @@ void DatabaseAPI::setClient(const std::string &a_client) {
   if (m_client)
     curl_free(m_client);
 
-  m_client = curl_easy_escape(m_curl, a_client.c_str(), 0);
+  m_client = curl_easy_escape(nullptr, a_client.c_str(), 0);
 }
 
 const std::string DatabaseAPI::buildSearchParamURL(
@@ -97,7 +111,7 @@ const std::string DatabaseAPI::buildSearchParamURL(
     url.append("&");
     url.append(iparam->first.c_str());
     url.append("=");
-    esc_txt = curl_easy_escape(m_curl, iparam->second.c_str(), 0);
+    esc_txt = curl_easy_escape(nullptr, iparam->second.c_str(), 0);
     url.append(esc_txt);
     curl_free(esc_txt);
   }
@@ -122,45 +136,63 @@ long DatabaseAPI::dbGet(const char *a_url_path,
   const string url = buildSearchParamURL(a_url_path, a_params);
 
   DL_DEBUG(log_context, "get url: " << url);
-  curl_easy_setopt(m_curl, CURLOPT_URL, url.c_str());
-  curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, &res_json);
-  curl_easy_setopt(m_curl, CURLOPT_ERRORBUFFER, error);
-  curl_easy_setopt(m_curl, CURLOPT_HTTPGET, 1);
+  DatabaseConnectionPool::Handle handle = acquireHandle();
+  CURL *curl = handle.get();
+
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res_json);
+  curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, error);
+  curl_easy_setopt(curl, CURLOPT_HTTPGET, 1);
 
-  CURLcode res = curl_easy_perform(m_curl);
+  CURLcode res = curl_easy_perform(curl);
 
   long http_code = 0;
-  curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &http_code);
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+
+  return dbResponse(res, http_code, res_json, error, a_result, log_context);
+}
 
-  if (res == CURLE_OK) {
-    if (res_json.size()) {
+/**
+ * Interprets the outcome of a DB request: parses the reply body into a_result
+ * and throws on transport failures or non-2xx status codes. This is static
+ * so that asynchronous completions do not depend on the DatabaseAPI instance
+ * that issued the request.
+ */
+long DatabaseAPI::dbResponse(CURLcode a_res, long a_http_code,
+                             const std::string &a_res_json,
+                             const char *a_error, libjson::Value &a_result,
+                             LogContext log_context) {
+  if (a_res == CURLE_OK) {
+    if (a_res_json.size()) {
       try {
-        a_result.fromString(res_json);
+        a_result.fromString(a_res_json);
       } catch (libjson::ParseError &e) {
-        DL_DEBUG(log_context, "PARSE [" << res_json << "]");
+        DL_DEBUG(log_context, "PARSE [" << a_res_json << "]");
         EXCEPT_PARAM(ID_SERVICE_ERROR,
                      "Invalid JSON returned from DB: " << e.toString());
       }
     }
 
-    if (http_code >= 200 && http_code < 300) {
-      return http_code;
+    if (a_http_code >= 200 && a_http_code < 300) {
+      return a_http_code;
     } else {
-      if (res_json.size() && a_result.asObject().has("errorMessage")) {
+      if (a_res_json.size() && a_result.asObject().has("errorMessage")) {
         EXCEPT_PARAM(ID_BAD_REQUEST, a_result.asObject().asString());
       } else {
         EXCEPT_PARAM(ID_BAD_REQUEST, "SDMS DB service call failed. Code: "
-                                         << http_code << ", err: " << error);
+                                         << a_http_code << ", err: "
+                                         << a_error);
       }
     }
   } else {
     EXCEPT_PARAM(ID_SERVICE_ERROR, "SDMS DB interface failed. error: "
-                                       << error << ", "
-                                       << curl_easy_strerror(res));
+                                       << a_error << ", "
+                                       << curl_easy_strerror(a_res));
   }
 }
 
-bool DatabaseAPI::dbGetRaw(const std::string url, string &a_result) {
+bool DatabaseAPI::dbGetRaw(const std::string url, string &a_result,
+                           long *a_http_code) {
   a_result.clear();
 
   char error[CURL_ERROR_SIZE];
@@ -168,21 +200,60 @@ bool DatabaseAPI::dbGetRaw(const std::string url, string &a_result) {
   a_result.clear();
   error[0] = 0;
 
-  curl_easy_setopt(m_curl, CURLOPT_URL, url.c_str());
-  curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, &a_result);
-  curl_easy_setopt(m_curl, CURLOPT_ERRORBUFFER, error);
-  curl_easy_setopt(m_curl, CURLOPT_HTTPGET, 1);
+  DatabaseConnectionPool::Handle handle = acquireHandle();
+  CURL *curl = handle.get();
+
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &a_result);
+  curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, error);
+  curl_easy_setopt(curl, CURLOPT_HTTPGET, 1);
 
-  CURLcode res = curl_easy_perform(m_curl);
+  CURLcode res = curl_easy_perform(curl);
 
   long http_code = 0;
-  curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &http_code);
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+  if (a_http_code)
+    *a_http_code = res == CURLE_OK ? http_code : 0;
+
   if (res == CURLE_OK && (http_code >= 200 && http_code < 300))
     return true;
   else
     return false;
 }
 
+/**
+ * Asynchronous dbGetRaw, the reply body is handed to the callback as is.
+ * Never blocks, the handle is borrowed by the DatabaseEventLoop.
+ */
+void DatabaseAPI::dbGetRawAsync(const string &a_url,
+                                uid_callback_t a_callback) {
+  struct AsyncCall {
+    string url;
+    string db_user;
+    string db_pass;
+    string result;
+    char error[CURL_ERROR_SIZE];
+  };
+
+  auto call = make_shared<AsyncCall>();
+  call->url = a_url;
+  call->db_user = m_db_user;
+  call->db_pass = m_db_pass;
+  call->error[0] = 0;
+
+  DatabaseEventLoop::getInstance().submit(
+      [call](CURL *a_curl) {
+        setHandleOptions(a_curl, call->db_user, call->db_pass);
+        curl_easy_setopt(a_curl, CURLOPT_URL, call->url.c_str());
+        curl_easy_setopt(a_curl, CURLOPT_WRITEDATA, &call->result);
+        curl_easy_setopt(a_curl, CURLOPT_ERRORBUFFER, call->error);
+        curl_easy_setopt(a_curl, CURLOPT_HTTPGET, 1);
+      },
+      [call, a_callback](CURLcode a_res, long a_http_code) {
+        a_callback(a_res == CURLE_OK ? a_http_code : 0, call->result);
+      });
+}
+
 long DatabaseAPI::dbPost(const char *a_url_path,
                          const vector<pair<string, string>> &a_params,
                          const string *a_body, Value &a_result,
@@ -199,51 +270,236 @@ long DatabaseAPI::dbPost(const char *a_url_path,
   // TODO: construct URL outside of function
   const string url = buildSearchParamURL(a_url_path, a_params);
 
-  curl_easy_setopt(m_curl, CURLOPT_URL, url.c_str());
-  curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, &res_json);
-  curl_easy_setopt(m_curl, CURLOPT_ERRORBUFFER, error);
-  curl_easy_setopt(m_curl, CURLOPT_POST, 1);
+  DatabaseConnectionPool::Handle handle = acquireHandle();
+  CURL *curl = handle.get();
+
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res_json);
+  curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, error);
+  curl_easy_setopt(curl, CURLOPT_POST, 1);
 
   // libcurl seems to no longer work with POSTs without a body, so must set body
   // to an empty string
-  curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS,
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDS,
                    a_body ? a_body->c_str() : empty_body);
 
-  CURLcode res = curl_easy_perform(m_curl);
+  CURLcode res = curl_easy_perform(curl);
 
   long http_code = 0;
-  curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &http_code);
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
 
-  if (res == CURLE_OK) {
-    if (res_json.size()) {
-      try {
-        a_result.fromString(res_json);
-      } catch (libjson::ParseError &e) {
-        DL_DEBUG(log_context, "PARSE [" << res_json << "]");
-        EXCEPT_PARAM(ID_SERVICE_ERROR,
-                     "Invalid JSON returned from DB: " << e.toString());
-      }
-    }
+  if (res == CURLE_OK && (http_code < 200 || http_code >= 300)) {
+    DL_DEBUG(log_context, "dbPost FAILED " << url << " ["
+                                           << (a_body ? *a_body : "") << "]");
+  }
 
-    if (http_code >= 200 && http_code < 300) {
-      return http_code;
-    } else {
-      if (res_json.size() && a_result.asObject().has("errorMessage")) {
-        DL_DEBUG(log_context, "dbPost FAILED " << url << " ["
-                                               << (a_body ? *a_body : "")
-                                               << "]");
+  return dbResponse(res, http_code, res_json, error, a_result, log_context);
+}
 
-        EXCEPT_PARAM(ID_BAD_REQUEST, a_result.asObject().asString());
-      } else {
-        EXCEPT_PARAM(ID_BAD_REQUEST, "SDMS DB service call failed. Code: "
-                                         << http_code << ", err: " << error);
-      }
-    }
+long DatabaseAPI::dbGetStream(const char *a_url_path,
+                              const vector<pair<string, string>> &a_params,
+                              db_item_fun_t a_item_fun,
+                              LogContext log_context) {
+  const string url = buildSearchParamURL(a_url_path, a_params);
+
+  DL_DEBUG(log_context, "get url: " << url);
+  return dbStream(url, false, nullptr, a_item_fun, log_context);
+}
+
+long DatabaseAPI::dbPostStream(const char *a_url_path,
+                               const vector<pair<string, string>> &a_params,
+                               const string *a_body, db_item_fun_t a_item_fun,
+                               LogContext log_context) {
+  const string url = buildSearchParamURL(a_url_path, a_params);
+
+  return dbStream(url, true, a_body, a_item_fun, log_context);
+}
+
+/**
+ * Performs a DB request whose reply is a JSON array, passing each element to
+ * a_item_fun as soon as it has been received. Only one element is parsed at a
+ * time, so the reply is never held in full (as text or as a DOM). Errors are
+ * reported exactly as by dbGet/dbPost.
+ */
+long DatabaseAPI::dbStream(const string &a_url, bool a_post,
+                           const string *a_body, db_item_fun_t a_item_fun,
+                           LogContext log_context) {
+  static const char *empty_body = "";
+
+  char error[CURL_ERROR_SIZE];
+
+  error[0] = 0;
+
+  DatabaseConnectionPool::Handle handle = acquireHandle();
+  CURL *curl = handle.get();
+
+  Value item;
+  DatabaseReplyStream stream(
+      curl, [&item, &a_item_fun, log_context](const string &a_element) {
+        try {
+          item.fromString(a_element);
+        } catch (libjson::ParseError &e) {
+          DL_DEBUG(log_context, "PARSE [" << a_element << "]");
+          EXCEPT_PARAM(ID_SERVICE_ERROR,
+                       "Invalid JSON returned from DB: " << e.toString());
+        }
+
+        a_item_fun(item);
+      });
+
+  curl_easy_setopt(curl, CURLOPT_URL, a_url.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
+                   DatabaseReplyStream::curlWriteCB);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &stream);
+  curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, error);
+
+  if (a_post) {
+    curl_easy_setopt(curl, CURLOPT_POST, 1);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS,
+                     a_body ? a_body->c_str() : empty_body);
   } else {
-    EXCEPT_PARAM(ID_SERVICE_ERROR, "SDMS DB interface failed. error: "
-                                       << error << ", "
-                                       << curl_easy_strerror(res));
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1);
+  }
+
+  CURLcode res = curl_easy_perform(curl);
+
+  long http_code = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+
+  // Failure translating an element aborts the transfer, report that first
+  if (stream.error())
+    rethrow_exception(stream.error());
+
+  if (stream.streamed() && res == CURLE_OK) {
+    if (!stream.complete())
+      EXCEPT(ID_SERVICE_ERROR, "Invalid JSON returned from DB: truncated array");
+
+    return http_code;
   }
+
+  // Error replies (and anything that is not an array) were buffered as-is
+  Value result;
+  dbResponse(res, http_code, stream.raw(), error, result, log_context);
+
+  TRANSLATE_BEGIN()
+  result.asArray();
+  TRANSLATE_END(result, log_context)
+
+  return http_code;
+}
+
+void DatabaseAPI::dbGetAsync(const char *a_url_path,
+                             const vector<pair<string, string>> &a_params,
+                             db_callback_t a_callback, LogContext log_context) {
+  const string url = buildSearchParamURL(a_url_path, a_params);
+
+  DL_DEBUG(log_context, "async get url: " << url);
+  dbAsync(url, false, nullptr, std::move(a_callback), log_context);
+}
+
+void DatabaseAPI::dbPostAsync(const char *a_url_path,
+                              const vector<pair<string, string>> &a_params,
+                              const string *a_body, db_callback_t a_callback,
+                              LogContext log_context) {
+  const string url = buildSearchParamURL(a_url_path, a_params);
+
+  dbAsync(url, true, a_body, std::move(a_callback), log_context);
+}
+
+std::future<libjson::Value>
+DatabaseAPI::dbGetAsync(const char *a_url_path,
+                        const vector<pair<string, string>> &a_params,
+                        LogContext log_context) {
+  auto promise = make_shared<std::promise<Value>>();
+  std::future<Value> future = promise->get_future();
+
+  dbGetAsync(
+      a_url_path, a_params,
+      [promise](Value &a_result, exception_ptr a_error) {
+        if (a_error)
+          promise->set_exception(a_error);
+        else
+          promise->set_value(std::move(a_result));
+      },
+      log_context);
+
+  return future;
+}
+
+std::future<libjson::Value>
+DatabaseAPI::dbPostAsync(const char *a_url_path,
+                         const vector<pair<string, string>> &a_params,
+                         const string *a_body, LogContext log_context) {
+  auto promise = make_shared<std::promise<Value>>();
+  std::future<Value> future = promise->get_future();
+
+  dbPostAsync(
+      a_url_path, a_params, a_body,
+      [promise](Value &a_result, exception_ptr a_error) {
+        if (a_error)
+          promise->set_exception(a_error);
+        else
+          promise->set_value(std::move(a_result));
+      },
+      log_context);
+
+  return future;
+}
+
+/**
+ * Hands the request to the shared DatabaseEventLoop, which configures a
+ * pooled handle for it once one is free. All buffers and credentials the
+ * transfer uses are owned by the closures rather than by this instance, so
+ * the DatabaseAPI may be destroyed while the request is still in flight.
+ */
+void DatabaseAPI::dbAsync(const string &a_url, bool a_post,
+                          const string *a_body, db_callback_t a_callback,
+                          LogContext log_context) {
+  struct AsyncCall {
+    string url;
+    string db_user;
+    string db_pass;
+    string body;
+    string res_json;
+    char error[CURL_ERROR_SIZE];
+  };
+
+  auto call = make_shared<AsyncCall>();
+  call->url = a_url;
+  call->db_user = m_db_user;
+  call->db_pass = m_db_pass;
+  if (a_body)
+    call->body = *a_body;
+  call->error[0] = 0;
+
+  DatabaseEventLoop::getInstance().submit(
+      [call, a_post](CURL *a_curl) {
+        setHandleOptions(a_curl, call->db_user, call->db_pass);
+        curl_easy_setopt(a_curl, CURLOPT_URL, call->url.c_str());
+        curl_easy_setopt(a_curl, CURLOPT_WRITEDATA, &call->res_json);
+        curl_easy_setopt(a_curl, CURLOPT_ERRORBUFFER, call->error);
+
+        if (a_post) {
+          curl_easy_setopt(a_curl, CURLOPT_POST, 1);
+          // See dbPost, libcurl needs a body (even if empty) on POSTs
+          curl_easy_setopt(a_curl, CURLOPT_POSTFIELDS, call->body.c_str());
+        } else {
+          curl_easy_setopt(a_curl, CURLOPT_HTTPGET, 1);
+        }
+      },
+      [call, a_callback, log_context](CURLcode a_res, long a_http_code) {
+        Value result;
+        exception_ptr error;
+
+        try {
+          dbResponse(a_res, a_http_code, call->res_json, call->error, result,
+                     log_context);
+        } catch (...) {
+          error = current_exception();
+        }
+
+        a_callback(result, error);
+      });
 }
 
 void DatabaseAPI::serverPing(LogContext log_context) {
@@ -291,6 +547,20 @@ bool DatabaseAPI::uidByPubKey(const std::string &a_pub_key,
   return dbGetRaw(url, a_uid);
 }
 
+bool DatabaseAPI::uidByPubKey(const std::string &a_pub_key, std::string &a_uid,
+                              long &a_http_code) {
+  const string url =
+      buildSearchParamURL("usr/find/by_pub_key", {{"pub_key", a_pub_key}});
+  return dbGetRaw(url, a_uid, &a_http_code);
+}
+
+void DatabaseAPI::uidByPubKeyAsync(const std::string &a_pub_key,
+                                   uid_callback_t a_callback) {
+  const string url =
+      buildSearchParamURL("usr/find/by_pub_key", {{"pub_key", a_pub_key}});
+  dbGetRawAsync(url, std::move(a_callback));
+}
+
 bool DatabaseAPI::userGetKeys(std::string &a_pub_key, std::string &a_priv_key,
                               LogContext log_context) {
   Value result;
@@ -751,7 +1021,6 @@ void DatabaseAPI::projView(const Auth::ProjectViewRequest &a_request,
 void DatabaseAPI::projList(const Auth::ProjectListRequest &a_request,
                            Auth::ListingReply &a_reply,
                            LogContext log_context) {
-  Value result;
   vector<pair<string, string>> params;
   if (a_request.has_subject())
     params.push_back({"subject", a_request.subject()});
@@ -770,9 +1039,8 @@ void DatabaseAPI::projList(const Auth::ProjectListRequest &a_request,
   if (a_request.has_count())
     params.push_back({"count", to_string(a_request.count())});
 
-  dbGet("prj/list", params, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("prj/list", params, listingItemHandler(a_reply, log_context),
+              log_context);
 }
 
 void DatabaseAPI::projGetRole(const Auth::ProjectGetRoleRequest &a_request,
@@ -857,7 +1125,6 @@ void DatabaseAPI::setProjectData(Auth::ProjectDataReply &a_reply,
 void DatabaseAPI::recordListByAlloc(
     const Auth::RecordListByAllocRequest &a_request,
     Auth::ListingReply &a_reply, LogContext log_context) {
-  Value result;
   vector<pair<string, string>> params;
   params.push_back({"repo", a_request.repo()});
   params.push_back({"subject", a_request.subject()});
@@ -866,9 +1133,8 @@ void DatabaseAPI::recordListByAlloc(
   if (a_request.has_count())
     params.push_back({"count", to_string(a_request.count())});
 
-  dbGet("/dat/list/by_alloc", params, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("/dat/list/by_alloc", params,
+              listingItemHandler(a_reply, log_context), log_context);
 }
 
 void DatabaseAPI::recordView(const Auth::RecordViewRequest &a_request,
@@ -1074,6 +1340,60 @@ void DatabaseAPI::recordUpdateSchemaError(const std::string &a_rec_id,
          log_context);
 }
 
+void DatabaseAPI::recordUpdateSchemaErrorBatch(
+    const std::vector<std::pair<std::string, std::string>> &a_errors,
+    LogContext log_context) {
+  libjson::Value result;
+
+  nlohmann::json payload;
+
+  nlohmann::json records = nlohmann::json::array();
+  for (const auto &error : a_errors) {
+    nlohmann::json record_entry;
+    record_entry["id"] = error.first;
+    record_entry["msg"] = error.second;
+    records.push_back(record_entry);
+  }
+  payload["records"] = records;
+
+  string body = payload.dump(-1, ' ', true);
+
+  dbPost("dat/update/md_err_msg/batch", {}, &body, result, log_context);
+}
+
+std::vector<DatabaseAPI::RecordMetadata>
+DatabaseAPI::recordViewMetadataBatch(const std::vector<std::string> &a_ids,
+                                     LogContext log_context) {
+  Value result;
+
+  nlohmann::json payload;
+  payload["ids"] = a_ids;
+
+  string body = payload.dump(-1, ' ', true);
+
+  dbPost("dat/view/metadata/batch", {}, &body, result, log_context);
+
+  const Value::Array &arr = result.asObject().getArray("results");
+  if (arr.size() != a_ids.size())
+    EXCEPT(ID_INTERNAL_ERROR, "Unexpected number of records from DB");
+
+  vector<RecordMetadata> records(arr.size());
+  for (size_t i = 0; i < arr.size(); i++) {
+    const Value::Object &obj = arr[i].asObject();
+
+    if (obj.has("error")) {
+      records[i].error = obj.asString();
+      continue;
+    }
+    if (obj.has("md"))
+      records[i].metadata = obj.asString();
+    if (obj.has("sch_id"))
+      records[i].sch_id = obj.asString();
+  }
+
+  return records;
+}
+
 void DatabaseAPI::recordExport(const Auth::RecordExportRequest &a_request,
                                Auth::RecordExportReply &a_reply,
                                LogContext log_context) {
@@ -1103,7 +1423,6 @@ void DatabaseAPI::recordExport(const Auth::RecordExportRequest &a_request,
 void DatabaseAPI::recordLock(const Auth::RecordLockRequest &a_request,
                              Auth::ListingReply &a_reply,
                              LogContext log_context) {
-  Value result;
   string ids;
 
   if (a_request.id_size() > 0) {
@@ -1118,21 +1437,16 @@ void DatabaseAPI::recordLock(const Auth::RecordLockRequest &a_request,
   } else
     ids = "[]";
 
-  dbGet("dat/lock",
-        {{"ids", ids}, {"lock", a_request.lock() ? "true" : "false"}}, result,
-        log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("dat/lock",
+              {{"ids", ids}, {"lock", a_request.lock() ? "true" : "false"}},
+              listingItemHandler(a_reply, log_context), log_context);
 }
 
 void DatabaseAPI::recordGetDependencyGraph(
     const Auth::RecordGetDependencyGraphRequest &a_request,
     Auth::ListingReply &a_reply, LogContext log_context) {
-  Value result;
-
-  dbGet("dat/dep/graph/get", {{"id", a_request.id()}}, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("dat/dep/graph/get", {{"id", a_request.id()}},
+              listingItemHandler(a_reply, log_context), log_context);
 }
 
 void DatabaseAPI::setRecordData(Auth::RecordDataReply &a_reply,
@@ -1279,7 +1593,6 @@ void DatabaseAPI::dataPath(const Auth::DataPathRequest &a_request,
 void DatabaseAPI::generalSearch(const Auth::SearchRequest &a_request,
                                 Auth::ListingReply &a_reply,
                                 LogContext log_context) {
-  Value result;
   string qry_begin, qry_end, qry_filter, params;
 
   uint32_t cnt = parseSearchRequest(a_request, qry_begin, qry_end, qry_filter,
@@ -1298,15 +1611,13 @@ void DatabaseAPI::generalSearch(const Auth::SearchRequest &a_request,
 
   DL_DEBUG(log_context, "Query: [" << body << "]");
 
-  dbPost("qry/exec/direct", {}, &body, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbPostStream("qry/exec/direct", {}, &body,
+               listingItemHandler(a_reply, log_context), log_context);
 }
 
 void DatabaseAPI::collListPublished(
     const Auth::CollListPublishedRequest &a_request,
     Auth::ListingReply &a_reply, LogContext log_context) {
-  Value result;
   vector<pair<string, string>> params;
 
   if (a_request.has_subject())
@@ -1316,9 +1627,8 @@ void DatabaseAPI::collListPublished(
   if (a_request.has_count())
     params.push_back({"count", to_string(a_request.count())});
 
-  dbGet("col/published/list", params, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("col/published/list", params,
+              listingItemHandler(a_reply, log_context), log_context);
 }
 
 void DatabaseAPI::collCreate(const Auth::CollCreateRequest &a_request,
@@ -1410,7 +1720,6 @@ void DatabaseAPI::collView(const Auth::CollViewRequest &a_request,
 void DatabaseAPI::collRead(const Auth::CollReadRequest &a_request,
                            Auth::ListingReply &a_reply,
                            LogContext log_context) {
-  Value result;
   vector<pair<string, string>> params;
   params.push_back({"id", a_request.id()});
   if (a_request.has_offset())
@@ -1418,9 +1727,8 @@ void DatabaseAPI::collRead(const Auth::CollReadRequest &a_request,
   if (a_request.has_count())
     params.push_back({"count", to_string(a_request.count())});
 
-  dbGet("col/read", params, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("col/read", params, listingItemHandler(a_reply, log_context),
+              log_context);
 }
 
 void DatabaseAPI::collWrite(const Auth::CollWriteRequest &a_request,
@@ -1455,11 +1763,8 @@ void DatabaseAPI::collWrite(const Auth::CollWriteRequest &a_request,
     params.push_back({"remove", rem_list});
   }
 
-  Value result;
-
-  dbGet("col/write", params, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("col/write", params, listingItemHandler(a_reply, log_context),
+              log_context);
 }
 
 void DatabaseAPI::collMove(const Auth::CollMoveRequest &a_request,
@@ -1620,30 +1925,36 @@ void DatabaseAPI::setCollPathData(CollPathReply &a_reply,
   TRANSLATE_END(a_result, log_context)
 }
 
-void DatabaseAPI::setListingDataReply(Auth::ListingReply &a_reply,
-                                      const libjson::Value &a_result,
-                                      LogContext log_context) {
-  Value::ObjectConstIter j;
+/**
+ * Returns an element handler for dbGetStream/dbPostStream that fills a_reply
+ * from a listing reply, one element at a time.
+ */
+DatabaseAPI::db_item_fun_t
+DatabaseAPI::listingItemHandler(Auth::ListingReply &a_reply,
+                                LogContext log_context) {
+  return [this, &a_reply, log_context](const Value &a_item) {
+    TRANSLATE_BEGIN()
 
-  TRANSLATE_BEGIN()
+    setListingDataItem(a_reply, a_item, log_context);
 
-  const Value::Array &arr = a_result.asArray();
+    TRANSLATE_END(a_item, log_context)
+  };
+}
 
-  for (Value::ArrayConstIter i = arr.begin(); i != arr.end(); i++) {
-    const Value::Object &obj = i->asObject();
+void DatabaseAPI::setListingDataItem(Auth::ListingReply &a_reply,
+                                     const libjson::Value &a_item,
+                                     LogContext log_context) {
+  const Value::Object &obj = a_item.asObject();
 
-    if (obj.has("paging")) {
-      const Value::Object &obj2 = obj.asObject();
+  if (obj.has("paging")) {
+    const Value::Object &obj2 = obj.asObject();
 
-      a_reply.set_offset(obj2.getNumber("off"));
-      a_reply.set_count(obj2.getNumber("cnt"));
-      a_reply.set_total(obj2.getNumber("tot"));
-    } else {
-      setListingData(a_reply.add_item(), obj, log_context);
-    }
+    a_reply.set_offset(obj2.getNumber("off"));
+    a_reply.set_count(obj2.getNumber("cnt"));
+    a_reply.set_total(obj2.getNumber("tot"));
+  } else {
+    setListingData(a_reply.add_item(), obj, log_context);
   }
-
-  TRANSLATE_END(a_result, log_context)
 }
 
 void DatabaseAPI::setListingData(ListingData *a_item,
@@ -1716,16 +2027,14 @@ void DatabaseAPI::setListingData(ListingData *a_item,
 void DatabaseAPI::queryList(const Auth::QueryListRequest &a_request,
                             Auth::ListingReply &a_reply,
                             LogContext log_context) {
-  Value result;
   vector<pair<string, string>> params;
   if (a_request.has_offset())
     params.push_back({"offset", to_string(a_request.offset())});
   if (a_request.has_count())
     params.push_back({"count", to_string(a_request.count())});
 
-  dbGet("qry/list", params, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("qry/list", params, listingItemHandler(a_reply, log_context),
+              log_context);
 }
 
 void DatabaseAPI::queryCreate(const Auth::QueryCreateRequest &a_request,
@@ -1840,7 +2149,6 @@ void DatabaseAPI::queryView(const Auth::QueryViewRequest &a_request,
 void DatabaseAPI::queryExec(const Auth::QueryExecRequest &a_request,
                             Auth::ListingReply &a_reply,
                             LogContext log_context) {
-  Value result;
   vector<pair<string, string>> params;
 
   params.push_back({"id", a_request.id()});
@@ -1849,9 +2157,8 @@ void DatabaseAPI::queryExec(const Auth::QueryExecRequest &a_request,
   if (a_request.has_count())
     params.push_back({"count", to_string(a_request.count())});
 
-  dbGet("/qry/exec", params, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("/qry/exec", params, listingItemHandler(a_reply, log_context),
+              log_context);
 }
 
 void DatabaseAPI::setQueryData(QueryDataReply &a_reply,
@@ -1902,7 +2209,6 @@ void DatabaseAPI::aclUpdate(const Auth::ACLUpdateRequest &a_request,
 void DatabaseAPI::aclSharedList(const Auth::ACLSharedListRequest &a_request,
                                 Auth::ListingReply &a_reply,
                                 LogContext log_context) {
-  Value result;
   vector<pair<string, string>> params;
 
   if (a_request.has_inc_users())
@@ -1911,22 +2217,19 @@ void DatabaseAPI::aclSharedList(const Auth::ACLSharedListRequest &a_request,
     params.push_back(
         {"inc_projects", a_request.inc_projects() ? "true" : "false"});
 
-  dbGet("acl/shared/list", params, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("acl/shared/list", params,
+              listingItemHandler(a_reply, log_context), log_context);
 }
 
 void DatabaseAPI::aclSharedListItems(
     const Auth::ACLSharedListItemsRequest &a_request,
     Auth::ListingReply &a_reply, LogContext log_context) {
-  Value result;
   vector<pair<string, string>> params;
 
   params.push_back({"owner", a_request.owner()});
 
-  dbGet("acl/shared/list/items", params, result, log_context);
-
-  setListingDataReply(a_reply, result, log_context);
+  dbGetStream("acl/shared/list/items", params,
+              listingItemHandler(a_reply, log_context), log_context);
 }
 
 void DatabaseAPI::setACLData(ACLDataReply &a_reply,
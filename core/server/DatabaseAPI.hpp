@@ -2,6 +2,9 @@
 #define DATABASEAPI_HPP
 #pragma once
 
+// Local private includes
+#include "DatabaseConnectionPool.hpp"
+
 // Local public includes
 #include "common/DynaLog.hpp"
 #include "common/SDMS.pb.h"
@@ -13,6 +16,9 @@
 #include <curl/curl.h>
 
 // Standard includes
+#include <exception>
+#include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -46,6 +52,23 @@ public:
   void clientLinkIdentity(const std::string &a_identity,
                           LogContext log_context);
   bool uidByPubKey(const std::string &a_pub_key, std::string &a_uid);
+  /// Same as above, a_http_code is set to 0 if the DB could not be reached
+  bool uidByPubKey(const std::string &a_pub_key, std::string &a_uid,
+                   long &a_http_code);
+
+  /**
+   * Completion callback for uidByPubKeyAsync, a_uid is only valid for a 2xx
+   * a_http_code and a_http_code is 0 if the DB could not be reached.
+   */
+  typedef std::function<void(long a_http_code, const std::string &a_uid)>
+      uid_callback_t;
+
+  /**
+   * Non-blocking uidByPubKey, the callback runs on the DatabaseEventLoop.
+   * Does not wait for a pooled handle, so it is safe on the proxy thread.
+   */
+  void uidByPubKeyAsync(const std::string &a_pub_key,
+                        uid_callback_t a_callback);
   bool userGetKeys(std::string &a_pub_key, std::string &a_priv_key,
                    LogContext log_context);
   void userSetKeys(const std::string &a_pub_key, const std::string &a_priv_key,
@@ -130,6 +153,21 @@ public:
   void recordUpdateSchemaError(const std::string &a_rec_id,
                                const std::string &a_err_msg,
                                LogContext log_context);
+  /// Record IDs and their validation error messages
+  void recordUpdateSchemaErrorBatch(
+      const std::vector<std::pair<std::string, std::string>> &a_errors,
+      LogContext log_context);
+
+  /// Metadata and schema of a record, or why they could not be read
+  struct RecordMetadata {
+    std::string metadata;
+    std::string sch_id;
+    std::string error;
+  };
+  /// Looks up several records at once, results are in the order of a_ids
+  std::vector<RecordMetadata>
+  recordViewMetadataBatch(const std::vector<std::string> &a_ids,
+                          LogContext log_context);
   void recordExport(const Auth::RecordExportRequest &a_request,
                     Auth::RecordExportReply &a_reply, LogContext log_context);
   void recordLock(const Auth::RecordLockRequest &a_request,
@@ -333,15 +371,72 @@ public:
       LogContext);
   void metricsPurge(uint32_t a_timestamp, LogContext);
 
+  /**
+   * Completion callback for asynchronous DB calls. On failure a_error holds
+   * the exception the equivalent blocking call would have thrown and a_result
+   * is null. Callbacks run on the DatabaseEventLoop thread and must not block.
+   */
+  typedef std::function<void(libjson::Value &a_result,
+                             std::exception_ptr a_error)>
+      db_callback_t;
+
+  /**
+   * Non-blocking variants of dbGet/dbPost. The request is built immediately
+   * (using the current client) and performed by the shared DatabaseEventLoop,
+   * so many calls can be in flight from a single thread. The number of
+   * concurrent requests is bounded by the DatabaseConnectionPool capacity,
+   * calls beyond it are queued by the event loop; the caller never waits for
+   * a handle, so callbacks may chain further asynchronous calls.
+   */
+  void dbGetAsync(
+      const char *a_url_path,
+      const std::vector<std::pair<std::string, std::string>> &a_params,
+      db_callback_t a_callback, LogContext);
+  void dbPostAsync(
+      const char *a_url_path,
+      const std::vector<std::pair<std::string, std::string>> &a_params,
+      const std::string *a_body, db_callback_t a_callback, LogContext);
+  std::future<libjson::Value>
+  dbGetAsync(const char *a_url_path,
+             const std::vector<std::pair<std::string, std::string>> &a_params,
+             LogContext);
+  std::future<libjson::Value>
+  dbPostAsync(const char *a_url_path,
+              const std::vector<std::pair<std::string, std::string>> &a_params,
+              const std::string *a_body, LogContext);
+
 private:
   long dbGet(const char *a_url_path,
              const std::vector<std::pair<std::string, std::string>> &a_params,
              libjson::Value &a_result, LogContext, bool a_log = true);
-  bool dbGetRaw(const std::string url, std::string &a_result);
+  bool dbGetRaw(const std::string url, std::string &a_result,
+                long *a_http_code = nullptr);
+  void dbGetRawAsync(const std::string &a_url, uid_callback_t a_callback);
   long dbPost(const char *a_url_path,
               const std::vector<std::pair<std::string, std::string>> &a_params,
               const std::string *a_body, libjson::Value &a_result, LogContext);
 
+  /// Handler for one element of a streamed (JSON array) DB reply
+  typedef std::function<void(const libjson::Value &a_item)> db_item_fun_t;
+
+  long
+  dbGetStream(const char *a_url_path,
+              const std::vector<std::pair<std::string, std::string>> &a_params,
+              db_item_fun_t a_item_fun, LogContext);
+  long
+  dbPostStream(const char *a_url_path,
+               const std::vector<std::pair<std::string, std::string>> &a_params,
+               const std::string *a_body, db_item_fun_t a_item_fun,
+               LogContext);
+  long dbStream(const std::string &a_url, bool a_post,
+                const std::string *a_body, db_item_fun_t a_item_fun,
+                LogContext);
+  void dbAsync(const std::string &a_url, bool a_post, const std::string *a_body,
+               db_callback_t a_callback, LogContext);
+  static long dbResponse(CURLcode a_res, long a_http_code,
+                         const std::string &a_res_json, const char *a_error,
+                         libjson::Value &a_result, LogContext);
+
   void setAuthStatus(Anon::AuthStatusReply &a_reply,
                      const libjson::Value &a_result);
   void setUserData(Auth::UserDataReply &a_reply, const libjson::Value &a_result,
@@ -356,9 +451,11 @@ private:
                        const libjson::Value &a_result, LogContext log_context);
   void setQueryData(Auth::QueryDataReply &a_reply,
                     const libjson::Value &a_result, LogContext log_context);
-  void setListingDataReply(Auth::ListingReply &a_reply,
-                           const libjson::Value &a_result,
-                           LogContext log_context);
+  db_item_fun_t listingItemHandler(Auth::ListingReply &a_reply,
+                                   LogContext log_context);
+  void setListingDataItem(Auth::ListingReply &a_reply,
+                          const libjson::Value &a_item,
+                          LogContext log_context);
   void setListingData(ListingData *a_item, const libjson::Value::Object &a_obj,
                       LogContext log_context);
   void setGroupData(Auth::GroupDataReply &a_reply,
@@ -428,10 +525,15 @@ private:
       uint32_t a_timestamp, uint32_t a_total,
       const std::map<std::string, std::map<uint16_t, uint32_t>> &a_metrics);
 
-  CURL *m_curl;
+  DatabaseConnectionPool::Handle acquireHandle();
+  static void setHandleOptions(CURL *a_curl, const std::string &a_db_user,
+                               const std::string &a_db_pass);
+
   char *m_client;
   std::string m_client_uid;
   std::string m_db_url;
+  std::string m_db_user;
+  std::string m_db_pass;
 };
 
 } // namespace Core
@@ -0,0 +1,187 @@
+// Local private includes
+#include "DatabaseConnectionPool.hpp"
+
+// Local public includes
+#include "common/SDMS.pb.h"
+#include "common/TraceException.hpp"
+
+// Standard includes
+#include <algorithm>
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+#define DB_POOL_DEFAULT_CAPACITY 32
+
+DatabaseConnectionPool::DatabaseConnectionPool() : m_share(nullptr) {
+  m_stats.capacity = DB_POOL_DEFAULT_CAPACITY;
+
+  m_share = curl_share_init();
+  if (!m_share)
+    EXCEPT(ID_INTERNAL_ERROR, "libcurl share init failed");
+
+  curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, shareLock);
+  curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, shareUnlock);
+  curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+  curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  // The connection cache is not shared, libcurl does not support sharing it
+  // between handles used from several threads at once. Each handle keeps its
+  // own connection alive instead.
+}
+
+DatabaseConnectionPool::~DatabaseConnectionPool() {
+  // Easy handles must be cleaned up before the share they are attached to
+  for (CURL *curl : m_all)
+    curl_easy_cleanup(curl);
+
+  if (m_share)
+    curl_share_cleanup(m_share);
+}
+
+void DatabaseConnectionPool::setCapacity(size_t a_capacity) {
+  vector<CURL *> removed;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    m_stats.capacity = max<size_t>(a_capacity, 1);
+
+    // Borrowed handles above the capacity are closed when they come back
+    while (m_all.size() > m_stats.capacity && !m_idle.empty()) {
+      removed.push_back(m_idle.back());
+      m_idle.pop_back();
+      forget(removed.back());
+    }
+  }
+
+  m_cvar.notify_all();
+
+  for (CURL *curl : removed)
+    curl_easy_cleanup(curl);
+}
+
+DatabaseConnectionPool::Handle DatabaseConnectionPool::acquire() {
+  unique_lock<mutex> lock(m_mutex);
+
+  if (m_idle.empty() && m_all.size() >= m_stats.capacity) {
+    m_stats.waited++;
+    m_cvar.wait(lock, [this] {
+      return !m_idle.empty() || m_all.size() < m_stats.capacity;
+    });
+  }
+
+  return take();
+}
+
+DatabaseConnectionPool::Handle DatabaseConnectionPool::tryAcquire() {
+  lock_guard<mutex> lock(m_mutex);
+
+  if (m_idle.empty() && m_all.size() >= m_stats.capacity)
+    return Handle(*this, nullptr);
+
+  return take();
+}
+
+DatabaseConnectionPool::Handle DatabaseConnectionPool::take() {
+  CURL *curl;
+
+  if (!m_idle.empty()) {
+    curl = m_idle.back();
+    m_idle.pop_back();
+  } else {
+    curl = createHandle();
+    m_all.push_back(curl);
+    m_stats.created = m_all.size();
+  }
+
+  m_stats.in_use++;
+  m_stats.acquired++;
+
+  return Handle(*this, curl);
+}
+
+void DatabaseConnectionPool::release(CURL *a_curl) {
+  // Drop references to the previous borrower's stack buffers
+  curl_easy_setopt(a_curl, CURLOPT_ERRORBUFFER, nullptr);
+  curl_easy_setopt(a_curl, CURLOPT_WRITEDATA, nullptr);
+
+  bool removed = false;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    m_stats.in_use--;
+    if (m_all.size() > m_stats.capacity) {
+      forget(a_curl);
+      removed = true;
+    } else {
+      m_idle.push_back(a_curl);
+    }
+  }
+
+  if (removed)
+    curl_easy_cleanup(a_curl);
+  else
+    m_cvar.notify_one();
+}
+
+/// Drops a handle that is being closed, must be called with m_mutex held
+void DatabaseConnectionPool::forget(CURL *a_curl) {
+  m_all.erase(std::find(m_all.begin(), m_all.end(), a_curl));
+  m_stats.created = m_all.size();
+}
+
+DatabaseConnectionPool::Stats DatabaseConnectionPool::getStats() const {
+  lock_guard<mutex> lock(m_mutex);
+
+  Stats stats = m_stats;
+  stats.idle = m_idle.size();
+
+  return stats;
+}
+
+/**
+ * Creates a new easy handle with the options shared by all DB requests.
+ * Credentials and per-request options are applied by DatabaseAPI on every
+ * borrow. Must be called with m_mutex held.
+ */
+CURL *DatabaseConnectionPool::createHandle() {
+  CURL *curl = curl_easy_init();
+  if (!curl)
+    EXCEPT(ID_INTERNAL_ERROR, "libcurl init failed");
+
+  curl_easy_setopt(curl, CURLOPT_SHARE, m_share);
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, 60L);
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, 30L);
+  // Handles are used from many threads, signals are not thread safe
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+  return curl;
+}
+
+void DatabaseConnectionPool::shareLock(CURL *a_curl, curl_lock_data a_data,
+                                       curl_lock_access a_access,
+                                       void *a_user_ptr) {
+  (void)a_curl;
+  (void)a_access;
+
+  static_cast<DatabaseConnectionPool *>(a_user_ptr)
+      ->m_share_mutex[a_data]
+      .lock();
+}
+
+void DatabaseConnectionPool::shareUnlock(CURL *a_curl, curl_lock_data a_data,
+                                         void *a_user_ptr) {
+  (void)a_curl;
+
+  static_cast<DatabaseConnectionPool *>(a_user_ptr)
+      ->m_share_mutex[a_data]
+      .unlock();
+}
+
+} // namespace Core
+} // namespace SDMS
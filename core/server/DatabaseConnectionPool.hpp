@@ -0,0 +1,117 @@
+#ifndef DATABASECONNECTIONPOOL_HPP
+#define DATABASECONNECTIONPOOL_HPP
+#pragma once
+
+// Third party includes
+#include <curl/curl.h>
+
+// Standard includes
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <stddef.h>
+#include <vector>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Process-wide, bounded pool of keep-alive libcurl easy handles used by
+ * DatabaseAPI to talk to the DB service.
+ *
+ * Previously every DatabaseAPI instance owned its own easy handle, so each
+ * short-lived instance (AuthMap lookups, TaskMgr, Config reloads) paid for a
+ * fresh DNS lookup, TCP connect and TLS handshake. Handles now live here and
+ * are borrowed for the duration of a single request. All handles are attached
+ * to one curl share object so DNS results and TLS sessions are reused across
+ * every borrower, and each handle keeps its own connection alive.
+ *
+ * Borrowers block when all handles are in use and the pool is at capacity,
+ * unless they use tryAcquire().
+ */
+class DatabaseConnectionPool {
+public:
+  struct Stats {
+    size_t capacity = 0; ///< Maximum number of handles
+    size_t created = 0;  ///< Handles that currently exist
+    size_t in_use = 0;   ///< Handles currently borrowed
+    size_t idle = 0;     ///< Handles waiting in the pool
+    size_t acquired = 0; ///< Total number of successful borrows
+    size_t waited = 0;   ///< Borrows that had to wait for a free handle
+  };
+
+  /**
+   * RAII lease on a pooled handle, the handle is returned to the pool when
+   * the lease goes out of scope.
+   */
+  class Handle {
+  public:
+    Handle(DatabaseConnectionPool &a_pool, CURL *a_curl)
+        : m_pool(&a_pool), m_curl(a_curl) {}
+    Handle(Handle &&a_other) noexcept
+        : m_pool(a_other.m_pool), m_curl(a_other.m_curl) {
+      a_other.m_curl = nullptr;
+    }
+    Handle(const Handle &) = delete;
+    Handle &operator=(const Handle &) = delete;
+    Handle &operator=(Handle &&) = delete;
+    ~Handle() {
+      if (m_curl)
+        m_pool->release(m_curl);
+    }
+
+    CURL *get() const { return m_curl; }
+
+  private:
+    DatabaseConnectionPool *m_pool;
+    CURL *m_curl;
+  };
+
+  static DatabaseConnectionPool &getInstance() {
+    static DatabaseConnectionPool inst;
+    return inst;
+  }
+
+  DatabaseConnectionPool(const DatabaseConnectionPool &) = delete;
+  DatabaseConnectionPool &operator=(const DatabaseConnectionPool &) = delete;
+
+  /// Set the maximum number of handles. Idle handles above it are closed
+  /// now, borrowed ones when they are returned.
+  void setCapacity(size_t a_capacity);
+
+  /// Borrow a handle, blocks if the pool is exhausted
+  Handle acquire();
+  /// Borrow a handle without waiting, the handle is null if none is free
+  Handle tryAcquire();
+
+  Stats getStats() const;
+
+private:
+  DatabaseConnectionPool();
+  ~DatabaseConnectionPool();
+
+  CURL *createHandle();
+  /// Must be called with m_mutex held and a handle available
+  Handle take();
+  void release(CURL *a_curl);
+  void forget(CURL *a_curl);
+
+  static void shareLock(CURL *a_curl, curl_lock_data a_data,
+                        curl_lock_access a_access, void *a_user_ptr);
+  static void shareUnlock(CURL *a_curl, curl_lock_data a_data,
+                          void *a_user_ptr);
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cvar;
+  std::vector<CURL *> m_idle;
+  std::vector<CURL *> m_all;
+  CURLSH *m_share;
+  /// One mutex per kind of shared data, as required by the curl share API
+  std::array<std::mutex, CURL_LOCK_DATA_LAST> m_share_mutex;
+  Stats m_stats;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
@@ -0,0 +1,194 @@
+// Local private includes
+#include "DatabaseEventLoop.hpp"
+
+// Local public includes
+#include "common/DynaLog.hpp"
+#include "common/SDMS.pb.h"
+#include "common/TraceException.hpp"
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+#define DB_LOOP_POLL_TIMEOUT_MS 1000
+/// Poll timeout while requests wait for handles held by other threads
+#define DB_LOOP_RETRY_TIMEOUT_MS 10
+
+DatabaseEventLoop::DatabaseEventLoop()
+    : m_multi(nullptr), m_run(true), m_in_flight(0) {
+  // Make sure the pool outlives the loop, active requests hold pool handles
+  DatabaseConnectionPool::getInstance();
+
+  m_log_context.thread_name = "dbEventLoop";
+
+  m_multi = curl_multi_init();
+  if (!m_multi)
+    EXCEPT(ID_INTERNAL_ERROR, "libcurl multi init failed");
+
+  m_thread = thread(&DatabaseEventLoop::loopThread, this);
+}
+
+DatabaseEventLoop::~DatabaseEventLoop() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_run = false;
+  }
+
+  curl_multi_wakeup(m_multi);
+  m_thread.join();
+
+  for (auto &active : m_active)
+    curl_multi_remove_handle(m_multi, active.first);
+
+  m_active.clear();
+  m_waiting.clear();
+  m_pending.clear();
+
+  curl_multi_cleanup(m_multi);
+}
+
+void DatabaseEventLoop::submit(setup_t a_setup, completion_t a_completion) {
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    m_pending.push_back({std::move(a_setup), std::move(a_completion)});
+    m_in_flight++;
+  }
+
+  curl_multi_wakeup(m_multi);
+}
+
+size_t DatabaseEventLoop::inFlight() const {
+  lock_guard<mutex> lock(m_mutex);
+
+  return m_in_flight;
+}
+
+void DatabaseEventLoop::loopThread() {
+  int running = 0;
+  int numfds;
+  CURLMcode mc;
+
+  while (1) {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      if (!m_run)
+        break;
+    }
+
+    addPending();
+
+    mc = curl_multi_perform(m_multi, &running);
+    if (mc != CURLM_OK) {
+      DL_ERROR(m_log_context,
+               "curl_multi_perform failed: " << curl_multi_strerror(mc));
+    }
+
+    completeFinished();
+
+    // Handles released by other threads do not wake the loop
+    mc = curl_multi_poll(m_multi, nullptr, 0,
+                         m_waiting.empty() ? DB_LOOP_POLL_TIMEOUT_MS
+                                           : DB_LOOP_RETRY_TIMEOUT_MS,
+                         &numfds);
+    if (mc != CURLM_OK) {
+      DL_ERROR(m_log_context,
+               "curl_multi_poll failed: " << curl_multi_strerror(mc));
+    }
+  }
+}
+
+/**
+ * Moves newly submitted requests onto the multi handle as long as the pool
+ * has free handles, the rest keep waiting for the next iteration. Requests
+ * that cannot be set up or added are completed immediately with a failure
+ * code.
+ */
+void DatabaseEventLoop::addPending() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    for (Pending &pending : m_pending)
+      m_waiting.push_back(std::move(pending));
+    m_pending.clear();
+  }
+
+  DatabaseConnectionPool &pool = DatabaseConnectionPool::getInstance();
+
+  while (!m_waiting.empty()) {
+    DatabaseConnectionPool::Handle handle = pool.tryAcquire();
+    CURL *curl = handle.get();
+    if (!curl)
+      break;
+
+    Pending pending = std::move(m_waiting.front());
+    m_waiting.pop_front();
+
+    CURLcode failed = CURLE_OK;
+    try {
+      pending.setup(curl);
+      if (curl_multi_add_handle(m_multi, curl) != CURLM_OK)
+        failed = CURLE_FAILED_INIT;
+    } catch (exception &e) {
+      DL_ERROR(m_log_context, "DB request setup failed: " << e.what());
+      failed = CURLE_FAILED_INIT;
+    }
+
+    if (failed == CURLE_OK) {
+      m_active[curl] = make_unique<Request>(std::move(handle),
+                                            std::move(pending.completion));
+      continue;
+    }
+
+    try {
+      pending.completion(failed, 0);
+    } catch (exception &e) {
+      DL_ERROR(m_log_context, "DB completion failed: " << e.what());
+    }
+
+    lock_guard<mutex> lock(m_mutex);
+    m_in_flight--;
+  }
+}
+
+void DatabaseEventLoop::completeFinished() {
+  CURLMsg *msg;
+  int msgs_left;
+
+  while ((msg = curl_multi_info_read(m_multi, &msgs_left))) {
+    if (msg->msg != CURLMSG_DONE)
+      continue;
+
+    CURL *curl = msg->easy_handle;
+    CURLcode res = msg->data.result;
+
+    curl_multi_remove_handle(m_multi, curl);
+
+    auto active = m_active.find(curl);
+    if (active == m_active.end())
+      continue;
+
+    unique_ptr<Request> request = std::move(active->second);
+    m_active.erase(active);
+
+    long http_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+
+    try {
+      request->completion(res, http_code);
+    } catch (exception &e) {
+      DL_ERROR(m_log_context, "DB completion failed: " << e.what());
+    } catch (...) {
+      DL_ERROR(m_log_context, "DB completion failed: unknown exception");
+    }
+
+    // Handle is released back to the pool here
+    request.reset();
+
+    lock_guard<mutex> lock(m_mutex);
+    m_in_flight--;
+  }
+}
+
+} // namespace Core
+} // namespace SDMS
@@ -0,0 +1,100 @@
+#ifndef DATABASEEVENTLOOP_HPP
+#define DATABASEEVENTLOOP_HPP
+#pragma once
+
+// Local private includes
+#include "DatabaseConnectionPool.hpp"
+
+// Local public includes
+#include "common/DynaLog.hpp"
+
+// Third party includes
+#include <curl/curl.h>
+
+// Standard includes
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Process-wide curl_multi event loop used by the asynchronous DatabaseAPI
+ * calls.
+ *
+ * A single background thread drives every in-flight DB request, so callers
+ * can keep many requests outstanding without parking a thread per request.
+ * Submitting never blocks: the loop borrows a handle from the
+ * DatabaseConnectionPool on its own thread, without waiting, and has the
+ * setup function configure it (URL, write buffer, body). Requests for which
+ * no handle is free wait in submission order until one is returned. The
+ * handle is returned to the pool after the completion function has run.
+ *
+ * Setup and completion functions run on the event loop thread and must not
+ * block or issue synchronous DB calls, they may submit further requests.
+ */
+class DatabaseEventLoop {
+public:
+  typedef std::function<void(CURL *a_curl)> setup_t;
+  typedef std::function<void(CURLcode a_result, long a_http_code)>
+      completion_t;
+
+  static DatabaseEventLoop &getInstance() {
+    static DatabaseEventLoop inst;
+    return inst;
+  }
+
+  DatabaseEventLoop(const DatabaseEventLoop &) = delete;
+  DatabaseEventLoop &operator=(const DatabaseEventLoop &) = delete;
+
+  /// Queue a request for transfer, returns immediately
+  void submit(setup_t a_setup, completion_t a_completion);
+
+  /// Number of requests submitted but not yet completed
+  size_t inFlight() const;
+
+private:
+  struct Pending {
+    setup_t setup;
+    completion_t completion;
+  };
+
+  struct Request {
+    Request(DatabaseConnectionPool::Handle &&a_handle,
+            completion_t &&a_completion)
+        : handle(std::move(a_handle)), completion(std::move(a_completion)) {}
+
+    DatabaseConnectionPool::Handle handle;
+    completion_t completion;
+  };
+
+  DatabaseEventLoop();
+  ~DatabaseEventLoop();
+
+  void loopThread();
+  void addPending();
+  void completeFinished();
+
+  CURLM *m_multi;
+  std::thread m_thread;
+  mutable std::mutex m_mutex;
+  bool m_run;
+  /// Requests submitted since the last loop iteration (guarded by m_mutex)
+  std::vector<Pending> m_pending;
+  /// Requests waiting for a free handle, oldest first (loop thread only)
+  std::deque<Pending> m_waiting;
+  /// Requests owned by the multi handle (loop thread only)
+  std::map<CURL *, std::unique_ptr<Request>> m_active;
+  size_t m_in_flight;
+  LogContext m_log_context;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
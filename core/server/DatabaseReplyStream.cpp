@@ -0,0 +1,119 @@
+// Local private includes
+#include "DatabaseReplyStream.hpp"
+
+// Standard includes
+#include <cctype>
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+DatabaseReplyStream::DatabaseReplyStream(CURL *a_curl,
+                                         element_fun_t a_element_fun)
+    : m_curl(a_curl), m_element_fun(std::move(a_element_fun)) {}
+
+void DatabaseReplyStream::write(const char *a_data, size_t a_len) {
+  char c;
+
+  for (size_t i = 0; i < a_len; i++) {
+    c = a_data[i];
+
+    switch (m_state) {
+    case State::START:
+      if (isspace(c))
+        continue;
+
+      if (m_curl) {
+        // Headers have been received by the time the body arrives
+        long http_code = 0;
+        curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &http_code);
+        if (http_code < 200 || http_code >= 300) {
+          m_state = State::RAW;
+          m_buffer.append(a_data + i, a_len - i);
+          return;
+        }
+      }
+
+      if (c == '[') {
+        m_state = State::BETWEEN;
+      } else {
+        m_state = State::RAW;
+        m_buffer.append(a_data + i, a_len - i);
+        return;
+      }
+      break;
+    case State::BETWEEN:
+      if (isspace(c) || c == ',')
+        continue;
+
+      if (c == ']') {
+        m_state = State::DONE;
+        continue;
+      }
+
+      m_state = State::ELEMENT;
+      // Fall through, c is the first char of the element
+      [[fallthrough]];
+    case State::ELEMENT:
+      if (m_in_string) {
+        m_buffer.push_back(c);
+        if (m_escape)
+          m_escape = false;
+        else if (c == '\\')
+          m_escape = true;
+        else if (c == '"')
+          m_in_string = false;
+      } else if (m_depth == 0 && (c == ',' || c == ']')) {
+        // End of a scalar element
+        emitElement();
+        m_state = (c == ']' ? State::DONE : State::BETWEEN);
+      } else {
+        m_buffer.push_back(c);
+        if (c == '"') {
+          m_in_string = true;
+        } else if (c == '{' || c == '[') {
+          m_depth++;
+        } else if (c == '}' || c == ']') {
+          if (--m_depth == 0) {
+            emitElement();
+            m_state = State::BETWEEN;
+          }
+        }
+      }
+      break;
+    case State::DONE:
+      // Only trailing whitespace is expected
+      break;
+    case State::RAW:
+      m_buffer.append(a_data + i, a_len - i);
+      return;
+    }
+  }
+}
+
+void DatabaseReplyStream::emitElement() {
+  if (!m_error) {
+    try {
+      m_element_fun(m_buffer);
+    } catch (...) {
+      m_error = current_exception();
+    }
+  }
+
+  m_buffer.clear();
+}
+
+size_t DatabaseReplyStream::curlWriteCB(char *a_ptr, size_t a_size,
+                                        size_t a_nmemb, void *a_userdata) {
+  DatabaseReplyStream *stream = static_cast<DatabaseReplyStream *>(a_userdata);
+  size_t len = a_size * a_nmemb;
+
+  stream->write(a_ptr, len);
+
+  // Returning less than len aborts the transfer
+  return stream->m_error ? 0 : len;
+}
+
+} // namespace Core
+} // namespace SDMS
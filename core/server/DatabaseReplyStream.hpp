@@ -0,0 +1,71 @@
+#ifndef DATABASEREPLYSTREAM_HPP
+#define DATABASEREPLYSTREAM_HPP
+#pragma once
+
+// Third party includes
+#include <curl/curl.h>
+
+// Standard includes
+#include <exception>
+#include <functional>
+#include <string>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Incremental splitter for DB replies that are JSON arrays.
+ *
+ * The stream is installed as the curl write callback and is fed the reply in
+ * whatever chunks curl delivers. Each top-level array element is handed to the
+ * element function as soon as its closing character arrives, so only a single
+ * element is ever buffered instead of the full reply (and its DOM).
+ *
+ * If the reply is not a JSON array, or the HTTP status is not 2xx, the stream
+ * falls back to buffering the raw reply so the regular error handling can be
+ * applied to it once the transfer completes.
+ */
+class DatabaseReplyStream {
+public:
+  typedef std::function<void(const std::string &a_element)> element_fun_t;
+
+  DatabaseReplyStream(CURL *a_curl, element_fun_t a_element_fun);
+
+  /// Feed the next chunk of the reply
+  void write(const char *a_data, size_t a_len);
+
+  /// True if the reply was streamed as an array (false if buffered raw)
+  bool streamed() const { return m_state != State::RAW; }
+
+  /// True once the closing bracket of the array has been consumed
+  bool complete() const { return m_state == State::DONE; }
+
+  /// Raw reply, only populated when the reply was not streamed
+  const std::string &raw() const { return m_buffer; }
+
+  /// Exception thrown by the element function, if any
+  std::exception_ptr error() const { return m_error; }
+
+  /// curl CURLOPT_WRITEFUNCTION, userdata must be a DatabaseReplyStream
+  static size_t curlWriteCB(char *a_ptr, size_t a_size, size_t a_nmemb,
+                            void *a_userdata);
+
+private:
+  enum class State { START, BETWEEN, ELEMENT, DONE, RAW };
+
+  void emitElement();
+
+  CURL *m_curl;
+  element_fun_t m_element_fun;
+  State m_state = State::START;
+  std::string m_buffer;     ///< Current element (or raw reply)
+  size_t m_depth = 0;       ///< Nesting depth within current element
+  bool m_in_string = false; ///< Inside a JSON string literal
+  bool m_escape = false;    ///< Previous char was a backslash in a string
+  std::exception_ptr m_error;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
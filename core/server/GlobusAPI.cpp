@@ -470,6 +470,83 @@ bool GlobusAPI::checkTransferStatus(const std::string &a_task_id,
   }
 }
 
+void GlobusAPI::checkTransferStatuses(const vector<string> &a_task_ids,
+                                      const string &a_acc_tok,
+                                      map<string, XfrState> &a_states) {
+  a_states.clear();
+  if (a_task_ids.empty())
+    return;
+
+  string filter = "task_id:";
+  for (vector<string>::const_iterator id = a_task_ids.begin();
+       id != a_task_ids.end(); ++id) {
+    if (id != a_task_ids.begin())
+      filter += ",";
+    filter += *id;
+  }
+
+  string raw_result;
+  long code = get(m_curl_xfr, m_config.glob_xfr_url, "task_list", a_acc_tok,
+                  {{"filter", filter},
+                   {"limit", to_string(a_task_ids.size())},
+                   {"fields", "task_id,status,nice_status,faults"}},
+                  raw_result);
+
+  // Transfers that need a closer look than the list provides
+  vector<string> check_one;
+
+  try {
+    if (!raw_result.size())
+      EXCEPT_PARAM(ID_SERVICE_ERROR, "Empty response. Code: " << code);
+
+    Value result;
+    result.fromString(raw_result);
+
+    Value::Object &resp_obj = result.asObject();
+
+    checkResponsCode(code, resp_obj);
+
+    Value::Array &data_arr = resp_obj.getArray("DATA");
+    for (Value::ArrayIter t = data_arr.begin(); t != data_arr.end(); ++t) {
+      Value::Object &task_obj = t->asObject();
+      const string &task_id = task_obj.getString("task_id");
+      const string &status = task_obj.getString("status");
+
+      // Same rules as checkTransferStatus
+      if (status == "ACTIVE" && task_obj.getNumber("faults") <= 30.0) {
+        a_states[task_id].status = XS_ACTIVE;
+      } else if (status == "SUCCEEDED") {
+        a_states[task_id].status = XS_SUCCEEDED;
+      } else if (status == "FAILED" || status == "INACTIVE") {
+        XfrState &state = a_states[task_id];
+        state.status = XS_FAILED;
+        state.cancel = true;
+        state.err_msg = task_obj.getString("nice_status");
+      } else {
+        check_one.push_back(task_id);
+      }
+    }
+  } catch (libjson::ParseError &e) {
+    DL_ERROR(m_log_context, "PARSE FAILED! " << raw_result);
+    EXCEPT_PARAM(ID_SERVICE_ERROR,
+                 "Globus task list API call returned invalid JSON.");
+  } catch (TraceException &e) {
+    DL_ERROR(m_log_context, raw_result);
+    e.addContext("Globus task list API call failed.");
+    throw;
+  } catch (...) {
+    DL_ERROR(m_log_context, "UNEXPECTED/MISSING JSON! " << raw_result);
+    EXCEPT_PARAM(ID_SERVICE_ERROR,
+                 "Globus task list API call returned unexpected content");
+  }
+
+  for (const string &task_id : check_one) {
+    XfrState &state = a_states[task_id];
+    state.cancel = checkTransferStatus(task_id, a_acc_tok, state.status,
+                                       state.err_msg);
+  }
+}
+
 void GlobusAPI::cancelTask(const std::string &a_task_id,
                            const std::string &a_acc_tok) {
 
@@ -14,6 +14,7 @@
 #include <curl/curl.h>
 
 // Standard includes
+#include <map>
 #include <string>
 #include <vector>
 
@@ -38,6 +39,14 @@ public:
     virtual void cb_CancelTransfer() = 0;
   };
 
+  /// Outcome of a status check, cancel is set when a failing transfer still
+  /// has to be cancelled
+  struct XfrState {
+    XfrStatus status = XS_INIT;
+    bool cancel = false;
+    std::string err_msg;
+  };
+
   struct EndpointInfo {
     std::string id;
     bool activated;
@@ -61,6 +70,15 @@ public:
   bool checkTransferStatus(const std::string &a_task_id,
                            const std::string &a_acc_tok, XfrStatus &a_status,
                            std::string &a_err_msg);
+  /**
+   * Checks several transfers submitted with the same access token in one
+   * task_list call. Transfers the list is not enough to judge, i.e. active
+   * ones with many faults, are checked one by one with checkTransferStatus.
+   * Transfers Globus does not return are left out of a_states.
+   */
+  void checkTransferStatuses(const std::vector<std::string> &a_task_ids,
+                             const std::string &a_acc_tok,
+                             std::map<std::string, XfrState> &a_states);
   void cancelTask(const std::string &a_task_id, const std::string &a_acc_tok);
   void getEndpointInfo(const std::string &a_ep_id,
                        const std::string &a_acc_token, EndpointInfo &a_ep_info);
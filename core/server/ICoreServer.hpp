@@ -19,6 +19,10 @@ public:
                                   LogContext log_context) = 0;
   virtual void metricsUpdateMsgCount(const std::string &a_uid,
                                      uint16_t a_msg_type) = 0;
+  /// Count a request dropped because its client stopped waiting for it
+  virtual void metricsRequestExpired(uint16_t a_msg_type) = 0;
+  /// Forget cached persistent keys of a user after they were revoked
+  virtual void revokeClientKeys(const std::string &a_uid) = 0;
 };
 
 } // namespace Core
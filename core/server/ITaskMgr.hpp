@@ -12,6 +12,7 @@
 // Standard includes
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace SDMS {
 namespace Core {
@@ -36,10 +37,23 @@ public:
     ~Task() {}
 
     std::string task_id;
+    /// User or project the task is scheduled for, the requesting client
+    /// unless the task works for another owner, see TaskScheduler
+    std::string owner;
+    /// TaskType, -1 if not known
+    int32_t type = -1;
     bool cancel;
     uint32_t retry_count;
     timepoint_t retry_time;
     timepoint_t retry_fail_time;
+    /// Set when a step completed while no worker held the task, i.e. a Globus
+    /// transfer ended. The next worker reports the outcome of resume_step
+    /// instead of starting the task over.
+    bool resume = false;
+    int resume_step = 0;
+    std::string resume_err_msg;
+    /// Repos and endpoints the running step holds a slot on
+    std::vector<std::string> targets;
   };
 
   virtual std::unique_ptr<Task> getNextTask(ITaskWorker *a_worker) = 0;
@@ -47,6 +61,26 @@ public:
                          LogContext log_context) = 0;
   virtual void newTasks(const libjson::Value &a_tasks,
                         LogContext log_context) = 0;
+  /**
+   * Hands a task waiting on a Globus transfer over to the transfer monitor
+   * so the worker is free for other tasks. The task is scheduled again once
+   * the transfer ended.
+   */
+  virtual void monitorTransfer(std::unique_ptr<Task> a_task,
+                               const std::string &a_glob_task_id,
+                               const std::string &a_acc_tok,
+                               LogContext log_context) = 0;
+  /**
+   * Takes a slot on the repos and endpoints a step is about to use. Returns
+   * false if one of them is saturated; the TaskMgr then owns the task and
+   * schedules it again once a slot frees up, starting over at the current
+   * step.
+   */
+  virtual bool acquireTargets(std::unique_ptr<Task> &a_task,
+                              const std::vector<std::string> &a_targets,
+                              LogContext log_context) = 0;
+  /// Gives back the slots taken by acquireTargets, if any
+  virtual void releaseTargets(Task &a_task, LogContext log_context) = 0;
 };
 
 } // namespace Core
@@ -2,6 +2,9 @@
 #define ITASKWORKER_HPP
 #pragma once
 
+// Local public includes
+#include "common/DynaLog.hpp"
+
 // Standard includes
 #include <condition_variable>
 #include <stdint.h>
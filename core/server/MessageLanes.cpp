@@ -0,0 +1,134 @@
+// Local private includes
+#include "MessageLanes.hpp"
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+const char *MessageLanes::name(Lane a_lane) {
+  switch (a_lane) {
+  case QUERY:
+    return "query";
+  case BULK:
+    return "bulk";
+  default:
+    return "interactive";
+  }
+}
+
+bool MessageLanes::fromName(const std::string &a_name, Lane &a_lane) {
+  for (uint8_t l = 0; l < LANE_COUNT; l++) {
+    if (a_name == name((Lane)l)) {
+      a_lane = (Lane)l;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string MessageLanes::host(Lane a_lane) {
+  // The interactive workers keep the address all workers used before
+  if (a_lane == INTERACTIVE)
+    return "workers";
+  return string("workers_") + name(a_lane);
+}
+
+const std::vector<std::pair<std::string, MessageLanes::Lane>> &
+MessageLanes::defaultLanes() {
+  static const vector<pair<string, Lane>> lanes = {
+      {"SearchRequest", QUERY},
+      {"QueryExecRequest", QUERY},
+      {"ProjectSearchRequest", QUERY},
+      {"RecordExportRequest", QUERY},
+      {"RecordListByAllocRequest", QUERY},
+      {"RepoCalcSizeRequest", QUERY},
+      {"RecordCreateBatchRequest", BULK},
+      {"RecordUpdateBatchRequest", BULK},
+      {"RecordDeleteRequest", BULK},
+      {"RecordAllocChangeRequest", BULK},
+      {"RecordOwnerChangeRequest", BULK},
+      {"CollDeleteRequest", BULK},
+      {"ProjectDeleteRequest", BULK},
+      {"DataDeleteRequest", BULK}};
+  return lanes;
+}
+
+void MessageLanes::setLane(uint16_t a_msg_type, Lane a_lane) {
+  lock_guard<mutex> lock(m_mutex);
+  if (a_msg_type >= m_lanes.size())
+    m_lanes.resize(a_msg_type + 1, INTERACTIVE);
+  m_lanes[a_msg_type] = a_lane;
+}
+
+MessageLanes::Lane MessageLanes::lane(uint16_t a_msg_type) const {
+  lock_guard<mutex> lock(m_mutex);
+  return a_msg_type < m_lanes.size() ? (Lane)m_lanes[a_msg_type] : INTERACTIVE;
+}
+
+void MessageLanes::setCapacity(Lane a_lane, size_t a_capacity) {
+  lock_guard<mutex> lock(m_mutex);
+  m_capacity[a_lane] = a_capacity;
+}
+
+size_t MessageLanes::capacity(Lane a_lane) const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_capacity[a_lane];
+}
+
+bool MessageLanes::admit(Lane a_lane, const std::string &a_correlation_id,
+                         time_point a_now) {
+  lock_guard<mutex> lock(m_mutex);
+  LaneStats &stats = m_stats[a_lane];
+
+  auto req = m_requests.find(a_correlation_id);
+  if (req != m_requests.end()) {
+    // Resent with the same ID, the first one is not counted twice
+    m_stats[req->second.lane].in_flight--;
+    m_requests.erase(req);
+  }
+
+  if (m_capacity[a_lane] && stats.in_flight >= m_capacity[a_lane]) {
+    stats.refused++;
+    return false;
+  }
+
+  m_requests[a_correlation_id] = {a_lane, a_now};
+  stats.in_flight++;
+  stats.routed++;
+  return true;
+}
+
+void MessageLanes::complete(const std::string &a_correlation_id) {
+  lock_guard<mutex> lock(m_mutex);
+  auto req = m_requests.find(a_correlation_id);
+  if (req == m_requests.end())
+    return;
+
+  m_stats[req->second.lane].in_flight--;
+  m_requests.erase(req);
+}
+
+size_t MessageLanes::expire(time_point a_before) {
+  lock_guard<mutex> lock(m_mutex);
+  size_t count = 0;
+
+  for (auto req = m_requests.begin(); req != m_requests.end();) {
+    if (req->second.admitted < a_before) {
+      m_stats[req->second.lane].in_flight--;
+      req = m_requests.erase(req);
+      count++;
+    } else {
+      ++req;
+    }
+  }
+  return count;
+}
+
+MessageLanes::LaneStats MessageLanes::stats(Lane a_lane) const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_stats[a_lane];
+}
+
+} // namespace Core
+} // namespace SDMS
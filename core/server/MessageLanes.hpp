@@ -0,0 +1,86 @@
+#ifndef MESSAGELANES_HPP
+#define MESSAGELANES_HPP
+#pragma once
+
+// Standard includes
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Sorts client requests into lanes that are served by separate groups of
+ * client workers.
+ *
+ * Cheap interactive requests, such as the task list polled by the web portal,
+ * would otherwise wait behind searches and batch writes on the same workers.
+ * Every lane has a bound on the requests it holds, counting the ones being
+ * worked on, so a burst of expensive requests is refused instead of piling up.
+ * Requests are tracked by correlation ID until their reply comes back.
+ *
+ * Used by the message router thread, the stats may be read from any thread.
+ */
+class MessageLanes {
+public:
+  enum Lane : uint8_t { INTERACTIVE = 0, QUERY, BULK, LANE_COUNT };
+
+  struct LaneStats {
+    size_t in_flight = 0;
+    uint64_t routed = 0;
+    uint64_t refused = 0;
+  };
+
+  typedef std::chrono::steady_clock::time_point time_point;
+
+  static const char *name(Lane a_lane);
+  /// Lane of "interactive", "query" or "bulk", false for anything else
+  static bool fromName(const std::string &a_name, Lane &a_lane);
+  /// Inproc host the workers of the lane connect to
+  static std::string host(Lane a_lane);
+  /// Message names sent to the query and bulk lanes unless configured
+  static const std::vector<std::pair<std::string, Lane>> &defaultLanes();
+
+  /// Message types not assigned to a lane are interactive
+  void setLane(uint16_t a_msg_type, Lane a_lane);
+  Lane lane(uint16_t a_msg_type) const;
+
+  /// Most requests held by the lane at once, 0 = unbounded
+  void setCapacity(Lane a_lane, size_t a_capacity);
+  size_t capacity(Lane a_lane) const;
+
+  /**
+   * Records a request sent to a lane. Returns false, and the request must be
+   * refused, if the lane is full.
+   */
+  bool admit(Lane a_lane, const std::string &a_correlation_id,
+             time_point a_now = std::chrono::steady_clock::now());
+  /// The reply of a request was sent, unknown IDs are ignored
+  void complete(const std::string &a_correlation_id);
+  /// Forgets requests admitted before a_before that never got a reply
+  size_t expire(time_point a_before);
+
+  LaneStats stats(Lane a_lane) const;
+
+private:
+  struct Request {
+    Lane lane;
+    time_point admitted;
+  };
+
+  std::vector<uint8_t> m_lanes;
+  std::array<size_t, LANE_COUNT> m_capacity{};
+  std::array<LaneStats, LANE_COUNT> m_stats{};
+  std::unordered_map<std::string, Request> m_requests;
+  mutable std::mutex m_mutex;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
@@ -0,0 +1,172 @@
+// Local private includes
+#include "PersistentKeyCache.hpp"
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+PersistentKeyCache::PersistentKeyCache(size_t a_capacity,
+                                       std::chrono::seconds a_ttl,
+                                       std::chrono::seconds a_negative_ttl,
+                                       std::chrono::seconds a_failure_ttl)
+    : m_capacity(a_capacity ? a_capacity : 1), m_ttl(a_ttl),
+      m_negative_ttl(a_negative_ttl), m_failure_ttl(a_failure_ttl) {}
+
+PersistentKeyCache::Lookup PersistentKeyCache::get(const std::string &a_key,
+                                                   std::string &a_uid) {
+  lock_guard<mutex> lock(m_mutex);
+
+  auto entry = m_entries.find(a_key);
+  if (entry != m_entries.end()) {
+    if (entry->second.expires > clock_t::now()) {
+      m_lru.splice(m_lru.begin(), m_lru, entry->second.lru);
+      if (entry->second.found) {
+        a_uid = entry->second.uid;
+        return Lookup::FOUND;
+      }
+      return Lookup::NOT_FOUND;
+    }
+    erase(entry);
+  }
+
+  return m_in_flight.count(a_key) ? Lookup::PENDING : Lookup::MISS;
+}
+
+bool PersistentKeyCache::beginLookup(const std::string &a_key,
+                                     uint64_t &a_generation) {
+  lock_guard<mutex> lock(m_mutex);
+
+  a_generation = m_generation;
+  return m_in_flight.insert(a_key).second;
+}
+
+uint64_t PersistentKeyCache::generation() const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_generation;
+}
+
+void PersistentKeyCache::store(const std::string &a_key,
+                               uint64_t a_generation, bool a_found,
+                               const std::string &a_uid) {
+  insert(a_key, a_generation, a_found, a_uid,
+         a_found ? m_ttl : m_negative_ttl);
+}
+
+void PersistentKeyCache::storeFailure(const std::string &a_key,
+                                      uint64_t a_generation) {
+  insert(a_key, a_generation, false, "", m_failure_ttl);
+}
+
+void PersistentKeyCache::insert(const std::string &a_key,
+                                uint64_t a_generation, bool a_found,
+                                const std::string &a_uid,
+                                std::chrono::seconds a_ttl) {
+  lock_guard<mutex> lock(m_mutex);
+
+  m_in_flight.erase(a_key);
+
+  // Invalidated while the lookup was running, the result may be stale
+  if (invalidated(a_key, a_generation, a_found, a_uid))
+    return;
+
+  auto entry = m_entries.find(a_key);
+  if (entry == m_entries.end()) {
+    if (m_entries.size() >= m_capacity)
+      erase(m_entries.find(m_lru.back()));
+
+    m_lru.push_front(a_key);
+    entry = m_entries.emplace(a_key, Entry()).first;
+    entry->second.lru = m_lru.begin();
+  } else {
+    m_lru.splice(m_lru.begin(), m_lru, entry->second.lru);
+  }
+
+  entry->second.uid = a_uid;
+  entry->second.found = a_found;
+  entry->second.expires = clock_t::now() + a_ttl;
+}
+
+void PersistentKeyCache::erase(
+    std::unordered_map<std::string, Entry>::iterator a_entry) {
+  m_lru.erase(a_entry->second.lru);
+  m_entries.erase(a_entry);
+}
+
+bool PersistentKeyCache::invalidated(const std::string &a_key,
+                                     uint64_t a_generation, bool a_found,
+                                     const std::string &a_uid) const {
+  if (a_generation < m_min_generation)
+    return true;
+
+  auto key = m_invalidated_keys.find(a_key);
+  if (key != m_invalidated_keys.end() && key->second > a_generation)
+    return true;
+
+  if (a_found) {
+    auto uid = m_invalidated_uids.find(a_uid);
+    if (uid != m_invalidated_uids.end() && uid->second > a_generation)
+      return true;
+  }
+
+  return false;
+}
+
+void PersistentKeyCache::recordInvalidation(
+    std::unordered_map<std::string, uint64_t> &a_records,
+    const std::string &a_name) {
+  m_generation++;
+
+  // Keep the records bounded, once there are too many every lookup that is
+  // still running is dropped instead
+  if (m_invalidated_keys.size() + m_invalidated_uids.size() >= m_capacity) {
+    m_invalidated_keys.clear();
+    m_invalidated_uids.clear();
+    m_min_generation = m_generation;
+    return;
+  }
+
+  a_records[a_name] = m_generation;
+}
+
+void PersistentKeyCache::invalidate(const std::string &a_key) {
+  lock_guard<mutex> lock(m_mutex);
+
+  recordInvalidation(m_invalidated_keys, a_key);
+  auto entry = m_entries.find(a_key);
+  if (entry != m_entries.end())
+    erase(entry);
+}
+
+void PersistentKeyCache::invalidateUID(const std::string &a_uid) {
+  lock_guard<mutex> lock(m_mutex);
+
+  recordInvalidation(m_invalidated_uids, a_uid);
+  for (auto entry = m_entries.begin(); entry != m_entries.end();) {
+    if (entry->second.found && entry->second.uid == a_uid) {
+      m_lru.erase(entry->second.lru);
+      entry = m_entries.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+}
+
+void PersistentKeyCache::clear() {
+  lock_guard<mutex> lock(m_mutex);
+
+  m_generation++;
+  m_min_generation = m_generation;
+  m_invalidated_keys.clear();
+  m_invalidated_uids.clear();
+  m_entries.clear();
+  m_lru.clear();
+}
+
+size_t PersistentKeyCache::size() const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+} // namespace Core
+} // namespace SDMS
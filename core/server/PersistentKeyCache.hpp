@@ -0,0 +1,122 @@
+#ifndef PERSISTENTKEYCACHE_HPP
+#define PERSISTENTKEYCACHE_HPP
+#pragma once
+
+// Standard includes
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <set>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Bounded LRU cache of persistent user public key lookups.
+ *
+ * Both outcomes of a DB lookup are cached: keys that map to a user (positive
+ * entries) and keys the DB does not know (negative entries), each with their
+ * own time to live. Lookups that failed because the DB could not be reached
+ * are remembered for a shorter time so a DB outage does not turn every
+ * message into a DB request.
+ *
+ * The cache also tracks which keys have a lookup in flight, so that only one
+ * asynchronous lookup is issued per key. Lookups are stamped with a
+ * generation and invalidations record the generation at which a key, or the
+ * keys of a user, were dropped. A result is not stored if its key or user was
+ * invalidated after the lookup started, so a revoked key can not be re-added
+ * by a slow lookup while lookups for other keys are kept.
+ */
+class PersistentKeyCache {
+public:
+  enum class Lookup {
+    MISS,      ///< Not cached, needs a DB lookup
+    PENDING,   ///< Not cached, a lookup is in flight
+    FOUND,     ///< Key belongs to a user
+    NOT_FOUND, ///< Key is unknown, or the DB could not be reached
+  };
+
+  PersistentKeyCache(size_t a_capacity = 10000,
+                     std::chrono::seconds a_ttl = std::chrono::seconds(300),
+                     std::chrono::seconds a_negative_ttl =
+                         std::chrono::seconds(30),
+                     std::chrono::seconds a_failure_ttl =
+                         std::chrono::seconds(5));
+
+  PersistentKeyCache(const PersistentKeyCache &) = delete;
+  PersistentKeyCache &operator=(const PersistentKeyCache &) = delete;
+
+  /// Look up a key, a_uid is set if FOUND is returned
+  Lookup get(const std::string &a_key, std::string &a_uid);
+
+  /**
+   * Mark a lookup as started. Returns false if a lookup for the key is
+   * already in flight. a_generation must be passed back to the store call.
+   */
+  bool beginLookup(const std::string &a_key, uint64_t &a_generation);
+
+  /// Current generation, for lookups that do not go through beginLookup
+  uint64_t generation() const;
+
+  /// Store the outcome of a lookup, a_found false adds a negative entry
+  void store(const std::string &a_key, uint64_t a_generation, bool a_found,
+             const std::string &a_uid);
+
+  /// Record that the DB could not be reached when looking up a key
+  void storeFailure(const std::string &a_key, uint64_t a_generation);
+
+  /// Drop a single key
+  void invalidate(const std::string &a_key);
+
+  /// Drop all keys belonging to a user, i.e. after the keys were revoked
+  void invalidateUID(const std::string &a_uid);
+
+  void clear();
+
+  size_t size() const;
+
+private:
+  typedef std::chrono::steady_clock clock_t;
+
+  struct Entry {
+    std::string uid;
+    bool found = false;
+    clock_t::time_point expires;
+    std::list<std::string>::iterator lru;
+  };
+
+  void insert(const std::string &a_key, uint64_t a_generation, bool a_found,
+              const std::string &a_uid, std::chrono::seconds a_ttl);
+  void erase(std::unordered_map<std::string, Entry>::iterator a_entry);
+  bool invalidated(const std::string &a_key, uint64_t a_generation,
+                   bool a_found, const std::string &a_uid) const;
+  void recordInvalidation(std::unordered_map<std::string, uint64_t> &a_records,
+                          const std::string &a_name);
+
+  size_t m_capacity;
+  std::chrono::seconds m_ttl;
+  std::chrono::seconds m_negative_ttl;
+  std::chrono::seconds m_failure_ttl;
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<std::string, Entry> m_entries;
+  /// Most recently used key first
+  std::list<std::string> m_lru;
+  std::set<std::string> m_in_flight;
+  uint64_t m_generation = 0;
+  /// Results of lookups started before this generation are dropped
+  uint64_t m_min_generation = 0;
+  /// Generation at which a key was last invalidated
+  std::unordered_map<std::string, uint64_t> m_invalidated_keys;
+  /// Generation at which the keys of a user were last invalidated
+  std::unordered_map<std::string, uint64_t> m_invalidated_uids;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
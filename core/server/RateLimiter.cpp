@@ -0,0 +1,85 @@
+// Local private includes
+#include "RateLimiter.hpp"
+
+// Standard includes
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+void RateLimiter::setLimit(MessageLanes::Lane a_lane, double a_rate,
+                           double a_burst) {
+  lock_guard<mutex> lock(m_mutex);
+  m_limits[a_lane].rate = max(a_rate, 0.0);
+  // At least one request must always get through
+  m_limits[a_lane].burst = max(a_burst, 1.0);
+}
+
+bool RateLimiter::admit(const std::string &a_uid, uint16_t a_msg_type,
+                        uint32_t &a_retry_after_ms, clock::time_point a_now) {
+  // Unauthenticated clients share "anon" and repo servers act for all users
+  if (a_uid == "anon" || a_uid.compare(0, 5, "repo/") == 0)
+    return true;
+
+  const MessageLanes::Lane lane = m_lanes.lane(a_msg_type);
+
+  lock_guard<mutex> lock(m_mutex);
+  const Limit &limit = m_limits[lane];
+  if (limit.rate == 0)
+    return true;
+
+  Bucket &bucket = m_buckets[a_uid][lane];
+  if (bucket.last == clock::time_point()) {
+    bucket.tokens = limit.burst;
+  } else {
+    double elapsed = chrono::duration<double>(a_now - bucket.last).count();
+    bucket.tokens = min(limit.burst, bucket.tokens + elapsed * limit.rate);
+  }
+  bucket.last = a_now;
+
+  if (bucket.tokens >= 1) {
+    bucket.tokens -= 1;
+    return true;
+  }
+
+  a_retry_after_ms = (uint32_t)ceil((1 - bucket.tokens) / limit.rate * 1000);
+  m_drops[a_uid]++;
+  return false;
+}
+
+std::map<std::string, uint64_t> RateLimiter::takeDrops() {
+  map<string, uint64_t> drops;
+  lock_guard<mutex> lock(m_mutex);
+  drops.swap(m_drops);
+  return drops;
+}
+
+size_t RateLimiter::purge(clock::time_point a_now) {
+  lock_guard<mutex> lock(m_mutex);
+  size_t count = 0;
+
+  for (auto user = m_buckets.begin(); user != m_buckets.end();) {
+    bool full = true;
+    for (size_t l = 0; l < MessageLanes::LANE_COUNT && full; ++l) {
+      const Bucket &bucket = user->second[l];
+      if (bucket.last == clock::time_point() || m_limits[l].rate == 0)
+        continue;
+      double elapsed = chrono::duration<double>(a_now - bucket.last).count();
+      full = bucket.tokens + elapsed * m_limits[l].rate >= m_limits[l].burst;
+    }
+
+    if (full) {
+      user = m_buckets.erase(user);
+      count++;
+    } else {
+      ++user;
+    }
+  }
+  return count;
+}
+
+} // namespace Core
+} // namespace SDMS
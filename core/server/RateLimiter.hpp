@@ -0,0 +1,79 @@
+#ifndef RATELIMITER_HPP
+#define RATELIMITER_HPP
+#pragma once
+
+// Local private includes
+#include "MessageLanes.hpp"
+
+// Standard includes
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Token bucket rate limits per user and message lane.
+ *
+ * Every user has a bucket per lane that refills at the lane's rate and holds
+ * at most its burst, a request takes one token. Requests of users that run
+ * out are refused with the time until the next token, so one runaway client
+ * can not fill the worker queues everyone shares.
+ *
+ * Anonymous requests and repository servers are not limited. Thread safe.
+ */
+class RateLimiter {
+public:
+  typedef std::chrono::steady_clock clock;
+
+  explicit RateLimiter(const MessageLanes &a_lanes) : m_lanes(a_lanes) {}
+
+  /**
+   * Requests per second a user may send to a lane, up to a_burst of them at
+   * once. A rate of 0 turns the limit off.
+   */
+  void setLimit(MessageLanes::Lane a_lane, double a_rate, double a_burst);
+
+  /**
+   * Takes a token for the request, returns false and sets a_retry_after_ms
+   * if the user is over the limit of the message's lane.
+   */
+  bool admit(const std::string &a_uid, uint16_t a_msg_type,
+             uint32_t &a_retry_after_ms, clock::time_point a_now = clock::now());
+
+  /// Refused requests per user since the last call
+  std::map<std::string, uint64_t> takeDrops();
+
+  /// Forgets users whose buckets are full again, returns how many
+  size_t purge(clock::time_point a_now = clock::now());
+
+private:
+  struct Limit {
+    double rate = 0;
+    double burst = 0;
+  };
+
+  struct Bucket {
+    double tokens = 0;
+    /// Default until first used
+    clock::time_point last;
+  };
+
+  typedef std::array<Bucket, MessageLanes::LANE_COUNT> buckets_t;
+
+  const MessageLanes &m_lanes;
+  std::array<Limit, MessageLanes::LANE_COUNT> m_limits{};
+  std::unordered_map<std::string, buckets_t> m_buckets;
+  std::map<std::string, uint64_t> m_drops;
+  std::mutex m_mutex;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
@@ -0,0 +1,100 @@
+// Local private includes
+#include "RepoConnectionPool.hpp"
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+RepoConnectionPool::RepoConnectionPool(size_t a_max_idle_per_repo)
+    : m_max_idle_per_repo(a_max_idle_per_repo) {}
+
+void RepoConnectionPool::setMaxIdlePerRepo(size_t a_max_idle) {
+  lock_guard<mutex> lock(m_mutex);
+  m_max_idle_per_repo = a_max_idle;
+}
+
+RepoConnectionPool::Connection
+RepoConnectionPool::acquire(const std::string &a_repo_id,
+                            const std::string &a_address,
+                            const std::string &a_pub_key,
+                            const connect_fun_t &a_connect) {
+  // Closed once the lock is released
+  vector<unique_ptr<ICommunicator>> stale;
+  uint64_t generation;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    Repo &repo = m_repos[a_repo_id];
+    if (repo.address != a_address || repo.pub_key != a_pub_key) {
+      m_stats.discarded += repo.idle.size();
+      stale.swap(repo.idle);
+      repo.address = a_address;
+      repo.pub_key = a_pub_key;
+      repo.generation = ++m_generation;
+    }
+    generation = repo.generation;
+
+    m_stats.acquired++;
+    m_stats.in_use++;
+
+    if (!repo.idle.empty()) {
+      unique_ptr<ICommunicator> comm = std::move(repo.idle.back());
+      repo.idle.pop_back();
+      m_stats.reused++;
+      return Connection(*this, a_repo_id, generation, std::move(comm));
+    }
+  }
+
+  // Connecting does not wait for the handshake, but keep it outside the lock
+  // all the same
+  unique_ptr<ICommunicator> comm;
+  try {
+    comm = a_connect(a_address, a_pub_key,
+                     "core_repo_client-" + to_string(m_next_socket_id++));
+  } catch (...) {
+    lock_guard<mutex> lock(m_mutex);
+    m_stats.in_use--;
+    throw;
+  }
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_stats.created++;
+  }
+
+  return Connection(*this, a_repo_id, generation, std::move(comm));
+}
+
+void RepoConnectionPool::release(const std::string &a_repo_id,
+                                 uint64_t a_generation,
+                                 std::unique_ptr<ICommunicator> a_comm,
+                                 bool a_reuse) {
+  lock_guard<mutex> lock(m_mutex);
+
+  m_stats.in_use--;
+
+  auto repo = m_repos.find(a_repo_id);
+  if (!a_reuse || repo == m_repos.end() ||
+      repo->second.generation != a_generation ||
+      repo->second.idle.size() >= m_max_idle_per_repo) {
+    m_stats.discarded++;
+    return;
+  }
+
+  repo->second.idle.push_back(std::move(a_comm));
+}
+
+RepoConnectionPool::Stats RepoConnectionPool::getStats() const {
+  lock_guard<mutex> lock(m_mutex);
+
+  Stats stats = m_stats;
+  for (auto &repo : m_repos)
+    stats.idle += repo.second.idle.size();
+
+  return stats;
+}
+
+} // namespace Core
+} // namespace SDMS
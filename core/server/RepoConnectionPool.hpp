@@ -0,0 +1,133 @@
+#ifndef REPOCONNECTIONPOOL_HPP
+#define REPOCONNECTIONPOOL_HPP
+#pragma once
+
+// Common public includes
+#include "common/ICommunicator.hpp"
+
+// Standard includes
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Process-wide pool of authenticated client connections from the core to the
+ * repository servers, kept per repo id.
+ *
+ * Task workers used to build a new secure socket, and so pay for a new CURVE
+ * handshake, for every delete, size or path request. Connections are now
+ * borrowed for a single request and handed back afterwards. The connections
+ * of a repo are only dropped when its address or public key changes.
+ *
+ * A connection only goes back to the pool once the borrower marks its
+ * exchange as complete. After a timeout or failure a late reply could still
+ * arrive and would be read by the next request, so such connections are
+ * closed.
+ */
+class RepoConnectionPool {
+public:
+  /// Creates a client connection to the repo at a_address
+  typedef std::function<std::unique_ptr<ICommunicator>(
+      const std::string &a_address, const std::string &a_pub_key,
+      const std::string &a_socket_id)>
+      connect_fun_t;
+
+  struct Stats {
+    size_t created = 0;   ///< Connections created so far
+    size_t in_use = 0;    ///< Connections currently borrowed
+    size_t idle = 0;      ///< Connections waiting in the pool
+    size_t acquired = 0;  ///< Total number of borrows
+    size_t reused = 0;    ///< Borrows served by an idle connection
+    size_t discarded = 0; ///< Connections closed instead of reused
+  };
+
+  /**
+   * RAII lease on a pooled connection. When the lease goes out of scope the
+   * connection is returned to the pool if reuse() was called, otherwise it is
+   * closed.
+   */
+  class Connection {
+  public:
+    Connection(RepoConnectionPool &a_pool, const std::string &a_repo_id,
+               uint64_t a_generation, std::unique_ptr<ICommunicator> a_comm)
+        : m_pool(&a_pool), m_repo_id(a_repo_id), m_generation(a_generation),
+          m_comm(std::move(a_comm)) {}
+    Connection(Connection &&a_other) noexcept = default;
+    Connection(const Connection &) = delete;
+    Connection &operator=(const Connection &) = delete;
+    Connection &operator=(Connection &&) = delete;
+    ~Connection() {
+      if (m_comm)
+        m_pool->release(m_repo_id, m_generation, std::move(m_comm), m_reuse);
+    }
+
+    ICommunicator *operator->() const { return m_comm.get(); }
+    ICommunicator &operator*() const { return *m_comm; }
+
+    /// The exchange completed, nothing more will arrive on the connection
+    void reuse() { m_reuse = true; }
+
+  private:
+    RepoConnectionPool *m_pool;
+    std::string m_repo_id;
+    uint64_t m_generation;
+    std::unique_ptr<ICommunicator> m_comm;
+    bool m_reuse = false;
+  };
+
+  static RepoConnectionPool &getInstance() {
+    static RepoConnectionPool inst;
+    return inst;
+  }
+
+  explicit RepoConnectionPool(size_t a_max_idle_per_repo = 16);
+  RepoConnectionPool(const RepoConnectionPool &) = delete;
+  RepoConnectionPool &operator=(const RepoConnectionPool &) = delete;
+
+  /// Idle connections kept per repo, more than this are closed on return
+  void setMaxIdlePerRepo(size_t a_max_idle);
+
+  /**
+   * Borrow a connection to a repo. An idle connection is reused if the
+   * repo's address and key are unchanged, otherwise a_connect creates one.
+   */
+  Connection acquire(const std::string &a_repo_id,
+                     const std::string &a_address,
+                     const std::string &a_pub_key,
+                     const connect_fun_t &a_connect);
+
+  Stats getStats() const;
+
+private:
+  struct Repo {
+    std::string address;
+    std::string pub_key;
+    /// Bumped whenever address or key change, older leases are not returned
+    uint64_t generation = 0;
+    std::vector<std::unique_ptr<ICommunicator>> idle;
+  };
+
+  void release(const std::string &a_repo_id, uint64_t a_generation,
+               std::unique_ptr<ICommunicator> a_comm, bool a_reuse);
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, Repo> m_repos;
+  size_t m_max_idle_per_repo;
+  uint64_t m_generation = 0;
+  std::atomic<uint64_t> m_next_socket_id{0};
+  Stats m_stats;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
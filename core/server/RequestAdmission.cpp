@@ -0,0 +1,47 @@
+// Local private includes
+#include "RequestAdmission.hpp"
+
+// Proto files
+#include "common/SDMS.pb.h"
+#include "common/SDMS_Anon.pb.h"
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+namespace {
+/// Message types above this require an authenticated user
+const uint16_t MAX_ANON_MSG_TYPE = 0x1FF;
+} // namespace
+
+Admission admitRequest(const IMessage &a_request, uint16_t a_msg_type,
+                       const string &a_uid,
+                       chrono::steady_clock::time_point a_now) {
+  if (a_uid.compare("anon") == 0 && a_msg_type > MAX_ANON_MSG_TYPE)
+    return Admission::AUTHN_REQUIRED;
+
+  if (a_request.getDeadline() <= a_now)
+    return Admission::EXPIRED;
+
+  return Admission::ACCEPT;
+}
+
+unique_ptr<IMessage> refuseRequest(const MessageFactory &a_msg_factory,
+                                   const IMessage &a_request,
+                                   Admission a_admission) {
+  auto response_msg = a_msg_factory.createResponseEnvelope(a_request);
+  auto nack = make_unique<Anon::NackReply>();
+  if (a_admission == Admission::AUTHN_REQUIRED) {
+    nack->set_err_code(ID_AUTHN_REQUIRED);
+    nack->set_err_msg("Authentication required");
+  } else {
+    nack->set_err_code(ID_SERVICE_ERROR);
+    nack->set_err_msg("Request deadline passed before it was processed");
+  }
+  response_msg->setPayload(move(nack));
+  return response_msg;
+}
+
+} // namespace Core
+} // namespace SDMS
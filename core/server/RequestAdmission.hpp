@@ -0,0 +1,43 @@
+#ifndef REQUESTADMISSION_HPP
+#define REQUESTADMISSION_HPP
+#pragma once
+
+// Common public includes
+#include "common/IMessage.hpp"
+#include "common/MessageFactory.hpp"
+
+// Standard includes
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Checks a ClientWorker makes before a request reaches its handler. A request
+ * that is not accepted is answered with a NackReply instead, so the message
+ * router stops counting it as in flight.
+ */
+enum class Admission {
+  ACCEPT,
+  /// Anonymous users may only send the unauthenticated message types
+  AUTHN_REQUIRED,
+  /// The client has stopped waiting for the reply
+  EXPIRED
+};
+
+Admission admitRequest(const IMessage &a_request, uint16_t a_msg_type,
+                       const std::string &a_uid,
+                       std::chrono::steady_clock::time_point a_now);
+
+/// Builds the NackReply for a request that was not accepted
+std::unique_ptr<IMessage> refuseRequest(const MessageFactory &a_msg_factory,
+                                        const IMessage &a_request,
+                                        Admission a_admission);
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
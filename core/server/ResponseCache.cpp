@@ -0,0 +1,191 @@
+// Local private includes
+#include "ResponseCache.hpp"
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Only writes that change the DB before their reply is sent are linked.
+ * Deleting records, collections and projects, and creating or deleting
+ * allocations, only queue a task and reply with TaskDataReply. The change is
+ * made later by a task worker, so replies to the reads they affect stay
+ * stale until their time to live runs out.
+ */
+const std::vector<ResponseCache::Policy> &ResponseCache::defaultPolicies() {
+  static const vector<Policy> policies = {
+      {"TopicListTopicsRequest",
+       60,
+       true,
+       {"CollCreateRequest", "CollUpdateRequest"}},
+      {"TagListByCountRequest",
+       60,
+       true,
+       {"RecordCreateRequest", "RecordCreateBatchRequest",
+        "RecordUpdateRequest", "RecordUpdateBatchRequest",
+        "CollCreateRequest", "CollUpdateRequest"}},
+      {"CollListPublishedRequest",
+       30,
+       false,
+       {"CollCreateRequest", "CollUpdateRequest", "ACLUpdateRequest"}},
+      {"RepoListRequest",
+       30,
+       false,
+       {"RepoCreateRequest", "RepoUpdateRequest", "RepoDeleteRequest"}},
+      {"SchemaViewRequest",
+       300,
+       false,
+       {"SchemaCreateRequest", "SchemaReviseRequest", "SchemaUpdateRequest",
+        "SchemaDeleteRequest"}},
+      {"UserViewRequest",
+       30,
+       false,
+       {"UserCreateRequest", "UserUpdateRequest",
+        "UserSetAccessTokenRequest", "RepoAllocationSetRequest",
+        "RepoAllocationSetDefaultRequest"}}};
+  return policies;
+}
+
+void ResponseCache::setCapacity(size_t a_bytes) {
+  lock_guard<mutex> lock(m_mutex);
+  m_capacity = a_bytes;
+  while (m_stats.bytes > m_capacity) {
+    erase(prev(m_lru.end()));
+    m_stats.evicted++;
+  }
+}
+
+void ResponseCache::enable(uint16_t a_msg_type, std::chrono::milliseconds a_ttl,
+                           bool a_shared) {
+  lock_guard<mutex> lock(m_mutex);
+  if (a_msg_type >= m_policies.size())
+    m_policies.resize(a_msg_type + 1);
+  m_policies[a_msg_type].ttl = a_ttl;
+  m_policies[a_msg_type].shared = a_shared;
+}
+
+void ResponseCache::invalidateOn(uint16_t a_write_type, uint16_t a_read_type) {
+  lock_guard<mutex> lock(m_mutex);
+  if (a_write_type >= m_invalidates.size())
+    m_invalidates.resize(a_write_type + 1);
+  m_invalidates[a_write_type].push_back(a_read_type);
+}
+
+bool ResponseCache::enabled(uint16_t a_msg_type) const {
+  // Policies and capacity are fixed before the cache is used, no lock needed
+  return m_capacity && a_msg_type < m_policies.size() &&
+         m_policies[a_msg_type].ttl.count() > 0;
+}
+
+bool ResponseCache::get(uint16_t a_msg_type, const std::string &a_uid,
+                        const std::string &a_request, std::string &a_reply,
+                        Ticket &a_ticket, clock::time_point a_now) {
+  a_ticket.key.clear();
+  if (!enabled(a_msg_type))
+    return false;
+
+  const TypePolicy &policy = m_policies[a_msg_type];
+  string key;
+  key.reserve(sizeof(a_msg_type) + a_uid.size() + 1 + a_request.size());
+  key.append((const char *)&a_msg_type, sizeof(a_msg_type));
+  if (!policy.shared)
+    key.append(a_uid);
+  key.push_back('\0');
+  key.append(a_request);
+
+  lock_guard<mutex> lock(m_mutex);
+  auto entry = m_entries.find(key);
+  if (entry != m_entries.end()) {
+    lru_t::iterator e = entry->second;
+    if (e->generation == policy.generation && e->expires > a_now) {
+      m_lru.splice(m_lru.begin(), m_lru, e);
+      a_reply = e->reply;
+      m_stats.hits++;
+      return true;
+    }
+    // Invalidated replies are dropped here rather than searched for
+    erase(e);
+    m_stats.expired++;
+  }
+
+  m_stats.misses++;
+  a_ticket.key = std::move(key);
+  a_ticket.msg_type = a_msg_type;
+  a_ticket.generation = policy.generation;
+  return false;
+}
+
+void ResponseCache::put(const Ticket &a_ticket, const std::string &a_reply,
+                        clock::time_point a_now) {
+  if (a_ticket.key.empty())
+    return;
+
+  lock_guard<mutex> lock(m_mutex);
+  const TypePolicy &policy = m_policies[a_ticket.msg_type];
+  if (policy.generation != a_ticket.generation)
+    return;
+
+  Entry entry{a_ticket.key, a_reply, a_ticket.msg_type, a_ticket.generation,
+              a_now + policy.ttl};
+  size_t size = entrySize(entry);
+  // A few huge replies would push out everything else
+  if (size > m_capacity / 8)
+    return;
+
+  auto old = m_entries.find(entry.key);
+  if (old != m_entries.end())
+    erase(old->second);
+
+  m_lru.push_front(std::move(entry));
+  m_entries[m_lru.front().key] = m_lru.begin();
+  m_stats.bytes += size;
+  m_stats.entries++;
+  m_stats.stored++;
+
+  while (m_stats.bytes > m_capacity) {
+    erase(prev(m_lru.end()));
+    m_stats.evicted++;
+  }
+}
+
+void ResponseCache::invalidate(uint16_t a_msg_type) {
+  // Links are fixed before the cache is used, no lock needed
+  if (a_msg_type >= m_invalidates.size() || m_invalidates[a_msg_type].empty())
+    return;
+
+  lock_guard<mutex> lock(m_mutex);
+  for (uint16_t read_type : m_invalidates[a_msg_type]) {
+    if (read_type < m_policies.size())
+      m_policies[read_type].generation++;
+  }
+  m_stats.invalidations++;
+}
+
+void ResponseCache::clear() {
+  lock_guard<mutex> lock(m_mutex);
+  m_lru.clear();
+  m_entries.clear();
+  m_stats.bytes = 0;
+  m_stats.entries = 0;
+}
+
+ResponseCache::Stats ResponseCache::getStats() const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_stats;
+}
+
+size_t ResponseCache::entrySize(const Entry &a_entry) {
+  // The key is held by the entry and the index
+  return sizeof(Entry) + 2 * a_entry.key.size() + a_entry.reply.size();
+}
+
+void ResponseCache::erase(lru_t::iterator a_entry) {
+  m_stats.bytes -= entrySize(*a_entry);
+  m_stats.entries--;
+  m_entries.erase(a_entry->key);
+  m_lru.erase(a_entry);
+}
+
+} // namespace Core
+} // namespace SDMS
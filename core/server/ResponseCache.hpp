@@ -0,0 +1,142 @@
+#ifndef RESPONSECACHE_HPP
+#define RESPONSECACHE_HPP
+#pragma once
+
+// Standard includes
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Process-wide cache of serialized replies to DB pass-through requests,
+ * shared by all ClientWorkers.
+ *
+ * Only message types that were enabled are cached, each with its own time to
+ * live. Replies are keyed by the serialized request and, unless the reply is
+ * the same for everyone, by the user that sent it. Handling a write request
+ * drops the cached replies of the read requests it is linked to, and a reply
+ * that was read from the DB before such a write is not stored afterwards.
+ *
+ * The cache holds at most the configured number of bytes, the least recently
+ * used replies are evicted first.
+ *
+ * Message types must be enabled and linked before the cache is used.
+ */
+class ResponseCache {
+public:
+  typedef std::chrono::steady_clock clock;
+
+  struct Policy {
+    const char *name;
+    /// Seconds a reply is kept
+    uint32_t ttl;
+    /// The reply does not depend on who sent the request
+    bool shared;
+    /// Write requests after which the cached replies are dropped, must
+    /// change the DB before they are answered
+    std::vector<const char *> invalidated_by;
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stored = 0;
+    /// Replies found past their time to live or invalidated
+    uint64_t expired = 0;
+    uint64_t evicted = 0;
+    /// Write requests that dropped cached replies
+    uint64_t invalidations = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+  };
+
+  /// Handed out by a missed lookup, needed to store the reply
+  struct Ticket {
+    std::string key;
+    uint16_t msg_type = 0;
+    uint64_t generation = 0;
+  };
+
+  static ResponseCache &getInstance() {
+    static ResponseCache inst;
+    return inst;
+  }
+
+  /// Read requests cached unless configured otherwise
+  static const std::vector<Policy> &defaultPolicies();
+
+  ResponseCache() {}
+  ResponseCache(const ResponseCache &) = delete;
+  ResponseCache &operator=(const ResponseCache &) = delete;
+
+  /// Most bytes of keys and replies held, 0 turns the cache off
+  void setCapacity(size_t a_bytes);
+  void enable(uint16_t a_msg_type, std::chrono::milliseconds a_ttl,
+              bool a_shared);
+  /// Handling a_write_type drops the cached replies to a_read_type
+  void invalidateOn(uint16_t a_write_type, uint16_t a_read_type);
+
+  bool enabled(uint16_t a_msg_type) const;
+
+  /**
+   * Looks up the reply to a request. On a miss a_ticket is set up for
+   * storing the reply with put().
+   */
+  bool get(uint16_t a_msg_type, const std::string &a_uid,
+           const std::string &a_request, std::string &a_reply,
+           Ticket &a_ticket, clock::time_point a_now = clock::now());
+  /// Stores the reply unless a write invalidated it since the lookup
+  void put(const Ticket &a_ticket, const std::string &a_reply,
+           clock::time_point a_now = clock::now());
+
+  /// Called once a request was handled, drops the replies it may change
+  void invalidate(uint16_t a_msg_type);
+
+  void clear();
+
+  Stats getStats() const;
+
+private:
+  struct TypePolicy {
+    std::chrono::milliseconds ttl{0};
+    bool shared = false;
+    /// Bumped by every invalidation, older lookups may not store replies
+    uint64_t generation = 0;
+  };
+
+  struct Entry {
+    std::string key;
+    std::string reply;
+    uint16_t msg_type;
+    uint64_t generation;
+    clock::time_point expires;
+  };
+
+  typedef std::list<Entry> lru_t;
+
+  static size_t entrySize(const Entry &a_entry);
+  void erase(lru_t::iterator a_entry);
+
+  /// Indexed by message type
+  std::vector<TypePolicy> m_policies;
+  std::vector<std::vector<uint16_t>> m_invalidates;
+
+  mutable std::mutex m_mutex;
+  size_t m_capacity = 0;
+  /// Most recently used first
+  lru_t m_lru;
+  std::unordered_map<std::string, lru_t::iterator> m_entries;
+  Stats m_stats;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
@@ -0,0 +1,170 @@
+// Local private includes
+#include "SchemaValidatorCache.hpp"
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+SchemaValidatorCache::definition_ptr_t
+SchemaValidatorCache::getDefinition(const std::string &a_uid,
+                                    const std::string &a_id,
+                                    const fetch_t &a_fetch) {
+  return getEntry(a_uid, a_id, a_fetch).definition;
+}
+
+SchemaValidatorCache::DefinitionEntry
+SchemaValidatorCache::getEntry(const std::string &a_uid,
+                               const std::string &a_id,
+                               const fetch_t &a_fetch) {
+  uint64_t generation;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    auto def = find(m_definitions, a_uid, a_id);
+    if (def != m_definitions.end())
+      return def->second;
+
+    generation = m_generation;
+  }
+
+  // Fetch and parse without holding the lock, the DB may be slow
+  Source source = a_fetch(a_id);
+  DefinitionEntry entry{make_shared<const nlohmann::json>(
+                            nlohmann::json::parse(source.definition)),
+                        source.pub};
+
+  lock_guard<mutex> lock(m_mutex);
+
+  m_stats.fetches++;
+  if (generation == m_generation)
+    m_definitions[entry.pub ? a_id : privateKey(a_uid, a_id)] = entry;
+
+  return entry;
+}
+
+SchemaValidatorCache::validator_ptr_t
+SchemaValidatorCache::getValidator(const std::string &a_uid,
+                                   const std::string &a_id,
+                                   const fetch_t &a_fetch) {
+  uint64_t generation;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    auto entry = find(m_validators, a_uid, a_id);
+    if (entry != m_validators.end()) {
+      m_stats.hits++;
+      return entry->second.validator;
+    }
+
+    m_stats.misses++;
+    generation = m_generation;
+  }
+
+  DefinitionEntry def = getEntry(a_uid, a_id, a_fetch);
+
+  // The loader is only invoked while compiling (set_root_schema), so it is
+  // safe for it to use the caller's fetch function.
+  auto refs = make_shared<set<string>>();
+  auto pub = make_shared<bool>(def.pub);
+  refs->insert(a_id);
+
+  auto validator = make_shared<nlohmann::json_schema::json_validator>(
+      [this, a_uid, a_fetch, refs, pub](const nlohmann::json_uri &a_uri,
+                                        nlohmann::json &a_value) {
+        DefinitionEntry ref = getEntry(a_uid, referenceID(a_uri), a_fetch);
+        refs->insert(referenceID(a_uri));
+        *pub = *pub && ref.pub;
+        a_value = *ref.definition;
+      });
+
+  validator->set_root_schema(*def.definition);
+
+  lock_guard<mutex> lock(m_mutex);
+
+  if (generation == m_generation)
+    m_validators[*pub ? a_id : privateKey(a_uid, a_id)] =
+        ValidatorEntry{validator, *refs};
+
+  return validator;
+}
+
+void SchemaValidatorCache::loadReference(const std::string &a_uid,
+                                         const nlohmann::json_uri &a_uri,
+                                         nlohmann::json &a_value,
+                                         const fetch_t &a_fetch) {
+  a_value = *getDefinition(a_uid, referenceID(a_uri), a_fetch);
+}
+
+void SchemaValidatorCache::invalidate(const std::string &a_id) {
+  lock_guard<mutex> lock(m_mutex);
+
+  m_generation++;
+
+  // The public entry and the private ones of every user
+  const string user_keys = privateKey("", a_id);
+  for (auto def = m_definitions.lower_bound(a_id);
+       def != m_definitions.end() &&
+       (def->first == a_id || def->first.compare(0, user_keys.size(),
+                                                 user_keys) == 0);) {
+    def = m_definitions.erase(def);
+    m_stats.invalidated++;
+  }
+
+  for (auto entry = m_validators.begin(); entry != m_validators.end();) {
+    if (entry->second.refs.count(a_id)) {
+      entry = m_validators.erase(entry);
+      m_stats.invalidated++;
+    } else {
+      ++entry;
+    }
+  }
+}
+
+void SchemaValidatorCache::clear() {
+  lock_guard<mutex> lock(m_mutex);
+
+  m_generation++;
+  m_definitions.clear();
+  m_validators.clear();
+}
+
+SchemaValidatorCache::Stats SchemaValidatorCache::getStats() const {
+  lock_guard<mutex> lock(m_mutex);
+
+  return m_stats;
+}
+
+std::string SchemaValidatorCache::privateKey(const std::string &a_uid,
+                                             const std::string &a_id) {
+  string key;
+  key.reserve(a_id.size() + 1 + a_uid.size());
+  key.append(a_id);
+  key.push_back('\0');
+  key.append(a_uid);
+  return key;
+}
+
+std::string SchemaValidatorCache::referenceID(const nlohmann::json_uri &a_uri) {
+  // Schema references are of the form "/<id>", skip leading "/"
+  return a_uri.path().substr(1);
+}
+
+/**
+ * Finds the entry of a schema visible to the user, the public one or the
+ * user's own. Must be called with m_mutex held.
+ */
+template <typename T>
+typename std::map<std::string, T>::iterator
+SchemaValidatorCache::find(std::map<std::string, T> &a_map,
+                           const std::string &a_uid, const std::string &a_id) {
+  auto entry = a_map.find(a_id);
+  if (entry != a_map.end())
+    return entry;
+  return a_map.find(privateKey(a_uid, a_id));
+}
+
+} // namespace Core
+} // namespace SDMS
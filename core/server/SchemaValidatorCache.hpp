@@ -0,0 +1,132 @@
+#ifndef SCHEMAVALIDATORCACHE_HPP
+#define SCHEMAVALIDATORCACHE_HPP
+#pragma once
+
+// Third party includes
+#include <nlohmann/json-schema.hpp>
+#include <nlohmann/json.hpp>
+
+// Standard includes
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Process-wide cache of parsed metadata schema definitions and compiled
+ * JSON-schema validators, shared by all ClientWorkers.
+ *
+ * Entries are keyed by schema ID, which already includes the schema revision
+ * (id:revision). Schema definitions are fetched through a caller supplied
+ * function so that each worker can use its own DatabaseAPI instance, the DB
+ * checks that the user may view the schema. Public schemas are shared by all
+ * users, private ones are only handed back to the user they were fetched for,
+ * so a cache hit never skips the access check. A validator is private if any
+ * schema it references is. Compiled validators remember every schema they
+ * referenced via $ref, and are dropped when any of them is invalidated.
+ *
+ * Compiled validators are immutable and can be used by several threads at
+ * once.
+ */
+class SchemaValidatorCache {
+public:
+  /// A schema definition as fetched from the DB
+  struct Source {
+    std::string definition; ///< JSON text of the definition
+    bool pub = false;       ///< Viewable by every user
+  };
+
+  /// Fetches the given schema ID on behalf of the user, throws if denied
+  typedef std::function<Source(const std::string &a_id)> fetch_t;
+  typedef std::shared_ptr<const nlohmann::json> definition_ptr_t;
+  typedef std::shared_ptr<const nlohmann::json_schema::json_validator>
+      validator_ptr_t;
+
+  struct Stats {
+    size_t hits = 0;        ///< Validator lookups served from the cache
+    size_t misses = 0;      ///< Validator lookups that required compiling
+    size_t fetches = 0;     ///< Schema definitions loaded from the DB
+    size_t invalidated = 0; ///< Entries dropped by invalidate()
+  };
+
+  static SchemaValidatorCache &getInstance() {
+    static SchemaValidatorCache inst;
+    return inst;
+  }
+
+  SchemaValidatorCache(const SchemaValidatorCache &) = delete;
+  SchemaValidatorCache &operator=(const SchemaValidatorCache &) = delete;
+
+  /// Get the parsed definition of a schema, fetching it if not cached
+  definition_ptr_t getDefinition(const std::string &a_uid,
+                                 const std::string &a_id,
+                                 const fetch_t &a_fetch);
+
+  /// Get a compiled validator for a schema, compiling it if not cached
+  validator_ptr_t getValidator(const std::string &a_uid,
+                               const std::string &a_id,
+                               const fetch_t &a_fetch);
+
+  /// Resolve a $ref to another schema, for use as a json_validator loader
+  void loadReference(const std::string &a_uid, const nlohmann::json_uri &a_uri,
+                     nlohmann::json &a_value, const fetch_t &a_fetch);
+
+  /**
+   * Drop a schema definition, its validator and any validators that
+   * reference it, for all users. Must be called whenever a schema is
+   * created, updated, revised or deleted.
+   */
+  void invalidate(const std::string &a_id);
+
+  void clear();
+
+  Stats getStats() const;
+
+private:
+  struct DefinitionEntry {
+    definition_ptr_t definition;
+    bool pub;
+  };
+
+  struct ValidatorEntry {
+    validator_ptr_t validator;
+    std::set<std::string> refs; ///< IDs of all schemas used by the validator
+  };
+
+  SchemaValidatorCache() {}
+
+  DefinitionEntry getEntry(const std::string &a_uid, const std::string &a_id,
+                           const fetch_t &a_fetch);
+
+  /**
+   * Key of an entry only visible to a_uid, public entries are keyed by the
+   * ID alone. Keys of the same ID sort next to each other.
+   */
+  static std::string privateKey(const std::string &a_uid,
+                                const std::string &a_id);
+  static std::string referenceID(const nlohmann::json_uri &a_uri);
+
+  template <typename T>
+  static typename std::map<std::string, T>::iterator
+  find(std::map<std::string, T> &a_map, const std::string &a_uid,
+       const std::string &a_id);
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, DefinitionEntry> m_definitions;
+  std::map<std::string, ValidatorEntry> m_validators;
+  /// Bumped on every invalidation, entries built across a bump are not cached
+  uint64_t m_generation = 0;
+  Stats m_stats;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
@@ -3,6 +3,7 @@
 #include "TaskMgr.hpp"
 #include "Config.hpp"
 #include "DatabaseAPI.hpp"
+#include "GlobusAPI.hpp"
 #include "TaskWorker.hpp"
 
 // Local public includes
@@ -13,7 +14,10 @@
 
 // Standard includes
 #include <algorithm>
+#include <map>
+#include <memory>
 #include <unistd.h>
+#include <vector>
 
 using namespace std;
 
@@ -28,6 +32,35 @@ void TaskMgr::initialize(LogContext log_context) {
 
   TaskWorker *worker;
 
+  // Scheduling weights and target limits are set up before any thread that
+  // schedules tasks is started, they are not changed afterwards
+  for (auto &share : m_config.task_share_weights)
+    m_tasks_ready.setWeight(share.first, share.second);
+
+  m_target_limiter.setDefaultLimits(m_config.task_repo_limit,
+                                    m_config.task_endpoint_limit);
+  for (auto &limit : m_config.task_target_limits)
+    m_target_limiter.setLimit(limit.first, limit.second);
+
+  // Must exist before the first worker can hand over a transfer. The Globus
+  // client is only used from the monitor thread.
+  auto glob = std::make_shared<GlobusAPI>(m_log_context);
+  m_transfer_monitor = std::make_unique<TransferMonitor>(
+      [glob](const vector<string> &a_glob_task_ids, const string &a_acc_tok,
+             map<string, GlobusAPI::XfrState> &a_states) {
+        glob->checkTransferStatuses(a_glob_task_ids, a_acc_tok, a_states);
+      },
+      [glob](const string &a_glob_task_id, const string &a_acc_tok) {
+        glob->cancelTask(a_glob_task_id, a_acc_tok);
+      },
+      [this](std::unique_ptr<Task> a_task) {
+        lock_guard<mutex> lock(m_worker_mutex);
+        // The transfer no longer uses its endpoints
+        releaseTargetsAndScheduleWorkers(*a_task, m_log_context);
+        retryTaskAndScheduleWorker(std::move(a_task), m_log_context);
+      },
+      m_log_context);
+
   ++m_thread_count;
   m_maint_thread = new thread(&TaskMgr::maintenanceThread, this, m_log_context,
                               m_thread_count);
@@ -230,29 +263,28 @@ void TaskMgr::purgeTaskHistory(LogContext log_context) const {
 
 /**
  * @brief Public method to add a new task to the "ready" queue
- * @param a_task_id - Task ID for NEW or READY task
+ * @param a_task - Task ID or DB record of a NEW or READY task
  *
  * Adds task to ready queue and schedules a worker if available. Called by
  * ClientWorkers or other external entities.
- *
- * NOTE: Takes ownership of JSON value leaving a NULL value in place.
  */
-void TaskMgr::newTask(const std::string &a_task_id, LogContext log_context) {
+void TaskMgr::newTask(const libjson::Value &a_task, LogContext log_context) {
   DL_DEBUG(log_context, "TaskMgr scheduling 1 new task");
 
-  // TODO BREAKS FAIR SCHEDULING - under heavy loading, this method will allow
-  // new tasks to take priority over older tasks that may not be loaded. When
-  // off-loading is added, need to check here for overflow and only schedule if
-  // system is below capacity.
+  // TODO Under heavy loading new tasks can still take priority over older
+  // tasks of the same owner that were not loaded. When off-loading is added,
+  // need to check here for overflow and only schedule if system is below
+  // capacity.
   lock_guard<mutex> lock(m_worker_mutex);
 
-  addNewTaskAndScheduleWorker(a_task_id, log_context);
+  addNewTaskAndScheduleWorker(a_task, log_context);
 }
 
 /**
  * @brief Internal method to add one or more new tasks
  *
- * @param a_tasks JSON array of task IDs for NEW and READY tasks
+ * @param a_tasks JSON array of NEW and READY tasks, either IDs or objects
+ * with the _id, owner and type of the task
  *
  * Adds task(s) to ready queue and schedules workers if available. Called by
  * TaskWorkers after finalizing a task returns new and/or unblocked tasks.
@@ -268,7 +300,7 @@ void TaskMgr::newTasks(const libjson::Value &a_tasks, LogContext log_context) {
     lock_guard<mutex> lock(m_worker_mutex);
 
     for (; t != arr.end(); t++) {
-      addNewTaskAndScheduleWorker(t->asString(), log_context);
+      addNewTaskAndScheduleWorker(*t, log_context);
     }
   } catch (...) {
     DL_ERROR(log_context,
@@ -279,32 +311,52 @@ void TaskMgr::newTasks(const libjson::Value &a_tasks, LogContext log_context) {
 /**
  * @brief Private method to add task and schedule
  *
- * @param a_task - JSON task descriptor
+ * @param a_task - Task ID, or object with _id and optional owner and type
+ *
+ * Tasks without an owner share one fair-share queue.
  *
  * NOTE: must be called with m_worker_mutex held by caller
  */
-void TaskMgr::addNewTaskAndScheduleWorker(const std::string &a_task_id,
+void TaskMgr::addNewTaskAndScheduleWorker(const libjson::Value &a_task,
                                           LogContext log_context) {
   // TODO Add logic to limit max number of ready tasks in memory
+  std::unique_ptr<Task> task;
 
-  DL_DEBUG(log_context, "Adding task " << a_task_id);
-  m_tasks_ready.push_back(std::make_unique<Task>(a_task_id));
-
-  if (m_worker_next) {
-    DL_DEBUG(log_context, "Waking task worker " << m_worker_next->id());
-    m_worker_next->m_run = true;
-    m_worker_next->m_cvar.notify_one();
-    m_worker_next = m_worker_next->m_next ? m_worker_next->m_next : 0;
+  if (a_task.isString()) {
+    task = std::make_unique<Task>(a_task.asString());
+  } else {
+    const libjson::Value::Object &obj = a_task.asObject();
+    task = std::make_unique<Task>(obj.getString("_id"));
+    if (obj.has("owner") && obj.value().isString())
+      task->owner = obj.asString();
+    if (obj.has("type") && obj.value().isNumber())
+      task->type = (int32_t)obj.asNumber();
   }
+
+  DL_DEBUG(log_context, "Adding task " << task->task_id << " of "
+                                       << task->owner << ", type "
+                                       << task->type);
+  m_tasks_ready.push(std::move(task));
+
+  wakeNextWorker();
 }
 
 void TaskMgr::retryTaskAndScheduleWorker(std::unique_ptr<Task> a_task,
                                          LogContext log_context) {
   DL_DEBUG(log_context, "Retrying task " << a_task->task_id);
-  m_tasks_ready.push_back(std::move(a_task));
+  m_tasks_ready.push(std::move(a_task));
+
+  wakeNextWorker();
+}
 
+/**
+ * @brief Wakes the first idle task worker, if any
+ *
+ * NOTE: must be called with m_worker_mutex held by caller
+ */
+void TaskMgr::wakeNextWorker() {
   if (m_worker_next) {
-    DL_DEBUG(log_context, "Waking task worker " << m_worker_next->id());
+    DL_DEBUG(m_log_context, "Waking task worker " << m_worker_next->id());
     m_worker_next->m_run = true;
     m_worker_next->m_cvar.notify_one();
     m_worker_next = m_worker_next->m_next ? m_worker_next->m_next : 0;
@@ -379,13 +431,84 @@ std::unique_ptr<TaskMgr::Task> TaskMgr::getNextTask(ITaskWorker *a_worker) {
   // Pop next task from ready queue and place in running map
   DL_DEBUG(log_context,
            "There are " << m_tasks_ready.size() << " grabbing one.");
-  auto task = std::move(m_tasks_ready.front());
-  m_tasks_ready.pop_front();
+  auto task = m_tasks_ready.pop();
   DL_DEBUG(log_context, "Now there are " << m_tasks_ready.size() << " left.");
 
   return task;
 }
 
+std::map<std::string, size_t> TaskMgr::getQueueDepths() {
+  lock_guard<mutex> lock(m_worker_mutex);
+  return m_tasks_ready.queueDepths();
+}
+
+std::map<std::string, TaskTargetLimiter::TargetStats>
+TaskMgr::getTargetStats() {
+  lock_guard<mutex> lock(m_worker_mutex);
+  return m_target_limiter.getStats();
+}
+
+bool TaskMgr::acquireTargets(std::unique_ptr<Task> &a_task,
+                             const std::vector<std::string> &a_targets,
+                             LogContext log_context) {
+  lock_guard<mutex> lock(m_worker_mutex);
+
+  // A task should not hold slots from an earlier step here, but make sure
+  releaseTargetsAndScheduleWorkers(*a_task, log_context);
+
+  string task_id = a_task->task_id;
+  if (m_target_limiter.acquire(a_task, a_targets))
+    return true;
+
+  DL_DEBUG(log_context,
+           "Task " << task_id << " waiting for a saturated repo or endpoint");
+  return false;
+}
+
+void TaskMgr::releaseTargets(Task &a_task, LogContext log_context) {
+  if (a_task.targets.empty())
+    return;
+
+  lock_guard<mutex> lock(m_worker_mutex);
+  releaseTargetsAndScheduleWorkers(a_task, log_context);
+}
+
+/**
+ * @brief Frees the target slots of a task and schedules tasks waiting on them
+ *
+ * NOTE: must be called with m_worker_mutex held by caller
+ */
+void TaskMgr::releaseTargetsAndScheduleWorkers(Task &a_task,
+                                               LogContext log_context) {
+  if (a_task.targets.empty())
+    return;
+
+  vector<std::unique_ptr<Task>> ready;
+  m_target_limiter.release(a_task, ready);
+
+  for (auto &task : ready) {
+    DL_DEBUG(log_context, "Task " << task->task_id << " may use its targets");
+    m_tasks_ready.push(std::move(task));
+    wakeNextWorker();
+  }
+}
+
+/**
+ * @brief Park a task until its Globus transfer ends
+ *
+ * Called by task workers right after submitting a transfer. The transfer
+ * monitor puts the task back on the ready queue once the transfer ended.
+ */
+void TaskMgr::monitorTransfer(std::unique_ptr<Task> a_task,
+                              const std::string &a_glob_task_id,
+                              const std::string &a_acc_tok,
+                              LogContext log_context) {
+  DL_DEBUG(log_context, "Task " << a_task->task_id
+                                << " waiting on Globus transfer "
+                                << a_glob_task_id);
+  m_transfer_monitor->add(std::move(a_task), a_glob_task_id, a_acc_tok);
+}
+
 /**
  * @brief Submit a task with a transient failure for later retry
  *
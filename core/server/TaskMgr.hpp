@@ -6,6 +6,9 @@
 #include "Config.hpp"
 #include "ITaskMgr.hpp"
 #include "ITaskWorker.hpp"
+#include "TaskScheduler.hpp"
+#include "TaskTargetLimiter.hpp"
+#include "TransferMonitor.hpp"
 
 // Local public includes
 #include "common/SDMS.pb.h"
@@ -15,9 +18,9 @@
 // Standard includes
 #include <chrono>
 #include <condition_variable>
-#include <deque>
 #include <list>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -32,8 +35,12 @@ public:
   static TaskMgr &getInstance(LogContext log_context, int thread_id);
 
   // Public interface used by CoreWorkers
-  void newTask(const std::string &a_task_id, LogContext log_context);
+  void newTask(const libjson::Value &a_task, LogContext log_context);
   void cancelTask(const std::string &a_task_id, LogContext log_context);
+  /// Ready tasks per owner, for metrics
+  std::map<std::string, size_t> getQueueDepths();
+  /// Steps running and waiting per repo and endpoint, for metrics
+  std::map<std::string, TaskTargetLimiter::TargetStats> getTargetStats();
 
 private:
   TaskMgr();
@@ -45,20 +52,30 @@ private:
   std::unique_ptr<Task> getNextTask(ITaskWorker *a_worker);
   bool retryTask(std::unique_ptr<Task> a_task, LogContext log_context);
   void newTasks(const libjson::Value &a_tasks, LogContext log_context);
+  void monitorTransfer(std::unique_ptr<Task> a_task,
+                       const std::string &a_glob_task_id,
+                       const std::string &a_acc_tok, LogContext log_context);
+  bool acquireTargets(std::unique_ptr<Task> &a_task,
+                      const std::vector<std::string> &a_targets,
+                      LogContext log_context);
+  void releaseTargets(Task &a_task, LogContext log_context);
 
   // Private methods
   void maintenanceThread(LogContext, int);
-  void addNewTaskAndScheduleWorker(const std::string &a_task_id,
+  void addNewTaskAndScheduleWorker(const libjson::Value &a_task,
                                    LogContext log_context);
   void retryTaskAndScheduleWorker(std::unique_ptr<Task> a_task,
                                   LogContext log_context);
   void wakeNextWorker();
+  void releaseTargetsAndScheduleWorkers(Task &a_task, LogContext log_context);
   void purgeTaskHistory(LogContext log_context) const;
 
   Config &m_config;
-  std::deque<std::unique_ptr<Task>> m_tasks_ready;
+  TaskScheduler m_tasks_ready;
+  TaskTargetLimiter m_target_limiter;
   std::multimap<timepoint_t, std::unique_ptr<Task>> m_tasks_retry;
   std::mutex m_worker_mutex;
+  std::unique_ptr<TransferMonitor> m_transfer_monitor;
   std::vector<ITaskWorker *> m_workers;
   ITaskWorker *m_worker_next;
   std::thread *m_maint_thread;
@@ -0,0 +1,102 @@
+// Local private includes
+#include "TaskScheduler.hpp"
+
+// Local public includes
+#include "common/SDMS.pb.h"
+#include "common/TraceException.hpp"
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+TaskScheduler::Priority TaskScheduler::priority(int32_t a_task_type) {
+  switch (a_task_type) {
+  case TT_ALLOC_CREATE:
+  case TT_ALLOC_DEL:
+    return PRIORITY_HIGH;
+  case TT_DATA_DEL:
+  case TT_REC_DEL:
+  case TT_USER_DEL:
+  case TT_PROJ_DEL:
+    return PRIORITY_LOW;
+  default:
+    return PRIORITY_NORMAL;
+  }
+}
+
+void TaskScheduler::setWeight(const std::string &a_owner, double a_weight) {
+  if (!(a_weight > 0))
+    EXCEPT_PARAM(1, "Invalid task scheduling weight " << a_weight << " for "
+                                                       << a_owner);
+
+  m_weights[a_owner] = a_weight;
+}
+
+double TaskScheduler::weight(const std::string &a_owner) const {
+  auto w = m_weights.find(a_owner);
+  return w == m_weights.end() ? 1.0 : w->second;
+}
+
+void TaskScheduler::push(std::unique_ptr<ITaskMgr::Task> a_task) {
+  Lane &lane = m_lanes[priority(a_task->type)];
+  // Emplacing an owner that is not queued starts a new turn for it
+  auto owner = lane.owners.emplace(a_task->owner, OwnerQueue());
+  if (owner.second)
+    lane.turns.push_back(a_task->owner);
+
+  owner.first->second.tasks.push_back(std::move(a_task));
+  m_size++;
+}
+
+std::unique_ptr<ITaskMgr::Task> TaskScheduler::pop() {
+  for (Lane &lane : m_lanes) {
+    while (!lane.turns.empty()) {
+      const string &name = lane.turns.front();
+      OwnerQueue &owner = lane.owners[name];
+
+      if (owner.deficit < 1.0) {
+        // Start of this owner's turn
+        owner.deficit += weight(name);
+        if (owner.deficit < 1.0) {
+          // Weights below 1 need several rounds to earn a task
+          lane.turns.push_back(name);
+          lane.turns.pop_front();
+          continue;
+        }
+      }
+
+      unique_ptr<ITaskMgr::Task> task = std::move(owner.tasks.front());
+      owner.tasks.pop_front();
+      owner.deficit -= 1.0;
+      m_size--;
+
+      if (owner.tasks.empty()) {
+        // Idle owners do not keep unused credit
+        lane.owners.erase(name);
+        lane.turns.pop_front();
+      } else if (owner.deficit < 1.0) {
+        lane.turns.push_back(name);
+        lane.turns.pop_front();
+      }
+
+      return task;
+    }
+  }
+
+  return nullptr;
+}
+
+std::map<std::string, size_t> TaskScheduler::queueDepths() const {
+  map<string, size_t> depths;
+
+  for (const Lane &lane : m_lanes) {
+    for (auto &owner : lane.owners)
+      depths[owner.first] += owner.second.tasks.size();
+  }
+
+  return depths;
+}
+
+} // namespace Core
+} // namespace SDMS
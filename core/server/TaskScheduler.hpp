@@ -0,0 +1,81 @@
+#ifndef TASKSCHEDULER_HPP
+#define TASKSCHEDULER_HPP
+#pragma once
+
+// Local private includes
+#include "ITaskMgr.hpp"
+
+// Standard includes
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Ready queue of the TaskMgr with per-owner fair sharing.
+ *
+ * Each owner has its own FIFO queue. Record allocation and owner changes
+ * belong to the user or project the records end up with, allocation create
+ * and delete to the allocation's subject. Every other task, including data
+ * gets and puts, belongs to the client that requested it, see
+ * ITaskMgr::Task::owner. Owners with ready tasks take turns using deficit round-robin: on its
+ * turn an owner may start as many tasks as its weight allows, so one owner
+ * queueing thousands of transfers delays the others by one task per round
+ * instead of by the whole backlog. Owners are weighted 1 unless configured.
+ *
+ * Task types are grouped in priority lanes served strictly in order.
+ * Allocation changes run before transfers, which run before bulk deletions.
+ * A steady stream of transfers therefore holds deletions back.
+ *
+ * Not thread safe, the TaskMgr calls it with m_worker_mutex held.
+ */
+class TaskScheduler {
+public:
+  enum Priority { PRIORITY_HIGH = 0, PRIORITY_NORMAL, PRIORITY_LOW };
+
+  TaskScheduler() {}
+
+  /// Lane for a TaskType, unknown types are scheduled as PRIORITY_NORMAL
+  static Priority priority(int32_t a_task_type);
+
+  /// Relative share of an owner, must be greater than zero
+  void setWeight(const std::string &a_owner, double a_weight);
+  double weight(const std::string &a_owner) const;
+
+  void push(std::unique_ptr<ITaskMgr::Task> a_task);
+  /// Next task to run, null if there is none
+  std::unique_ptr<ITaskMgr::Task> pop();
+
+  bool empty() const { return m_size == 0; }
+  size_t size() const { return m_size; }
+  /// Ready tasks per owner, over all lanes
+  std::map<std::string, size_t> queueDepths() const;
+
+private:
+  static const size_t PRIORITY_COUNT = PRIORITY_LOW + 1;
+
+  struct OwnerQueue {
+    std::deque<std::unique_ptr<ITaskMgr::Task>> tasks;
+    /// Tasks the owner may still start this round
+    double deficit = 0.0;
+  };
+
+  struct Lane {
+    std::unordered_map<std::string, OwnerQueue> owners;
+    /// Owners with ready tasks in turn order
+    std::deque<std::string> turns;
+  };
+
+  Lane m_lanes[PRIORITY_COUNT];
+  std::unordered_map<std::string, double> m_weights;
+  size_t m_size = 0;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
@@ -0,0 +1,96 @@
+// Local private includes
+#include "TaskTargetLimiter.hpp"
+
+// Standard includes
+#include <algorithm>
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+void TaskTargetLimiter::setDefaultLimits(uint32_t a_repo_limit,
+                                         uint32_t a_endpoint_limit) {
+  m_repo_limit = a_repo_limit;
+  m_endpoint_limit = a_endpoint_limit;
+}
+
+void TaskTargetLimiter::setLimit(const std::string &a_target,
+                                 uint32_t a_limit) {
+  m_limits[a_target] = a_limit;
+}
+
+uint32_t TaskTargetLimiter::limit(const std::string &a_target) const {
+  auto l = m_limits.find(a_target);
+  if (l != m_limits.end())
+    return l->second;
+
+  // Repo IDs are always "repo/<name>", anything else is a Globus endpoint
+  return a_target.compare(0, 5, "repo/") == 0 ? m_repo_limit
+                                               : m_endpoint_limit;
+}
+
+bool TaskTargetLimiter::acquire(std::unique_ptr<ITaskMgr::Task> &a_task,
+                                std::vector<std::string> a_targets) {
+  // A transfer within one endpoint uses one slot
+  sort(a_targets.begin(), a_targets.end());
+  a_targets.erase(unique(a_targets.begin(), a_targets.end()),
+                  a_targets.end());
+
+  for (const string &id : a_targets) {
+    uint32_t max = limit(id);
+    auto target = m_targets.find(id);
+    if (max && target != m_targets.end() && target->second.in_flight >= max) {
+      target->second.waiting.push_back(std::move(a_task));
+      return false;
+    }
+  }
+
+  for (const string &id : a_targets)
+    m_targets[id].in_flight++;
+
+  a_task->targets = std::move(a_targets);
+  return true;
+}
+
+void TaskTargetLimiter::release(
+    ITaskMgr::Task &a_task,
+    std::vector<std::unique_ptr<ITaskMgr::Task>> &a_ready) {
+  for (const string &id : a_task.targets) {
+    auto t = m_targets.find(id);
+    if (t == m_targets.end())
+      continue;
+
+    Target &target = t->second;
+    if (target.in_flight)
+      target.in_flight--;
+
+    // One slot freed, one waiting task may try again. It may still have to
+    // wait on one of its other targets.
+    if (!target.waiting.empty()) {
+      a_ready.push_back(std::move(target.waiting.front()));
+      target.waiting.pop_front();
+    }
+
+    if (!target.in_flight && target.waiting.empty())
+      m_targets.erase(t);
+  }
+
+  a_task.targets.clear();
+}
+
+std::map<std::string, TaskTargetLimiter::TargetStats>
+TaskTargetLimiter::getStats() const {
+  map<string, TargetStats> stats;
+
+  for (auto &target : m_targets) {
+    TargetStats &s = stats[target.first];
+    s.in_flight = target.second.in_flight;
+    s.waiting = target.second.waiting.size();
+  }
+
+  return stats;
+}
+
+} // namespace Core
+} // namespace SDMS
@@ -0,0 +1,76 @@
+#ifndef TASKTARGETLIMITER_HPP
+#define TASKTARGETLIMITER_HPP
+#pragma once
+
+// Local private includes
+#include "ITaskMgr.hpp"
+
+// Standard includes
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Limits how many task steps run against one target at a time.
+ *
+ * Targets are repo servers (repo IDs) and Globus endpoints. A burst of tasks
+ * for one repo used to hit it all at once, time out and go to the retry
+ * queue. A step now takes a slot on each of its targets before it runs. If
+ * any target is full the task waits here and is handed back once a slot on
+ * that target frees up, while tasks for other targets keep running.
+ *
+ * A limit of 0 means unlimited. Not thread safe, the TaskMgr calls it with
+ * m_worker_mutex held.
+ */
+class TaskTargetLimiter {
+public:
+  struct TargetStats {
+    uint32_t in_flight = 0;
+    size_t waiting = 0;
+  };
+
+  explicit TaskTargetLimiter(uint32_t a_repo_limit = 0,
+                             uint32_t a_endpoint_limit = 0)
+      : m_repo_limit(a_repo_limit), m_endpoint_limit(a_endpoint_limit) {}
+
+  void setDefaultLimits(uint32_t a_repo_limit, uint32_t a_endpoint_limit);
+  /// Overrides the default limit of one repo or endpoint
+  void setLimit(const std::string &a_target, uint32_t a_limit);
+  uint32_t limit(const std::string &a_target) const;
+
+  /**
+   * Takes a slot on every target for a_task, or none. On success the targets
+   * are recorded in a_task->targets. Otherwise the task waits on a full
+   * target, a_task is left empty and false is returned.
+   */
+  bool acquire(std::unique_ptr<ITaskMgr::Task> &a_task,
+               std::vector<std::string> a_targets);
+  /// Frees the slots of a_task, waiting tasks that may run are appended to
+  /// a_ready
+  void release(ITaskMgr::Task &a_task,
+               std::vector<std::unique_ptr<ITaskMgr::Task>> &a_ready);
+
+  /// Targets with steps running or waiting
+  std::map<std::string, TargetStats> getStats() const;
+
+private:
+  struct Target {
+    uint32_t in_flight = 0;
+    std::deque<std::unique_ptr<ITaskMgr::Task>> waiting;
+  };
+
+  uint32_t m_repo_limit;
+  uint32_t m_endpoint_limit;
+  std::map<std::string, uint32_t> m_limits;
+  std::map<std::string, Target> m_targets;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
@@ -3,6 +3,7 @@
 #include "TaskWorker.hpp"
 #include "Config.hpp"
 #include "ITaskMgr.hpp"
+#include "RepoConnectionPool.hpp"
 
 // Common public includes
 #include "common/CommunicatorFactory.hpp"
@@ -84,7 +85,21 @@ void TaskWorker::workerThread(LogContext log_context) {
 
     while (true) {
       try {
-        if (first) {
+        // The previous step is over, unless it was a transfer the monitor
+        // already released
+        m_mgr.releaseTargets(*m_task, log_context);
+
+        if (first && m_task->resume) {
+          // The step that started a Globus transfer ended while the task was
+          // with the transfer monitor, report its outcome
+          step = m_task->resume_step;
+          err_msg = m_task->resume_err_msg;
+          m_task->resume = false;
+          m_db.taskRun(m_task->task_id, task_cmd, log_context,
+                       err_msg.size() ? 0 : &step,
+                       err_msg.size() ? &err_msg : 0);
+          first = false;
+        } else if (first) {
           m_db.taskRun(m_task->task_id, task_cmd, log_context, 0);
           first = false;
         } else {
@@ -107,10 +122,28 @@ void TaskWorker::workerThread(LogContext log_context) {
 
         ICommunicator::Response response;
         if (m_execute.count(cmd)) {
+          if (!m_mgr.acquireTargets(m_task, stepTargets(cmd, params),
+                                    log_context)) {
+            // TaskMgr owns the task until its targets have room, the step is
+            // fetched again then
+            break;
+          }
+
           DL_DEBUG(log_context,
                    "TASK_ID: " << m_task->task_id << ", Step: " << step);
           response = m_execute[cmd](*this, params, log_context);
 
+          if (m_xfr_task_id.size()) {
+            // Free this worker while the transfer runs, the task comes back
+            // through the ready queue when it ended
+            m_task->resume_step = step;
+            m_mgr.monitorTransfer(std::move(m_task), m_xfr_task_id,
+                                  m_xfr_acc_tok, log_context);
+            m_xfr_task_id.clear();
+            m_xfr_acc_tok.clear();
+            break;
+          }
+
         } else if (cmd == TC_STOP) {
           DL_DEBUG(log_context, "TASK_ID: " << m_task->task_id
                                             << ", STOP at step: " << step);
@@ -127,6 +160,7 @@ void TaskWorker::workerThread(LogContext log_context) {
                                     << response.error << " time_out detected: "
                                     << response.time_out << " cmd: " << cmd);
           DL_DEBUG(log_context, "err_msg: " << err_msg);
+          m_mgr.releaseTargets(*m_task, log_context);
           if (m_mgr.retryTask(std::move(m_task), log_context)) {
             DL_DEBUG(log_context, "retry period exceeded");
             err_msg = "Maximum task retry period exceeded.";
@@ -187,9 +221,35 @@ void TaskWorker::workerThread(LogContext log_context) {
       }
     } // End of inner while loop
 
+    if (m_task) {
+      m_mgr.releaseTargets(*m_task, log_context);
+    }
+
   } // End of outer while loop
 }
 
+/**
+ * @brief Repos and Globus endpoints a task step will use
+ *
+ * Used to apply the per repo and per endpoint limits of the TaskMgr.
+ */
+std::vector<std::string> TaskWorker::stepTargets(uint32_t a_cmd,
+                                                 const Value &a_task_params) {
+  const Value::Object &obj = a_task_params.asObject();
+
+  switch (a_cmd) {
+  case TC_RAW_DATA_TRANSFER:
+    return {obj.getString("src_repo_ep"), obj.getString("dst_repo_ep")};
+  case TC_RAW_DATA_DELETE:
+  case TC_RAW_DATA_UPDATE_SIZE:
+  case TC_ALLOC_CREATE:
+  case TC_ALLOC_DELETE:
+    return {obj.getString("repo_id")};
+  default:
+    return {};
+  }
+}
+
 ICommunicator::Response
 TaskWorker::cmdRawDataTransfer(TaskWorker &me, const Value &a_task_params,
                                LogContext log_context) {
@@ -292,25 +352,9 @@ TaskWorker::cmdRawDataTransfer(TaskWorker &me, const Value &a_task_params,
     DL_TRACE(log_context, "Begin transfer of " << files_v.size() << " files");
     string glob_task_id =
         me.m_glob.transfer(src_ep, dst_ep, files_v, encrypted, acc_tok);
-    // Monitor Globus transfer
-
-    GlobusAPI::XfrStatus xfr_status;
-    string err_msg;
-
-    do {
-      sleep(5);
-
-      if (me.m_glob.checkTransferStatus(glob_task_id, acc_tok, xfr_status,
-                                        err_msg)) {
-        // Transfer task needs to be cancelled
-        DL_DEBUG(log_context, "Cancelling task: " << glob_task_id);
-        me.m_glob.cancelTask(glob_task_id, acc_tok);
-      }
-    } while (xfr_status < GlobusAPI::XS_SUCCEEDED);
-
-    if (xfr_status == GlobusAPI::XS_FAILED) {
-      EXCEPT(1, err_msg);
-    }
+    // Monitored by the TaskMgr once this step returns
+    me.m_xfr_task_id = glob_task_id;
+    me.m_xfr_acc_tok = acc_tok;
   } else {
     DL_DEBUG(log_context, "No files to transfer");
   }
@@ -536,9 +580,8 @@ TaskWorker::repoSendRecv(const string &a_repo_id,
       std::get<std::string>(a_msg->get(MessageAttribute::CORRELATION_ID));
   Config &config = Config::getInstance();
 
-  std::string registered_repos = "";
-
-  std::map<std::string, RepoData> repos;
+  RepoData repo;
+  bool found = false;
   if (config.repoCacheInvalid()) {
     DL_TRACE(log_context, "config repo cache is detected to be invalid.");
     // Task worker is not in charge of updating the cache that is handled by
@@ -549,92 +592,77 @@ TaskWorker::repoSendRecv(const string &a_repo_id,
     m_db.repoView(temp_repos, log_context);
 
     for (RepoData &r : temp_repos) {
-      repos[r.id()] = r;
       DL_TRACE(log_context,
                "Refreshed cache with repos: " << r.id() << " " << r.address());
+      if (r.id() == a_repo_id) {
+        repo = r;
+        found = true;
+      }
     }
   } else {
-    repos = config.getRepos();
+    found = config.getRepo(a_repo_id, repo);
   }
 
-  if (!repos.count(a_repo_id)) {
-    for (auto &repo : repos) {
-      registered_repos = repo.second.id() + " ";
+  if (!found) {
+    std::string registered_repos = "";
+    for (auto &registered : config.getRepos()) {
+      registered_repos += registered.second.id() + " ";
     }
     EXCEPT_PARAM(1, "Task refers to non-existent repo server: "
                         << a_repo_id
                         << " Registered repos are: " << registered_repos);
   }
-  // Need to be able to split repos into host and scheme and port
-  const std::string client_id = [&]() {
-    std::stringstream ss;
-    ss << "task_worker-";
-    ss << id();
-    std::string str;
-    ss >> str;
-    return str;
-  }();
 
   try {
 
-    auto client =
-        [&](const std::string &repo_address, const std::string &repo_pub_key,
-            const std::string &socket_id, LogContext log_context) {
-          AddressSplitter splitter(repo_address);
-
-          /// Creating input parameters for constructing Communication Instance
-          SocketOptions socket_options;
-          socket_options.scheme = splitter.scheme();
-          socket_options.scheme = URIScheme::TCP;
-          socket_options.class_type = SocketClassType::CLIENT;
-          socket_options.direction_type =
-              SocketDirectionalityType::BIDIRECTIONAL;
-          socket_options.communication_type =
-              SocketCommunicationType::ASYNCHRONOUS;
-          socket_options.connection_life = SocketConnectionLife::INTERMITTENT;
-          socket_options.connection_security = SocketConnectionSecurity::SECURE;
-          socket_options.protocol_type = ProtocolType::ZQTP;
-          socket_options.host = splitter.host();
-          socket_options.port = splitter.port();
-          socket_options.local_id = socket_id;
-
-          CredentialFactory cred_factory;
-
-          std::unordered_map<CredentialType, std::string> cred_options;
-          cred_options[CredentialType::PUBLIC_KEY] =
-              config.sec_ctx->get(CredentialType::PUBLIC_KEY);
-          cred_options[CredentialType::PRIVATE_KEY] =
-              config.sec_ctx->get(CredentialType::PRIVATE_KEY);
-          // Cannot grab the public key from sec_ctx because we have several
-          // repos to pick from
-          // cred_options[CredentialType::SERVER_KEY] =
-          // config.sec_ctx->get(CredentialType::SERVER_KEY);
-          cred_options[CredentialType::SERVER_KEY] = repo_pub_key;
-
-          DL_TRACE(log_context,
-                   "Core server client to repo server public key "
-                       << cred_options[CredentialType::PUBLIC_KEY]);
-          DL_TRACE(log_context,
-                   "Core server client to repo server private key "
-                       << cred_options[CredentialType::PRIVATE_KEY]);
-          DL_TRACE(log_context,
-                   "Core server client to repo server Repo public key "
-                       << cred_options[CredentialType::SERVER_KEY]);
-          auto credentials =
-              cred_factory.create(ProtocolType::ZQTP, cred_options);
-
-          uint32_t timeout_on_receive = Config::getInstance().repo_timeout;
-          long timeout_on_poll = Config::getInstance().repo_timeout;
-
-          // When creating a communication channel with a server application we
-          // need to locally have a client socket. So though we have specified a
-          // client socket we will actually be communicating with the server.
-          CommunicatorFactory communicator_factory(log_context);
-          return communicator_factory.create(socket_options, *credentials,
-                                             timeout_on_receive,
-                                             timeout_on_poll);
-        }(repos.at(a_repo_id).address(), repos.at(a_repo_id).pub_key(),
-          client_id, log_context); // Pass the address into the lambda
+    auto connect = [&](const std::string &repo_address,
+                       const std::string &repo_pub_key,
+                       const std::string &socket_id) {
+      AddressSplitter splitter(repo_address);
+
+      /// Creating input parameters for constructing Communication Instance
+      SocketOptions socket_options;
+      socket_options.scheme = URIScheme::TCP;
+      socket_options.class_type = SocketClassType::CLIENT;
+      socket_options.direction_type = SocketDirectionalityType::BIDIRECTIONAL;
+      socket_options.communication_type = SocketCommunicationType::ASYNCHRONOUS;
+      socket_options.connection_life = SocketConnectionLife::INTERMITTENT;
+      socket_options.connection_security = SocketConnectionSecurity::SECURE;
+      socket_options.protocol_type = ProtocolType::ZQTP;
+      socket_options.host = splitter.host();
+      socket_options.port = splitter.port();
+      socket_options.local_id = socket_id;
+
+      CredentialFactory cred_factory;
+
+      std::unordered_map<CredentialType, std::string> cred_options;
+      cred_options[CredentialType::PUBLIC_KEY] =
+          config.sec_ctx->get(CredentialType::PUBLIC_KEY);
+      cred_options[CredentialType::PRIVATE_KEY] =
+          config.sec_ctx->get(CredentialType::PRIVATE_KEY);
+      // Cannot grab the public key from sec_ctx because we have several
+      // repos to pick from
+      cred_options[CredentialType::SERVER_KEY] = repo_pub_key;
+
+      DL_DEBUG(log_context, "Opening connection " << socket_id << " to repo "
+                                                  << a_repo_id << " at "
+                                                  << repo_address);
+      auto credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
+
+      uint32_t timeout_on_receive = config.repo_timeout;
+      long timeout_on_poll = config.repo_timeout;
+
+      // When creating a communication channel with a server application we
+      // need to locally have a client socket. So though we have specified a
+      // client socket we will actually be communicating with the server.
+      CommunicatorFactory communicator_factory(log_context);
+      return communicator_factory.create(socket_options, *credentials,
+                                         timeout_on_receive, timeout_on_poll);
+    };
+
+    RepoConnectionPool::Connection client =
+        RepoConnectionPool::getInstance().acquire(
+            a_repo_id, repo.address(), repo.pub_key(), connect);
 
     client->send(*a_msg);
 
@@ -651,6 +679,18 @@ TaskWorker::repoSendRecv(const string &a_repo_id,
       return response;
     }
 
+    // Only a completed exchange returns the connection to the pool, a reply
+    // still in flight would be read by the next request
+    if (std::get<std::string>(response.message->get(
+            MessageAttribute::CORRELATION_ID)) == log_context.correlation_id) {
+      client.reuse();
+    } else {
+      DL_WARNING(log_context, "Reply from repo " << a_repo_id
+                                                 << " has a different "
+                                                    "correlation id, closing "
+                                                    "the connection");
+    }
+
     auto proto_msg =
         std::get<google::protobuf::Message *>(response.message->getPayload());
     auto nack = dynamic_cast<Anon::NackReply *>(proto_msg);
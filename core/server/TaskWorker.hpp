@@ -18,6 +18,7 @@
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace SDMS {
 namespace Core {
@@ -59,6 +60,8 @@ private:
   bool checkEncryption(const GlobusAPI::EndpointInfo &a_ep_info1,
                        const GlobusAPI::EndpointInfo &a_ep_info2,
                        Encryption a_encrypt);
+  static std::vector<std::string>
+  stepTargets(uint32_t a_cmd, const libjson::Value &a_task_params);
   ICommunicator::Response repoSendRecv(const std::string &a_repo_id,
                                        std::unique_ptr<IMessage> &&a_msg,
                                        LogContext log_context);
@@ -69,6 +72,9 @@ private:
   DatabaseAPI m_db;
   GlobusAPI m_glob;
   std::atomic<bool> m_running = true;
+  /// Set by cmdRawDataTransfer, the task is handed to the transfer monitor
+  std::string m_xfr_task_id;
+  std::string m_xfr_acc_tok;
 };
 
 } // namespace Core
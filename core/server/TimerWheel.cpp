@@ -0,0 +1,102 @@
+// Local private includes
+#include "TimerWheel.hpp"
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+void TimerWheel::schedule(const std::string &a_id, time_t a_deadline) {
+  place(string(a_id), a_deadline);
+  m_size++;
+}
+
+void TimerWheel::place(std::string &&a_id, time_t a_deadline) {
+  if (a_deadline <= m_current) {
+    m_due.emplace_back(std::move(a_id), a_deadline);
+    return;
+  }
+
+  time_t delta = a_deadline - m_current;
+  time_t at = a_deadline;
+  size_t level = 0;
+
+  while (level < LEVELS - 1 && delta >= (time_t(1) << (SLOT_BITS * (level + 1))))
+    level++;
+
+  if (delta >= SPAN) {
+    // Beyond the wheel, parked in the top level slot reached last
+    at = m_current + SPAN - 1;
+  }
+
+  size_t slot = (at >> (SLOT_BITS * level)) & (SLOTS - 1);
+  m_slots[level][slot].emplace_back(std::move(a_id), a_deadline);
+}
+
+/**
+ * Spreads the slot of a_level that starts at m_current over the lower levels
+ */
+void TimerWheel::cascade(size_t a_level) {
+  size_t slot = (m_current >> (SLOT_BITS * a_level)) & (SLOTS - 1);
+  slot_t timers;
+  timers.swap(m_slots[a_level][slot]);
+
+  for (auto &timer : timers)
+    place(std::move(timer.first), timer.second);
+}
+
+void TimerWheel::advance(time_t a_now, std::vector<std::string> &a_expired) {
+  if (m_size == 0) {
+    m_current = max(m_current, a_now);
+    return;
+  }
+
+  if (a_now - m_current >= SPAN) {
+    // Not advanced for a long time, sort everything out again
+    slot_t timers;
+    timers.swap(m_due);
+    for (auto &level : m_slots) {
+      for (auto &slot : level) {
+        for (auto &timer : slot)
+          timers.push_back(std::move(timer));
+        slot.clear();
+      }
+    }
+    m_current = a_now;
+    for (auto &timer : timers)
+      place(std::move(timer.first), timer.second);
+  }
+
+  while (m_current < a_now) {
+    m_current++;
+
+    // Higher levels first, they may feed the slots below
+    for (size_t level = LEVELS - 1; level > 0; level--) {
+      if ((m_current & ((time_t(1) << (SLOT_BITS * level)) - 1)) == 0)
+        cascade(level);
+    }
+
+    slot_t &slot = m_slots[0][m_current & (SLOTS - 1)];
+    for (auto &timer : slot)
+      m_due.push_back(std::move(timer));
+    slot.clear();
+  }
+
+  for (auto &timer : m_due) {
+    a_expired.push_back(std::move(timer.first));
+    m_size--;
+  }
+  m_due.clear();
+}
+
+void TimerWheel::clear() {
+  for (auto &level : m_slots) {
+    for (auto &slot : level)
+      slot.clear();
+  }
+  m_due.clear();
+  m_size = 0;
+}
+
+} // namespace Core
+} // namespace SDMS
@@ -0,0 +1,66 @@
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+#pragma once
+
+// Standard includes
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Hierarchical timer wheel with a resolution of one second.
+ *
+ * Scheduling a timer and advancing the wheel by one second are O(1); a
+ * timer is touched once per level on its way down, so finding expired keys
+ * no longer means scanning every key. Three levels of 64 slots cover about
+ * three days, timers further out are parked in the last slot and
+ * rescheduled when they come up.
+ *
+ * Timers cannot be cancelled. Owners reschedule by adding another timer and
+ * must check that a timer returned by advance is still current. Not thread
+ * safe.
+ */
+class TimerWheel {
+public:
+  explicit TimerWheel(time_t a_now = time(0)) : m_current(a_now) {}
+
+  void schedule(const std::string &a_id, time_t a_deadline);
+
+  /**
+   * Moves the wheel to a_now and appends the ids of timers with a deadline
+   * at or before a_now to a_expired.
+   */
+  void advance(time_t a_now, std::vector<std::string> &a_expired);
+
+  /// Timers scheduled, including ones that are no longer current
+  size_t size() const { return m_size; }
+  void clear();
+
+private:
+  static const int SLOT_BITS = 6;
+  static const size_t SLOTS = 1 << SLOT_BITS;
+  static const size_t LEVELS = 3;
+  /// Seconds covered by all levels
+  static const time_t SPAN = time_t(1) << (SLOT_BITS * LEVELS);
+
+  typedef std::vector<std::pair<std::string, time_t>> slot_t;
+
+  void place(std::string &&a_id, time_t a_deadline);
+  void cascade(size_t a_level);
+
+  /// Last second that was processed
+  time_t m_current;
+  slot_t m_slots[LEVELS][SLOTS];
+  /// Timers that were already due when scheduled
+  slot_t m_due;
+  size_t m_size = 0;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
@@ -0,0 +1,225 @@
+// Local private includes
+#include "TransferMonitor.hpp"
+
+// Local public includes
+#include "common/TraceException.hpp"
+
+// Standard includes
+#include <algorithm>
+#include <exception>
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+TransferMonitor::TransferMonitor(check_fun_t a_check, cancel_fun_t a_cancel,
+                                 resume_fun_t a_resume,
+                                 LogContext a_log_context)
+    : TransferMonitor(std::move(a_check), std::move(a_cancel),
+                      std::move(a_resume), a_log_context, Options()) {}
+
+TransferMonitor::TransferMonitor(check_fun_t a_check, cancel_fun_t a_cancel,
+                                 resume_fun_t a_resume,
+                                 LogContext a_log_context,
+                                 const Options &a_options)
+    : m_check(std::move(a_check)), m_cancel(std::move(a_cancel)),
+      m_resume(std::move(a_resume)), m_log_context(a_log_context),
+      m_options(a_options) {
+  m_log_context.thread_name += "-TransferMonitor";
+  m_options.batch_size = max<size_t>(m_options.batch_size, 1);
+  m_thread = thread(&TransferMonitor::monitorThread, this);
+}
+
+TransferMonitor::~TransferMonitor() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_running = false;
+  }
+  m_cvar.notify_all();
+  m_thread.join();
+}
+
+void TransferMonitor::add(std::unique_ptr<ITaskMgr::Task> a_task,
+                          const std::string &a_glob_task_id,
+                          const std::string &a_acc_tok) {
+  DL_DEBUG(m_log_context, "Monitoring Globus transfer "
+                              << a_glob_task_id << " of task "
+                              << a_task->task_id);
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    Transfer &transfer = m_transfers[a_glob_task_id];
+    transfer.task = std::move(a_task);
+    transfer.acc_tok = a_acc_tok;
+    transfer.interval = m_options.min_interval;
+    transfer.next_check = clock_t::now() + transfer.interval;
+    transfer.check_errors = 0;
+  }
+  m_cvar.notify_one();
+}
+
+size_t TransferMonitor::size() const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_transfers.size();
+}
+
+void TransferMonitor::monitorThread() {
+  unique_lock<mutex> lock(m_mutex);
+
+  while (m_running) {
+    if (m_transfers.empty()) {
+      m_cvar.wait(lock);
+      continue;
+    }
+
+    clock_t::time_point next_check = m_transfers.begin()->second.next_check;
+    for (auto &transfer : m_transfers)
+      next_check = min(next_check, transfer.second.next_check);
+
+    if (next_check > clock_t::now()) {
+      // Woken early by new transfers or shutdown, recalculate
+      m_cvar.wait_until(lock, next_check);
+      continue;
+    }
+
+    checkDue(lock);
+  }
+}
+
+/**
+ * Checks every transfer that is due. Must be called with a_lock held, it is
+ * released while Globus is contacted.
+ */
+void TransferMonitor::checkDue(std::unique_lock<std::mutex> &a_lock) {
+  clock_t::time_point now = clock_t::now();
+
+  // Grouped by token, a task_list call only returns transfers of its owner
+  map<string, vector<string>> due;
+  for (auto &transfer : m_transfers) {
+    if (transfer.second.next_check <= now)
+      due[transfer.second.acc_tok].push_back(transfer.first);
+  }
+
+  struct Checked {
+    bool error = false;
+    string error_msg;
+    GlobusAPI::XfrState state;
+  };
+  map<string, Checked> checked;
+
+  a_lock.unlock();
+
+  for (auto &token : due) {
+    const vector<string> &ids = token.second;
+    for (size_t start = 0; start < ids.size(); start += m_options.batch_size) {
+      vector<string> batch(
+          ids.begin() + start,
+          ids.begin() + min(ids.size(), start + m_options.batch_size));
+
+      map<string, GlobusAPI::XfrState> states;
+      string error_msg;
+      try {
+        m_check(batch, token.first, states);
+      } catch (TraceException &e) {
+        error_msg = e.toString();
+      } catch (exception &e) {
+        error_msg = e.what();
+      }
+
+      for (const string &id : batch) {
+        Checked &result = checked[id];
+        auto state = states.find(id);
+        if (error_msg.size()) {
+          result.error = true;
+          result.error_msg = error_msg;
+        } else if (state == states.end()) {
+          result.error = true;
+          result.error_msg = "Globus did not report transfer " + id;
+        } else {
+          result.state = state->second;
+        }
+      }
+    }
+  }
+
+  vector<unique_ptr<ITaskMgr::Task>> ended;
+  vector<pair<string, string>> cancel;
+
+  a_lock.lock();
+  now = clock_t::now();
+
+  for (auto &result : checked) {
+    auto transfer = m_transfers.find(result.first);
+    if (transfer == m_transfers.end())
+      continue;
+
+    Transfer &xfr = transfer->second;
+    string err_msg;
+    bool done = false;
+
+    if (result.second.error) {
+      DL_WARNING(m_log_context, "Checking Globus transfer "
+                                    << result.first << " failed: "
+                                    << result.second.error_msg);
+      if (++xfr.check_errors >= m_options.max_check_errors) {
+        err_msg = result.second.error_msg;
+        done = true;
+      }
+    } else {
+      xfr.check_errors = 0;
+      const GlobusAPI::XfrState &state = result.second.state;
+      if (state.cancel) {
+        DL_DEBUG(m_log_context, "Cancelling task: " << result.first);
+        cancel.push_back(make_pair(result.first, xfr.acc_tok));
+      }
+      if (state.status == GlobusAPI::XS_FAILED) {
+        err_msg = state.err_msg.size() ? state.err_msg
+                                       : "Globus transfer " + result.first +
+                                             " failed";
+        done = true;
+      } else if (state.status == GlobusAPI::XS_SUCCEEDED) {
+        done = true;
+      }
+    }
+
+    if (done) {
+      DL_DEBUG(m_log_context, "Globus transfer "
+                                  << result.first << " of task "
+                                  << xfr.task->task_id << " ended"
+                                  << (err_msg.size() ? ": " + err_msg : ""));
+      xfr.task->resume = true;
+      xfr.task->resume_err_msg = err_msg;
+      ended.push_back(std::move(xfr.task));
+      m_transfers.erase(transfer);
+    } else {
+      // Long transfers are checked less and less often
+      if (!result.second.error)
+        xfr.interval = min(xfr.interval * 2, m_options.max_interval);
+      xfr.next_check = now + xfr.interval;
+    }
+  }
+
+  a_lock.unlock();
+
+  for (auto &task : cancel) {
+    try {
+      m_cancel(task.first, task.second);
+    } catch (TraceException &e) {
+      DL_ERROR(m_log_context, "Cancelling Globus transfer "
+                                  << task.first
+                                  << " failed: " << e.toString());
+    } catch (exception &e) {
+      DL_ERROR(m_log_context, "Cancelling Globus transfer "
+                                  << task.first << " failed: " << e.what());
+    }
+  }
+
+  for (auto &task : ended)
+    m_resume(std::move(task));
+
+  a_lock.lock();
+}
+
+} // namespace Core
+} // namespace SDMS
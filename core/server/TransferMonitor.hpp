@@ -0,0 +1,109 @@
+#ifndef TRANSFERMONITOR_HPP
+#define TRANSFERMONITOR_HPP
+#pragma once
+
+// Local private includes
+#include "GlobusAPI.hpp"
+#include "ITaskMgr.hpp"
+
+// Local public includes
+#include "common/DynaLog.hpp"
+
+// Standard includes
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Watches the Globus transfers of all tasks from a single thread.
+ *
+ * A task worker used to poll its transfer every 5 seconds until it ended,
+ * which could take hours and bounded the number of concurrent transfers by
+ * the number of task workers. Workers now hand the task over after
+ * submitting the transfer. The monitor checks the transfers that are due in
+ * batches, one Globus call per access token, and backs off while a transfer
+ * stays active. When a transfer ends the task is handed back to be resumed.
+ */
+class TransferMonitor {
+public:
+  typedef std::chrono::steady_clock clock_t;
+
+  /// Checks transfers that were submitted with the same access token
+  typedef std::function<void(
+      const std::vector<std::string> &a_glob_task_ids,
+      const std::string &a_acc_tok,
+      std::map<std::string, GlobusAPI::XfrState> &a_states)>
+      check_fun_t;
+  typedef std::function<void(const std::string &a_glob_task_id,
+                             const std::string &a_acc_tok)>
+      cancel_fun_t;
+  /// Receives a task whose transfer ended, resume and resume_err_msg are set
+  typedef std::function<void(std::unique_ptr<ITaskMgr::Task> a_task)>
+      resume_fun_t;
+
+  struct Options {
+    /// Delay before the first check, and between checks right after one
+    clock_t::duration min_interval = std::chrono::seconds(5);
+    /// The delay doubles while a transfer stays active, up to this
+    clock_t::duration max_interval = std::chrono::seconds(60);
+    /// Most transfers checked with one Globus call
+    size_t batch_size = 50;
+    /// A transfer fails after this many checks in a row could not be made
+    uint32_t max_check_errors = 5;
+  };
+
+  TransferMonitor(check_fun_t a_check, cancel_fun_t a_cancel,
+                  resume_fun_t a_resume, LogContext a_log_context);
+  TransferMonitor(check_fun_t a_check, cancel_fun_t a_cancel,
+                  resume_fun_t a_resume, LogContext a_log_context,
+                  const Options &a_options);
+  ~TransferMonitor();
+
+  TransferMonitor(const TransferMonitor &) = delete;
+  TransferMonitor &operator=(const TransferMonitor &) = delete;
+
+  void add(std::unique_ptr<ITaskMgr::Task> a_task,
+           const std::string &a_glob_task_id, const std::string &a_acc_tok);
+
+  /// Number of transfers being watched
+  size_t size() const;
+
+private:
+  struct Transfer {
+    std::unique_ptr<ITaskMgr::Task> task;
+    std::string acc_tok;
+    clock_t::time_point next_check;
+    clock_t::duration interval;
+    uint32_t check_errors = 0;
+  };
+
+  void monitorThread();
+  void checkDue(std::unique_lock<std::mutex> &a_lock);
+
+  check_fun_t m_check;
+  cancel_fun_t m_cancel;
+  resume_fun_t m_resume;
+  LogContext m_log_context;
+  Options m_options;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cvar;
+  /// Keyed by Globus task id
+  std::map<std::string, Transfer> m_transfers;
+  bool m_running = true;
+  std::thread m_thread;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
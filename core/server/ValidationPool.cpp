@@ -0,0 +1,129 @@
+// Local private includes
+#include "ValidationPool.hpp"
+
+// Standard includes
+#include <algorithm>
+
+using namespace std;
+
+namespace SDMS {
+namespace Core {
+
+ValidationPool::ValidationPool(size_t a_num_threads) : m_run(true) {
+  startThreads(a_num_threads);
+}
+
+ValidationPool::~ValidationPool() { stopThreads(); }
+
+void ValidationPool::setNumThreads(size_t a_num_threads) {
+  stopThreads();
+  startThreads(a_num_threads);
+}
+
+void ValidationPool::startThreads(size_t a_num_threads) {
+  if (a_num_threads == 0)
+    a_num_threads = min<size_t>(max(1u, thread::hardware_concurrency()),
+                                DEFAULT_MAX_THREADS);
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_run = true;
+  }
+
+  // Every thread calling parallelFor() is a worker too
+  for (size_t i = 1; i < a_num_threads; i++)
+    m_threads.emplace_back(&ValidationPool::workerThread, this);
+}
+
+void ValidationPool::stopThreads() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_run = false;
+  }
+
+  m_work_cvar.notify_all();
+
+  for (thread &t : m_threads)
+    t.join();
+
+  m_threads.clear();
+}
+
+void ValidationPool::parallelFor(size_t a_count, const task_t &a_task) {
+  if (a_count == 0)
+    return;
+
+  if (a_count == 1 || m_threads.empty()) {
+    for (size_t i = 0; i < a_count; i++)
+      a_task(i);
+    return;
+  }
+
+  Batch batch{&a_task, a_count, 0, 0, nullptr};
+  unique_lock<mutex> lock(m_mutex);
+
+  m_batches.push_back(&batch);
+  m_work_cvar.notify_all();
+
+  while (batch.next < batch.count)
+    runTask(batch, lock);
+
+  m_done_cvar.wait(lock, [&batch] { return batch.busy == 0; });
+
+  if (batch.error)
+    rethrow_exception(batch.error);
+}
+
+void ValidationPool::workerThread() {
+  unique_lock<mutex> lock(m_mutex);
+
+  while (true) {
+    m_work_cvar.wait(lock, [this] { return !m_run || !m_batches.empty(); });
+
+    if (!m_run)
+      break;
+
+    // Take turns between the batches of different callers
+    Batch *batch = m_batches.front();
+    m_batches.pop_front();
+    m_batches.push_back(batch);
+
+    runTask(*batch, lock);
+
+    if (batch->busy == 0 && batch->next >= batch->count)
+      m_done_cvar.notify_all();
+  }
+}
+
+void ValidationPool::runTask(Batch &a_batch, unique_lock<mutex> &a_lock) {
+  size_t index = a_batch.next++;
+  a_batch.busy++;
+
+  if (a_batch.next >= a_batch.count)
+    m_batches.erase(find(m_batches.begin(), m_batches.end(), &a_batch));
+
+  a_lock.unlock();
+
+  exception_ptr error;
+  try {
+    (*a_batch.task)(index);
+  } catch (...) {
+    error = current_exception();
+  }
+
+  a_lock.lock();
+  a_batch.busy--;
+
+  if (error) {
+    if (!a_batch.error)
+      a_batch.error = error;
+    // Skip whatever has not been started yet
+    if (a_batch.next < a_batch.count) {
+      a_batch.next = a_batch.count;
+      m_batches.erase(find(m_batches.begin(), m_batches.end(), &a_batch));
+    }
+  }
+}
+
+} // namespace Core
+} // namespace SDMS
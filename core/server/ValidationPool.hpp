@@ -0,0 +1,88 @@
+#ifndef VALIDATIONPOOL_HPP
+#define VALIDATIONPOOL_HPP
+#pragma once
+
+// Standard includes
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stddef.h>
+#include <thread>
+#include <vector>
+
+namespace SDMS {
+namespace Core {
+
+/**
+ * Small fixed-size thread pool used to fan out CPU-bound work, such as
+ * metadata schema validation of batch record requests, across cores.
+ *
+ * One pool is shared by all ClientWorkers, so the number of validation
+ * threads does not grow with the number of workers. Several parallelFor()
+ * calls may run at once; the pool threads take indices from them in turn and
+ * every caller also works on its own indices, so a large batch on one worker
+ * does not stall batches on other workers.
+ */
+class ValidationPool {
+public:
+  typedef std::function<void(size_t a_index)> task_t;
+
+  /// Most threads used by default
+  static constexpr size_t DEFAULT_MAX_THREADS = 4;
+
+  /// The pool shared by the ClientWorkers
+  static ValidationPool &getInstance() {
+    static ValidationPool inst;
+    return inst;
+  }
+
+  /// A thread count of 0 uses one thread per core, at most DEFAULT_MAX_THREADS
+  explicit ValidationPool(size_t a_num_threads = 0);
+  ~ValidationPool();
+
+  ValidationPool(const ValidationPool &) = delete;
+  ValidationPool &operator=(const ValidationPool &) = delete;
+
+  /// Restart the pool with a new thread count, only while it is not in use
+  void setNumThreads(size_t a_num_threads);
+
+  /**
+   * Run a_task for every index in [0, a_count) and wait for all of them to
+   * finish. The calling thread also processes indices. If any task throws,
+   * the remaining indices are skipped and the first exception is rethrown.
+   */
+  void parallelFor(size_t a_count, const task_t &a_task);
+
+  size_t numThreads() const { return m_threads.size() + 1; }
+
+private:
+  /// One parallelFor() call, lives on the caller's stack
+  struct Batch {
+    const task_t *task;
+    size_t count;
+    size_t next;
+    size_t busy;
+    std::exception_ptr error;
+  };
+
+  void startThreads(size_t a_num_threads);
+  void stopThreads();
+  void workerThread();
+  /// Runs one index of a_batch, must be called with m_mutex held
+  void runTask(Batch &a_batch, std::unique_lock<std::mutex> &a_lock);
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_work_cvar;
+  std::condition_variable m_done_cvar;
+  bool m_run;
+  /// Batches with indices not yet started, oldest first
+  std::deque<Batch *> m_batches;
+};
+
+} // namespace Core
+} // namespace SDMS
+
+#endif
@@ -1,10 +1,13 @@
 // Local private includes
 #include "CoreServer.hpp"
+#include "MessageLanes.hpp"
+#include "ResponseCache.hpp"
 // Core server version
 #include "Version.hpp"
 
 // Local public includes
 #include "common/DynaLog.hpp"
+#include "common/ProtoBufMap.hpp"
 #include "common/TraceException.hpp"
 #include "common/Util.hpp"
 // messaging version
@@ -15,6 +18,7 @@
 
 // Standard includes
 #include "Config.hpp"
+#include <algorithm>
 #include <climits>
 #include <fstream>
 #include <iostream>
@@ -50,6 +54,12 @@ int main(int a_argc, char **a_argv) {
     // Note: we may want to dynamically choose type at compile time
     // based on underlying type of LogLevel enum
     unsigned int cfg_log_level = UINT_MAX;
+    size_t cfg_log_queue = 8192;
+    string cfg_log_overflow = "block";
+    std::vector<string> cfg_task_shares;
+    std::vector<string> cfg_task_limits;
+    std::vector<string> cfg_msg_lanes;
+    std::vector<string> cfg_cache_ttls;
 
     po::options_description opts("Options");
 
@@ -82,11 +92,76 @@ int main(int a_argc, char **a_argv) {
         po::value<uint32_t>(&config.num_client_worker_threads),
         "Number of client worker threads")(
         "task-threads", po::value<uint32_t>(&config.num_task_worker_threads),
-        "Number of task worker threads")("cfg", po::value<string>(&cfg_file),
-                                         "Use config file for options")(
+        "Number of task worker threads")(
+        "db-connections",
+        po::value<uint32_t>(&config.num_db_connections),
+        "Maximum number of pooled DB connections")(
+        "validation-threads",
+        po::value<uint32_t>(&config.num_validation_threads),
+        "Metadata validation threads shared by all client workers (0 = one "
+        "per core, at most 4)")(
+        "max-msg-size", po::value<uint32_t>(&config.max_msg_size),
+        "Largest message body accepted from or sent to clients (bytes)")(
+        "max-req-size", po::value<uint32_t>(&config.max_req_size),
+        "Largest request accepted on the external interfaces (bytes)")(
+        "msg-chunk-size", po::value<uint32_t>(&config.msg_chunk_size),
+        "Send replies larger than this in chunks (bytes, 0 = never)")(
+        "zmq-io-threads", po::value<uint32_t>(&config.num_zmq_io_threads),
+        "Number of ZeroMQ I/O threads shared by all TCP connections")(
+        "zmq-io-cpus",
+        po::value<std::vector<int>>(&config.zmq_io_cpus)->multitoken(),
+        "CPUs to pin the ZeroMQ I/O threads to (default = any)")(
+        "task-share",
+        po::value<std::vector<string>>(&cfg_task_shares)->multitoken(),
+        "Task scheduling weight of a user or project as id=weight "
+        "(default = 1)")(
+        "task-repo-limit", po::value<uint32_t>(&config.task_repo_limit),
+        "Task steps running against one repo at a time (0 = unlimited)")(
+        "task-endpoint-limit",
+        po::value<uint32_t>(&config.task_endpoint_limit),
+        "Task transfers using one Globus endpoint at a time (0 = unlimited)")(
+        "task-limit",
+        po::value<std::vector<string>>(&cfg_task_limits)->multitoken(),
+        "Limit of one repo or endpoint as id=count, overrides the above")(
+        "query-threads",
+        po::value<uint32_t>(&config.num_query_worker_threads),
+        "Client worker threads for searches and exports (0 = use client "
+        "threads)")(
+        "bulk-threads", po::value<uint32_t>(&config.num_bulk_worker_threads),
+        "Client worker threads for batch writes and deletes (0 = use client "
+        "threads)")(
+        "interactive-queue",
+        po::value<uint32_t>(&config.interactive_queue_limit),
+        "Queued interactive requests before refusing more (0 = unlimited)")(
+        "query-queue", po::value<uint32_t>(&config.query_queue_limit),
+        "Queued search and export requests before refusing more (0 = "
+        "unlimited)")(
+        "bulk-queue", po::value<uint32_t>(&config.bulk_queue_limit),
+        "Queued batch requests before refusing more (0 = unlimited)")(
+        "msg-lane", po::value<std::vector<string>>(&cfg_msg_lanes)->multitoken(),
+        "Move a request to a lane as RequestName=interactive|query|bulk")(
+        "interactive-rate", po::value<double>(&config.interactive_rate_limit),
+        "Interactive requests per second per user (0 = unlimited)")(
+        "query-rate", po::value<double>(&config.query_rate_limit),
+        "Search and export requests per second per user (0 = unlimited)")(
+        "bulk-rate", po::value<double>(&config.bulk_rate_limit),
+        "Batch requests per second per user (0 = unlimited)")(
+        "rate-burst", po::value<double>(&config.rate_limit_burst),
+        "Seconds worth of requests a user may send at once")(
+        "response-cache-mb", po::value<uint32_t>(&config.response_cache_mb),
+        "Memory for cached replies to read requests in MB (0 = no cache)")(
+        "cache-ttl",
+        po::value<std::vector<string>>(&cfg_cache_ttls)->multitoken(),
+        "Time to live of cached replies as RequestName=seconds (0 = not "
+        "cached)")(
+        "cfg", po::value<string>(&cfg_file), "Use config file for options")(
         "gen-keys", po::bool_switch(&gen_keys),
         "Generate new server keys then exit")(
-        "log-level", po::value<unsigned int>(&cfg_log_level), "Set log level");
+        "log-level", po::value<unsigned int>(&cfg_log_level), "Set log level")(
+        "log-queue", po::value<size_t>(&cfg_log_queue),
+        "Async log queue size in lines (0 = synchronous logging)")(
+        "log-overflow", po::value<string>(&cfg_log_overflow),
+        "Action when async log queue is full (block or drop)");
 
     try {
       po::variables_map opt_map;
@@ -191,6 +266,69 @@ int main(int a_argc, char **a_argv) {
           global_logger.setLevel(cast_log_level);
         }
       }
+
+      if (cfg_log_overflow != "block" && cfg_log_overflow != "drop") {
+        EXCEPT_PARAM(1, "Invalid log overflow action: " << cfg_log_overflow);
+      }
+      global_logger.setAsync(cfg_log_queue, cfg_log_overflow == "drop"
+                                                ? LogOverflow::DROP
+                                                : LogOverflow::BLOCK);
+
+      // Splits "id=number", false if malformed or number is negative
+      auto parseIdValue = [](const string &a_arg, string &a_id,
+                             double &a_value) {
+        size_t pos = a_arg.rfind('=');
+        if (pos == string::npos || pos == 0)
+          return false;
+        try {
+          a_value = stod(a_arg.substr(pos + 1));
+        } catch (exception &) {
+          return false;
+        }
+        a_id = a_arg.substr(0, pos);
+        return a_value >= 0;
+      };
+      string id;
+      double value;
+
+      for (const string &share : cfg_task_shares) {
+        if (!parseIdValue(share, id, value) || value == 0) {
+          EXCEPT_PARAM(1, "Invalid task share: " << share);
+        }
+        config.task_share_weights[id] = value;
+      }
+
+      for (const string &limit : cfg_task_limits) {
+        if (!parseIdValue(limit, id, value) || value > UINT_MAX) {
+          EXCEPT_PARAM(1, "Invalid task limit: " << limit);
+        }
+        config.task_target_limits[id] = (uint32_t)value;
+      }
+
+      for (const string &msg_lane : cfg_msg_lanes) {
+        size_t pos = msg_lane.rfind('=');
+        Core::MessageLanes::Lane lane;
+        if (pos == string::npos ||
+            !Core::MessageLanes::fromName(msg_lane.substr(pos + 1), lane)) {
+          EXCEPT_PARAM(1, "Invalid message lane: " << msg_lane);
+        }
+        // Throws if the request name is unknown
+        ProtoBufMap::getInstance().getMessageType(2, msg_lane.substr(0, pos));
+        config.msg_lanes[msg_lane.substr(0, pos)] = msg_lane.substr(pos + 1);
+      }
+
+      for (const string &cache_ttl : cfg_cache_ttls) {
+        // Only read requests known to be safe to cache may be configured
+        const auto &policies = Core::ResponseCache::defaultPolicies();
+        if (!parseIdValue(cache_ttl, id, value) || value > UINT_MAX ||
+            find_if(policies.begin(), policies.end(),
+                    [&](const Core::ResponseCache::Policy &a_policy) {
+                      return id == a_policy.name;
+                    }) == policies.end()) {
+          EXCEPT_PARAM(1, "Invalid cache ttl: " << cache_ttl);
+        }
+        config.response_cache_ttls[id] = (uint32_t)value;
+      }
     } catch (po::unknown_option &e) {
       DL_ERROR(log_context, "Options error: " << e.what());
       return 1;
@@ -72,4 +72,56 @@ BOOST_AUTO_TEST_CASE(testing_AuthMap_setgetcount) {
              5);
 }
 
+BOOST_AUTO_TEST_CASE(testing_AuthMap_lookup) {
+  AuthMap auth_map(30, 30, "https://db/sdms/blah", "greatestone", "1234");
+
+  auth_map.addKey(PublicKeyType::TRANSIENT, "trans", "u/bob");
+  auth_map.addKey(PublicKeyType::SESSION, "session", "u/alice");
+  auth_map.addKey(PublicKeyType::PERSISTENT, "repo", "repo/one");
+
+  std::string uid;
+  PublicKeyType type;
+  BOOST_TEST(auth_map.lookup("trans", uid, type));
+  BOOST_TEST(uid == "u/bob");
+  BOOST_TEST((type == PublicKeyType::TRANSIENT));
+
+  BOOST_TEST(auth_map.lookupAndCount("session", uid, type));
+  BOOST_TEST(uid == "u/alice");
+  BOOST_TEST((type == PublicKeyType::SESSION));
+  BOOST_TEST(auth_map.getAccessCount(PublicKeyType::SESSION, "session") == 1);
+
+  BOOST_TEST(auth_map.lookup("repo", uid, type));
+  BOOST_TEST(uid == "repo/one");
+  BOOST_TEST((type == PublicKeyType::PERSISTENT));
+
+  // Removing one type of a key leaves the others
+  auth_map.migrateKey(PublicKeyType::TRANSIENT, PublicKeyType::SESSION,
+                      "trans", "u/bob");
+  BOOST_TEST(auth_map.size(PublicKeyType::TRANSIENT) == 0);
+  BOOST_TEST(auth_map.size(PublicKeyType::SESSION) == 2);
+  BOOST_TEST(auth_map.lookup("trans", uid, type));
+  BOOST_TEST((type == PublicKeyType::SESSION));
+}
+
+BOOST_AUTO_TEST_CASE(testing_AuthMap_expired_keys) {
+  AuthMap auth_map(30, 60, "https://db/sdms/blah", "greatestone", "1234");
+
+  const time_t now = time(0);
+  auth_map.addKey(PublicKeyType::TRANSIENT, "old", "u/bob");
+  auth_map.addKey(PublicKeyType::TRANSIENT, "reset", "u/alice");
+
+  BOOST_TEST(auth_map.getExpiredKeys(PublicKeyType::TRANSIENT, now).empty());
+
+  // Resetting a key replaces its expiry, the old one is skipped
+  auth_map.resetKey(PublicKeyType::TRANSIENT, "reset");
+  auth_map.removeKey(PublicKeyType::TRANSIENT, "old");
+  BOOST_TEST(
+      auth_map.getExpiredKeys(PublicKeyType::TRANSIENT, now + 29).empty());
+
+  auto expired = auth_map.getExpiredKeys(PublicKeyType::TRANSIENT, now + 40);
+  BOOST_REQUIRE(expired.size() == 1);
+  BOOST_TEST(expired[0] == "reset");
+  BOOST_TEST(auth_map.getExpiredKeys(PublicKeyType::SESSION, now + 40).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,169 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE databaseapi
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "DatabaseAPI.hpp"
+#include "DatabaseConnectionPool.hpp"
+#include "DatabaseEventLoop.hpp"
+
+// Local public includes
+#include "common/TraceException.hpp"
+
+// Third party includes
+#include <google/protobuf/stubs/common.h>
+
+// Standard includes
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace SDMS;
+using namespace SDMS::Core;
+
+struct GlobalProtobufTeardown {
+  ~GlobalProtobufTeardown() {
+    // This is the teardown function that runs once at the end
+    google::protobuf::ShutdownProtobufLibrary();
+  }
+};
+
+// Declare a global fixture instance
+BOOST_GLOBAL_FIXTURE(GlobalProtobufTeardown);
+
+BOOST_AUTO_TEST_SUITE(DatabaseAPITest)
+
+// Nothing listens on port 1, so every request fails at the transport level
+const std::string unreachable_db_url = "http://127.0.0.1:1/api/";
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseAPI_async_future_error) {
+  LogContext log_context;
+  DatabaseAPI db(unreachable_db_url, "user", "pass");
+
+  std::future<libjson::Value> result =
+      db.dbGetAsync("admin/ping", {}, log_context);
+
+  BOOST_TEST((result.wait_for(std::chrono::seconds(30)) ==
+              std::future_status::ready));
+  BOOST_CHECK_THROW(result.get(), TraceException);
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseAPI_async_callback_outlives_api) {
+  LogContext log_context;
+  std::promise<bool> failed;
+  std::future<bool> done = failed.get_future();
+
+  {
+    // Completion must not depend on the DatabaseAPI instance
+    DatabaseAPI db(unreachable_db_url, "user", "pass");
+    std::string body = "{}";
+    db.dbPostAsync(
+        "metrics/msg_count/update", {}, &body,
+        [&failed](libjson::Value &a_result, std::exception_ptr a_error) {
+          (void)a_result;
+          failed.set_value(a_error != nullptr);
+        },
+        log_context);
+  }
+
+  BOOST_TEST((done.wait_for(std::chrono::seconds(30)) ==
+              std::future_status::ready));
+  BOOST_TEST(done.get());
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseAPI_async_many_in_flight) {
+  LogContext log_context;
+  DatabaseAPI db(unreachable_db_url, "user", "pass");
+  std::vector<std::future<libjson::Value>> results;
+
+  for (int i = 0; i < 10; ++i) {
+    results.push_back(db.dbGetAsync("admin/ping", {}, log_context));
+  }
+
+  for (auto &result : results) {
+    BOOST_CHECK_THROW(result.get(), TraceException);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseAPI_async_pool_exhausted) {
+  LogContext log_context;
+  DatabaseAPI db(unreachable_db_url, "user", "pass");
+  DatabaseConnectionPool &pool = DatabaseConnectionPool::getInstance();
+  pool.setCapacity(1);
+
+  // Handles of earlier tests are released after their callbacks ran
+  while (DatabaseEventLoop::getInstance().inFlight())
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  std::future<libjson::Value> result;
+  {
+    // Calls are queued rather than waiting for the handles held here
+    std::vector<DatabaseConnectionPool::Handle> held;
+    held.push_back(pool.acquire());
+    while (held.back().get())
+      held.push_back(pool.tryAcquire());
+
+    result = db.dbGetAsync("admin/ping", {}, log_context);
+    BOOST_TEST((result.wait_for(std::chrono::milliseconds(100)) ==
+                std::future_status::timeout));
+  }
+
+  BOOST_TEST((result.wait_for(std::chrono::seconds(30)) ==
+              std::future_status::ready));
+  BOOST_CHECK_THROW(result.get(), TraceException);
+
+  // A callback chaining another call must not wait on its own handle
+  std::promise<bool> chained;
+  std::future<bool> done = chained.get_future();
+  db.dbGetAsync(
+      "admin/ping", {},
+      [&db, &chained, log_context](libjson::Value &, std::exception_ptr) {
+        db.dbGetAsync(
+            "admin/ping", {},
+            [&chained](libjson::Value &, std::exception_ptr a_error) {
+              chained.set_value(a_error != nullptr);
+            },
+            log_context);
+      },
+      log_context);
+
+  BOOST_TEST((done.wait_for(std::chrono::seconds(30)) ==
+              std::future_status::ready));
+  BOOST_TEST(done.get());
+  pool.setCapacity(32);
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseAPI_uid_by_pub_key_async_no_wait) {
+  DatabaseAPI db(unreachable_db_url, "user", "pass");
+  DatabaseConnectionPool &pool = DatabaseConnectionPool::getInstance();
+  pool.setCapacity(1);
+
+  while (DatabaseEventLoop::getInstance().inFlight())
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  std::promise<long> looked_up;
+  std::future<long> http_code = looked_up.get_future();
+  {
+    // Key lookups run on the proxy thread, they must not wait for a handle
+    std::vector<DatabaseConnectionPool::Handle> held;
+    held.push_back(pool.acquire());
+    while (held.back().get())
+      held.push_back(pool.tryAcquire());
+
+    db.uidByPubKeyAsync("key", [&looked_up](long a_http_code,
+                                            const std::string &) {
+      looked_up.set_value(a_http_code);
+    });
+    BOOST_TEST((http_code.wait_for(std::chrono::milliseconds(100)) ==
+                std::future_status::timeout));
+  }
+
+  BOOST_TEST((http_code.wait_for(std::chrono::seconds(30)) ==
+              std::future_status::ready));
+  BOOST_TEST(http_code.get() == 0);
+  pool.setCapacity(32);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
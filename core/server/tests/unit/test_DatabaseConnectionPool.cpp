@@ -0,0 +1,129 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE databaseconnectionpool
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "DatabaseConnectionPool.hpp"
+
+// Standard includes
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace SDMS::Core;
+
+BOOST_AUTO_TEST_SUITE(DatabaseConnectionPoolTest)
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseConnectionPool_reuse) {
+  DatabaseConnectionPool &pool = DatabaseConnectionPool::getInstance();
+  pool.setCapacity(2);
+
+  CURL *first = nullptr;
+  {
+    DatabaseConnectionPool::Handle handle = pool.acquire();
+    BOOST_TEST(handle.get() != nullptr);
+    first = handle.get();
+
+    DatabaseConnectionPool::Stats stats = pool.getStats();
+    BOOST_TEST(stats.in_use == 1);
+    BOOST_TEST(stats.idle == 0);
+  }
+
+  DatabaseConnectionPool::Stats stats = pool.getStats();
+  BOOST_TEST(stats.in_use == 0);
+  BOOST_TEST(stats.idle == 1);
+
+  // Released handles are handed out again rather than creating new ones
+  DatabaseConnectionPool::Handle handle = pool.acquire();
+  BOOST_TEST(handle.get() == first);
+  BOOST_TEST(pool.getStats().created == 1);
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseConnectionPool_bounded) {
+  DatabaseConnectionPool &pool = DatabaseConnectionPool::getInstance();
+  pool.setCapacity(2);
+
+  DatabaseConnectionPool::Handle handle1 = pool.acquire();
+  DatabaseConnectionPool::Handle handle2 = pool.acquire();
+  BOOST_TEST(handle1.get() != handle2.get());
+  BOOST_TEST(pool.getStats().created == 2);
+
+  size_t waited = pool.getStats().waited;
+  CURL *borrowed = nullptr;
+
+  std::thread borrower([&pool, &borrowed] {
+    DatabaseConnectionPool::Handle handle3 = pool.acquire();
+    borrowed = handle3.get();
+  });
+
+  // Borrower must block until a handle is returned
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  BOOST_TEST(borrowed == nullptr);
+
+  CURL *returned = handle1.get();
+  {
+    DatabaseConnectionPool::Handle released = std::move(handle1);
+  }
+  borrower.join();
+
+  BOOST_TEST(borrowed == returned);
+  DatabaseConnectionPool::Stats stats = pool.getStats();
+  BOOST_TEST(stats.created == 2);
+  BOOST_TEST(stats.waited == waited + 1);
+  BOOST_TEST(stats.in_use == 1);
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseConnectionPool_try_acquire) {
+  DatabaseConnectionPool &pool = DatabaseConnectionPool::getInstance();
+  pool.setCapacity(2);
+
+  size_t waited = pool.getStats().waited;
+  std::vector<DatabaseConnectionPool::Handle> held;
+  held.push_back(pool.tryAcquire());
+  held.push_back(pool.tryAcquire());
+  BOOST_TEST(held[0].get() != nullptr);
+  BOOST_TEST(held[1].get() != nullptr);
+
+  // Does not wait when the pool is exhausted
+  {
+    DatabaseConnectionPool::Handle none = pool.tryAcquire();
+    BOOST_TEST(none.get() == nullptr);
+  }
+  BOOST_TEST(pool.getStats().in_use == 2);
+  BOOST_TEST(pool.getStats().waited == waited);
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseConnectionPool_shrink) {
+  DatabaseConnectionPool &pool = DatabaseConnectionPool::getInstance();
+  // Nothing is borrowed, so idle handles are closed down to the capacity
+  pool.setCapacity(1);
+  BOOST_TEST(pool.getStats().created <= 1);
+
+  pool.setCapacity(3);
+  std::vector<DatabaseConnectionPool::Handle> held;
+  for (int i = 0; i < 3; ++i)
+    held.push_back(pool.acquire());
+  held.pop_back();
+  BOOST_TEST(pool.getStats().created == 3);
+  BOOST_TEST(pool.getStats().idle == 1);
+
+  pool.setCapacity(1);
+  DatabaseConnectionPool::Stats stats = pool.getStats();
+  BOOST_TEST(stats.created == 2);
+  BOOST_TEST(stats.idle == 0);
+
+  // Borrowed handles above the capacity are closed when returned
+  held.pop_back();
+  stats = pool.getStats();
+  BOOST_TEST(stats.created == 1);
+  BOOST_TEST(stats.idle == 0);
+
+  held.pop_back();
+  stats = pool.getStats();
+  BOOST_TEST(stats.created == 1);
+  BOOST_TEST(stats.idle == 1);
+  BOOST_TEST(stats.in_use == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE databasereplystream
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "DatabaseReplyStream.hpp"
+
+// Standard includes
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace SDMS::Core;
+
+BOOST_AUTO_TEST_SUITE(DatabaseReplyStreamTest)
+
+const std::string listing_reply =
+    " [{\"id\":\"d/1\",\"title\":\"a ] } , [ { title\",\"deps\":[{\"id\":"
+    "\"d/2\",\"type\":0,\"dir\":1}]},\n {\"id\":\"d/3\",\"title\":\"quote "
+    "\\\" and \\\\\"},{\"paging\":{\"off\":0,\"cnt\":2,\"tot\":2}}]\n";
+
+const std::vector<std::string> listing_elements = {
+    "{\"id\":\"d/1\",\"title\":\"a ] } , [ { title\",\"deps\":[{\"id\":"
+    "\"d/2\",\"type\":0,\"dir\":1}]}",
+    "{\"id\":\"d/3\",\"title\":\"quote \\\" and \\\\\"}",
+    "{\"paging\":{\"off\":0,\"cnt\":2,\"tot\":2}}"};
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseReplyStream_single_chunk) {
+  std::vector<std::string> elements;
+  DatabaseReplyStream stream(nullptr, [&elements](const std::string &a_elem) {
+    elements.push_back(a_elem);
+  });
+
+  stream.write(listing_reply.data(), listing_reply.size());
+
+  BOOST_TEST(stream.streamed());
+  BOOST_TEST(stream.complete());
+  BOOST_TEST(elements == listing_elements);
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseReplyStream_byte_chunks) {
+  std::vector<std::string> elements;
+  DatabaseReplyStream stream(nullptr, [&elements](const std::string &a_elem) {
+    elements.push_back(a_elem);
+  });
+
+  for (char c : listing_reply) {
+    stream.write(&c, 1);
+  }
+
+  BOOST_TEST(stream.complete());
+  BOOST_TEST(elements == listing_elements);
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseReplyStream_scalars) {
+  std::vector<std::string> elements;
+  DatabaseReplyStream stream(nullptr, [&elements](const std::string &a_elem) {
+    elements.push_back(a_elem);
+  });
+
+  std::string reply = "[1,\"two\",true,[3]]";
+  stream.write(reply.data(), reply.size());
+
+  std::vector<std::string> expected = {"1", "\"two\"", "true", "[3]"};
+  BOOST_TEST(stream.complete());
+  BOOST_TEST(elements == expected);
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseReplyStream_not_array) {
+  size_t count = 0;
+  DatabaseReplyStream stream(
+      nullptr, [&count](const std::string &a_elem) { (void)a_elem; count++; });
+
+  std::string reply = "  {\"errorMessage\":\"[bad]\"}";
+  stream.write(reply.data(), 10);
+  stream.write(reply.data() + 10, reply.size() - 10);
+
+  BOOST_TEST(!stream.streamed());
+  BOOST_TEST(count == 0);
+  BOOST_TEST(stream.raw() == "{\"errorMessage\":\"[bad]\"}");
+}
+
+BOOST_AUTO_TEST_CASE(testing_DatabaseReplyStream_element_error) {
+  size_t count = 0;
+  DatabaseReplyStream stream(nullptr, [&count](const std::string &a_elem) {
+    (void)a_elem;
+    if (++count == 2)
+      throw std::runtime_error("bad element");
+  });
+
+  std::string reply = "[{},{},{}]";
+  size_t written = DatabaseReplyStream::curlWriteCB(
+      const_cast<char *>(reply.data()), 1, reply.size(), &stream);
+
+  // Transfer is aborted and no further elements are handled
+  BOOST_TEST(written == 0);
+  BOOST_TEST(count == 2);
+  BOOST_TEST((stream.error() != nullptr));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
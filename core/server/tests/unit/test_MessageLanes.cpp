@@ -0,0 +1,78 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE messagelanes
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "MessageLanes.hpp"
+
+// Standard includes
+#include <chrono>
+#include <string>
+
+using namespace SDMS::Core;
+
+BOOST_AUTO_TEST_SUITE(MessageLanesTest)
+
+BOOST_AUTO_TEST_CASE(testing_MessageLanes_names) {
+  MessageLanes::Lane lane;
+  BOOST_TEST(MessageLanes::fromName("query", lane));
+  BOOST_TEST(lane == MessageLanes::QUERY);
+  BOOST_TEST(MessageLanes::fromName("bulk", lane));
+  BOOST_TEST(lane == MessageLanes::BULK);
+  BOOST_TEST(!MessageLanes::fromName("fast", lane));
+
+  BOOST_TEST(MessageLanes::host(MessageLanes::INTERACTIVE) == "workers");
+  BOOST_TEST(MessageLanes::host(MessageLanes::QUERY) == "workers_query");
+}
+
+BOOST_AUTO_TEST_CASE(testing_MessageLanes_classify) {
+  MessageLanes lanes;
+  lanes.setLane(300, MessageLanes::QUERY);
+  lanes.setLane(10, MessageLanes::BULK);
+
+  BOOST_TEST(lanes.lane(300) == MessageLanes::QUERY);
+  BOOST_TEST(lanes.lane(10) == MessageLanes::BULK);
+  BOOST_TEST(lanes.lane(11) == MessageLanes::INTERACTIVE);
+  BOOST_TEST(lanes.lane(5000) == MessageLanes::INTERACTIVE);
+}
+
+BOOST_AUTO_TEST_CASE(testing_MessageLanes_capacity) {
+  MessageLanes lanes;
+  lanes.setCapacity(MessageLanes::QUERY, 2);
+
+  BOOST_TEST(lanes.admit(MessageLanes::QUERY, "a"));
+  BOOST_TEST(lanes.admit(MessageLanes::QUERY, "b"));
+  BOOST_TEST(!lanes.admit(MessageLanes::QUERY, "c"));
+
+  // A full query lane does not hold up the interactive one
+  for (int i = 0; i < 100; i++)
+    BOOST_TEST(lanes.admit(MessageLanes::INTERACTIVE, std::to_string(i)));
+
+  lanes.complete("a");
+  lanes.complete("unknown");
+  BOOST_TEST(lanes.admit(MessageLanes::QUERY, "c"));
+
+  MessageLanes::LaneStats stats = lanes.stats(MessageLanes::QUERY);
+  BOOST_TEST(stats.in_flight == 2);
+  BOOST_TEST(stats.routed == 3);
+  BOOST_TEST(stats.refused == 1);
+}
+
+BOOST_AUTO_TEST_CASE(testing_MessageLanes_resent_and_expired) {
+  MessageLanes lanes;
+  lanes.setCapacity(MessageLanes::BULK, 1);
+  auto start = std::chrono::steady_clock::now();
+
+  BOOST_TEST(lanes.admit(MessageLanes::BULK, "a", start));
+  // The same request again does not count twice
+  BOOST_TEST(lanes.admit(MessageLanes::BULK, "a", start));
+  BOOST_TEST(lanes.stats(MessageLanes::BULK).in_flight == 1);
+
+  BOOST_TEST(lanes.expire(start) == 0);
+  BOOST_TEST(lanes.expire(start + std::chrono::seconds(1)) == 1);
+  BOOST_TEST(lanes.stats(MessageLanes::BULK).in_flight == 0);
+  BOOST_TEST(lanes.admit(MessageLanes::BULK, "b", start));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
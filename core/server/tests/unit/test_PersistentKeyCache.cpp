@@ -0,0 +1,150 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE persistentkeycache
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "PersistentKeyCache.hpp"
+
+// Standard includes
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace SDMS::Core;
+
+typedef PersistentKeyCache::Lookup Lookup;
+
+BOOST_AUTO_TEST_SUITE(PersistentKeyCacheTest)
+
+BOOST_AUTO_TEST_CASE(testing_PersistentKeyCache_store) {
+  PersistentKeyCache cache;
+  std::string uid;
+
+  BOOST_TEST((cache.get("key1", uid) == Lookup::MISS));
+
+  cache.store("key1", cache.generation(), true, "u/bob");
+  cache.store("key2", cache.generation(), false, "");
+
+  BOOST_TEST((cache.get("key1", uid) == Lookup::FOUND));
+  BOOST_TEST(uid == "u/bob");
+  BOOST_TEST((cache.get("key2", uid) == Lookup::NOT_FOUND));
+  BOOST_TEST(cache.size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(testing_PersistentKeyCache_lookup_in_flight) {
+  PersistentKeyCache cache;
+  std::string uid;
+  uint64_t generation = 0;
+
+  BOOST_TEST(cache.beginLookup("key1", generation));
+  // Only one lookup per key at a time
+  uint64_t other_generation = 0;
+  BOOST_TEST(cache.beginLookup("key1", other_generation) == false);
+  BOOST_TEST((cache.get("key1", uid) == Lookup::PENDING));
+
+  cache.store("key1", generation, true, "u/bob");
+  BOOST_TEST((cache.get("key1", uid) == Lookup::FOUND));
+
+  // A lookup that fails is remembered as not found
+  BOOST_TEST(cache.beginLookup("key2", generation));
+  cache.storeFailure("key2", generation);
+  BOOST_TEST((cache.get("key2", uid) == Lookup::NOT_FOUND));
+}
+
+BOOST_AUTO_TEST_CASE(testing_PersistentKeyCache_invalidate) {
+  PersistentKeyCache cache;
+  std::string uid;
+
+  cache.store("key1", cache.generation(), true, "u/bob");
+  cache.store("key2", cache.generation(), true, "u/bob");
+  cache.store("key3", cache.generation(), true, "u/sue");
+
+  // Lookup started before the revocation must not bring the key back
+  uint64_t generation = 0;
+  BOOST_TEST(cache.beginLookup("key4", generation));
+
+  cache.invalidateUID("u/bob");
+
+  BOOST_TEST((cache.get("key1", uid) == Lookup::MISS));
+  BOOST_TEST((cache.get("key2", uid) == Lookup::MISS));
+  BOOST_TEST((cache.get("key3", uid) == Lookup::FOUND));
+
+  cache.store("key4", generation, true, "u/bob");
+  BOOST_TEST((cache.get("key4", uid) == Lookup::MISS));
+
+  cache.invalidate("key3");
+  BOOST_TEST((cache.get("key3", uid) == Lookup::MISS));
+  BOOST_TEST(cache.size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(testing_PersistentKeyCache_invalidate_other_keys) {
+  PersistentKeyCache cache;
+  std::string uid;
+
+  uint64_t generation1 = 0;
+  uint64_t generation2 = 0;
+  uint64_t generation3 = 0;
+  BOOST_TEST(cache.beginLookup("key1", generation1));
+  BOOST_TEST(cache.beginLookup("key2", generation2));
+  BOOST_TEST(cache.beginLookup("key3", generation3));
+
+  // Only lookups for the invalidated key or user are dropped
+  cache.invalidate("key1");
+  cache.invalidateUID("u/bob");
+
+  cache.store("key1", generation1, true, "u/sue");
+  cache.store("key2", generation2, true, "u/bob");
+  cache.store("key3", generation3, true, "u/sue");
+
+  BOOST_TEST((cache.get("key1", uid) == Lookup::MISS));
+  BOOST_TEST((cache.get("key2", uid) == Lookup::MISS));
+  BOOST_TEST((cache.get("key3", uid) == Lookup::FOUND));
+  BOOST_TEST(uid == "u/sue");
+
+  // Lookups started after the invalidation are stored
+  BOOST_TEST(cache.beginLookup("key1", generation1));
+  cache.store("key1", generation1, true, "u/sue");
+  BOOST_TEST((cache.get("key1", uid) == Lookup::FOUND));
+
+  // clear() drops every lookup that is still running
+  BOOST_TEST(cache.beginLookup("key4", generation1));
+  cache.clear();
+  cache.store("key4", generation1, true, "u/sue");
+  BOOST_TEST((cache.get("key4", uid) == Lookup::MISS));
+}
+
+BOOST_AUTO_TEST_CASE(testing_PersistentKeyCache_lru) {
+  PersistentKeyCache cache(2);
+  std::string uid;
+
+  cache.store("key1", cache.generation(), true, "u/one");
+  cache.store("key2", cache.generation(), true, "u/two");
+
+  // Touch key1 so key2 is the least recently used
+  BOOST_TEST((cache.get("key1", uid) == Lookup::FOUND));
+  cache.store("key3", cache.generation(), true, "u/three");
+
+  BOOST_TEST(cache.size() == 2);
+  BOOST_TEST((cache.get("key1", uid) == Lookup::FOUND));
+  BOOST_TEST((cache.get("key2", uid) == Lookup::MISS));
+  BOOST_TEST((cache.get("key3", uid) == Lookup::FOUND));
+}
+
+BOOST_AUTO_TEST_CASE(testing_PersistentKeyCache_ttl) {
+  PersistentKeyCache cache(10, std::chrono::seconds(1),
+                           std::chrono::seconds(0), std::chrono::seconds(0));
+  std::string uid;
+
+  cache.store("key1", cache.generation(), true, "u/bob");
+  cache.store("key2", cache.generation(), false, "");
+
+  BOOST_TEST((cache.get("key1", uid) == Lookup::FOUND));
+  BOOST_TEST((cache.get("key2", uid) == Lookup::MISS));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  BOOST_TEST((cache.get("key1", uid) == Lookup::MISS));
+  BOOST_TEST(cache.size() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,86 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE ratelimiter
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "RateLimiter.hpp"
+
+// Standard includes
+#include <chrono>
+#include <string>
+
+using namespace SDMS::Core;
+
+namespace {
+const uint16_t search_msg_type = 300;
+const uint16_t view_msg_type = 301;
+} // namespace
+
+struct LimiterFixture {
+  LimiterFixture() : limiter(lanes) {
+    lanes.setLane(search_msg_type, MessageLanes::QUERY);
+    limiter.setLimit(MessageLanes::QUERY, 2, 2);
+    limiter.setLimit(MessageLanes::INTERACTIVE, 10, 20);
+  }
+
+  MessageLanes lanes;
+  RateLimiter limiter;
+  RateLimiter::clock::time_point start = RateLimiter::clock::now();
+};
+
+BOOST_FIXTURE_TEST_SUITE(RateLimiterTest, LimiterFixture)
+
+BOOST_AUTO_TEST_CASE(testing_RateLimiter_burst_then_refill) {
+  uint32_t retry_after_ms = 0;
+  BOOST_TEST(limiter.admit("u/bob", search_msg_type, retry_after_ms, start));
+  BOOST_TEST(limiter.admit("u/bob", search_msg_type, retry_after_ms, start));
+  BOOST_TEST(!limiter.admit("u/bob", search_msg_type, retry_after_ms, start));
+  BOOST_TEST(retry_after_ms == 500);
+
+  // Other lanes and other users are not affected
+  BOOST_TEST(limiter.admit("u/bob", view_msg_type, retry_after_ms, start));
+  BOOST_TEST(limiter.admit("u/alice", search_msg_type, retry_after_ms, start));
+
+  auto later = start + std::chrono::milliseconds(500);
+  BOOST_TEST(limiter.admit("u/bob", search_msg_type, retry_after_ms, later));
+  BOOST_TEST(!limiter.admit("u/bob", search_msg_type, retry_after_ms, later));
+}
+
+BOOST_AUTO_TEST_CASE(testing_RateLimiter_drops) {
+  uint32_t retry_after_ms = 0;
+  for (int i = 0; i < 5; i++)
+    limiter.admit("u/bob", search_msg_type, retry_after_ms, start);
+
+  auto drops = limiter.takeDrops();
+  BOOST_TEST(drops.size() == 1);
+  BOOST_TEST(drops["u/bob"] == 3);
+  BOOST_TEST(limiter.takeDrops().empty());
+}
+
+BOOST_AUTO_TEST_CASE(testing_RateLimiter_exempt) {
+  uint32_t retry_after_ms = 0;
+  for (int i = 0; i < 10; i++) {
+    BOOST_TEST(limiter.admit("anon", search_msg_type, retry_after_ms, start));
+    BOOST_TEST(
+        limiter.admit("repo/one", search_msg_type, retry_after_ms, start));
+  }
+
+  // No limit on the bulk lane
+  lanes.setLane(view_msg_type, MessageLanes::BULK);
+  for (int i = 0; i < 10; i++)
+    BOOST_TEST(limiter.admit("u/bob", view_msg_type, retry_after_ms, start));
+}
+
+BOOST_AUTO_TEST_CASE(testing_RateLimiter_purge) {
+  uint32_t retry_after_ms = 0;
+  limiter.admit("u/bob", search_msg_type, retry_after_ms, start);
+  limiter.admit("u/alice", search_msg_type, retry_after_ms, start);
+  limiter.admit("u/alice", search_msg_type, retry_after_ms, start);
+
+  // Bob's bucket is full again after half a second, Alice's after one
+  BOOST_TEST(limiter.purge(start + std::chrono::milliseconds(600)) == 1);
+  BOOST_TEST(limiter.purge(start + std::chrono::seconds(1)) == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,169 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE repoconnectionpool
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "RepoConnectionPool.hpp"
+
+// Standard includes
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace SDMS;
+using namespace SDMS::Core;
+
+namespace {
+
+class FakeCommunicator : public ICommunicator {
+public:
+  FakeCommunicator(const std::string &a_address, const std::string &a_id)
+      : m_address(a_address), m_id(a_id) {}
+
+  Response poll(const MessageType) override { return Response(); }
+  Response pollPassThrough(const MessageType) override { return Response(); }
+  void send(IMessage &) override {}
+  Response receive(const MessageType) override { return Response(); }
+  const std::string id() const noexcept override { return m_id; }
+  const std::string address() const noexcept override { return m_address; }
+  void *nativeHandle() const noexcept override { return nullptr; }
+
+private:
+  std::string m_address;
+  std::string m_id;
+};
+
+struct Connector {
+  std::vector<std::string> socket_ids;
+
+  RepoConnectionPool::connect_fun_t function() {
+    return [this](const std::string &a_address, const std::string &,
+                  const std::string &a_socket_id) {
+      socket_ids.push_back(a_socket_id);
+      return std::unique_ptr<ICommunicator>(
+          new FakeCommunicator(a_address, a_socket_id));
+    };
+  }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(RepoConnectionPoolTest)
+
+BOOST_AUTO_TEST_CASE(testing_RepoConnectionPool_reuse) {
+  RepoConnectionPool pool;
+  Connector connector;
+  std::string first_id;
+
+  {
+    auto conn = pool.acquire("repo/a", "tcp://a:9000", "key_a",
+                             connector.function());
+    first_id = conn->id();
+    BOOST_TEST(pool.getStats().in_use == 1);
+    conn.reuse();
+  }
+  BOOST_TEST(pool.getStats().in_use == 0);
+  BOOST_TEST(pool.getStats().idle == 1);
+
+  {
+    auto conn = pool.acquire("repo/a", "tcp://a:9000", "key_a",
+                             connector.function());
+    BOOST_TEST(conn->id() == first_id);
+    conn.reuse();
+  }
+
+  // Each repo has its own connections
+  {
+    auto conn = pool.acquire("repo/b", "tcp://b:9000", "key_b",
+                             connector.function());
+    BOOST_TEST(conn->address() == "tcp://b:9000");
+    conn.reuse();
+  }
+
+  RepoConnectionPool::Stats stats = pool.getStats();
+  BOOST_TEST(connector.socket_ids.size() == 2);
+  BOOST_TEST(connector.socket_ids[0] != connector.socket_ids[1]);
+  BOOST_TEST(stats.created == 2);
+  BOOST_TEST(stats.acquired == 3);
+  BOOST_TEST(stats.reused == 1);
+  BOOST_TEST(stats.idle == 2);
+}
+
+BOOST_AUTO_TEST_CASE(testing_RepoConnectionPool_not_reused) {
+  RepoConnectionPool pool;
+  Connector connector;
+
+  // A lease that is not marked reusable, i.e. timed out, is closed
+  {
+    auto conn = pool.acquire("repo/a", "tcp://a:9000", "key_a",
+                             connector.function());
+  }
+  BOOST_TEST(pool.getStats().idle == 0);
+  BOOST_TEST(pool.getStats().discarded == 1);
+
+  {
+    auto conn = pool.acquire("repo/a", "tcp://a:9000", "key_a",
+                             connector.function());
+    conn.reuse();
+  }
+  BOOST_TEST(connector.socket_ids.size() == 2);
+  BOOST_TEST(pool.getStats().idle == 1);
+}
+
+BOOST_AUTO_TEST_CASE(testing_RepoConnectionPool_repo_changed) {
+  RepoConnectionPool pool;
+  Connector connector;
+
+  {
+    auto conn = pool.acquire("repo/a", "tcp://a:9000", "key_a",
+                             connector.function());
+    conn.reuse();
+  }
+
+  {
+    // Borrowed before the key changes, must not go back to the pool
+    auto old_conn = pool.acquire("repo/a", "tcp://a:9000", "key_a",
+                                 connector.function());
+    old_conn.reuse();
+
+    auto conn = pool.acquire("repo/a", "tcp://a:9000", "key_new",
+                             connector.function());
+    BOOST_TEST(connector.socket_ids.size() == 2);
+    conn.reuse();
+  }
+
+  RepoConnectionPool::Stats stats = pool.getStats();
+  BOOST_TEST(stats.idle == 1);
+  BOOST_TEST(stats.discarded == 1);
+
+  {
+    auto conn = pool.acquire("repo/a", "tcp://moved:9000", "key_new",
+                             connector.function());
+    BOOST_TEST(conn->address() == "tcp://moved:9000");
+    conn.reuse();
+  }
+  BOOST_TEST(connector.socket_ids.size() == 3);
+  BOOST_TEST(pool.getStats().idle == 1);
+}
+
+BOOST_AUTO_TEST_CASE(testing_RepoConnectionPool_max_idle) {
+  RepoConnectionPool pool(1);
+  Connector connector;
+
+  {
+    auto conn1 = pool.acquire("repo/a", "tcp://a:9000", "key_a",
+                              connector.function());
+    auto conn2 = pool.acquire("repo/a", "tcp://a:9000", "key_a",
+                              connector.function());
+    conn1.reuse();
+    conn2.reuse();
+  }
+
+  RepoConnectionPool::Stats stats = pool.getStats();
+  BOOST_TEST(stats.created == 2);
+  BOOST_TEST(stats.idle == 1);
+  BOOST_TEST(stats.discarded == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE requestadmission
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "RequestAdmission.hpp"
+
+// Public common includes
+#include "common/CommunicatorFactory.hpp"
+#include "common/CredentialFactory.hpp"
+#include "common/DynaLog.hpp"
+#include "common/MessageFactory.hpp"
+#include "common/ProtoBufMap.hpp"
+#include "common/SocketOptions.hpp"
+
+// Proto file includes
+#include "common/SDMS.pb.h"
+#include "common/SDMS_Anon.pb.h"
+#include "common/SDMS_Auth.pb.h"
+
+// Standard includes
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+using namespace SDMS;
+using namespace SDMS::Core;
+
+namespace {
+
+SocketOptions generateOptions(const std::string &a_local_id,
+                              SocketClassType a_class_type) {
+  SocketOptions socket_options;
+  socket_options.scheme = URIScheme::INPROC;
+  socket_options.class_type = a_class_type;
+  socket_options.direction_type = SocketDirectionalityType::BIDIRECTIONAL;
+  socket_options.communication_type = SocketCommunicationType::ASYNCHRONOUS;
+  socket_options.connection_life = a_class_type == SocketClassType::SERVER
+                                       ? SocketConnectionLife::PERSISTENT
+                                       : SocketConnectionLife::INTERMITTENT;
+  socket_options.protocol_type = ProtocolType::ZQTP;
+  socket_options.host = "test_request_admission";
+  socket_options.local_id = a_local_id;
+  return socket_options;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(RequestAdmissionTest)
+
+BOOST_AUTO_TEST_CASE(testing_RequestAdmission_checks) {
+  const ProtoBufMap &proto_map = ProtoBufMap::getInstance();
+  const uint16_t anon_type = proto_map.getMessageType(1, "VersionRequest");
+  const uint16_t auth_type = proto_map.getMessageType(2, "RecordViewRequest");
+  const auto now = std::chrono::steady_clock::now();
+
+  MessageFactory msg_factory;
+  auto request = msg_factory.create(MessageType::GOOGLE_PROTOCOL_BUFFER);
+
+  // Without a deadline a request never expires
+  BOOST_TEST((admitRequest(*request, auth_type, "u/alice", now) ==
+              Admission::ACCEPT));
+  BOOST_TEST((admitRequest(*request, anon_type, "anon", now) ==
+              Admission::ACCEPT));
+  BOOST_TEST((admitRequest(*request, auth_type, "anon", now) ==
+              Admission::AUTHN_REQUIRED));
+
+  request->setDeadline(now + std::chrono::seconds(1));
+  BOOST_TEST((admitRequest(*request, auth_type, "u/alice", now) ==
+              Admission::ACCEPT));
+  BOOST_TEST((admitRequest(*request, auth_type, "u/alice",
+                           now + std::chrono::seconds(1)) ==
+              Admission::EXPIRED));
+}
+
+BOOST_AUTO_TEST_CASE(testing_RequestAdmission_expired) {
+  LogContext log_context;
+  log_context.thread_name = "test_request_admission";
+  CommunicatorFactory factory(log_context);
+
+  CredentialFactory cred_factory;
+  std::unordered_map<CredentialType, std::string> cred_options;
+  auto credentials = cred_factory.create(ProtocolType::ZQTP, cred_options);
+
+  auto server = factory.create(
+      generateOptions("worker", SocketClassType::SERVER), *credentials, 100,
+      10);
+  auto client = factory.create(
+      generateOptions("client", SocketClassType::CLIENT), *credentials, 100,
+      10);
+
+  MessageFactory msg_factory;
+  auto request = msg_factory.create(MessageType::GOOGLE_PROTOCOL_BUFFER);
+  request->set(MessageAttribute::ID, "u/alice");
+  auto view_req = std::make_unique<Auth::RecordViewRequest>();
+  view_req->set_id("d/1234");
+  request->setPayload(std::move(view_req));
+  request->setDeadline(std::chrono::steady_clock::now() +
+                       std::chrono::milliseconds(10));
+  const std::string correlation_id =
+      std::get<std::string>(request->get(MessageAttribute::CORRELATION_ID));
+  client->send(*request);
+
+  ICommunicator::Response response =
+      server->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+  BOOST_REQUIRE(response.time_out == false);
+  BOOST_REQUIRE(response.error == false);
+
+  // The client gives up while the request waits for a worker
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // Handlers are only called for accepted requests
+  IMessage &message = *response.message;
+  const uint16_t msg_type =
+      std::get<uint16_t>(message.get(constants::message::google::MSG_TYPE));
+  const std::string uid =
+      std::get<std::string>(message.get(MessageAttribute::ID));
+  const Admission admission = admitRequest(message, msg_type, uid,
+                                           std::chrono::steady_clock::now());
+  BOOST_REQUIRE((admission == Admission::EXPIRED));
+  server->send(*refuseRequest(msg_factory, message, admission));
+
+  ICommunicator::Response client_response =
+      client->receive(MessageType::GOOGLE_PROTOCOL_BUFFER);
+  BOOST_REQUIRE(client_response.time_out == false);
+  BOOST_REQUIRE(client_response.error == false);
+  BOOST_TEST(std::get<std::string>(client_response.message->get(
+                 MessageAttribute::CORRELATION_ID)) == correlation_id);
+
+  auto nack = dynamic_cast<Anon::NackReply *>(
+      std::get<::google::protobuf::Message *>(
+          client_response.message->getPayload()));
+  BOOST_REQUIRE(nack != nullptr);
+  BOOST_TEST(nack->err_code() == ID_SERVICE_ERROR);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
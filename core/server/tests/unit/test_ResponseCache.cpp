@@ -0,0 +1,149 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE responsecache
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "ResponseCache.hpp"
+
+// Public common includes
+#include "common/ProtoBufMap.hpp"
+
+// Standard includes
+#include <chrono>
+#include <set>
+#include <string>
+
+using namespace SDMS;
+using namespace SDMS::Core;
+
+namespace {
+const uint16_t READ_TYPE = 300;
+const uint16_t SHARED_TYPE = 301;
+const uint16_t WRITE_TYPE = 302;
+} // namespace
+
+struct ResponseCacheFixture {
+  ResponseCacheFixture() {
+    cache.setCapacity(1 << 20);
+    cache.enable(READ_TYPE, std::chrono::seconds(30), false);
+    cache.enable(SHARED_TYPE, std::chrono::seconds(30), true);
+    cache.invalidateOn(WRITE_TYPE, READ_TYPE);
+  }
+
+  /// Looks up a request and stores a_reply if it missed
+  bool cached(uint16_t a_msg_type, const std::string &a_uid,
+              const std::string &a_request, const std::string &a_reply,
+              ResponseCache::clock::time_point a_now) {
+    ResponseCache::Ticket ticket;
+    std::string reply;
+    if (cache.get(a_msg_type, a_uid, a_request, reply, ticket, a_now)) {
+      BOOST_TEST(reply == a_reply);
+      return true;
+    }
+    cache.put(ticket, a_reply, a_now);
+    return false;
+  }
+
+  ResponseCache cache;
+  ResponseCache::clock::time_point now = ResponseCache::clock::now();
+};
+
+BOOST_FIXTURE_TEST_SUITE(ResponseCacheTest, ResponseCacheFixture)
+
+BOOST_AUTO_TEST_CASE(testing_ResponseCache_scope) {
+  BOOST_TEST(cache.enabled(READ_TYPE));
+  BOOST_TEST(!cache.enabled(WRITE_TYPE));
+
+  BOOST_TEST(!cached(READ_TYPE, "u/alice", "req", "alice's reply", now));
+  BOOST_TEST(cached(READ_TYPE, "u/alice", "req", "alice's reply", now));
+  // Replies depend on the user unless they are shared
+  BOOST_TEST(!cached(READ_TYPE, "u/bob", "req", "bob's reply", now));
+  BOOST_TEST(!cached(READ_TYPE, "u/alice", "other", "reply", now));
+
+  BOOST_TEST(!cached(SHARED_TYPE, "u/alice", "req", "public", now));
+  BOOST_TEST(cached(SHARED_TYPE, "u/bob", "req", "public", now));
+
+  ResponseCache::Stats stats = cache.getStats();
+  BOOST_TEST(stats.hits == 2);
+  BOOST_TEST(stats.misses == 4);
+  BOOST_TEST(stats.entries == 4);
+}
+
+BOOST_AUTO_TEST_CASE(testing_ResponseCache_ttl) {
+  const auto before = now + std::chrono::seconds(29);
+  const auto after = now + std::chrono::seconds(31);
+
+  BOOST_TEST(!cached(READ_TYPE, "u/alice", "req", "reply", now));
+  BOOST_TEST(cached(READ_TYPE, "u/alice", "req", "reply", before));
+  BOOST_TEST(!cached(READ_TYPE, "u/alice", "req", "reply", after));
+  BOOST_TEST(cache.getStats().expired == 1);
+}
+
+BOOST_AUTO_TEST_CASE(testing_ResponseCache_invalidate) {
+  BOOST_TEST(!cached(READ_TYPE, "u/alice", "req", "old", now));
+  BOOST_TEST(!cached(SHARED_TYPE, "u/alice", "req", "public", now));
+
+  // A read that started before the write must not store what it read
+  ResponseCache::Ticket ticket;
+  std::string reply;
+  BOOST_TEST(!cache.get(READ_TYPE, "u/bob", "req", reply, ticket, now));
+
+  cache.invalidate(WRITE_TYPE);
+  cache.put(ticket, "stale", now);
+
+  BOOST_TEST(!cached(READ_TYPE, "u/alice", "req", "new", now));
+  BOOST_TEST(cached(READ_TYPE, "u/alice", "req", "new", now));
+  BOOST_TEST(!cached(READ_TYPE, "u/bob", "req", "fresh", now));
+  // Replies not linked to the write are kept
+  BOOST_TEST(cached(SHARED_TYPE, "u/alice", "req", "public", now));
+
+  // Requests without links change nothing
+  cache.invalidate(READ_TYPE);
+  BOOST_TEST(cached(READ_TYPE, "u/alice", "req", "new", now));
+  BOOST_TEST(cache.getStats().invalidations == 1);
+}
+
+BOOST_AUTO_TEST_CASE(testing_ResponseCache_capacity) {
+  cache.setCapacity(16 * 1024);
+  const std::string reply(1000, 'x');
+
+  for (int i = 0; i < 32; ++i)
+    cached(READ_TYPE, "u/alice", std::to_string(i), reply, now);
+
+  ResponseCache::Stats stats = cache.getStats();
+  BOOST_TEST(stats.bytes <= 16 * 1024);
+  BOOST_TEST(stats.evicted > 0);
+  // Least recently used go first
+  BOOST_TEST(cached(READ_TYPE, "u/alice", "31", reply, now));
+  BOOST_TEST(!cached(READ_TYPE, "u/alice", "0", reply, now));
+
+  // Replies too big for their share of the cache are not stored
+  const std::string huge(4 * 1024, 'x');
+  BOOST_TEST(!cached(READ_TYPE, "u/alice", "huge", huge, now));
+  BOOST_TEST(!cached(READ_TYPE, "u/alice", "huge", huge, now));
+
+  cache.setCapacity(0);
+  BOOST_TEST(!cache.enabled(READ_TYPE));
+  BOOST_TEST(cache.getStats().bytes == 0);
+}
+
+BOOST_AUTO_TEST_CASE(testing_ResponseCache_default_policies) {
+  // Writes run as tasks change the DB after the handler returns
+  const std::set<std::string> task_writes = {
+      "RecordDeleteRequest", "CollDeleteRequest", "ProjectDeleteRequest",
+      "RepoAllocationCreateRequest", "RepoAllocationDeleteRequest"};
+
+  // Throws if a request name is unknown
+  const ProtoBufMap &proto_map = ProtoBufMap::getInstance();
+  for (auto &policy : ResponseCache::defaultPolicies()) {
+    BOOST_TEST(policy.ttl > 0);
+    proto_map.getMessageType(2, policy.name);
+    for (const char *write : policy.invalidated_by) {
+      proto_map.getMessageType(2, write);
+      BOOST_TEST(task_writes.count(write) == 0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,154 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE schemavalidatorcache
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "SchemaValidatorCache.hpp"
+
+// Standard includes
+#include <map>
+#include <stdexcept>
+#include <string>
+
+using namespace SDMS::Core;
+
+struct SchemaStore {
+  std::map<std::string, std::string> defs;
+  /// Private schemas and the user that owns them
+  std::map<std::string, std::string> owners;
+  size_t fetch_count = 0;
+
+  /// Fetches on behalf of a_uid, like the DB schema view
+  SchemaValidatorCache::fetch_t fetcher(const std::string &a_uid = "u/any") {
+    return [this, a_uid](const std::string &a_id) {
+      fetch_count++;
+      auto owner = owners.find(a_id);
+      if (owner != owners.end() && owner->second != a_uid)
+        throw std::runtime_error("Permission denied");
+
+      SchemaValidatorCache::Source source;
+      source.definition = defs.at(a_id);
+      source.pub = owner == owners.end();
+      return source;
+    };
+  }
+};
+
+BOOST_AUTO_TEST_SUITE(SchemaValidatorCacheTest)
+
+BOOST_AUTO_TEST_CASE(testing_SchemaValidatorCache_reuse) {
+  SchemaValidatorCache &cache = SchemaValidatorCache::getInstance();
+  cache.clear();
+
+  SchemaStore store;
+  store.defs["test:0"] = "{\"type\":\"object\",\"properties\":{\"a\":{\"type\":"
+                         "\"number\"}},\"required\":[\"a\"]}";
+
+  SchemaValidatorCache::validator_ptr_t validator1 =
+      cache.getValidator("u/any", "test:0", store.fetcher());
+  SchemaValidatorCache::validator_ptr_t validator2 =
+      cache.getValidator("u/any", "test:0", store.fetcher());
+
+  // Compiled once, fetched once
+  BOOST_TEST(validator1.get() == validator2.get());
+  BOOST_TEST(store.fetch_count == 1);
+
+  validator1->validate(nlohmann::json::parse("{\"a\":1}"));
+  BOOST_CHECK_THROW(validator1->validate(nlohmann::json::parse("{\"b\":1}")),
+                    std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(testing_SchemaValidatorCache_invalidate) {
+  SchemaValidatorCache &cache = SchemaValidatorCache::getInstance();
+  cache.clear();
+
+  SchemaStore store;
+  store.defs["test:1"] = "{\"type\":\"object\",\"properties\":{\"a\":{\"type\":"
+                         "\"number\"}}}";
+
+  SchemaValidatorCache::validator_ptr_t validator1 =
+      cache.getValidator("u/any", "test:1", store.fetcher());
+  BOOST_CHECK_THROW(
+      validator1->validate(nlohmann::json::parse("{\"a\":\"text\"}")),
+      std::exception);
+
+  // Schema updated in the DB, the cache must pick up the new definition
+  store.defs["test:1"] = "{\"type\":\"object\",\"properties\":{\"a\":{\"type\":"
+                         "\"string\"}}}";
+  cache.invalidate("test:1");
+
+  SchemaValidatorCache::validator_ptr_t validator2 =
+      cache.getValidator("u/any", "test:1", store.fetcher());
+
+  BOOST_TEST(validator1.get() != validator2.get());
+  BOOST_TEST(store.fetch_count == 2);
+  validator2->validate(nlohmann::json::parse("{\"a\":\"text\"}"));
+}
+
+BOOST_AUTO_TEST_CASE(testing_SchemaValidatorCache_definition) {
+  SchemaValidatorCache &cache = SchemaValidatorCache::getInstance();
+  cache.clear();
+
+  SchemaStore store;
+  store.defs["test:2"] = "{\"type\":\"object\"}";
+
+  SchemaValidatorCache::definition_ptr_t def1 =
+      cache.getDefinition("u/any", "test:2", store.fetcher());
+  SchemaValidatorCache::definition_ptr_t def2 =
+      cache.getDefinition("u/any", "test:2", store.fetcher());
+
+  BOOST_TEST(def1.get() == def2.get());
+  BOOST_TEST((*def1)["type"] == "object");
+  BOOST_TEST(store.fetch_count == 1);
+
+  // Fetch failures are not cached
+  BOOST_CHECK_THROW(cache.getDefinition("u/any", "missing:0", store.fetcher()),
+                    std::out_of_range);
+  BOOST_CHECK_THROW(cache.getDefinition("u/any", "missing:0", store.fetcher()),
+                    std::out_of_range);
+  BOOST_TEST(store.fetch_count == 3);
+}
+
+BOOST_AUTO_TEST_CASE(testing_SchemaValidatorCache_private) {
+  SchemaValidatorCache &cache = SchemaValidatorCache::getInstance();
+  cache.clear();
+
+  SchemaStore store;
+  store.defs["secret:0"] = "{\"type\":\"object\"}";
+  store.owners["secret:0"] = "u/alice";
+  store.defs["shared:0"] =
+      "{\"type\":\"object\",\"properties\":{\"a\":{\"$ref\":\"secret:0\"}}}";
+
+  SchemaValidatorCache::validator_ptr_t validator =
+      cache.getValidator("u/alice", "secret:0", store.fetcher("u/alice"));
+  BOOST_TEST(cache.getValidator("u/alice", "secret:0", store.fetcher("u/alice"))
+                 .get() == validator.get());
+  BOOST_TEST(store.fetch_count == 1);
+
+  // Other users are still checked by the DB
+  BOOST_CHECK_THROW(
+      cache.getValidator("u/bob", "secret:0", store.fetcher("u/bob")),
+      std::runtime_error);
+  BOOST_CHECK_THROW(
+      cache.getDefinition("u/bob", "secret:0", store.fetcher("u/bob")),
+      std::runtime_error);
+
+  // Validators using a private schema are private too
+  cache.getValidator("u/alice", "shared:0", store.fetcher("u/alice"));
+  BOOST_CHECK_THROW(
+      cache.getValidator("u/bob", "shared:0", store.fetcher("u/bob")),
+      std::runtime_error);
+
+  // Public definitions are shared
+  size_t fetch_count = store.fetch_count;
+  cache.getDefinition("u/bob", "shared:0", store.fetcher("u/bob"));
+  BOOST_TEST(store.fetch_count == fetch_count);
+
+  // Invalidation drops the entries of every user
+  cache.invalidate("secret:0");
+  cache.getValidator("u/alice", "secret:0", store.fetcher("u/alice"));
+  BOOST_TEST(store.fetch_count > fetch_count);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
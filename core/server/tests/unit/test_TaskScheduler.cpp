@@ -0,0 +1,169 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE taskscheduler
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "TaskScheduler.hpp"
+
+// Local public includes
+#include "common/SDMS.pb.h"
+#include "common/TraceException.hpp"
+
+// Standard includes
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace SDMS;
+using namespace SDMS::Core;
+
+namespace {
+
+void push(TaskScheduler &a_sched, const std::string &a_owner, int a_count,
+          int32_t a_type = TT_DATA_GET) {
+  for (int i = 0; i < a_count; i++) {
+    auto task = std::make_unique<ITaskMgr::Task>(a_owner + "/" +
+                                                 std::to_string(i));
+    task->owner = a_owner;
+    task->type = a_type;
+    a_sched.push(std::move(task));
+  }
+}
+
+std::vector<std::string> popOwners(TaskScheduler &a_sched, size_t a_count) {
+  std::vector<std::string> owners;
+  while (owners.size() < a_count) {
+    auto task = a_sched.pop();
+    if (!task)
+      break;
+    owners.push_back(task->owner);
+  }
+  return owners;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(TaskSchedulerTest)
+
+BOOST_AUTO_TEST_CASE(testing_TaskScheduler_empty) {
+  TaskScheduler sched;
+  BOOST_TEST(sched.empty());
+  BOOST_TEST(!sched.pop());
+}
+
+BOOST_AUTO_TEST_CASE(testing_TaskScheduler_round_robin) {
+  TaskScheduler sched;
+
+  // A big backlog queued first must not delay other owners
+  push(sched, "u/heavy", 100);
+  push(sched, "u/light", 3);
+  push(sched, "p/proj", 2);
+  BOOST_TEST(sched.size() == 105);
+
+  std::vector<std::string> expected = {"u/heavy", "u/light", "p/proj",
+                                       "u/heavy", "u/light", "p/proj",
+                                       "u/heavy", "u/light", "u/heavy",
+                                       "u/heavy"};
+  BOOST_TEST(popOwners(sched, expected.size()) == expected,
+             boost::test_tools::per_element());
+  BOOST_TEST(sched.size() == 95);
+}
+
+BOOST_AUTO_TEST_CASE(testing_TaskScheduler_fifo_per_owner) {
+  TaskScheduler sched;
+  push(sched, "u/a", 3);
+
+  BOOST_TEST(sched.pop()->task_id == "u/a/0");
+  BOOST_TEST(sched.pop()->task_id == "u/a/1");
+  BOOST_TEST(sched.pop()->task_id == "u/a/2");
+}
+
+BOOST_AUTO_TEST_CASE(testing_TaskScheduler_weights) {
+  TaskScheduler sched;
+  sched.setWeight("u/double", 2);
+  sched.setWeight("u/half", 0.5);
+  BOOST_TEST(sched.weight("u/double") == 2);
+  BOOST_TEST(sched.weight("u/other") == 1);
+
+  push(sched, "u/double", 100);
+  push(sched, "u/other", 100);
+  push(sched, "u/half", 100);
+
+  std::map<std::string, int> counts;
+  for (const std::string &owner : popOwners(sched, 70))
+    counts[owner]++;
+
+  BOOST_TEST(counts["u/double"] == 40);
+  BOOST_TEST(counts["u/other"] == 20);
+  BOOST_TEST(counts["u/half"] == 10);
+
+  BOOST_CHECK_THROW(sched.setWeight("u/none", 0), TraceException);
+}
+
+BOOST_AUTO_TEST_CASE(testing_TaskScheduler_priority) {
+  TaskScheduler sched;
+
+  push(sched, "u/a", 1, TT_DATA_DEL);
+  push(sched, "u/a", 1, TT_DATA_GET);
+  push(sched, "u/b", 1, TT_ALLOC_CREATE);
+  push(sched, "u/c", 1, -1);
+
+  BOOST_TEST(sched.pop()->type == TT_ALLOC_CREATE);
+  BOOST_TEST(sched.pop()->type == TT_DATA_GET);
+  // Tasks of unknown type go with the transfers
+  BOOST_TEST(sched.pop()->type == -1);
+  BOOST_TEST(sched.pop()->type == TT_DATA_DEL);
+  BOOST_TEST(sched.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testing_TaskScheduler_queue_depths) {
+  TaskScheduler sched;
+
+  push(sched, "u/a", 3, TT_DATA_GET);
+  push(sched, "u/a", 2, TT_REC_DEL);
+  push(sched, "u/b", 1, TT_ALLOC_DEL);
+
+  std::map<std::string, size_t> depths = sched.queueDepths();
+  BOOST_TEST(depths.size() == 2);
+  BOOST_TEST(depths["u/a"] == 5);
+  BOOST_TEST(depths["u/b"] == 1);
+
+  popOwners(sched, 6);
+  BOOST_TEST(sched.queueDepths().empty());
+}
+
+// Workers take tasks while owners keep submitting, as in a busy core
+BOOST_AUTO_TEST_CASE(testing_TaskScheduler_simulated_workload) {
+  TaskScheduler sched;
+  const size_t workers = 4;
+
+  push(sched, "u/bulk", 5000);
+
+  std::map<std::string, size_t> finished_at;
+  size_t tick = 0;
+  while (!sched.empty()) {
+    // A few interactive users submit one task every other tick for a while
+    if (tick < 40 && tick % 2 == 0) {
+      for (int u = 0; u < 5; u++)
+        push(sched, "u/user" + std::to_string(u), 1);
+    }
+
+    for (size_t w = 0; w < workers; w++) {
+      auto task = sched.pop();
+      if (!task)
+        break;
+      finished_at[task->owner] = tick;
+    }
+    tick++;
+  }
+
+  // Each user gets a turn every round, so their tasks barely wait even with
+  // thousands of bulk tasks ahead of them
+  for (int u = 0; u < 5; u++)
+    BOOST_TEST(finished_at["u/user" + std::to_string(u)] <= 42);
+  BOOST_TEST(finished_at["u/bulk"] > 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,112 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE tasktargetlimiter
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "TaskTargetLimiter.hpp"
+
+// Standard includes
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace SDMS;
+using namespace SDMS::Core;
+
+namespace {
+
+std::unique_ptr<ITaskMgr::Task> makeTask(const std::string &a_id) {
+  return std::make_unique<ITaskMgr::Task>(a_id);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(TaskTargetLimiterTest)
+
+BOOST_AUTO_TEST_CASE(testing_TaskTargetLimiter_limits) {
+  TaskTargetLimiter limiter(2, 3);
+  limiter.setLimit("repo/big", 10);
+  limiter.setLimit("ep-slow", 1);
+
+  BOOST_TEST(limiter.limit("repo/a") == 2);
+  BOOST_TEST(limiter.limit("repo/big") == 10);
+  BOOST_TEST(limiter.limit("ep-fast") == 3);
+  BOOST_TEST(limiter.limit("ep-slow") == 1);
+}
+
+BOOST_AUTO_TEST_CASE(testing_TaskTargetLimiter_saturated_target_waits) {
+  TaskTargetLimiter limiter(1, 0);
+
+  auto task1 = makeTask("task/1");
+  auto task2 = makeTask("task/2");
+  auto task3 = makeTask("task/3");
+
+  BOOST_TEST(limiter.acquire(task1, {"repo/a"}));
+  BOOST_TEST(task1->targets.size() == 1);
+
+  // repo/a is full, task 2 waits while task 3 for repo/b runs
+  BOOST_TEST(!limiter.acquire(task2, {"repo/a"}));
+  BOOST_TEST(!task2);
+  BOOST_TEST(limiter.acquire(task3, {"repo/b"}));
+
+  auto stats = limiter.getStats();
+  BOOST_TEST(stats["repo/a"].in_flight == 1);
+  BOOST_TEST(stats["repo/a"].waiting == 1);
+  BOOST_TEST(stats["repo/b"].in_flight == 1);
+
+  std::vector<std::unique_ptr<ITaskMgr::Task>> ready;
+  limiter.release(*task3, ready);
+  BOOST_TEST(ready.empty());
+  BOOST_TEST(task3->targets.empty());
+
+  limiter.release(*task1, ready);
+  BOOST_REQUIRE(ready.size() == 1);
+  BOOST_TEST(ready[0]->task_id == "task/2");
+
+  BOOST_TEST(limiter.acquire(ready[0], {"repo/a"}));
+  limiter.release(*ready[0], ready);
+  BOOST_TEST(limiter.getStats().empty());
+}
+
+BOOST_AUTO_TEST_CASE(testing_TaskTargetLimiter_all_or_nothing) {
+  TaskTargetLimiter limiter(0, 1);
+
+  auto xfr1 = makeTask("task/1");
+  auto xfr2 = makeTask("task/2");
+  BOOST_TEST(limiter.acquire(xfr1, {"ep-a", "ep-b"}));
+  BOOST_TEST(!limiter.acquire(xfr2, {"ep-c", "ep-b"}));
+
+  // The waiting transfer holds no slot on ep-c
+  auto xfr3 = makeTask("task/3");
+  BOOST_TEST(limiter.acquire(xfr3, {"ep-c"}));
+
+  // Unlimited repos are only counted
+  auto task = makeTask("task/4");
+  BOOST_TEST(limiter.acquire(task, {"repo/a"}));
+  auto task2 = makeTask("task/5");
+  BOOST_TEST(limiter.acquire(task2, {"repo/a"}));
+  BOOST_TEST(limiter.getStats()["repo/a"].in_flight == 2);
+}
+
+BOOST_AUTO_TEST_CASE(testing_TaskTargetLimiter_same_endpoint) {
+  TaskTargetLimiter limiter(0, 1);
+
+  // A transfer between two paths of one endpoint takes one slot
+  auto xfr = makeTask("task/1");
+  BOOST_TEST(limiter.acquire(xfr, {"ep-a", "ep-a"}));
+  BOOST_TEST(xfr->targets.size() == 1);
+  BOOST_TEST(limiter.getStats()["ep-a"].in_flight == 1);
+}
+
+BOOST_AUTO_TEST_CASE(testing_TaskTargetLimiter_release_without_targets) {
+  TaskTargetLimiter limiter(1, 1);
+  auto task = makeTask("task/1");
+  std::vector<std::unique_ptr<ITaskMgr::Task>> ready;
+
+  limiter.release(*task, ready);
+  BOOST_TEST(ready.empty());
+  BOOST_TEST(limiter.acquire(task, {}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE timerwheel
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "TimerWheel.hpp"
+
+// Standard includes
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace SDMS::Core;
+
+BOOST_AUTO_TEST_SUITE(TimerWheelTest)
+
+BOOST_AUTO_TEST_CASE(testing_TimerWheel_expires_at_deadline) {
+  TimerWheel wheel(1000);
+  wheel.schedule("a", 1005);
+  wheel.schedule("b", 1010);
+  BOOST_TEST(wheel.size() == 2);
+
+  std::vector<std::string> expired;
+  wheel.advance(1004, expired);
+  BOOST_TEST(expired.empty());
+
+  wheel.advance(1005, expired);
+  BOOST_REQUIRE(expired.size() == 1);
+  BOOST_TEST(expired[0] == "a");
+
+  expired.clear();
+  wheel.advance(1100, expired);
+  BOOST_REQUIRE(expired.size() == 1);
+  BOOST_TEST(expired[0] == "b");
+  BOOST_TEST(wheel.size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(testing_TimerWheel_past_deadline) {
+  TimerWheel wheel(1000);
+  wheel.schedule("late", 900);
+
+  std::vector<std::string> expired;
+  wheel.advance(1000, expired);
+  BOOST_REQUIRE(expired.size() == 1);
+  BOOST_TEST(expired[0] == "late");
+}
+
+BOOST_AUTO_TEST_CASE(testing_TimerWheel_cascades_levels) {
+  const time_t start = 5000;
+  TimerWheel wheel(start);
+
+  // One timer per level and one beyond the span of the wheel
+  std::vector<time_t> deadlines = {start + 30, start + 64 * 10 + 7,
+                                   start + 64 * 64 * 5 + 3,
+                                   start + 64 * 64 * 64 + 100};
+  for (size_t i = 0; i < deadlines.size(); i++)
+    wheel.schedule(std::to_string(i), deadlines[i]);
+
+  std::vector<std::string> expired;
+  for (size_t i = 0; i < deadlines.size(); i++) {
+    wheel.advance(deadlines[i] - 1, expired);
+    BOOST_TEST(expired.empty());
+    wheel.advance(deadlines[i], expired);
+    BOOST_REQUIRE(expired.size() == 1);
+    BOOST_TEST(expired[0] == std::to_string(i));
+    expired.clear();
+  }
+  BOOST_TEST(wheel.size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(testing_TimerWheel_long_gap) {
+  TimerWheel wheel(0);
+  wheel.schedule("a", 10);
+  wheel.schedule("b", 64 * 64 * 64 * 3);
+
+  // Not advanced for longer than the span of the wheel
+  std::vector<std::string> expired;
+  wheel.advance(64 * 64 * 64 * 2, expired);
+  BOOST_REQUIRE(expired.size() == 1);
+  BOOST_TEST(expired[0] == "a");
+
+  expired.clear();
+  wheel.advance(64 * 64 * 64 * 3, expired);
+  BOOST_REQUIRE(expired.size() == 1);
+  BOOST_TEST(expired[0] == "b");
+}
+
+BOOST_AUTO_TEST_CASE(testing_TimerWheel_clear) {
+  TimerWheel wheel(0);
+  wheel.schedule("a", 1);
+  wheel.schedule("b", 100000);
+  wheel.clear();
+  BOOST_TEST(wheel.size() == 0);
+
+  std::vector<std::string> expired;
+  wheel.advance(200000, expired);
+  BOOST_TEST(expired.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
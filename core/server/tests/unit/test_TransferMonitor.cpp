@@ -0,0 +1,193 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE transfermonitor
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "TransferMonitor.hpp"
+
+// Standard includes
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace SDMS;
+using namespace SDMS::Core;
+
+namespace {
+
+/// Plays the part of Globus and of the TaskMgr
+struct FakeGlobus {
+  std::mutex mutex;
+  std::condition_variable cvar;
+  std::map<std::string, GlobusAPI::XfrState> states;
+  std::vector<size_t> batch_sizes;
+  std::vector<std::string> tokens;
+  std::vector<std::string> cancelled;
+  std::vector<std::unique_ptr<ITaskMgr::Task>> resumed;
+  bool fail_checks = false;
+
+  void setStatus(const std::string &a_id, GlobusAPI::XfrStatus a_status,
+                 bool a_cancel = false, const std::string &a_err_msg = "") {
+    std::lock_guard<std::mutex> lock(mutex);
+    GlobusAPI::XfrState &state = states[a_id];
+    state.status = a_status;
+    state.cancel = a_cancel;
+    state.err_msg = a_err_msg;
+  }
+
+  TransferMonitor::check_fun_t check() {
+    return [this](const std::vector<std::string> &a_ids,
+                  const std::string &a_acc_tok,
+                  std::map<std::string, GlobusAPI::XfrState> &a_states) {
+      std::lock_guard<std::mutex> lock(mutex);
+      batch_sizes.push_back(a_ids.size());
+      tokens.push_back(a_acc_tok);
+      if (fail_checks)
+        EXCEPT(1, "Globus unavailable");
+      for (const std::string &id : a_ids) {
+        auto state = states.find(id);
+        if (state != states.end())
+          a_states[id] = state->second;
+      }
+    };
+  }
+
+  TransferMonitor::cancel_fun_t cancel() {
+    return [this](const std::string &a_id, const std::string &) {
+      std::lock_guard<std::mutex> lock(mutex);
+      cancelled.push_back(a_id);
+    };
+  }
+
+  TransferMonitor::resume_fun_t resume() {
+    return [this](std::unique_ptr<ITaskMgr::Task> a_task) {
+      std::lock_guard<std::mutex> lock(mutex);
+      resumed.push_back(std::move(a_task));
+      cvar.notify_all();
+    };
+  }
+
+  bool waitResumed(size_t a_count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cvar.wait_for(lock, std::chrono::seconds(5),
+                         [&] { return resumed.size() >= a_count; });
+  }
+};
+
+std::unique_ptr<ITaskMgr::Task> makeTask(const std::string &a_id) {
+  return std::unique_ptr<ITaskMgr::Task>(new ITaskMgr::Task(a_id));
+}
+
+TransferMonitor::Options fastOptions() {
+  TransferMonitor::Options options;
+  options.min_interval = std::chrono::milliseconds(10);
+  options.max_interval = std::chrono::milliseconds(40);
+  return options;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(TransferMonitorTest)
+
+BOOST_AUTO_TEST_CASE(testing_TransferMonitor_succeeded) {
+  FakeGlobus globus;
+  LogContext log_context;
+  TransferMonitor monitor(globus.check(), globus.cancel(), globus.resume(),
+                          log_context, fastOptions());
+
+  globus.setStatus("xfr1", GlobusAPI::XS_ACTIVE);
+  monitor.add(makeTask("task/1"), "xfr1", "tok");
+  BOOST_TEST(monitor.size() == 1);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_TEST(monitor.size() == 1);
+  globus.setStatus("xfr1", GlobusAPI::XS_SUCCEEDED);
+
+  BOOST_REQUIRE(globus.waitResumed(1));
+  BOOST_TEST(monitor.size() == 0);
+  BOOST_TEST(globus.resumed[0]->task_id == "task/1");
+  BOOST_TEST(globus.resumed[0]->resume);
+  BOOST_TEST(globus.resumed[0]->resume_err_msg.empty());
+  BOOST_TEST(globus.cancelled.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testing_TransferMonitor_failed) {
+  FakeGlobus globus;
+  LogContext log_context;
+  TransferMonitor monitor(globus.check(), globus.cancel(), globus.resume(),
+                          log_context, fastOptions());
+
+  globus.setStatus("xfr1", GlobusAPI::XS_FAILED, true, "too many faults");
+  monitor.add(makeTask("task/1"), "xfr1", "tok");
+
+  BOOST_REQUIRE(globus.waitResumed(1));
+  BOOST_TEST(globus.resumed[0]->resume);
+  BOOST_TEST(globus.resumed[0]->resume_err_msg == "too many faults");
+  BOOST_TEST(globus.cancelled.size() == 1);
+  BOOST_TEST(globus.cancelled[0] == "xfr1");
+}
+
+BOOST_AUTO_TEST_CASE(testing_TransferMonitor_batches) {
+  FakeGlobus globus;
+  LogContext log_context;
+  TransferMonitor::Options options = fastOptions();
+  options.min_interval = std::chrono::milliseconds(100);
+  options.batch_size = 2;
+  TransferMonitor monitor(globus.check(), globus.cancel(), globus.resume(),
+                          log_context, options);
+
+  // Added together, so all are due on the same pass
+  for (int i = 0; i < 3; i++) {
+    std::string id = "xfr" + std::to_string(i);
+    globus.setStatus(id, GlobusAPI::XS_SUCCEEDED);
+    monitor.add(makeTask("task/" + std::to_string(i)), id, "tok_a");
+  }
+  globus.setStatus("xfr_b", GlobusAPI::XS_SUCCEEDED);
+  monitor.add(makeTask("task/b"), "xfr_b", "tok_b");
+
+  BOOST_REQUIRE(globus.waitResumed(4));
+  std::lock_guard<std::mutex> lock(globus.mutex);
+  // One call per token and batch
+  BOOST_TEST(globus.batch_sizes.size() == 3);
+  BOOST_TEST(globus.tokens[0] == "tok_a");
+  BOOST_TEST(globus.batch_sizes[0] == 2);
+  BOOST_TEST(globus.batch_sizes[1] == 1);
+  BOOST_TEST(globus.tokens[2] == "tok_b");
+}
+
+BOOST_AUTO_TEST_CASE(testing_TransferMonitor_check_errors) {
+  FakeGlobus globus;
+  LogContext log_context;
+  TransferMonitor::Options options = fastOptions();
+  options.max_check_errors = 3;
+  TransferMonitor monitor(globus.check(), globus.cancel(), globus.resume(),
+                          log_context, options);
+
+  globus.fail_checks = true;
+  monitor.add(makeTask("task/1"), "xfr1", "tok");
+
+  BOOST_REQUIRE(globus.waitResumed(1));
+  BOOST_TEST(globus.batch_sizes.size() == 3);
+  BOOST_TEST(globus.resumed[0]->resume);
+  BOOST_TEST(globus.resumed[0]->resume_err_msg.find("Globus unavailable") !=
+             std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(testing_TransferMonitor_shutdown) {
+  FakeGlobus globus;
+  LogContext log_context;
+  {
+    TransferMonitor monitor(globus.check(), globus.cancel(), globus.resume(),
+                            log_context, fastOptions());
+    globus.setStatus("xfr1", GlobusAPI::XS_ACTIVE);
+    monitor.add(makeTask("task/1"), "xfr1", "tok");
+  }
+  BOOST_TEST(globus.resumed.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#define BOOST_TEST_MAIN
+
+#define BOOST_TEST_MODULE validationpool
+#include <boost/test/unit_test.hpp>
+
+// Local private includes
+#include "ValidationPool.hpp"
+
+// Standard includes
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace SDMS::Core;
+
+BOOST_AUTO_TEST_SUITE(ValidationPoolTest)
+
+BOOST_AUTO_TEST_CASE(testing_ValidationPool_all_indices) {
+  ValidationPool pool(4);
+
+  BOOST_TEST(pool.numThreads() == 4);
+
+  // Reuse the same pool for several rounds
+  for (size_t count : {0, 1, 3, 1000}) {
+    std::vector<int> done(count, 0);
+
+    pool.parallelFor(count, [&done](size_t a_index) { done[a_index]++; });
+
+    for (size_t i = 0; i < count; i++)
+      BOOST_TEST(done[i] == 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testing_ValidationPool_uses_threads) {
+  ValidationPool pool(4);
+  std::mutex mtx;
+  std::set<std::thread::id> ids;
+
+  pool.parallelFor(64, [&mtx, &ids](size_t a_index) {
+    (void)a_index;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    std::lock_guard<std::mutex> lock(mtx);
+    ids.insert(std::this_thread::get_id());
+  });
+
+  BOOST_TEST(ids.size() > 1);
+}
+
+BOOST_AUTO_TEST_CASE(testing_ValidationPool_exception) {
+  ValidationPool pool(3);
+  std::atomic<size_t> count(0);
+
+  BOOST_CHECK_THROW(pool.parallelFor(100,
+                                     [&count](size_t a_index) {
+                                       count++;
+                                       if (a_index == 10)
+                                         throw std::runtime_error("bad");
+                                     }),
+                    std::runtime_error);
+
+  BOOST_TEST(count <= 100);
+
+  // Pool is still usable after a failure
+  count = 0;
+  pool.parallelFor(10, [&count](size_t a_index) {
+    (void)a_index;
+    count++;
+  });
+  BOOST_TEST(count == 10);
+}
+
+BOOST_AUTO_TEST_CASE(testing_ValidationPool_shared) {
+  ValidationPool pool(2);
+  std::vector<std::thread> callers;
+  std::vector<std::vector<int>> done(4, std::vector<int>(500, 0));
+
+  // Callers of different workers use the pool at the same time
+  for (size_t c = 0; c < done.size(); c++) {
+    callers.emplace_back([&pool, &done, c] {
+      pool.parallelFor(done[c].size(),
+                       [&done, c](size_t a_index) { done[c][a_index]++; });
+    });
+  }
+  for (std::thread &caller : callers)
+    caller.join();
+
+  for (auto &caller_done : done) {
+    for (int count : caller_done)
+      BOOST_TEST(count == 1);
+  }
+
+  pool.setNumThreads(3);
+  BOOST_TEST(pool.numThreads() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(testing_ValidationPool_default_size) {
+  ValidationPool pool;
+
+  BOOST_TEST(pool.numThreads() >= 1);
+  BOOST_TEST(pool.numThreads() <= ValidationPool::DEFAULT_MAX_THREADS);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -195,8 +195,14 @@ class Connection:
             desc = self._msg_desc_by_type[msg_type]
 
             if frame_values[0] > 0:
-                # Create message by parsing content
+                # Create message by parsing content, large bodies may be
+                # sent as several chunks that follow each other
                 data = self._socket.recv(0)
+                if self._socket.getsockopt(zmq.RCVMORE):
+                    chunks = [data]
+                    while self._socket.getsockopt(zmq.RCVMORE):
+                        chunks.append(self._socket.recv(0))
+                    data = b"".join(chunks)
                 reply = GetMessageClass(desc)()
                 reply.ParseFromString(data)
             else:
@@ -215,9 +221,11 @@ class Connection:
     #
     # @param message - The protobuf message object to be sent
     # @param ctxt - Reply re-association value (int)
+    # @param a_time_left - Milliseconds the reply will be waited for, sent
+    #                      as the request deadline if set (int)
     # @exception Exception: if unregistered message type is sent.
     #
-    def send(self, message, ctxt):
+    def send(self, message, ctxt, a_time_left=None):
         # Find msg type by descriptor look-up
         if not (message.DESCRIPTOR in self._msg_type_by_desc):
             raise Exception("Attempt to send unregistered message type.")
@@ -234,6 +242,9 @@ class Connection:
         self._socket.send_string(correlation_id, zmq.SNDMORE)
         self._socket.send_string(self._pub_key, zmq.SNDMORE)
         self._socket.send_string("no_user", zmq.SNDMORE)
+        if a_time_left is not None:
+            # Deadline part, the server drops the request once it passes
+            self._socket.send(b"DFDL" + struct.pack("!Q", a_time_left), zmq.SNDMORE)
 
         # Serialize
         data = message.SerializeToString()
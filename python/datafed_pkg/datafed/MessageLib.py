@@ -73,6 +73,8 @@ class API:
         self._auth = False
         self._nack_except = True
         self._timeout = 50000
+        # Only servers that know the deadline part of the envelope get one
+        self._send_deadline = False
 
         if not server_host:
             raise Exception("Server host is not defined")
@@ -219,6 +221,8 @@ class API:
                 )
             raise Exception(error_msg)
 
+        self._send_deadline = reply.api_minor >= 2
+
         if client_token:
             self.manualAuthByToken(client_token)
         else:
@@ -350,8 +354,8 @@ class API:
     # @exception Exception: On message context mismatch (out of sync)
     #
     def sendRecv(self, msg, timeout=None, nack_except=None):
-        self.send(msg)
         _timeout = timeout if timeout is not None else self._timeout
+        self.send(msg, _timeout)
         reply, mt, ctxt = self.recv(_timeout, nack_except)
         if reply is None:
             raise Exception("Timeout!!!!!!!!!")
@@ -365,13 +369,18 @@ class API:
     # @brief Asynchronously send a protobuf message to DataFed server.
     #
     # @param msg: Protobuf message to send to the server
+    #   timeout: Milliseconds the reply will be waited for, the server
+    #   drops the request once they have passed (None or < 0 = no limit)
     # @return Auto-generated message re-association context int
     #    value (match to context in subsequent reply).
     # @retval int
     #
-    def send(self, msg):
+    def send(self, msg, timeout=None):
         self._ctxt += 1
-        self._conn.send(msg, self._ctxt)
+        time_left = None
+        if self._send_deadline and timeout is not None and timeout >= 0:
+            time_left = timeout
+        self._conn.send(msg, self._ctxt, time_left)
         return self._ctxt
 
     # @brief Receive a protobuf message (reply) from DataFed server.
@@ -34,7 +34,7 @@ using namespace SDMS::Auth;
 
 namespace Repo {
 
-map<uint16_t, RequestWorker::msg_fun_t> RequestWorker::m_msg_handlers;
+vector<RequestWorker::msg_fun_t> RequestWorker::m_msg_handlers;
 
 bool RequestWorker::prefixesEqual(const std::string &str1,
                                   const std::string &str2,
@@ -159,7 +159,6 @@ RequestWorker::RequestWorker(size_t a_tid, LogContext log_context)
     : m_config(Config::getInstance()), m_tid(a_tid), m_run(true),
       m_log_context(log_context) {
 
-  m_msg_mapper = std::unique_ptr<IMessageMapper>(new ProtoBufMap);
   DL_DEBUG(m_log_context, "Setting up message handlers.");
   setupMsgHandlers();
   DL_DEBUG(m_log_context, "Creating worker thread.");
@@ -181,7 +180,7 @@ void RequestWorker::wait() {
 }
 
 #define SET_MSG_HANDLER(proto_id, msg, func)                                   \
-  m_msg_handlers[m_msg_mapper->getMessageType(proto_id, #msg)] = func
+  m_msg_handlers[msg_mapper.getMessageType(proto_id, #msg)] = func
 
 void RequestWorker::setupMsgHandlers() {
   static std::atomic_flag lock = ATOMIC_FLAG_INIT;
@@ -190,14 +189,17 @@ void RequestWorker::setupMsgHandlers() {
     return;
 
   try {
+    // Handlers are indexed directly by message type, unhandled types are null
+    const ProtoBufMap &msg_mapper = ProtoBufMap::getInstance();
+    m_msg_handlers.assign(msg_mapper.maxMessageType() + 1, nullptr);
 
     uint8_t proto_id =
-        m_msg_mapper->getProtocolID(MessageProtocol::GOOGLE_ANONONYMOUS);
+        msg_mapper.getProtocolID(MessageProtocol::GOOGLE_ANONONYMOUS);
 
     SET_MSG_HANDLER(proto_id, VersionRequest,
                     &RequestWorker::procVersionRequest);
 
-    proto_id = m_msg_mapper->getProtocolID(MessageProtocol::GOOGLE_AUTHORIZED);
+    proto_id = msg_mapper.getProtocolID(MessageProtocol::GOOGLE_AUTHORIZED);
 
     SET_MSG_HANDLER(proto_id, RepoDataDeleteRequest,
                     &RequestWorker::procDataDeleteRequest);
@@ -282,13 +284,13 @@ void RequestWorker::workerThread(LogContext log_context) {
 
           DL_TRACE(message_log_context, "Received msg of type: " << msg_type);
 
-          if (m_msg_handlers.count(msg_type)) {
-            map<uint16_t, msg_fun_t>::iterator handler =
-                m_msg_handlers.find(msg_type);
+          msg_fun_t handler = msg_type < m_msg_handlers.size()
+                                  ? m_msg_handlers[msg_type]
+                                  : nullptr;
+          if (handler) {
             DL_TRACE(message_log_context, "Calling handler");
 
-            auto send_message =
-                (this->*handler->second)(std::move(response.message));
+            auto send_message = (this->*handler)(std::move(response.message));
 
             client->send(*(send_message));
 
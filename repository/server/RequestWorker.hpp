@@ -8,7 +8,6 @@
 // Common public includes
 #include "common/DynaLog.hpp"
 #include "common/IMessage.hpp"
-#include "common/IMessageMapper.hpp"
 #include "common/MessageFactory.hpp"
 
 // Standard includes
@@ -51,9 +50,9 @@ private:
 
   typedef std::unique_ptr<IMessage> (RequestWorker::*msg_fun_t)(
       std::unique_ptr<IMessage> &&request);
-  static std::map<uint16_t, msg_fun_t> m_msg_handlers;
+  /// Message handler functions indexed by message type
+  static std::vector<msg_fun_t> m_msg_handlers;
 
-  std::unique_ptr<IMessageMapper> m_msg_mapper;
   MessageFactory m_msg_factory;
   LogContext m_log_context;
 };